@@ -0,0 +1,299 @@
+// Host driver for the pipeline benchmark (src/modules/pipeline_bench.h)
+//
+// Streams to a loopback receiver in this process, so runs are repeatable
+// and need no device; --recv-stall makes the receiver stop reading, which
+// pushes TCP back-pressure into the ring the way a stuck server does.
+#include "../../src/config.h"
+#include "../../src/modules/pipeline_bench.h"
+#include "../../src/modules/buffer_manager.h"
+#include "../../src/modules/audio_convert.h"
+#include "../../src/modules/i2s_handler.h"
+#include "../../src/modules/tcp_streamer.h"
+#include "../../src/modules/udp_streamer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "lwip/sockets.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#undef memcpy
+
+#define RECEIVER_PORT_TCP 19000
+#define RECEIVER_PORT_UDP 19001
+
+typedef struct
+{
+    bool udp;
+    uint32_t stall_ms;       // Receiver stops reading this long...
+    uint32_t stall_every_ms; // ...this often
+    std::atomic<bool> running;
+    std::atomic<uint64_t> bytes;
+    std::atomic<uint32_t> packets;
+    int listen_sock;
+} receiver_t;
+
+static receiver_t receiver;
+
+static int64_t now_ms(void)
+{
+    return esp_timer_get_time() / 1000;
+}
+
+static void *receiver_thread(void *arg)
+{
+    (void)arg;
+    std::vector<uint8_t> buf(64 * 1024);
+    int sock = receiver.listen_sock;
+    if (!receiver.udp)
+    {
+        sock = accept(receiver.listen_sock, NULL, NULL);
+        if (sock < 0)
+        {
+            return NULL;
+        }
+    }
+
+    struct timeval tv = {0, 100000};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    int64_t next_stall_ms = now_ms() + receiver.stall_every_ms;
+
+    while (receiver.running.load())
+    {
+        if (receiver.stall_every_ms > 0 && now_ms() >= next_stall_ms)
+        {
+            vTaskDelay(pdMS_TO_TICKS(receiver.stall_ms));
+            next_stall_ms += receiver.stall_every_ms;
+        }
+        ssize_t got = recv(sock, buf.data(), buf.size(), 0);
+        if (got > 0)
+        {
+            receiver.bytes += (uint64_t)got;
+            receiver.packets++;
+        }
+        else if (got == 0)
+        {
+            break;
+        }
+    }
+
+    if (sock != receiver.listen_sock)
+    {
+        close(sock);
+    }
+    return NULL;
+}
+
+static bool receiver_start(bool udp, pthread_t *thread)
+{
+    receiver.udp = udp;
+    receiver.listen_sock = socket(AF_INET, udp ? SOCK_DGRAM : SOCK_STREAM, 0);
+    if (receiver.listen_sock < 0)
+    {
+        return false;
+    }
+    int one = 1;
+    setsockopt(receiver.listen_sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (!udp)
+    {
+        // Small socket buffer so a stalled receiver is felt within a few blocks
+        int rcvbuf = 32 * 1024;
+        setsockopt(receiver.listen_sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(udp ? RECEIVER_PORT_UDP : RECEIVER_PORT_TCP);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(receiver.listen_sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        (!udp && listen(receiver.listen_sock, 1) != 0))
+    {
+        perror("receiver");
+        close(receiver.listen_sock);
+        return false;
+    }
+
+    receiver.running.store(true);
+    return pthread_create(thread, NULL, receiver_thread, NULL) == 0;
+}
+
+// Raw little-endian int32 I2S slots, as captured from the DMA buffers
+static bool load_trace(const char *path, std::vector<int32_t> *trace)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        perror(path);
+        return false;
+    }
+    int32_t block[1024];
+    size_t got;
+    while ((got = fread(block, sizeof(int32_t), 1024, f)) > 0)
+    {
+        trace->insert(trace->end(), block, block + got);
+    }
+    fclose(f);
+    return !trace->empty();
+}
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s [options]\n"
+           "  --tcp | --udp          Transport (default: configured protocol)\n"
+           "  --rate HZ              Capture rate (default %d)\n"
+           "  --bits 16|24|32        Ring and wire sample depth (default %d)\n"
+           "  --stereo               Two channels\n"
+           "  --seconds N            Paced run length (default %d)\n"
+           "  --stall MS --every MS  Sender stalls (default %d every %d)\n"
+           "  --recv-stall MS --recv-every MS\n"
+           "                         Receiver stops reading (TCP back-pressure)\n"
+           "  --ring BYTES           Ring size (default %d)\n"
+           "  --trace FILE           Replay raw little-endian int32 I2S slots\n",
+           prog, SAMPLE_RATE, BITS_PER_SAMPLE, PIPELINE_BENCH_DURATION_MS / 1000, PIPELINE_BENCH_STALL_MS,
+           PIPELINE_BENCH_STALL_EVERY_MS, RING_BUFFER_SIZE);
+}
+
+int main(int argc, char **argv)
+{
+    i2s_audio_format_t format;
+    i2s_handler_get_format(&format);
+    pipeline_bench_params_t params;
+    pipeline_bench_default_params(&params);
+    size_t ring_size = RING_BUFFER_SIZE;
+    const char *trace_path = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--help") == 0)
+        {
+            usage(argv[0]);
+            return 0;
+        }
+        if (strcmp(arg, "--tcp") == 0)
+        {
+            params.protocol = PIPELINE_BENCH_TCP;
+            continue;
+        }
+        if (strcmp(arg, "--udp") == 0)
+        {
+            params.protocol = PIPELINE_BENCH_UDP;
+            continue;
+        }
+        if (strcmp(arg, "--stereo") == 0)
+        {
+            format.channels = 2;
+            continue;
+        }
+        if (value == NULL)
+        {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+        if (strcmp(arg, "--rate") == 0)
+        {
+            format.sample_rate = (uint32_t)atoi(value);
+        }
+        else if (strcmp(arg, "--bits") == 0)
+        {
+            format.bits_per_sample = (uint8_t)atoi(value);
+        }
+        else if (strcmp(arg, "--seconds") == 0)
+        {
+            params.duration_ms = (uint32_t)atoi(value) * 1000;
+        }
+        else if (strcmp(arg, "--stall") == 0)
+        {
+            params.stall_ms = (uint32_t)atoi(value);
+        }
+        else if (strcmp(arg, "--every") == 0)
+        {
+            params.stall_every_ms = (uint32_t)atoi(value);
+        }
+        else if (strcmp(arg, "--recv-stall") == 0)
+        {
+            receiver.stall_ms = (uint32_t)atoi(value);
+        }
+        else if (strcmp(arg, "--recv-every") == 0)
+        {
+            receiver.stall_every_ms = (uint32_t)atoi(value);
+        }
+        else if (strcmp(arg, "--ring") == 0)
+        {
+            ring_size = (size_t)atoi(value);
+        }
+        else if (strcmp(arg, "--trace") == 0)
+        {
+            trace_path = value;
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (!i2s_handler_set_format(&format))
+    {
+        fprintf(stderr, "Unsupported format\n");
+        return 2;
+    }
+    params.sample_rate = format.sample_rate;
+
+    std::vector<int32_t> trace;
+    if (trace_path != NULL)
+    {
+        if (!load_trace(trace_path, &trace))
+        {
+            return 1;
+        }
+        params.trace = trace.data();
+        params.trace_samples = trace.size();
+    }
+
+    audio_convert_init();
+    buffer_manager_set_format(i2s_handler_bytes_per_sample(), format.channels);
+    if (!buffer_manager_init(ring_size))
+    {
+        return 1;
+    }
+
+    bool udp = params.protocol == PIPELINE_BENCH_UDP;
+    pthread_t thread;
+    if (!receiver_start(udp, &thread))
+    {
+        return 1;
+    }
+
+    bool connected;
+    if (udp)
+    {
+        connected = udp_streamer_set_server("127.0.0.1", RECEIVER_PORT_UDP) && udp_streamer_init() &&
+                    udp_streamer_reconnect();
+    }
+    else
+    {
+        connected = tcp_streamer_set_server("127.0.0.1", RECEIVER_PORT_TCP) && tcp_streamer_init() &&
+                    tcp_streamer_reconnect();
+    }
+
+    pipeline_bench_report_t report;
+    bool ok = connected && pipeline_bench_run(&params, &report);
+    if (ok)
+    {
+        pipeline_bench_log_report(&params, &report);
+    }
+
+    udp ? udp_streamer_close() : tcp_streamer_close();
+    receiver.running.store(false);
+    pthread_join(thread, NULL);
+    close(receiver.listen_sock);
+    printf("Receiver: %llu bytes in %u reads\n", (unsigned long long)receiver.bytes.load(),
+           receiver.packets.load());
+    return ok ? 0 : 1;
+}
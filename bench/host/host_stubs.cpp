@@ -0,0 +1,285 @@
+// Host implementations of the firmware services the pipeline modules call:
+// FreeRTOS tasks, notifications, mutexes and critical sections on pthreads,
+// esp_timer, the i2s_handler format and the counted memcpy()
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "../../src/modules/i2s_handler.h"
+#include "../../src/config.h"
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+#undef memcpy
+
+struct bench_task
+{
+    TaskFunction_t fn;
+    void *arg;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notified;
+};
+
+struct bench_semaphore
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool available;
+};
+
+static std::atomic<uint64_t> copy_bytes(0);
+static pthread_mutex_t critical_lock = PTHREAD_MUTEX_INITIALIZER;
+static thread_local bench_task *current_task = NULL;
+static i2s_audio_format_t current_format = {
+    .sample_rate = SAMPLE_RATE,
+    .bits_per_sample = BITS_PER_SAMPLE,
+    .channels = CHANNELS};
+
+static int64_t monotonic_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static struct timespec deadline_after(TickType_t ticks)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t ns = (uint64_t)ts.tv_nsec + (uint64_t)ticks * portTICK_PERIOD_MS * 1000000ULL;
+    ts.tv_sec += ns / 1000000000ULL;
+    ts.tv_nsec = ns % 1000000000ULL;
+    return ts;
+}
+
+static bench_task *task_alloc(TaskFunction_t fn, void *arg)
+{
+    bench_task *task = new bench_task();
+    task->fn = fn;
+    task->arg = arg;
+    task->notified = 0;
+    pthread_mutex_init(&task->lock, NULL);
+    pthread_cond_init(&task->cond, NULL);
+    return task;
+}
+
+static void *task_entry(void *arg)
+{
+    current_task = (bench_task *)arg;
+    current_task->fn(current_task->arg);
+    return NULL;
+}
+
+extern "C" void *bench_host_memcpy(void *dst, const void *src, size_t bytes)
+{
+    copy_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    return memcpy(dst, src, bytes);
+}
+
+extern "C" uint64_t bench_host_copy_bytes(void)
+{
+    return copy_bytes.load();
+}
+
+void bench_host_critical_enter(void)
+{
+    pthread_mutex_lock(&critical_lock);
+}
+
+void bench_host_critical_exit(void)
+{
+    pthread_mutex_unlock(&critical_lock);
+}
+
+int64_t esp_timer_get_time(void)
+{
+    static const int64_t boot_us = monotonic_us();
+    return monotonic_us() - boot_us;
+}
+
+uint32_t esp_cpu_get_cycle_count(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core)
+{
+    (void)name;
+    (void)stack;
+    (void)priority;
+    (void)core;
+    bench_task *task = task_alloc(fn, arg);
+    if (pthread_create(&task->thread, NULL, task_entry, task) != 0)
+    {
+        delete task;
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+    if (handle != NULL)
+    {
+        *handle = task;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg, UBaseType_t priority,
+                       TaskHandle_t *handle)
+{
+    return xTaskCreatePinnedToCore(fn, name, stack, arg, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    // Only self-deletion is used; the handle stays valid for late notifications
+    if (task == NULL || task == current_task)
+    {
+        pthread_exit(NULL);
+    }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec ts;
+    uint64_t ns = (uint64_t)(ticks > 0 ? ticks : 1) * portTICK_PERIOD_MS * 1000000ULL;
+    ts.tv_sec = ns / 1000000000ULL;
+    ts.tv_nsec = ns % 1000000000ULL;
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+    {
+    }
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(esp_timer_get_time() / 1000 / portTICK_PERIOD_MS);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    if (current_task == NULL)
+    {
+        current_task = task_alloc(NULL, NULL); // Main thread, or any thread not started here
+        current_task->thread = pthread_self();
+    }
+    return current_task;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&task->lock);
+    task->notified++;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks)
+{
+    bench_task *task = xTaskGetCurrentTaskHandle();
+    struct timespec deadline = deadline_after(ticks);
+    pthread_mutex_lock(&task->lock);
+    while (task->notified == 0 && ticks > 0)
+    {
+        if (ticks == portMAX_DELAY)
+        {
+            pthread_cond_wait(&task->cond, &task->lock);
+        }
+        else if (pthread_cond_timedwait(&task->cond, &task->lock, &deadline) == ETIMEDOUT)
+        {
+            break;
+        }
+    }
+    uint32_t value = task->notified;
+    if (value > 0)
+    {
+        task->notified = clear ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&task->lock);
+    return value;
+}
+
+static SemaphoreHandle_t semaphore_create(bool available)
+{
+    bench_semaphore *sem = new bench_semaphore();
+    pthread_mutex_init(&sem->lock, NULL);
+    pthread_cond_init(&sem->cond, NULL);
+    sem->available = available;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return semaphore_create(true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return semaphore_create(false);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    struct timespec deadline = deadline_after(ticks);
+    pthread_mutex_lock(&sem->lock);
+    while (!sem->available && ticks > 0)
+    {
+        if (ticks == portMAX_DELAY)
+        {
+            pthread_cond_wait(&sem->cond, &sem->lock);
+        }
+        else if (pthread_cond_timedwait(&sem->cond, &sem->lock, &deadline) == ETIMEDOUT)
+        {
+            break;
+        }
+    }
+    bool taken = sem->available;
+    sem->available = false;
+    pthread_mutex_unlock(&sem->lock);
+    return taken ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    pthread_mutex_lock(&sem->lock);
+    sem->available = true;
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->lock);
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->lock);
+    delete sem;
+}
+
+bool i2s_handler_set_format(const i2s_audio_format_t *format)
+{
+    if (format == NULL || format->sample_rate == 0 || (format->channels != 1 && format->channels != 2))
+    {
+        return false;
+    }
+    if (format->bits_per_sample != 16 && format->bits_per_sample != 24 && format->bits_per_sample != 32)
+    {
+        return false;
+    }
+    current_format = *format;
+    return true;
+}
+
+void i2s_handler_get_format(i2s_audio_format_t *format)
+{
+    *format = current_format;
+}
+
+size_t i2s_handler_bytes_per_sample(void)
+{
+    return current_format.bits_per_sample / 8;
+}
@@ -0,0 +1,22 @@
+// Host shim, force-included (-include): counts memcpy() bytes for the copy figure
+#pragma once
+#ifdef __cplusplus
+#include <cstring>
+#include <string>
+#include <algorithm>
+#include <atomic>
+extern "C" {
+#else
+#include <string.h>
+#endif
+#include <stdint.h>
+#include <stddef.h>
+
+void *bench_host_memcpy(void *dst, const void *src, size_t bytes);
+uint64_t bench_host_copy_bytes(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define memcpy(dst, src, bytes) bench_host_memcpy(dst, src, bytes)
@@ -0,0 +1,13 @@
+#pragma once
+#include <stdio.h>
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
+
+#define BENCH_HOST_LOG(level, tag, format, ...) \
+    printf("%c (%lld) %s: " format "\n", level, (long long)(esp_timer_get_time() / 1000), tag, ##__VA_ARGS__)
+#define ESP_LOGE(tag, format, ...) BENCH_HOST_LOG('E', tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) BENCH_HOST_LOG('W', tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) BENCH_HOST_LOG('I', tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) ((void)(tag))
+#define ESP_LOGV(tag, format, ...) ((void)(tag))
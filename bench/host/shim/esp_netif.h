@@ -0,0 +1,21 @@
+#pragma once
+#include "esp_err.h"
+#include <stdint.h>
+
+typedef struct esp_netif_obj esp_netif_t;
+typedef struct
+{
+    uint32_t addr;
+} esp_ip4_addr_t;
+typedef struct
+{
+    esp_ip4_addr_t ip, netmask, gw;
+} esp_netif_ip_info_t;
+
+static inline esp_netif_t *esp_netif_get_handle_from_ifkey(const char *key) { (void)key; return NULL; }
+static inline esp_err_t esp_netif_get_ip_info(esp_netif_t *netif, esp_netif_ip_info_t *info)
+{
+    (void)netif;
+    (void)info;
+    return ESP_FAIL;
+}
@@ -0,0 +1,30 @@
+// Host shim: the FreeRTOS subset the pipeline modules use, on pthreads
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms) * configTICK_RATE_HZ / 1000)
+#define portMAX_DELAY 0xffffffffu
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define tskNO_AFFINITY 0x7fffffff
+
+
+// Critical sections: one process-wide lock
+typedef struct
+{
+    int unused;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+void bench_host_critical_enter(void);
+void bench_host_critical_exit(void);
+#define portENTER_CRITICAL(mux) ((void)(mux), bench_host_critical_enter())
+#define portEXIT_CRITICAL(mux) ((void)(mux), bench_host_critical_exit())
@@ -0,0 +1,2 @@
+#pragma once
+// Host build: no target, so the conversion kernels take the scalar path
@@ -104,4 +104,112 @@ const API = {
     save: () => API.request("/api/system/save", { method: "POST" }),
     load: () => API.request("/api/system/load", { method: "POST" }),
   },
+
+  // Live push channel (/ws): metrics deltas and new log lines, no polling
+  live: {
+    // Wire order and width of the metric fields (see ws_push.h)
+    fields: [
+      ["uptime_sec", 4],
+      ["wifi_connected", 1],
+      ["wifi_rssi", -1],
+      ["tcp_connected", 1],
+      ["tcp_bytes_sent", 8],
+      ["tcp_reconnects", 4],
+      ["buffer_usage_percent", 1],
+      ["free_heap", 4],
+      ["min_free_heap", 4],
+      ["latency_avg_us", 4],
+      ["latency_max_us", 4],
+      ["sample_rate", 4],
+      ["overflow_events", 4],
+      ["vad_open", 1],
+      ["agc_gain_db10", -2],
+    ],
+    levels: { 1: "ERROR", 2: "WARN", 3: "INFO", 4: "DEBUG", 5: "VERBOSE" },
+
+    // Decode one binary frame into { metrics, logs }
+    decode(buffer, metrics) {
+      const view = new DataView(buffer);
+      const text = new TextDecoder();
+      const logs = [];
+      let pos = 0;
+      while (pos < view.byteLength) {
+        const section = view.getUint8(pos++);
+        if (section === 1) {
+          const mask = view.getUint32(pos, true);
+          pos += 4;
+          this.fields.forEach(([name, width], bit) => {
+            if (!(mask & (1 << bit))) return;
+            const bytes = Math.abs(width);
+            let value;
+            if (bytes === 8) {
+              value = Number(view.getBigUint64(pos, true));
+            } else if (bytes === 4) {
+              value = view.getUint32(pos, true);
+            } else if (bytes === 2) {
+              value = width < 0 ? view.getInt16(pos, true) : view.getUint16(pos, true);
+            } else {
+              value = width < 0 ? view.getInt8(pos) : view.getUint8(pos);
+            }
+            metrics[name] = value;
+            pos += bytes;
+          });
+        } else if (section === 2) {
+          const count = view.getUint8(pos++);
+          for (let i = 0; i < count; i++) {
+            const seq = view.getUint32(pos, true);
+            const timestamp = view.getUint32(pos + 4, true);
+            const level = this.levels[view.getUint8(pos + 8)] || "INFO";
+            const tagLen = view.getUint8(pos + 9);
+            const tag = text.decode(new Uint8Array(buffer, pos + 10, tagLen));
+            pos += 10 + tagLen;
+            const msgLen = view.getUint8(pos++);
+            const message = text.decode(new Uint8Array(buffer, pos, msgLen));
+            pos += msgLen;
+            logs.push({ seq, timestamp, level, tag, message });
+          }
+        } else {
+          break; // Unknown section: newer firmware
+        }
+      }
+      return logs;
+    },
+
+    // Open the channel; reconnects until close() is called
+    // handlers: { onMetrics(metrics), onLogs(entries), onState(connected) }
+    connect(handlers, intervalMs = 1000) {
+      const auth = API.getAuthHeader().substring(6);
+      const url = `ws://${location.host}/ws?auth=${encodeURIComponent(auth)}`;
+      const metrics = {};
+      let socket = null;
+      let closed = false;
+
+      const open = () => {
+        socket = new WebSocket(url);
+        socket.binaryType = "arraybuffer";
+        socket.onopen = () => {
+          socket.send(`interval=${intervalMs}`);
+          if (handlers.onState) handlers.onState(true);
+        };
+        socket.onmessage = (event) => {
+          const logs = API.live.decode(event.data, metrics);
+          if (handlers.onMetrics) handlers.onMetrics(metrics);
+          if (logs.length > 0 && handlers.onLogs) handlers.onLogs(logs);
+        };
+        socket.onclose = () => {
+          if (handlers.onState) handlers.onState(false);
+          if (!closed) setTimeout(open, 3000);
+        };
+      };
+
+      if (!("WebSocket" in window)) return null;
+      open();
+      return {
+        close() {
+          closed = true;
+          if (socket) socket.close();
+        },
+      };
+    },
+  },
 };
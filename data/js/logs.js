@@ -164,13 +164,44 @@ function downloadLogs() {
   showAlert(`Downloaded ${logs.length} logs`, "success");
 }
 
+// Live log lines from the /ws push channel
+const MAX_LIVE_LOGS = 500;
+let liveChannel = null;
+let liveConnected = false;
+let lastSeq = 0;
+
+function appendLiveLogs(entries) {
+  const fresh = entries.filter((e) => e.seq > lastSeq);
+  if (fresh.length === 0) return;
+  lastSeq = fresh[fresh.length - 1].seq;
+  logs = logs.concat(fresh).slice(-MAX_LIVE_LOGS);
+  updateStats();
+  filterAndDisplayLogs();
+}
+
 // Toggle auto-refresh
 function toggleAutoRefresh() {
   autoRefresh = autoRefreshCheckbox.checked;
 
   if (autoRefresh) {
-    refreshInterval = setInterval(loadLogs, 2000);
+    // Prefer the push channel; poll only while it is down
+    if (!liveChannel) {
+      liveChannel = API.live.connect({
+        onLogs: appendLiveLogs,
+        onState: (connected) => {
+          liveConnected = connected;
+        },
+      });
+    }
+    refreshInterval = setInterval(() => {
+      if (!liveConnected) loadLogs();
+    }, 2000);
   } else {
+    if (liveChannel) {
+      liveChannel.close();
+      liveChannel = null;
+      liveConnected = false;
+    }
     if (refreshInterval) {
       clearInterval(refreshInterval);
       refreshInterval = null;
@@ -43,16 +43,49 @@ async function loadMonitoringData() {
   }
 }
 
+// Live updates from the /ws push channel (fields the device sends deltas for)
+let liveChannel = null;
+let liveConnected = false;
+
+function applyLiveMetrics(m) {
+  updateStatusBadge("wifi-status", !!m.wifi_connected, "WiFi");
+  updateStatusBadge("tcp-status", !!m.tcp_connected, "TCP");
+  setElementText("monitor-heap", formatBytes(m.free_heap));
+  setElementText("monitor-min-heap", formatBytes(m.min_free_heap));
+  setElementText("monitor-buffer", m.buffer_usage_percent + "%");
+  setElementText("monitor-uptime", formatUptime(m.uptime_sec));
+  setElementText("monitor-wifi-connected", m.wifi_connected ? "✅ Yes" : "❌ No");
+  setElementText("monitor-tcp-connected", m.tcp_connected ? "✅ Yes" : "❌ No");
+  setElementText("monitor-bytes-sent", formatBytes(m.tcp_bytes_sent));
+  setElementText("monitor-reconnects", m.tcp_reconnects);
+  setElementText("monitor-sample-rate", m.sample_rate + " Hz");
+}
+
 function toggleAutoRefresh() {
   const checkbox = document.getElementById("auto-refresh");
 
   if (checkbox.checked) {
-    // Start auto-refresh
+    // Prefer the push channel; poll only while it is down
+    if (!liveChannel) {
+      liveChannel = API.live.connect({
+        onMetrics: applyLiveMetrics,
+        onState: (connected) => {
+          liveConnected = connected;
+        },
+      });
+    }
     if (!autoRefreshInterval) {
-      autoRefreshInterval = setInterval(loadMonitoringData, 2000);
+      autoRefreshInterval = setInterval(() => {
+        if (!liveConnected) loadMonitoringData();
+      }, 2000);
     }
   } else {
     // Stop auto-refresh
+    if (liveChannel) {
+      liveChannel.close();
+      liveChannel = null;
+      liveConnected = false;
+    }
     if (autoRefreshInterval) {
       clearInterval(autoRefreshInterval);
       autoRefreshInterval = null;
@@ -81,4 +114,7 @@ window.addEventListener("beforeunload", () => {
   if (autoRefreshInterval) {
     clearInterval(autoRefreshInterval);
   }
+  if (liveChannel) {
+    liveChannel.close();
+  }
 });
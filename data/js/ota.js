@@ -37,8 +37,8 @@ async function uploadFirmware() {
     return;
   }
 
-  if (!file.name.endsWith(".bin")) {
-    showAlert(uploadStatus, "Please select a valid .bin file", "error");
+  if (!file.name.endsWith(".bin") && !file.name.endsWith(".bin.gz")) {
+    showAlert(uploadStatus, "Please select a valid .bin or .bin.gz file", "error");
     return;
   }
 
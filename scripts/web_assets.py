@@ -0,0 +1,135 @@
+"""
+Web UI asset generator
+
+Compresses the files in data/ with gzip at build time and writes them as a
+C++ table (web_assets_data.cpp) for web_assets.h:
+- CSS/JS get a content hash in their path (/js/app.<hash>.js) and are
+  served as immutable; the HTML pages are rewritten to reference them.
+- HTML keeps its path and is revalidated with its ETag.
+
+Used by src/CMakeLists.txt (ESP-IDF) and scripts/embed_data_files.py
+(PlatformIO). Standalone: python web_assets.py <data_dir> <output.cpp>
+"""
+import gzip
+import hashlib
+import os
+import sys
+
+# Served assets, relative to data/ (pages first: they reference the rest)
+ASSET_FILES = [
+    "index.html",
+    "config.html",
+    "monitor.html",
+    "ota.html",
+    "logs.html",
+    "network.html",
+    "css/style.css",
+    "js/api.js",
+    "js/utils.js",
+    "js/app.js",
+    "js/config.js",
+    "js/monitor.js",
+    "js/ota.js",
+    "js/logs.js",
+    "js/network.js",
+]
+
+MIME_TYPES = {
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+}
+
+HASH_CHARS = 8
+
+
+def content_hash(data):
+    return hashlib.sha256(data).hexdigest()[:HASH_CHARS]
+
+
+def load_assets(data_dir):
+    """Read, fingerprint and compress the assets; returns a list of dicts"""
+    raw = {}
+    for name in ASSET_FILES:
+        with open(os.path.join(data_dir, name), "rb") as f:
+            raw[name] = f.read()
+
+    # Fingerprinted paths for everything that is not a page
+    renamed = {}
+    for name, data in raw.items():
+        if not name.endswith(".html"):
+            stem, ext = os.path.splitext(name)
+            renamed[name] = f"{stem}.{content_hash(data)}{ext}"
+
+    assets = []
+    for name in ASSET_FILES:
+        data = raw[name]
+        immutable = name in renamed
+        if not immutable:
+            for old, new in renamed.items():
+                data = data.replace(f'"/{old}"'.encode(), f'"/{new}"'.encode())
+        # mtime=0 keeps the output (and the firmware image) reproducible
+        compressed = gzip.compress(data, compresslevel=9, mtime=0)
+        assets.append({
+            "uri": "/" + renamed.get(name, name),
+            "mime": MIME_TYPES.get(os.path.splitext(name)[1], "application/octet-stream"),
+            "raw_size": len(data),
+            "gzip": compressed,
+            "etag": content_hash(data),
+            "immutable": immutable,
+        })
+    return assets
+
+
+def write_source(assets, out_path):
+    lines = [
+        "// Generated by scripts/web_assets.py from data/ - do not edit",
+        '#include "web_assets.h"',
+        "",
+    ]
+    for i, asset in enumerate(assets):
+        lines.append(f"// {asset['uri']}: {asset['raw_size']} -> {len(asset['gzip'])} bytes")
+        lines.append(f"static const uint8_t asset_{i}[] = {{")
+        data = asset["gzip"]
+        for offset in range(0, len(data), 16):
+            chunk = ", ".join(f"0x{b:02x}" for b in data[offset:offset + 16])
+            lines.append(f"    {chunk},")
+        lines.append("};")
+        lines.append("")
+
+    lines.append("const web_asset_t web_assets[] = {")
+    for i, asset in enumerate(assets):
+        lines.append(
+            f'    {{"{asset["uri"]}", "{asset["mime"]}", "\\"{asset["etag"]}\\"", asset_{i}, '
+            f'sizeof(asset_{i}), {asset["raw_size"]}, {"true" if asset["immutable"] else "false"}}},')
+    lines.append("};")
+    lines.append("")
+    lines.append("const size_t web_asset_count = sizeof(web_assets) / sizeof(web_assets[0]);")
+    lines.append("")
+
+    content = "\n".join(lines)
+    # Leave an unchanged file alone so it does not trigger a rebuild
+    if os.path.exists(out_path):
+        with open(out_path, "r") as f:
+            if f.read() == content:
+                return
+    os.makedirs(os.path.dirname(os.path.abspath(out_path)), exist_ok=True)
+    with open(out_path, "w") as f:
+        f.write(content)
+
+
+def generate(data_dir, out_path):
+    assets = load_assets(data_dir)
+    write_source(assets, out_path)
+    raw = sum(a["raw_size"] for a in assets)
+    packed = sum(len(a["gzip"]) for a in assets)
+    print(f"Web assets: {len(assets)} files, {raw} -> {packed} bytes gzip")
+    return assets
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        print("usage: web_assets.py <data_dir> <output.cpp>")
+        sys.exit(1)
+    generate(sys.argv[1], sys.argv[2])
@@ -11,6 +11,20 @@
 // Web Authentication Configuration
 #define WEB_AUTH_USERNAME "sarpel"
 #define WEB_AUTH_PASSWORD "13524678"
+#define JSON_STREAM_CHUNK_SIZE 512 // Scratch per streamed JSON response (json_stream.h)
+#define HISTORY_STREAM_BATCH 8     // History entries decoded per lock hold when streaming
+#define WEB_ASSET_MAX_AGE_S 31536000 // Cache lifetime of fingerprinted CSS/JS (web_assets.h)
+
+// WebSocket push (/ws, see ws_push.h); needs CONFIG_HTTPD_WS_SUPPORT
+#define WS_PUSH_MAX_CLIENTS 3
+#define WS_PUSH_TICK_MS 250               // Push task period
+#define WS_PUSH_MIN_INTERVAL_MS 500       // Fastest metrics rate a client may ask for
+#define WS_PUSH_DEFAULT_INTERVAL_MS 1000
+#define WS_PUSH_LOG_BYTES_PER_SEC 4096    // Per-client log budget (token bucket)
+#define WS_PUSH_FRAME_MAX 1024            // Largest frame per client per push
+#define WS_PUSH_STACK_SIZE 4096
+#define WS_PUSH_PRIORITY 2                // Below the streamers
+#define WS_PUSH_CORE 0
 
 // Captive Portal Configuration
 #define CAPTIVE_PORTAL_SSID "AudioStreamer-Setup"
@@ -34,6 +48,7 @@
 // NTP Configuration
 #define NTP_SERVER "pool.ntp.org"
 #define NTP_TIMEZONE "UTC-3" // Adjust for your timezone
+#define NTP_SYNC_INTERVAL_MS 300000 // SNTP poll, also a wall-clock reference for the capture clock
 
 // I2S pins (XIAO ESP32S3)
 #define I2S_BCLK_GPIO 2 // BCLK
@@ -67,6 +82,32 @@ typedef enum
     AUDIO_CHANNELS_STEREO = 2
 } audio_channels_t;
 
+// Transport codec (carried in stream framing)
+typedef enum
+{
+    AUDIO_CODEC_PCM = 0,       // Ring format as-is
+    AUDIO_CODEC_IMA_ADPCM = 1, // 4 bits/sample, self-contained frames
+    AUDIO_CODEC_OPUS = 2,      // Requires AUDIO_CODEC_OPUS_ENABLED
+    AUDIO_CODEC_SILENCE = 3    // Wire only: VAD silence frame (duration + comfort-noise level)
+} audio_codec_t;
+
+// Latency profile: sizes capture chunks, DMA and sender blocks together
+typedef enum
+{
+    LATENCY_PROFILE_LOW = 0,      // ~10 ms budget (speech-to-text, monitoring)
+    LATENCY_PROFILE_BALANCED = 1, // ~40 ms budget
+    LATENCY_PROFILE_ARCHIVAL = 2, // ~250 ms budget, large efficient blocks
+    LATENCY_PROFILE_CUSTOM = 3    // Compile-time sizes below + buffer_dma_count/length
+} latency_profile_t;
+
+// What to do when the ring buffer is full
+typedef enum
+{
+    OVERFLOW_POLICY_DROP_OLDEST = 0, // Shed the oldest audio, keep latency bounded (default)
+    OVERFLOW_POLICY_DROP_NEWEST = 1, // Clip incoming blocks, keep what is buffered
+    OVERFLOW_POLICY_DEGRADE = 2      // Drop oldest, and step to a cheaper codec under sustained overflow (UDP or framed TCP; steps back once drained)
+} overflow_policy_t;
+
 // Audio format configuration
 #define AUDIO_FORMAT_DEFAULT AUDIO_FORMAT_PCM_16BIT
 #define AUDIO_SAMPLE_RATE_DEFAULT AUDIO_SAMPLE_RATE_16K
@@ -76,6 +117,14 @@ typedef enum
 #define I2S_SLOT_BIT_WIDTH 32 // 32-bit slot (INMP441 produces 24-bit data)
 #define I2S_READ_SAMPLES 256
 #define TCP_SEND_SAMPLES 4096
+#define NETWORK_SENDER_WATERMARK_SAMPLES 0 // Wake the sender at this fill; 0 = one packet's worth
+#define NETWORK_SENDER_MAX_WAIT_MS 2000    // Send whatever is buffered if the watermark is not reached
+
+// Latency profiles (see latency_profile.h); CUSTOM keeps the sizes above
+#define LATENCY_PROFILE_DEFAULT LATENCY_PROFILE_CUSTOM
+#define I2S_READ_SAMPLES_MAX 1024          // Largest capture chunk a profile may pick
+#define LATENCY_SEND_SAMPLES_MAX TCP_SEND_SAMPLES // Sender block cap (TCP buffers are sized for it)
+#define LATENCY_STATS_WINDOW 256           // Sends per max-latency window
 
 // Audio format validation ranges
 #define AUDIO_SAMPLE_RATE_MIN 8000
@@ -91,10 +140,61 @@ typedef enum
 #define CHANNELS 1         // Mono
 #define BYTES_PER_SAMPLE 2 // 16-bit = 2 bytes per sample
 
+// Audio Compression Configuration (encoder runs in the network sender task)
+#define AUDIO_CODEC_DEFAULT AUDIO_CODEC_PCM
+#define AUDIO_ADPCM_FRAME_SAMPLES 505 // Per channel: 4-byte header + 252 data bytes (256 bytes mono)
+#define AUDIO_CODEC_OPUS_ENABLED 0    // Needs an Opus component (opus.h) added to the build
+#define AUDIO_OPUS_BITRATE 24000      // bps
+#define AUDIO_OPUS_FRAME_MS 20        // 2.5, 5, 10, 20, 40 or 60
+#define AUDIO_OPUS_COMPLEXITY 5       // 0-10, CPU vs quality
+
+// On-device DSP (dsp_chain.h): runs on raw slots in the I2S reader, before the ring
+#define DSP_CAPTURE_RATE 0              // I2S rate; 0 = audio sample rate, else an integer multiple (decimated)
+#define DSP_DECIMATE_MAX 6              // Largest capture/stream rate ratio
+#define DSP_DECIMATOR_TAPS_PER_PHASE 16 // FIR length per unit of decimation
+#define DSP_HIGHPASS_ENABLED 0
+#define DSP_HIGHPASS_HZ 80              // DC-blocking Butterworth cutoff
+#define DSP_AGC_ENABLED 0
+#define DSP_AGC_TARGET_DBFS -20         // Level the AGC steers towards (full-scale sine reference)
+#define DSP_AGC_MAX_GAIN_DB 30
+#define DSP_AGC_NOISE_FLOOR_DBFS -60    // Gain is held below this level (no noise pumping)
+#define DSP_AGC_ATTACK_MS 20
+#define DSP_AGC_RELEASE_MS 800
+#define DSP_LIMITER_DBFS -1             // Peak ceiling after the AGC
+// Cycle budgets per output sample; overruns are counted per stage
+#define DSP_RESAMPLE_BUDGET_CYCLES 400
+#define DSP_HIGHPASS_BUDGET_CYCLES 40
+#define DSP_AGC_BUDGET_CYCLES 40
+
+// Silence Detection (VAD gate, see vad_gate.h); needs UDP or TCP framing
+#define VAD_ENABLED 0
+#define VAD_THRESHOLD_DBFS -50 // Gate opens above this level
+#define VAD_HANGOVER_MS 500    // Stay open after the level drops
+#define VAD_PREROLL_MS 200     // Audio sent ahead of an opening
+#define VAD_PREROLL_MAX_MS 500
+#define VAD_TRANSITIONS_MAX 64 // Gate transitions kept for the sender
+
+// Sample Conversion Configuration
+#define AUDIO_CONVERT_SIMD_ENABLED 1      // Use ESP32-S3 PIE vector kernels (scalar fallback otherwise)
+#define AUDIO_CONVERT_BENCHMARK_ENABLED 0 // Log cycles/sample of every conversion kernel at boot
+
+// Pipeline benchmark (pipeline_bench.h): set by the bench env in platformio.ini
+#ifndef PIPELINE_BENCH_ENABLED
+#define PIPELINE_BENCH_ENABLED 0             // Run the benchmark against the configured server before streaming
+#endif
+#define PIPELINE_BENCH_THROUGHPUT_BLOCKS 2048 // Capture blocks in the unpaced run
+#define PIPELINE_BENCH_DURATION_MS 10000     // Paced run (keep below WATCHDOG_TIMEOUT_SEC)
+#define PIPELINE_BENCH_STALL_MS 500          // Injected sender stall...
+#define PIPELINE_BENCH_STALL_EVERY_MS 2500   // ...this often
+#define PIPELINE_BENCH_MAX_BLOCKS 4096       // Latencies kept for the percentiles
+#define PIPELINE_BENCH_STACK_SIZE 4096       // Capture task
+#define PIPELINE_BENCH_NETWORK_WAIT_MS 20000 // Wait for WiFi before benchmarking
+
 // Buffer Configuration
 #define I2S_DMA_BUF_COUNT 8
 #define I2S_DMA_BUF_LEN 512          // 512 samples per DMA buffer (1024 for better resilience)
 #define RING_BUFFER_SIZE (48 * 1024) // 48 KB - reduced to fit fragmented memory after WiFi init
+#define BUFFER_QUIESCE_TIMEOUT_MS 50 // Max time I2S/network tasks wait for a ring resize/reset
 
 // Task Configuration
 #define I2S_READER_STACK_SIZE 4096
@@ -126,14 +226,18 @@ typedef enum
 #define MAX_RECONNECT_ATTEMPTS 10      // Max TCP reconnect attempts before reboot
 #define RECONNECT_BACKOFF_MS 1000      // Start with 1 second
 #define MAX_RECONNECT_BACKOFF_MS 30000 // Cap at 30 seconds
+#define STREAM_NETWORK_WAIT_MS 500     // Sender waits this long per loop for an IP (boot or outage)
 #define MAX_I2S_FAILURES 100           // Max consecutive I2S failures before reinit
 #define MAX_BUFFER_OVERFLOWS 20        // Max overflows before action
 #define OVERFLOW_COOLDOWN_MS 5000      // Wait after overflow detected
+#define OVERFLOW_POLICY_DEFAULT OVERFLOW_POLICY_DROP_OLDEST
+#define BUFFER_DROP_OLDEST_TARGET_PERCENT 75 // Drop-oldest trims the ring down to this fill
+#define OVERFLOW_DEGRADE_RECOVER_PERCENT 20  // Degrade: ring fill below which a codec step is undone...
+#define OVERFLOW_DEGRADE_RECOVER_MS 60000    // ... once it has stayed there this long
 
 // Thresholds for error detection (moved from hardcoded values)
 #define I2S_UNDERFLOW_THRESHOLD 100 // Max I2S underflows before action
 #define WIFI_CONNECT_MAX_RETRIES 20 // Max WiFi connection attempts
-#define TCP_CONNECT_MAX_RETRIES 5   // Max TCP connection attempts per cycle
 
 // Stack Monitoring
 #define ENABLE_STACK_MONITORING 1 // Monitor stack usage
@@ -146,21 +250,44 @@ typedef enum
 // Recovery Actions
 #define ENABLE_AUTO_REBOOT 1  // Reboot on critical failures
 #define ENABLE_I2S_REINIT 1   // Reinitialize I2S on persistent failures
-#define ENABLE_BUFFER_DRAIN 1 // Force drain buffer on overflow
+#define ENABLE_BUFFER_DRAIN 1 // Act on sustained overflow (degrade policy) instead of only dropping
 
 // Streaming Protocol Configuration
 #define STREAMING_PROTOCOL_TCP 0
 #define STREAMING_PROTOCOL_UDP 1
-#define STREAMING_PROTOCOL_BOTH 2
+#define STREAMING_PROTOCOL_BOTH 2 // TCP and UDP as independent fan-out sinks; for several servers prefer UDP multicast
 
 #ifndef STREAMING_PROTOCOL
 #define STREAMING_PROTOCOL STREAMING_PROTOCOL_TCP
 #endif
 
+// Multi-destination fan-out (STREAMING_PROTOCOL_BOTH): each sink sends from its own cursor
+#define STREAM_SINK_MAX 4                                             // Destinations
+#define STREAM_SINK_BUFFER_SIZE (256 * 1024)                          // Shared fan-out ring in PSRAM (slowest sink's backlog)
+#define STREAM_SINK_INTERNAL_BUFFER_SIZE (48 * 1024)                  // ... in internal RAM on boards without PSRAM
+#define STREAM_SINK_RECORD_MAX_BYTES (TCP_SEND_SAMPLES * 4)           // Largest record (one 32-bit PCM block)
+#define STREAM_SINK_TASK_STACK_SIZE 6144
+#define STREAM_SINK_REALTIME_PRIORITY TCP_SENDER_PRIORITY             // UDP sink
+#define STREAM_SINK_ARCHIVE_PRIORITY (TCP_SENDER_PRIORITY - 1)        // TCP sink
+#define STREAM_SINK_SUSPEND_TIMEOUT_MS (TCP_CONNECT_TIMEOUT_MS + 500) // A sink mid-connect finishes it first
+
 // UDP Specific Configuration
 #define UDP_PACKET_MAX_SIZE 1472 // Safe UDP packet size (under Ethernet MTU)
 #define UDP_SEND_TIMEOUT_MS 100  // Timeout for UDP sends
 #define UDP_BUFFER_COUNT 8       // Number of UDP packets to buffer
+#define UDP_SEND_RETRY_COUNT 3   // Retries (1 tick apart) when the TX queue is full
+
+// UDP Multicast (one send reaches every subscribed server)
+#define UDP_MULTICAST_ENABLED 0
+#define UDP_MULTICAST_GROUP "239.255.1.1" // Administratively scoped group
+#define UDP_MULTICAST_PORT 9002
+#define UDP_MULTICAST_TTL 1 // 1 = local subnet only
+
+// UDP Forward Error Correction (XOR parity)
+#define UDP_FEC_ENABLED 0        // Send one parity packet per group of data packets
+#define UDP_FEC_GROUP_SIZE 8     // Data packets per parity packet (8 = 12.5% overhead)
+#define UDP_FEC_GROUP_SIZE_MIN 2 // 50% overhead
+#define UDP_FEC_GROUP_SIZE_MAX 16
 
 // Adaptive Buffering Configuration
 #define ADAPTIVE_BUFFERING_ENABLED 1
@@ -172,6 +299,55 @@ typedef enum
 #define ADAPTIVE_CHECK_INTERVAL_MS 5000          // Check every 5 seconds
 #define ADAPTIVE_RESIZE_DELAY_MS 10000           // Wait 10s between resizes
 
+// Link-quality-adaptive stream tiers (see modules/adaptive_quality.h)
+#define ADAPTIVE_QUALITY_ENABLED 1
+#define ADAPTIVE_QUALITY_INTERVAL_MS 2000        // Evaluation window
+#define ADAPTIVE_QUALITY_DOWN_WINDOWS 2          // Bad windows in a row before stepping down
+#define ADAPTIVE_QUALITY_UP_WINDOWS 5            // Clean windows in a row before stepping up one tier
+#define ADAPTIVE_QUALITY_MIN_DWELL_MS 10000      // No step up or congestion step down sooner after a switch
+#define ADAPTIVE_QUALITY_RSSI_TIER1 -67          // dBm below which tier 1 (16-bit ADPCM, FEC 1/8) is used
+#define ADAPTIVE_QUALITY_RSSI_TIER2 -74          // ... tier 2 (at most 16 kHz, FEC 1/4)
+#define ADAPTIVE_QUALITY_RSSI_TIER3 -80          // ... tier 3 (at most 8 kHz, FEC 1/2)
+#define ADAPTIVE_QUALITY_RSSI_HYSTERESIS_DB 4    // Extra RSSI needed to leave a tier upwards
+#define ADAPTIVE_QUALITY_LOSS_HIGH_PERCENT 5     // UDP send loss that counts as congestion
+#define ADAPTIVE_QUALITY_LOSS_CLEAN_PERCENT 1    // ... and as a clean window
+#define ADAPTIVE_QUALITY_BUFFER_HIGH_PERCENT 50  // Ring usage that counts as congestion
+#define ADAPTIVE_QUALITY_BUFFER_CLEAN_PERCENT 20 // ... and as a clean window
+
+// Capture timestamps on a shared wall clock (see modules/media_clock.h)
+#define MEDIA_CLOCK_DRIFT_WINDOW_MS 10000       // Sample clock fit window (drift measured per window)
+#define MEDIA_CLOCK_DRIFT_SMOOTHING 8           // Drift estimates averaged over about this many windows
+#define MEDIA_CLOCK_CAPTURE_RESYNC_US 5000      // Block this far off the sample clock re-anchors it
+#define MEDIA_CLOCK_STEP_US 50000               // Wall-clock reference this far off is stepped to, not slewed
+#define MEDIA_CLOCK_FREQ_MIN_INTERVAL_MS 60000  // Shortest reference baseline for the esp_timer drift
+#define MEDIA_CLOCK_MAX_DRIFT_PPB 500000        // Drift estimates are clamped to this
+#ifndef MEDIA_CLOCK_SERVER_SYNC_ENABLED
+#define MEDIA_CLOCK_SERVER_SYNC_ENABLED 0       // Two-way time exchange with the stream server
+#endif
+#define MEDIA_CLOCK_SERVER_PORT 9003            // Own port: the server may also listen on UDP_MULTICAST_PORT
+#define MEDIA_CLOCK_SERVER_INTERVAL_MS 10000    // Between exchange bursts
+#define MEDIA_CLOCK_SERVER_BURST 8              // Requests per burst (shortest round trip wins)
+#define MEDIA_CLOCK_SERVER_TIMEOUT_MS 200       // Reply wait per request
+#define MEDIA_CLOCK_SERVER_MAX_RTT_US 20000     // Longer round trips are not used
+#define MEDIA_CLOCK_SERVER_HOLDOFF_MS (3 * MEDIA_CLOCK_SERVER_INTERVAL_MS) // SNTP ignored this long after a server reference
+#define MEDIA_CLOCK_TASK_STACK_SIZE 3072
+#define MEDIA_CLOCK_TASK_PRIORITY 2
+#define MEDIA_CLOCK_TASK_CORE 0
+
+// Outage spool to flash (see modules/flash_spool.h): needs the "spool" partition
+#ifndef FLASH_SPOOL_ENABLED
+#define FLASH_SPOOL_ENABLED 0                // Spill the ring to flash while the stream is down (TCP needs framing)
+#endif
+#define FLASH_SPOOL_PARTITION_LABEL "spool"
+#define FLASH_SPOOL_HIGH_PERCENT 50          // Ring usage that starts a spill while the stream is down...
+#define FLASH_SPOOL_LOW_PERCENT 10           // ...and ends it
+#define FLASH_SPOOL_POLL_MS 50               // Spool task checks a lent ring this often
+#define FLASH_SPOOL_REPLAY_BURST 4           // Spooled records sent after each live block
+#define FLASH_SPOOL_REPLAY_MAX_PERCENT 25    // Replay waits while the live backlog is above this
+#define FLASH_SPOOL_TASK_STACK_SIZE 3072
+#define FLASH_SPOOL_TASK_PRIORITY 3          // Below the pipeline: flash stalls never preempt audio
+#define FLASH_SPOOL_TASK_CORE 0
+
 // Network Stack Optimization Configuration
 #define NETWORK_OPTIMIZATION_ENABLED 1
 
@@ -184,6 +360,19 @@ typedef enum
 #define TCP_TX_BUFFER_SIZE 32768     // 32KB TCP send buffer
 #define TCP_RX_BUFFER_SIZE 32768     // 32KB TCP receive buffer
 
+// Non-blocking TCP send path
+#define TCP_CONNECT_TIMEOUT_MS 5000                           // select() limit for connect()
+#define TCP_SEND_WAIT_MS 20                                   // Longest select() wait inside one send call
+#define TCP_INFLIGHT_WINDOW_BYTES (TCP_SEND_SAMPLES * 4 + 256) // Unsent tail kept by the streamer (one block)
+#define TCP_STALL_TIMEOUT_MS 3000                             // Peer not draining this long = dead connection
+#define TCP_BACKPRESSURE_DROP_PERCENT 90                      // Stalled TCP: drop oldest block above this ring usage
+
+// TCP framing: prefix every block with tcp_frame_header_t (see tcp_streamer.h)
+// so the server can detect gaps after a reconnect and measure capture latency
+#define TCP_FRAMING_ENABLED 0
+#define BUFFER_CAPTURE_MARKS 64          // Capture time marks kept by the ring buffer
+#define BUFFER_CAPTURE_MARK_SAMPLES 4096 // Samples between marks (64 x 4096 spans a full 512 KB ring)
+
 // UDP Optimization
 #define UDP_TX_BUFFER_SIZE 65536 // 64KB UDP send buffer
 #define UDP_RX_BUFFER_SIZE 65536 // 64KB UDP receive buffer
@@ -198,6 +387,11 @@ typedef enum
 #define WIFI_RX_MGMT_BUF_NUM 10    // Number of management buffers
 #define WIFI_RX_BA_WIN 8           // Block ACK window size
 
+// WiFi fast reconnect and roaming
+#define WIFI_FAST_RECONNECT_ENABLED 1 // Rejoin the cached AP (BSSID/channel in NVS) before a full scan
+#define WIFI_ROAMING_ASSIST_ENABLED 1 // 802.11k/v/r when the AP offers it (CONFIG_ESP_WIFI_11KV_SUPPORT / 11R_SUPPORT)
+#define WIFI_ROAM_RSSI_THRESHOLD -70  // Ask the AP for a better BSS (802.11v query) below this RSSI, dBm
+
 // Network Performance Tuning
 #define NETWORK_TASK_STACK_SIZE 4096        // Network task stack size
 #define NETWORK_EVENT_QUEUE_SIZE 16         // Network event queue size
@@ -209,5 +403,47 @@ typedef enum
 
 // Performance Monitoring Configuration
 #define MAX_ALERTS 100            // Maximum alerts to store
+#define PIPELINE_STATS_ENABLED 1     // Per-stage cycle histograms (pipeline_stats.h)
+#define PIPELINE_STATS_MAX_TASKS 24  // Tasks sampled for /api/perf/pipeline
+
+// Configuration snapshots (config_manager_v2_acquire)
+#define CONFIG_SNAPSHOT_SLOTS 3          // Published + held by readers + being written
+#define CONFIG_MAX_SUBSCRIBERS 12        // Change callbacks
+#define CONFIG_SAVE_DEBOUNCE_MS 1500     // NVS commit once saves stop for this long
+#define CONFIG_SAVE_TASK_STACK_SIZE 4096
+#define CONFIG_SAVE_TASK_PRIORITY 1
+#define CONFIG_CATEGORY_BLOB_MAX 768     // One category as "name\0value\0" pairs
+
+// Rate limiting of repeated log lines and alerts (rate_limiter.h)
+#define RATE_LIMIT_SITES 32              // Call sites tracked per limiter
+#define LOG_RATE_LIMIT_BURST 5           // Identical log lines printed back to back
+#define LOG_RATE_LIMIT_REFILL_MS 1000    // Then one per second
+#define LOG_RATE_LIMIT_SUMMARY_MS 5000   // Quiet time before "repeated N times"
+#define ALERT_RATE_LIMIT_BURST 1         // Identical alerts stored back to back
+#define ALERT_RATE_LIMIT_REFILL_MS 60000 // Repeats within this fold into the last alert
+
+// Live reconfiguration (live_reconfig.h)
+#define LIVE_RECONFIG_AUTO_APPLY 1           // Apply audio/stream config changes without a request
+#define LIVE_RECONFIG_SETTLE_MS 500          // Wait for a burst of field changes to finish
+#define LIVE_RECONFIG_DRAIN_TIMEOUT_MS 500   // Let the sender empty the ring before an audio restart
+#define LIVE_RECONFIG_PAUSE_TIMEOUT_MS 3000  // Give up if a task does not park in time
+#define LIVE_RECONFIG_TASK_STACK_SIZE 4096
+#define LIVE_RECONFIG_TASK_PRIORITY 2        // Above the save task, below the pipeline
+
+// OTA updates (ota_handler.h): received into PSRAM blocks, flashed by a separate writer task
+#define OTA_BLOCK_SIZE (64 * 1024)           // Flash write unit
+#define OTA_BLOCK_COUNT 4                    // Receive runs this far ahead of a flash stall
+#define OTA_BLOCK_INTERNAL_SIZE (4 * 1024)   // Without PSRAM: blocks come from internal RAM (no gzip)
+#define OTA_BLOCK_INTERNAL_COUNT 2           // ... double-buffered, at most OTA_BLOCK_COUNT
+#define OTA_BLOCK_WAIT_MS 30000              // Longest wait for the writer to free a block
+#define OTA_RECV_TIMEOUT_RETRIES 5           // Socket timeouts tolerated in a row while receiving
+#define OTA_WRITER_STACK_SIZE 4096
+#define OTA_WRITER_PRIORITY 2                // Below the pipeline: flash stalls never preempt audio
+#define OTA_WRITER_CORE 0
+#define OTA_PULL_URL_MAX 256
+#define OTA_PULL_TIMEOUT_MS 10000            // HTTP(S) client socket timeout
+#define OTA_PULL_STACK_SIZE 8192             // TLS handshake
+#define OTA_PULL_PRIORITY 3
+#define OTA_REBOOT_DELAY_MS 2000             // Let the response reach the client
 
 #endif // CONFIG_H
@@ -1,14 +1,22 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
 #include "esp_system.h"
 #include "esp_heap_caps.h"
 #include "esp_task_wdt.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
 
 #include "config.h"
 #include "modules/i2s_handler.h"
+#include "modules/audio_convert.h"
+#include "modules/audio_encoder.h"
+#include "modules/latency_profile.h"
+#include "modules/dsp_chain.h"
+#include "modules/vad_gate.h"
 #include "modules/network_manager.h"
 #include "modules/tcp_streamer.h"
 #include "modules/udp_streamer.h"
@@ -17,27 +25,1080 @@
 #include "modules/web_server_v2.h"
 #include "modules/captive_portal.h"
 #include "modules/performance_monitor.h"
+#include "modules/pipeline_stats.h"
+#include "modules/log_manager.h"
+#include "modules/live_reconfig.h"
+#include "modules/boot_profile.h"
+#include "modules/adaptive_quality.h"
+#include "modules/stream_sink.h"
+#include "modules/media_clock.h"
+#include "modules/flash_spool.h"
+#if PIPELINE_BENCH_ENABLED
+#include "modules/pipeline_bench.h"
+#endif
+
+static const char *TAG = "MAIN";
+
+// Task handles
+static TaskHandle_t i2s_reader_task_handle = NULL;
+static TaskHandle_t tcp_sender_task_handle = NULL;
+static TaskHandle_t watchdog_task_handle = NULL;
+
+// Watchdog flags
+static uint32_t i2s_reader_last_feed = 0;
+static uint32_t tcp_sender_last_feed = 0;
+
+// Error counters
+static uint32_t consecutive_i2s_failures = 0;
+static uint32_t consecutive_tcp_failures = 0;
+static uint32_t consecutive_udp_failures = 0;
+static uint32_t buffer_overflow_count = 0;
+static uint32_t last_overflow_time = 0;
+
+// Overflow policy (degrade is requested by the I2S reader, carried out by the sender)
+static overflow_policy_t overflow_policy = OVERFLOW_POLICY_DEFAULT;
+static volatile bool degrade_requested = false;
+
+// Set once app_main has brought WiFi up (or handed over to the captive portal)
+static volatile bool network_bring_up_done = false;
+
+static void start_captive_portal(bool with_timeout);
+static void create_tasks(void);
+
+/**
+ * Apply audio sample rate / bit depth / channels from unified config
+ * to the I2S capture path and the ring buffer format
+ */
+static void apply_audio_format(void)
+{
+    char value[16];
+    i2s_audio_format_t format;
+    i2s_handler_get_format(&format);
+
+    if (config_manager_v2_get_field(CONFIG_FIELD_AUDIO_SAMPLE_RATE, value, sizeof(value)))
+    {
+        format.sample_rate = strtoul(value, NULL, 10);
+    }
+    if (config_manager_v2_get_field(CONFIG_FIELD_AUDIO_BITS_PER_SAMPLE, value, sizeof(value)))
+    {
+        format.bits_per_sample = (uint8_t)atoi(value);
+    }
+    if (config_manager_v2_get_field(CONFIG_FIELD_AUDIO_CHANNELS, value, sizeof(value)))
+    {
+        format.channels = (uint8_t)atoi(value);
+    }
+
+    audio_codec_t codec = AUDIO_CODEC_DEFAULT;
+    if (config_manager_v2_get_field(CONFIG_FIELD_AUDIO_CODEC, value, sizeof(value)))
+    {
+        codec = (audio_codec_t)atoi(value);
+    }
+
+    // The link-quality tier may cap the configured rate, depth and codec
+    adaptive_quality_set_base(&format, codec);
+    adaptive_quality_get_format(&format, &codec);
+
+    if (!i2s_handler_set_format(&format))
+    {
+        ESP_LOGW(TAG, "Configured audio format not supported, using %d Hz %d-bit mono",
+                 SAMPLE_RATE, BITS_PER_SAMPLE);
+    }
+
+    i2s_handler_get_format(&format);
+    buffer_manager_set_format(i2s_handler_bytes_per_sample(), format.channels);
+    audio_encoder_init(codec, &format);
+}
+
+/**
+ * Configure the DSP chain and the I2S capture rate from unified config
+ *
+ * Must run after apply_audio_format() (the stream format is the chain's
+ * output) and before apply_latency_profile(), which sizes DMA for it.
+ */
+static void apply_dsp_config(void)
+{
+    char value[16];
+    dsp_chain_config_t dsp;
+    dsp.capture_rate = DSP_CAPTURE_RATE;
+    dsp.highpass_enabled = DSP_HIGHPASS_ENABLED;
+    dsp.highpass_hz = DSP_HIGHPASS_HZ;
+    dsp.agc_enabled = DSP_AGC_ENABLED;
+    dsp.agc_target_dbfs = DSP_AGC_TARGET_DBFS;
+    dsp.agc_max_gain_db = DSP_AGC_MAX_GAIN_DB;
+    dsp.limiter_dbfs = DSP_LIMITER_DBFS;
+
+    if (config_manager_v2_get_field(CONFIG_FIELD_DSP_CAPTURE_RATE, value, sizeof(value)))
+    {
+        dsp.capture_rate = strtoul(value, NULL, 10);
+    }
+    if (config_manager_v2_get_field(CONFIG_FIELD_DSP_HIGHPASS_ENABLED, value, sizeof(value)))
+    {
+        dsp.highpass_enabled = (atoi(value) != 0);
+    }
+    if (config_manager_v2_get_field(CONFIG_FIELD_DSP_HIGHPASS_HZ, value, sizeof(value)))
+    {
+        dsp.highpass_hz = strtoul(value, NULL, 10);
+    }
+    if (config_manager_v2_get_field(CONFIG_FIELD_DSP_AGC_ENABLED, value, sizeof(value)))
+    {
+        dsp.agc_enabled = (atoi(value) != 0);
+    }
+    if (config_manager_v2_get_field(CONFIG_FIELD_DSP_AGC_TARGET_DB, value, sizeof(value)))
+    {
+        dsp.agc_target_dbfs = atoi(value);
+    }
+    if (config_manager_v2_get_field(CONFIG_FIELD_DSP_AGC_MAX_GAIN_DB, value, sizeof(value)))
+    {
+        dsp.agc_max_gain_db = strtoul(value, NULL, 10);
+    }
+    if (config_manager_v2_get_field(CONFIG_FIELD_DSP_LIMITER_DB, value, sizeof(value)))
+    {
+        dsp.limiter_dbfs = atoi(value);
+    }
+
+    i2s_audio_format_t format;
+    i2s_handler_get_format(&format);
+    if (!dsp_chain_init(&dsp, &format))
+    {
+        ESP_LOGW(TAG, "DSP settings partly rejected, see DSP_CHAIN log");
+    }
+
+    // Clock I2S at capture_rate only if the decimator accepted it
+    uint32_t decimation = dsp_chain_decimation();
+    i2s_handler_set_capture_rate(decimation > 1 ? format.sample_rate * decimation : 0);
+}
+
+/**
+ * Apply the ring overflow policy from unified config
+ */
+static void apply_overflow_policy(void)
+{
+    char value[8];
+    overflow_policy = OVERFLOW_POLICY_DEFAULT;
+    if (config_manager_v2_get_field(CONFIG_FIELD_BUFFER_OVERFLOW_POLICY, value, sizeof(value)))
+    {
+        overflow_policy = (overflow_policy_t)atoi(value);
+    }
+    buffer_manager_set_overflow_policy(overflow_policy);
+}
+
+/**
+ * Resolve the latency profile into I2S, DMA and block sizes
+ *
+ * Must run after apply_audio_format() and before i2s_handler_init(), since
+ * the DMA layout is fixed when the channel is created.
+ */
+static void apply_latency_profile(void)
+{
+    char value[16];
+    latency_profile_t profile = LATENCY_PROFILE_DEFAULT;
+    uint32_t dma_count = I2S_DMA_BUF_COUNT;
+    uint32_t dma_len = I2S_DMA_BUF_LEN;
+
+    if (config_manager_v2_get_field(CONFIG_FIELD_LATENCY_PROFILE, value, sizeof(value)))
+    {
+        profile = (latency_profile_t)atoi(value);
+    }
+    if (config_manager_v2_get_field(CONFIG_FIELD_BUFFER_DMA_COUNT, value, sizeof(value)))
+    {
+        dma_count = strtoul(value, NULL, 10);
+    }
+    if (config_manager_v2_get_field(CONFIG_FIELD_BUFFER_DMA_LENGTH, value, sizeof(value)))
+    {
+        dma_len = strtoul(value, NULL, 10);
+    }
+
+    i2s_audio_format_t format;
+    i2s_handler_get_format(&format);
+    if (!latency_profile_apply(profile, &format, dma_count, dma_len))
+    {
+        ESP_LOGW(TAG, "Latency profile %d not recognised, using custom sizes", profile);
+    }
+
+    // DMA runs at the capture rate: keep each descriptor the same length in time
+    const latency_params_t *params = latency_profile_get();
+    i2s_handler_set_dma(params->dma_desc_num, params->dma_frame_num * dsp_chain_decimation());
+}
+
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP
+static uint32_t tcp_backpressure_drops = 0; // Blocks shed while TCP was backed up
+
+/**
+ * Count and log a block shed while TCP was backed up
+ */
+static void tcp_note_backpressure_drop(void)
+{
+    tcp_backpressure_drops++;
+    if ((tcp_backpressure_drops % 50) == 1)
+    {
+        ESP_LOGW(TAG, "TCP backed up, dropping oldest audio (%lu blocks, %zu bytes in flight)",
+                 tcp_backpressure_drops, tcp_streamer_in_flight());
+    }
+}
+
+/**
+ * Decide whether to keep a block the TCP streamer refused
+ *
+ * A refusal on a live connection means the socket is backed up, not broken:
+ * keep the block in the ring (backpressure) until the ring is nearly full,
+ * then let it go so the oldest audio makes room for new captures. Used by
+ * the encoded and silence-frame paths, whose output is not spooled.
+ *
+ * @return true to keep the block for the next attempt
+ */
+static bool tcp_keep_refused_block(void)
+{
+    if (!tcp_streamer_is_connected())
+    {
+        return false; // Real failure, reconnect logic handles it
+    }
+
+    if (buffer_manager_usage_percent() < TCP_BACKPRESSURE_DROP_PERCENT)
+    {
+        return true;
+    }
+
+    tcp_note_backpressure_drop();
+    return false;
+}
+
+/**
+ * Decide what to do with a raw PCM block the TCP streamer refused
+ *
+ * Same backpressure rule as tcp_keep_refused_block(), but a block that would
+ * be dropped goes to the flash spool instead when one is available, to be
+ * replayed as backfill.
+ *
+ * @param span The refused block
+ * @param samples Samples in span
+ * @return Samples to consume (0 keeps the block for the next attempt)
+ */
+static size_t tcp_refused_block_consume(const buffer_span_t *span, size_t samples)
+{
+    if (!tcp_streamer_is_connected())
+    {
+        return samples; // Real failure, reconnect logic handles it
+    }
+
+    if (buffer_manager_usage_percent() < TCP_BACKPRESSURE_DROP_PERCENT)
+    {
+        return 0;
+    }
+
+    size_t spooled = flash_spool_spill(span);
+    if (spooled > 0)
+    {
+        return spooled;
+    }
+
+    tcp_note_backpressure_drop();
+    return samples;
+}
+#endif
+
+#if STREAMING_PROTOCOL != STREAMING_PROTOCOL_BOTH
+/**
+ * Replay outage audio from the flash spool after a live block
+ *
+ * Runs faster than real time but behind live audio: it stops while the
+ * ring backs up, and a record the streamer refuses stays spooled for the
+ * next round.
+ */
+static void replay_backfill(void)
+{
+    for (int i = 0; i < FLASH_SPOOL_REPLAY_BURST && flash_spool_pending() > 0; i++)
+    {
+        if (buffer_manager_usage_percent() > FLASH_SPOOL_REPLAY_MAX_PERCENT)
+        {
+            return;
+        }
+        flash_spool_block_t block;
+        if (!flash_spool_peek(&block))
+        {
+            return;
+        }
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP
+        bool sent = tcp_streamer_send_backfill(&block);
+#else
+        bool sent = udp_streamer_send_backfill(&block);
+#endif
+        if (!sent)
+        {
+            return;
+        }
+        flash_spool_release();
+    }
+}
+#endif
+
+/**
+ * Get a contiguous pointer to one encoder frame inside the ring spans
+ *
+ * Frames that straddle the ring wrap are copied into staging.
+ */
+static const int16_t *span_frame(const buffer_span_t *span, size_t offset, size_t samples, int16_t *staging)
+{
+    if (offset + samples <= span->samples[0])
+    {
+        return (const int16_t *)span->data[0] + offset;
+    }
+    if (offset >= span->samples[0])
+    {
+        return (const int16_t *)span->data[1] + (offset - span->samples[0]);
+    }
+
+    size_t head = span->samples[0] - offset;
+    memcpy(staging, (const int16_t *)span->data[0] + offset, head * sizeof(int16_t));
+    memcpy(staging + head, span->data[1], (samples - head) * sizeof(int16_t));
+    return staging;
+}
+
+#if STREAMING_PROTOCOL != STREAMING_PROTOCOL_TCP
+/**
+ * Get the capture time of a sample further into a block, at the nominal stream rate
+ *
+ * @param capture_us Capture time of the block's first sample (0 = unknown)
+ * @param samples Interleaved samples from the start of the block
+ */
+static int64_t capture_after(int64_t capture_us, size_t samples)
+{
+    i2s_audio_format_t format;
+    i2s_handler_get_format(&format);
+    uint64_t samples_per_sec = (uint64_t)format.sample_rate * format.channels;
+    if (capture_us == 0 || samples_per_sec == 0)
+    {
+        return capture_us;
+    }
+    return capture_us + (int64_t)(samples * 1000000ULL / samples_per_sec);
+}
+#endif
+
+#if STREAMING_PROTOCOL != STREAMING_PROTOCOL_BOTH
+/**
+ * Encode whole frames from the ring spans and hand them to the streamers
+ *
+ * UDP packs as many fixed-size frames per datagram as fit (one per datagram
+ * for variable-size codecs); TCP sends frames back to back, length-prefixed
+ * for variable-size codecs. A partial trailing frame stays in the ring.
+ *
+ * @param span Spans from buffer_manager_peek_read()
+ * @param staging Scratch for one frame (audio_encoder_frame_samples())
+ * @param encoded Output scratch (encoded_size bytes)
+ * @param success Set to false if any send failed
+ * @return Samples consumed (whole frames)
+ */
+static size_t stream_encoded_block(const buffer_span_t *span, int16_t *staging,
+                                   uint8_t *encoded, size_t encoded_size, bool *success)
+{
+    const size_t frame_samples = audio_encoder_frame_samples();
+    const size_t frame_bytes_max = audio_encoder_max_frame_bytes();
+    const bool fixed_size = audio_encoder_fixed_frame_size();
+    const uint8_t codec = (uint8_t)audio_encoder_get_codec();
+    size_t frames = (span->samples[0] + span->samples[1]) / frame_samples;
+    bool tcp_ok = true;
+    bool udp_ok = true;
+    size_t used = 0;
+    uint32_t block_start = pipeline_stats_start();
+    uint32_t encode_cycles = 0;
+
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_UDP
+    size_t payload_max = udp_streamer_max_payload();
+    if (payload_max > encoded_size)
+    {
+        payload_max = encoded_size;
+    }
+    size_t payload_samples = 0;
+    uint64_t payload_sample_index = 0; // First frame of the datagram
+    int64_t payload_capture_us = 0;
+#else
+    size_t payload_max = encoded_size;
+#endif
+
+    for (size_t f = 0; f < frames; f++)
+    {
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_UDP
+        // Flush the datagram before the next frame could overflow it
+        if (used > 0 && used + frame_bytes_max > payload_max)
+        {
+            udp_ok = udp_streamer_send_encoded(encoded, used, payload_samples, codec, payload_sample_index,
+                                               payload_capture_us) && udp_ok;
+            used = 0;
+            payload_samples = 0;
+        }
+#endif
+
+        const int16_t *in = span_frame(span, f * frame_samples, frame_samples, staging);
+        uint32_t encode_start = pipeline_stats_start();
+        size_t n = audio_encoder_encode_frame(in, encoded + used, payload_max - used);
+        encode_cycles += pipeline_stats_start() - encode_start;
+        if (n == 0)
+        {
+            continue;
+        }
+
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP
+        tcp_frame_info_t info;
+        memset(&info, 0, sizeof(info));
+        buffer_manager_peek_capture(f * frame_samples, &info.sample_index, &info.capture_us);
+        info.samples = frame_samples;
+        info.codec = codec;
+        bool frame_ok = tcp_streamer_send_encoded(encoded + used, n, &info, !fixed_size);
+        if (!frame_ok && tcp_keep_refused_block())
+        {
+            frames = f; // This frame and the rest stay in the ring
+            break;
+        }
+        frame_ok = frame_ok || tcp_streamer_is_connected();
+        tcp_ok = frame_ok && tcp_ok;
+#endif
+
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_UDP
+        if (payload_samples == 0)
+        {
+            buffer_manager_peek_capture(f * frame_samples, &payload_sample_index, &payload_capture_us);
+        }
+        used += n;
+        payload_samples += frame_samples;
+        if (!fixed_size)
+        {
+            udp_ok = udp_streamer_send_encoded(encoded, used, payload_samples, codec, payload_sample_index,
+                                               payload_capture_us) && udp_ok;
+            used = 0;
+            payload_samples = 0;
+        }
+#endif
+    }
+
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_UDP
+    if (used > 0)
+    {
+        udp_ok = udp_streamer_send_encoded(encoded, used, payload_samples, codec, payload_sample_index,
+                                           payload_capture_us) && udp_ok;
+    }
+#endif
+
+    // Everything in the block that was not encoding is streamer send time
+    pipeline_stats_record_cycles(PIPELINE_STAGE_ENCODE, encode_cycles);
+    pipeline_stats_record_cycles(PIPELINE_STAGE_SEND, pipeline_stats_start() - block_start - encode_cycles);
+
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP
+    *success = tcp_ok;
+#else
+    *success = udp_ok;
+#endif
+    (void)tcp_ok;
+    (void)udp_ok;
+    (void)fixed_size;
+    (void)codec;
+    return frames * frame_samples;
+}
+#endif
+
+/**
+ * Trim ring spans to their first samples
+ */
+static void span_limit(buffer_span_t *span, size_t samples)
+{
+    if (samples <= span->samples[0])
+    {
+        span->samples[0] = samples;
+        span->samples[1] = 0;
+        span->data[1] = NULL;
+    }
+    else if (samples < span->samples[0] + span->samples[1])
+    {
+        span->samples[1] = samples - span->samples[0];
+    }
+}
+
+/**
+ * Get the pre-roll the sender holds back while the gate is closed
+ *
+ * Capped at half the ring so the wait watermark can still be reached.
+ */
+static size_t gate_preroll(void)
+{
+    size_t preroll = vad_gate_preroll_samples();
+    size_t capacity = buffer_manager_available() + buffer_manager_free_space();
+    return (preroll > capacity / 2) ? capacity / 2 : preroll;
+}
+
+/**
+ * Cut a peeked block at the next silence gate transition
+ *
+ * Speech is limited to send_samples and rounded up to a whole encoder frame
+ * at a close, so the tail of a word is never held back. While the gate is
+ * still closed at the newest audio, silence stops pre-roll short of it so an
+ * opening can be back-dated into samples that are still in the ring.
+ *
+ * @param span Peeked spans; trimmed to a speech run
+ * @param samples Samples in span
+ * @param send_samples Longest speech block
+ * @param frame_samples Encoder frame (channels for PCM)
+ * @param channels Interleaved channels
+ * @param silent Output: true if the run is silence
+ * @return Samples in the run (0 = keep waiting)
+ */
+static size_t gate_block(buffer_span_t *span, size_t samples, size_t send_samples,
+                         size_t frame_samples, size_t channels, bool *silent)
+{
+    bool active = true;
+    size_t run = vad_gate_run(span->sample_index, samples, &active);
+    *silent = !active;
+
+    if (!active)
+    {
+        if (run == samples)
+        {
+            size_t preroll = gate_preroll();
+            run = (run > preroll) ? run - preroll : 0;
+        }
+        return run - (run % channels);
+    }
+
+    if (run < samples && run < send_samples && frame_samples > 0)
+    {
+        run = ((run + frame_samples - 1) / frame_samples) * frame_samples;
+    }
+    if (run > send_samples)
+    {
+        run = send_samples;
+    }
+    if (run > samples)
+    {
+        run = samples;
+    }
+    span_limit(span, run);
+    return run;
+}
+
+#if STREAMING_PROTOCOL != STREAMING_PROTOCOL_BOTH
+/**
+ * Replace a silent run with a silence frame
+ *
+ * The frame carries the run length as its sample count and the comfort-noise
+ * RMS as a uint16 LE payload. A UDP header counts only 16 bits of samples, so
+ * long runs go out as several datagrams.
+ *
+ * @param span Peeked spans (for the capture position)
+ * @param samples Samples in the silent run
+ * @param channels Interleaved channels
+ * @param success Set to false if any send failed
+ * @return Samples consumed
+ */
+static size_t stream_silence_block(const buffer_span_t *span, size_t samples, size_t channels, bool *success)
+{
+    *success = true;
+    if (samples == 0)
+    {
+        return 0;
+    }
+
+    uint16_t level = vad_gate_noise_level();
+    uint8_t payload[2] = {(uint8_t)(level & 0xFF), (uint8_t)(level >> 8)};
+    bool tcp_ok = true;
+    bool udp_ok = true;
+
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP
+    tcp_frame_info_t info;
+    memset(&info, 0, sizeof(info));
+    info.sample_index = span->sample_index;
+    info.capture_us = span->capture_us;
+    info.samples = samples;
+    info.codec = AUDIO_CODEC_SILENCE;
+    tcp_ok = tcp_streamer_send_encoded(payload, sizeof(payload), &info, false);
+    if (!tcp_ok && tcp_keep_refused_block())
+    {
+        return 0; // Retry the run with the next block
+    }
+    tcp_ok = tcp_ok || tcp_streamer_is_connected();
+#endif
+
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_UDP
+    const size_t max_run = UINT16_MAX - (UINT16_MAX % channels);
+    for (size_t sent = 0; sent < samples;)
+    {
+        size_t n = (samples - sent > max_run) ? max_run : samples - sent;
+        bool ok = udp_streamer_send_encoded(payload, sizeof(payload), n, AUDIO_CODEC_SILENCE,
+                                            span->sample_index + sent, capture_after(span->capture_us, sent));
+        udp_ok = ok && udp_ok;
+        sent += n;
+    }
+#endif
+
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP
+    *success = tcp_ok;
+#else
+    *success = udp_ok;
+#endif
+    (void)tcp_ok;
+    (void)udp_ok;
+    (void)span;
+    (void)channels;
+
+    vad_gate_add_suppressed(samples);
+    return samples;
+}
+#endif
+
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+/**
+ * View a PCM record as a single ring span for the streamers
+ */
+static buffer_span_t record_pcm_span(const stream_record_t *record, const uint8_t *payload)
+{
+    buffer_span_t span;
+    memset(&span, 0, sizeof(span));
+    span.data[0] = (uint8_t *)payload; // Streamers only read
+    span.samples[0] = record->samples;
+    span.sample_bytes = record->sample_bytes;
+    span.sample_index = record->sample_index;
+    span.capture_us = record->capture_us;
+    return span;
+}
+
+// TCP sink: the reliable destination (e.g. an archival server); a backed-up socket only delays itself
+static bool tcp_sink_send(const stream_record_t *record, const uint8_t *payload)
+{
+    if (!tcp_streamer_wait_writable(TCP_SEND_WAIT_MS))
+    {
+        return false; // Refused: the sink retries the record
+    }
+
+    if (record->codec == AUDIO_CODEC_PCM)
+    {
+        buffer_span_t span = record_pcm_span(record, payload);
+        return tcp_streamer_send_span(&span);
+    }
+
+    tcp_frame_info_t info;
+    memset(&info, 0, sizeof(info));
+    info.sample_index = record->sample_index;
+    info.capture_us = record->capture_us;
+    info.samples = record->samples;
+    info.codec = record->codec;
+    return tcp_streamer_send_encoded(payload, record->bytes, &info,
+                                     (record->flags & STREAM_RECORD_FLAG_VARIABLE) != 0);
+}
+
+static const stream_sink_ops_t tcp_sink_ops = {
+    "tcp", true, tcp_streamer_reconnect, tcp_streamer_is_connected, tcp_sink_send, NULL};
+
+// UDP sink: real time, so it also defines the end-to-end latency; fixed-size frames share a datagram
+static uint8_t udp_pack[UDP_PACKET_MAX_SIZE];
+static size_t udp_pack_bytes = 0;
+static size_t udp_pack_samples = 0;
+static uint8_t udp_pack_codec = AUDIO_CODEC_PCM;
+static uint64_t udp_pack_sample_index = 0;
+static int64_t udp_pack_capture_us = 0;
+
+static void udp_sink_flush(void)
+{
+    if (udp_pack_bytes == 0)
+    {
+        return;
+    }
+
+    if (udp_streamer_send_encoded(udp_pack, udp_pack_bytes, udp_pack_samples, udp_pack_codec,
+                                  udp_pack_sample_index, udp_pack_capture_us) &&
+        udp_pack_capture_us != 0)
+    {
+        latency_profile_record(esp_timer_get_time() - udp_pack_capture_us);
+    }
+    udp_pack_bytes = 0;
+    udp_pack_samples = 0;
+}
+
+static bool udp_sink_send(const stream_record_t *record, const uint8_t *payload)
+{
+    if (record->codec == AUDIO_CODEC_PCM)
+    {
+        udp_sink_flush();
+        buffer_span_t span = record_pcm_span(record, payload);
+        bool sent = udp_streamer_send_span(&span);
+        if (sent && record->capture_us != 0)
+        {
+            latency_profile_record(esp_timer_get_time() - record->capture_us);
+        }
+        return sent;
+    }
+
+    if (record->codec == AUDIO_CODEC_SILENCE)
+    {
+        // A UDP header counts only 16 bits of samples
+        udp_sink_flush();
+        const size_t channels = record->channels > 0 ? record->channels : 1;
+        const size_t max_run = UINT16_MAX - (UINT16_MAX % channels);
+        bool sent = true;
+        for (size_t done = 0; done < record->samples;)
+        {
+            size_t n = (record->samples - done > max_run) ? max_run : record->samples - done;
+            sent = udp_streamer_send_encoded(payload, record->bytes, n, AUDIO_CODEC_SILENCE,
+                                             record->sample_index + done,
+                                             capture_after(record->capture_us, done)) && sent;
+            done += n;
+        }
+        return sent;
+    }
+
+    if (udp_pack_bytes > 0 &&
+        (record->codec != udp_pack_codec || udp_pack_bytes + record->bytes > udp_streamer_max_payload()))
+    {
+        udp_sink_flush();
+    }
+    if (record->bytes > udp_streamer_max_payload())
+    {
+        return false;
+    }
+    if (udp_pack_bytes == 0)
+    {
+        udp_pack_codec = record->codec;
+        udp_pack_sample_index = record->sample_index;
+        udp_pack_capture_us = record->capture_us;
+    }
+    memcpy(udp_pack + udp_pack_bytes, payload, record->bytes);
+    udp_pack_bytes += record->bytes;
+    udp_pack_samples += record->samples;
+    if (record->flags & STREAM_RECORD_FLAG_VARIABLE)
+    {
+        udp_sink_flush(); // One variable-size frame per datagram
+    }
+    return true;
+}
+
+static bool udp_sink_connect(void)
+{
+    udp_pack_bytes = 0;
+    udp_pack_samples = 0;
+    return udp_streamer_reconnect();
+}
+
+static const stream_sink_ops_t udp_sink_ops = {
+    "udp", false, udp_sink_connect, udp_streamer_is_connected, udp_sink_send, udp_sink_flush};
+#endif
+
+/**
+ * Get the stream server's time service port from unified config
+ */
+static uint16_t configured_media_clock_port(void)
+{
+    char value[8];
+    if (config_manager_v2_get_field(CONFIG_FIELD_MEDIA_CLOCK_PORT, value, sizeof(value)))
+    {
+        return (uint16_t)atoi(value);
+    }
+    return MEDIA_CLOCK_SERVER_PORT;
+}
+
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP || STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+/**
+ * Apply TCP stream settings from config (before tcp_streamer_init or a reconnect)
+ */
+static void apply_tcp_config(void)
+{
+    char value[8];
+    char server_ip[16] = TCP_SERVER_IP;
+    uint16_t server_port = TCP_SERVER_PORT;
+    bool framing = TCP_FRAMING_ENABLED;
+
+    config_manager_v2_get_field(CONFIG_FIELD_TCP_SERVER_IP, server_ip, sizeof(server_ip));
+    if (config_manager_v2_get_field(CONFIG_FIELD_TCP_SERVER_PORT, value, sizeof(value)))
+    {
+        server_port = (uint16_t)atoi(value);
+    }
+    if (!tcp_streamer_set_server(server_ip, server_port))
+    {
+        strncpy(server_ip, TCP_SERVER_IP, sizeof(server_ip) - 1);
+        tcp_streamer_set_server(TCP_SERVER_IP, TCP_SERVER_PORT);
+    }
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP
+    media_clock_set_server(server_ip, configured_media_clock_port()); // With both streams the time server sits with the UDP one
+#endif
 
-static const char *TAG = "MAIN";
+    if (config_manager_v2_get_field(CONFIG_FIELD_TCP_FRAMING_ENABLED, value, sizeof(value)))
+    {
+        framing = (atoi(value) != 0);
+    }
 
-// Task handles
-static TaskHandle_t i2s_reader_task_handle = NULL;
-static TaskHandle_t tcp_sender_task_handle = NULL;
-static TaskHandle_t watchdog_task_handle = NULL;
+    tcp_streamer_set_framing(framing);
 
-// Watchdog flags
-static uint32_t i2s_reader_last_feed = 0;
-static uint32_t tcp_sender_last_feed = 0;
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP
+    // Backfill is only told apart from live audio by the frame header
+    if (FLASH_SPOOL_ENABLED && !framing)
+    {
+        ESP_LOGW(TAG, "Outage spool needs tcp_framing_enabled, spool disabled");
+    }
+    flash_spool_set_enabled(framing);
+#endif
 
-// Error counters
-static uint32_t consecutive_i2s_failures = 0;
-static uint32_t consecutive_tcp_failures = 0;
-static uint32_t consecutive_udp_failures = 0;
-static uint32_t buffer_overflow_count = 0;
-static uint32_t last_overflow_time = 0;
+    // Without frame headers the server cannot follow a format or codec change
+    adaptive_quality_set_signalled(framing);
+}
+#endif
 
-static void start_captive_portal(bool with_timeout);
-static void create_tasks(void);
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_UDP || STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+/**
+ * Apply UDP FEC from unified config, raised to the link-quality tier's protection
+ */
+static void apply_udp_fec(void)
+{
+    char value[8];
+    bool fec_enabled = UDP_FEC_ENABLED;
+    uint8_t fec_group_size = UDP_FEC_GROUP_SIZE;
+
+    if (config_manager_v2_get_field(CONFIG_FIELD_UDP_FEC_ENABLED, value, sizeof(value)))
+    {
+        fec_enabled = (atoi(value) != 0);
+    }
+    if (config_manager_v2_get_field(CONFIG_FIELD_UDP_FEC_GROUP_SIZE, value, sizeof(value)))
+    {
+        fec_group_size = (uint8_t)atoi(value);
+    }
+
+    adaptive_quality_set_base_fec(fec_enabled, fec_group_size);
+    adaptive_quality_get_fec(&fec_enabled, &fec_group_size);
+    if (!udp_streamer_set_fec(fec_enabled, fec_group_size))
+    {
+        udp_streamer_set_fec(fec_enabled, UDP_FEC_GROUP_SIZE);
+    }
+}
+
+/**
+ * Push UDP stream options (server, multicast, FEC) from the unified config into the streamer
+ */
+static void apply_udp_config(void)
+{
+    char value[16];
+    char server_ip[16] = UDP_SERVER_IP;
+    uint16_t server_port = UDP_SERVER_PORT;
+    bool multicast_enabled = UDP_MULTICAST_ENABLED;
+    char multicast_group[16] = UDP_MULTICAST_GROUP;
+    uint16_t multicast_port = UDP_MULTICAST_PORT;
+    uint8_t multicast_ttl = UDP_MULTICAST_TTL;
+
+    config_manager_v2_get_field(CONFIG_FIELD_UDP_SERVER_IP, server_ip, sizeof(server_ip));
+    if (config_manager_v2_get_field(CONFIG_FIELD_UDP_SERVER_PORT, value, sizeof(value)))
+    {
+        server_port = (uint16_t)atoi(value);
+    }
+    if (!udp_streamer_set_server(server_ip, server_port))
+    {
+        strncpy(server_ip, UDP_SERVER_IP, sizeof(server_ip) - 1);
+        udp_streamer_set_server(UDP_SERVER_IP, UDP_SERVER_PORT);
+    }
+    media_clock_set_server(server_ip, configured_media_clock_port());
+
+    if (config_manager_v2_get_field(CONFIG_FIELD_UDP_MULTICAST_ENABLED, value, sizeof(value)))
+    {
+        multicast_enabled = (atoi(value) != 0);
+    }
+    config_manager_v2_get_field(CONFIG_FIELD_UDP_MULTICAST_GROUP, multicast_group, sizeof(multicast_group));
+    if (config_manager_v2_get_field(CONFIG_FIELD_UDP_MULTICAST_PORT, value, sizeof(value)))
+    {
+        multicast_port = (uint16_t)atoi(value);
+    }
+    if (config_manager_v2_get_field(CONFIG_FIELD_UDP_MULTICAST_TTL, value, sizeof(value)))
+    {
+        multicast_ttl = (uint8_t)atoi(value);
+    }
+
+    if (!udp_streamer_set_multicast(multicast_enabled, multicast_group, multicast_port, multicast_ttl))
+    {
+        ESP_LOGW(TAG, "Invalid multicast settings, using unicast to %s", server_ip);
+        udp_streamer_set_multicast(false, NULL, 0, 0);
+    }
+
+    apply_udp_fec();
+}
+#endif
+
+/**
+ * Configure the silence gate from unified config (after apply_tcp_config)
+ *
+ * Silence frames carry their duration in the frame header, so a TCP stream
+ * without framing cannot use the gate.
+ */
+static void apply_vad_config(void)
+{
+    char value[16];
+    bool enabled = VAD_ENABLED;
+    int threshold_db = VAD_THRESHOLD_DBFS;
+    uint32_t hangover_ms = VAD_HANGOVER_MS;
+    uint32_t preroll_ms = VAD_PREROLL_MS;
+
+    if (config_manager_v2_get_field(CONFIG_FIELD_VAD_ENABLED, value, sizeof(value)))
+    {
+        enabled = (atoi(value) != 0);
+    }
+    if (config_manager_v2_get_field(CONFIG_FIELD_VAD_THRESHOLD_DB, value, sizeof(value)))
+    {
+        threshold_db = atoi(value);
+    }
+    if (config_manager_v2_get_field(CONFIG_FIELD_VAD_HANGOVER_MS, value, sizeof(value)))
+    {
+        hangover_ms = strtoul(value, NULL, 10);
+    }
+    if (config_manager_v2_get_field(CONFIG_FIELD_VAD_PREROLL_MS, value, sizeof(value)))
+    {
+        preroll_ms = strtoul(value, NULL, 10);
+    }
+
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP || STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+    if (enabled && !tcp_streamer_framing_enabled())
+    {
+        ESP_LOGW(TAG, "Silence gate needs tcp_framing_enabled, gate disabled");
+        enabled = false;
+    }
+#endif
+
+    i2s_audio_format_t format;
+    i2s_handler_get_format(&format);
+    vad_gate_init(enabled, threshold_db, hangover_ms, preroll_ms, &format);
+}
+
+/**
+ * Apply changed settings while the pipeline is parked (live_reconfig callback)
+ *
+ * Stream parts run first: the silence gate depends on TCP framing.
+ *
+ * @param parts Mask of reconfig_part_t
+ * @return true if every part was applied
+ */
+static bool apply_live_config(uint32_t parts)
+{
+    bool success = true;
+
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+    // The sinks call into the streamers: park them as well
+    if (!stream_sink_suspend(STREAM_SINK_SUSPEND_TIMEOUT_MS))
+    {
+        stream_sink_resume();
+        ESP_LOGE(TAG, "Fan-out sinks did not park, reconfiguration not applied");
+        return false;
+    }
+#endif
+
+    if (parts & RECONFIG_PART_STREAM)
+    {
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP || STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+        apply_tcp_config();
+        if (!tcp_streamer_reconnect())
+        {
+            ESP_LOGW(TAG, "TCP reconnect after reconfiguration failed, will retry");
+            success = false;
+        }
+#endif
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_UDP || STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+        apply_udp_config();
+        if (!udp_streamer_reconnect())
+        {
+            ESP_LOGW(TAG, "UDP reconnect after reconfiguration failed, will retry");
+            success = false;
+        }
+#endif
+        audio_encoder_reset(); // New peer starts a fresh decoder
+    }
+
+    if (parts & RECONFIG_PART_AUDIO)
+    {
+        // Clocks and the DMA layout are fixed when the channel is created
+        i2s_handler_deinit();
+        apply_audio_format();
+        apply_dsp_config();
+        apply_latency_profile();
+        apply_overflow_policy();
+        apply_vad_config();
+        buffer_manager_reset(); // Buffered audio belongs to the old clock
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+        stream_sink_reset();
+#endif
+        if (!i2s_handler_init())
+        {
+            ESP_LOGE(TAG, "I2S init with the new format failed");
+            success = false;
+        }
+    }
+
+    if (parts & RECONFIG_PART_CODEC)
+    {
+        // Quality tier switch; a clock change came with the audio part above
+        if (!(parts & RECONFIG_PART_AUDIO))
+        {
+            i2s_audio_format_t format;
+            audio_codec_t codec;
+            adaptive_quality_get_format(&format, &codec);
+            i2s_handler_get_format(&format); // Capture keeps running at this format
+            audio_encoder_init(codec, &format);
+        }
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_UDP || STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+        apply_udp_fec();
+#endif
+    }
+
+    // Frames from here on carry the tier they were encoded at
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP || STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+    tcp_streamer_set_quality_tier(adaptive_quality_get_tier());
+#endif
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_UDP || STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+    udp_streamer_set_quality_tier(adaptive_quality_get_tier());
+#endif
+
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+    stream_sink_resume();
+#endif
+
+    // Parked tasks did not feed the watchdog
+    i2s_reader_last_feed = xTaskGetTickCount();
+    tcp_sender_last_feed = xTaskGetTickCount();
+    return success;
+}
+
+// Capture parameters owned by the I2S reader
+typedef struct
+{
+    int32_t *tmp_buffer;      // DMA landing buffer for raw 32-bit slots
+    size_t read_samples;      // Raw samples per read
+    uint64_t samples_per_sec; // Interleaved raw samples per second
+    int64_t dsp_delay_us;
+} reader_params_t;
+
+/**
+ * Size the reader for the active format, decimation and latency profile
+ *
+ * Runs at task start and again after a live audio reconfiguration.
+ *
+ * @return false if the landing buffer cannot be allocated
+ */
+static bool reader_configure(reader_params_t *params)
+{
+    heap_caps_free(params->tmp_buffer);
+    params->tmp_buffer = NULL;
+
+    // Raw chunk at the capture rate: whole decimator periods of whole frames
+    i2s_audio_format_t format;
+    i2s_handler_get_format(&format);
+    const size_t decimation = dsp_chain_decimation();
+    const size_t raw_period = decimation * format.channels;
+    size_t read_samples = latency_profile_get()->i2s_read_samples * decimation;
+    if (read_samples > I2S_READ_SAMPLES_MAX)
+    {
+        read_samples = I2S_READ_SAMPLES_MAX - (I2S_READ_SAMPLES_MAX % raw_period);
+    }
+
+    // Conversion writes straight into the ring
+    // 16-byte aligned so the SIMD conversion kernels can use 128-bit loads
+    params->tmp_buffer = (int32_t *)heap_caps_aligned_alloc(16, read_samples * sizeof(int32_t),
+                                                            MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    params->read_samples = read_samples;
+
+    // For back-dating each block to its first sample
+    params->samples_per_sec = (uint64_t)i2s_handler_get_capture_rate() * format.channels;
+    params->dsp_delay_us = dsp_chain_delay_us();
+
+    // The sample clock follows the ring rate, after decimation
+    media_clock_set_sample_rate(format.sample_rate * format.channels);
+    return params->tmp_buffer != NULL;
+}
 
 /**
  * I2S Reader Task with Error Recovery
@@ -46,32 +1107,73 @@ static void i2s_reader_task(void *arg)
 {
     ESP_LOGI(TAG, "I2S Reader task started");
 
-    const size_t read_samples = I2S_READ_SAMPLES;
-    // ✅ CHANGED: Use int16_t buffer for direct 16-bit I2S reading (50% bandwidth savings)
-    int16_t *i2s_buffer = (int16_t *)malloc(read_samples * sizeof(int16_t));
-    // ✅ ADD: Temporary buffer for 32-bit samples (required for thread-safe i2s_read_16)
-    int32_t *tmp_buffer = (int32_t *)malloc(read_samples * sizeof(int32_t));
-
-    if (i2s_buffer == NULL || tmp_buffer == NULL)
+    reader_params_t params = {NULL, 0, 0, 0};
+    if (!reader_configure(&params))
     {
         ESP_LOGE(TAG, "CRITICAL: Failed to allocate I2S buffers");
-        free(i2s_buffer);
-        free(tmp_buffer);
         esp_restart(); // Critical failure, reboot
         return;
     }
 
     while (1)
     {
-        // ✅ CHANGED: Use i2s_read_16() to read directly as 16-bit samples
-        size_t samples_read = i2s_read_16(i2s_buffer, tmp_buffer, read_samples);
+        // Parked while I2S restarts with a new clock config
+        if (live_reconfig_checkpoint(RECONFIG_TASK_READER))
+        {
+            if (!reader_configure(&params))
+            {
+                ESP_LOGE(TAG, "CRITICAL: Failed to allocate I2S buffers");
+                esp_restart();
+            }
+            consecutive_i2s_failures = 0;
+        }
+
+        uint32_t read_start = pipeline_stats_start();
+        size_t samples_read = i2s_read_raw(params.tmp_buffer, params.read_samples);
+        pipeline_stats_record(PIPELINE_STAGE_I2S_READ, read_start);
 
         if (samples_read > 0)
         {
+            // The read returns once the last sample of the block is in, so the block
+            // started samples_read sample periods ago
+            int64_t capture_us = esp_timer_get_time() - (int64_t)((samples_read * 1000000ULL) / params.samples_per_sec);
+
             consecutive_i2s_failures = 0; // Reset failure counter
 
-            // ✅ CHANGED: Use buffer_manager_write_16() for native 16-bit storage
-            size_t written = buffer_manager_write_16(i2s_buffer, samples_read);
+            // DSP in place on the raw slots; the ring holds the (decimated) stream rate
+            uint32_t dsp_start = pipeline_stats_start();
+            samples_read = dsp_chain_process(params.tmp_buffer, samples_read);
+            pipeline_stats_record(PIPELINE_STAGE_DSP, dsp_start);
+            capture_us -= params.dsp_delay_us;
+
+            // Read returns jitter with scheduling; the sample clock does not
+            capture_us = media_clock_capture(buffer_manager_stream_index(), capture_us);
+
+            // Gate on the processed slots, before they are converted into the ring
+            vad_gate_process(params.tmp_buffer, samples_read, buffer_manager_stream_index());
+
+            // ✅ ZERO-COPY: Convert 24-bit slots directly into reserved ring space
+            // using the kernel for the configured output width (16/24/32-bit)
+            buffer_span_t span;
+            uint32_t ring_start = pipeline_stats_start();
+            size_t written = buffer_manager_reserve_write(samples_read, &span);
+            uint32_t ring_cycles = pipeline_stats_start() - ring_start;
+            if (written > 0)
+            {
+                uint32_t convert_start = pipeline_stats_start();
+                i2s_convert(params.tmp_buffer, span.data[0], span.samples[0]);
+                if (span.samples[1] > 0)
+                {
+                    i2s_convert(params.tmp_buffer + span.samples[0], span.data[1], span.samples[1]);
+                }
+                pipeline_stats_record(PIPELINE_STAGE_CONVERT, convert_start);
+
+                ring_start = pipeline_stats_start();
+                buffer_manager_commit_write_at(written, capture_us);
+                ring_cycles += pipeline_stats_start() - ring_start;
+                boot_profile_mark(BOOT_PHASE_CAPTURE);
+            }
+            pipeline_stats_record_cycles(PIPELINE_STAGE_RING_WRITE, ring_cycles);
 
             if (written < samples_read)
             {
@@ -82,11 +1184,16 @@ static void i2s_reader_task(void *arg)
                 last_overflow_time = xTaskGetTickCount();
 
 #if ENABLE_BUFFER_DRAIN
+                // The ring already sheds audio per policy; sustained overflow means the
+                // link cannot carry the bitrate, so ask the sender for a cheaper codec
                 if (buffer_overflow_count > MAX_BUFFER_OVERFLOWS)
                 {
-                    ESP_LOGW(TAG, "Too many overflows (%lu), forcing buffer drain",
-                             buffer_overflow_count);
-                    buffer_manager_reset(); // Emergency drain
+                    if (overflow_policy == OVERFLOW_POLICY_DEGRADE && !degrade_requested)
+                    {
+                        ESP_LOGW(TAG, "Sustained overflow (%lu), requesting codec degrade",
+                                 buffer_overflow_count);
+                        degrade_requested = true;
+                    }
                     buffer_overflow_count = 0;
                 }
 #endif
@@ -140,11 +1247,178 @@ static void i2s_reader_task(void *arg)
         }
     }
 
-    free(i2s_buffer);
-    free(tmp_buffer);
+    heap_caps_free(params.tmp_buffer);
     vTaskDelete(NULL);
 }
 
+// Encoder scratch owned by the network sender
+typedef struct
+{
+    int16_t *staging;   // One frame, for frames straddling the ring wrap
+    uint8_t *buffer;    // One datagram of encoded output
+    size_t buffer_size;
+} encoder_scratch_t;
+
+/**
+ * Size the sender for the active codec: encoder scratch, block and wake watermark
+ *
+ * Runs at task start and again after an overflow degrade changes the codec.
+ */
+static void sender_configure(encoder_scratch_t *scratch, size_t *send_samples_out, size_t *wake_samples_out)
+{
+    free(scratch->staging);
+    free(scratch->buffer);
+    scratch->staging = NULL;
+    scratch->buffer = NULL;
+    scratch->buffer_size = 0;
+
+    const latency_params_t *latency = latency_profile_get();
+    size_t send_samples = latency->send_samples;
+
+    // Encoder scratch: one frame for ring-wrap straddles, one datagram of output
+    if (audio_encoder_get_codec() != AUDIO_CODEC_PCM)
+    {
+        scratch->buffer_size = audio_encoder_max_frame_bytes();
+        if (scratch->buffer_size < UDP_PACKET_MAX_SIZE)
+        {
+            scratch->buffer_size = UDP_PACKET_MAX_SIZE;
+        }
+        scratch->staging = (int16_t *)malloc(audio_encoder_frame_samples() * sizeof(int16_t));
+        scratch->buffer = (uint8_t *)malloc(scratch->buffer_size);
+        if (scratch->staging == NULL || scratch->buffer == NULL)
+        {
+            ESP_LOGE(TAG, "Failed to allocate encoder buffers, streaming raw PCM");
+            free(scratch->staging);
+            free(scratch->buffer);
+            scratch->staging = NULL;
+            scratch->buffer = NULL;
+        }
+        else if (audio_encoder_frame_samples() > send_samples)
+        {
+            // A block must hold at least one whole frame or nothing is ever consumed
+            send_samples = audio_encoder_frame_samples();
+        }
+    }
+
+    ESP_LOGI(TAG, "Sending up to %zu samples per block from ring buffer", send_samples);
+
+    // ✅ EVENT-DRIVEN: sleep until the ring holds one packet's worth, then send at once
+    size_t wake_samples = latency->wake_samples;
+    if (wake_samples == 0)
+    {
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_UDP || STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+        wake_samples = udp_streamer_max_payload() / buffer_manager_get_sample_bytes();
+#else
+        wake_samples = send_samples / 4;
+#endif
+    }
+    if (scratch->staging != NULL && wake_samples < audio_encoder_frame_samples())
+    {
+        wake_samples = audio_encoder_frame_samples(); // Nothing to send before a whole frame
+    }
+    if (wake_samples > send_samples)
+    {
+        wake_samples = send_samples;
+    }
+    ESP_LOGI(TAG, "Sender wakes at %zu buffered samples", wake_samples);
+
+    *send_samples_out = send_samples;
+    *wake_samples_out = wake_samples;
+}
+
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+/**
+ * Hand a block to every sink: gated and encoded once, sent by each sink from its own cursor
+ *
+ * Never waits for the network, so a slow destination cannot hold up the
+ * others or back up the capture ring.
+ *
+ * @param span Peeked spans (already cut by the silence gate)
+ * @param samples Samples in span
+ * @param silent The block is a gated silent run
+ * @param encoded Encode with the active codec (PCM records otherwise)
+ * @param channels Interleaved channels
+ * @param scratch Encoder scratch
+ * @return Samples consumed (whole frames when encoding)
+ */
+static size_t fanout_block(const buffer_span_t *span, size_t samples, bool silent, bool encoded,
+                           size_t channels, const encoder_scratch_t *scratch)
+{
+    uint32_t block_start = pipeline_stats_start();
+    uint32_t encode_cycles = 0;
+    stream_record_t record;
+    memset(&record, 0, sizeof(record));
+    record.sample_index = span->sample_index;
+    record.capture_us = span->capture_us;
+    record.channels = (uint8_t)channels;
+
+    if (silent)
+    {
+        if (samples == 0)
+        {
+            return 0;
+        }
+        uint16_t level = vad_gate_noise_level();
+        uint8_t payload[2] = {(uint8_t)(level & 0xFF), (uint8_t)(level >> 8)};
+        record.bytes = sizeof(payload);
+        record.samples = samples;
+        record.codec = AUDIO_CODEC_SILENCE;
+        stream_sink_append(&record, payload);
+        vad_gate_add_suppressed(samples);
+    }
+    else if (encoded)
+    {
+        // Whole frames only; a partial frame waits in the ring for the next block
+        const size_t frame_samples = audio_encoder_frame_samples();
+        const size_t frames = samples / frame_samples;
+        record.samples = frame_samples;
+        record.codec = (uint8_t)audio_encoder_get_codec();
+        record.flags = audio_encoder_fixed_frame_size() ? 0 : STREAM_RECORD_FLAG_VARIABLE;
+
+        for (size_t f = 0; f < frames; f++)
+        {
+            const int16_t *in = span_frame(span, f * frame_samples, frame_samples, scratch->staging);
+            uint32_t encode_start = pipeline_stats_start();
+            record.bytes = audio_encoder_encode_frame(in, scratch->buffer, scratch->buffer_size);
+            encode_cycles += pipeline_stats_start() - encode_start;
+            if (record.bytes == 0)
+            {
+                continue;
+            }
+            buffer_manager_peek_capture(f * frame_samples, &record.sample_index, &record.capture_us);
+            stream_sink_append(&record, scratch->buffer);
+        }
+        samples = frames * frame_samples;
+        pipeline_stats_record_cycles(PIPELINE_STAGE_ENCODE, encode_cycles);
+    }
+    else
+    {
+        stream_sink_append_span(span, (uint8_t)channels);
+    }
+
+    // The sinks send in their own time: this stage is the hand-off
+    stream_sink_publish();
+    pipeline_stats_record_cycles(PIPELINE_STAGE_SEND, pipeline_stats_start() - block_start - encode_cycles);
+    return samples;
+}
+#endif
+
+/**
+ * Connect the configured streamer(s) that are not connected yet
+ * @return true if at least one is connected
+ */
+static bool connect_streams(void)
+{
+    bool connected = false;
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP || STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+    connected |= tcp_streamer_is_connected() || tcp_streamer_reconnect();
+#endif
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_UDP || STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+    connected |= udp_streamer_is_connected() || udp_streamer_reconnect();
+#endif
+    return connected;
+}
+
 /**
  * Network Sender Task with TCP/UDP Support and Exponential Backoff
  */
@@ -152,62 +1426,176 @@ static void network_sender_task(void *arg)
 {
     ESP_LOGI(TAG, "Network Sender task started (TCP/UDP)");
 
-    // ✅ CHANGED: Use int16_t buffer for native 16-bit samples (50% bandwidth savings)
-    const size_t send_samples = TCP_SEND_SAMPLES;
-    static int16_t send_buffer[TCP_SEND_SAMPLES]; // Static allocation in .bss section
-
-    ESP_LOGI(TAG, "Using 16-bit send buffer (%zu samples)", send_samples);
+    // ✅ ZERO-COPY: Samples are sent straight out of the ring buffer, no staging buffer
+    encoder_scratch_t scratch = {NULL, NULL, 0};
+    size_t send_samples = 0;
+    size_t wake_samples = 0;
+    sender_configure(&scratch, &send_samples, &wake_samples);
 
-    ESP_LOGI(TAG, "Waiting for initial buffer fill...");
-    vTaskDelay(pdMS_TO_TICKS(5000));
+    i2s_audio_format_t capture_format;
+    i2s_handler_get_format(&capture_format);
+    size_t channels = capture_format.channels > 0 ? capture_format.channels : 1;
+    bool last_block_silent = false;
 
     uint32_t reconnect_backoff_ms = RECONNECT_BACKOFF_MS;
     uint32_t reconnect_attempts = 0;
+    bool streams_up = STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH; // Fan-out sinks connect on their own
 
     while (1)
     {
-        size_t min_samples = send_samples / 4;
+        // Parked while sockets reopen or the format changes; nothing is borrowed here
+        if (live_reconfig_checkpoint(RECONFIG_TASK_SENDER))
+        {
+            sender_configure(&scratch, &send_samples, &wake_samples);
+            i2s_handler_get_format(&capture_format);
+            channels = capture_format.channels > 0 ? capture_format.channels : 1;
+            last_block_silent = false;
+            reconnect_backoff_ms = RECONNECT_BACKOFF_MS;
+            reconnect_attempts = 0;
+        }
+
+        // ✅ FAST BOOT: capture runs from boot; connect once WiFi is up while the ring holds the audio
+        if (!streams_up)
+        {
+            degrade_requested = false; // Overflow here is the network, not the codec
+            tcp_sender_last_feed = xTaskGetTickCount();
+            flash_spool_lend_ring(); // Nothing reads the ring until the stream is up
+
+            // Woken by IP_EVENT_STA_GOT_IP; the timeout keeps the checkpoint and watchdog feed going
+            if (!network_manager_wait_connected(STREAM_NETWORK_WAIT_MS))
+            {
+                continue;
+            }
+            if (!connect_streams())
+            {
+                // Server not up yet: back off without counting toward the reboot limit
+                for (uint32_t waited = 0; waited < reconnect_backoff_ms &&
+                                          !live_reconfig_pause_requested(RECONFIG_TASK_SENDER);
+                     waited += 100)
+                {
+                    tcp_sender_last_feed = xTaskGetTickCount();
+                    vTaskDelay(pdMS_TO_TICKS(100));
+                }
+                reconnect_backoff_ms *= 2;
+                if (reconnect_backoff_ms > MAX_RECONNECT_BACKOFF_MS)
+                {
+                    reconnect_backoff_ms = MAX_RECONNECT_BACKOFF_MS;
+                }
+                continue;
+            }
+
+            streams_up = true;
+            boot_profile_mark(BOOT_PHASE_STREAM);
+            audio_encoder_reset(); // Fresh codec state for the new connection
+            reconnect_backoff_ms = RECONNECT_BACKOFF_MS;
+            reconnect_attempts = 0;
+        }
+
+        // Overflow degrade: the quality controller owns the codec and switches it
+        // through a codec-only reconfiguration, between blocks at the checkpoint
+        if (degrade_requested)
+        {
+            i2s_audio_format_t format;
+            i2s_handler_get_format(&format);
+            if (!adaptive_quality_degrade_codec(&format))
+            {
+                ESP_LOGW(TAG, "No signalled cheaper codec (needs UDP or framed TCP), dropping oldest audio only");
+            }
+            degrade_requested = false; // A later overflow storm may step down again
+        }
+
+        // The ring is the sender's again (a spill in progress finishes its copy first)
+        flash_spool_reclaim_ring();
+
+        // Blocks on a task notification from the I2S reader; no polling
+        // While the gate is closed the pre-roll stays buffered, so wait beyond it
+        size_t wait_samples = last_block_silent ? wake_samples + gate_preroll() : wake_samples;
+        if (buffer_manager_wait_available(wait_samples, NETWORK_SENDER_MAX_WAIT_MS) < wait_samples)
+        {
+            ESP_LOGW(TAG, "Buffer wait timeout, continuing with available data");
+        }
+
+        // ✅ ZERO-COPY: Borrow ring spans and transmit them in place
+        // (everything buffered when gated: one silence frame may cover several blocks)
+        const bool encoded = scratch.staging != NULL && audio_encoder_get_codec() != AUDIO_CODEC_PCM;
+        buffer_span_t span;
+        uint32_t ring_start = pipeline_stats_start();
+        size_t samples_read = buffer_manager_peek_read(vad_gate_enabled() ? SIZE_MAX : send_samples, &span);
+        uint32_t ring_cycles = pipeline_stats_start() - ring_start;
+
+        if (samples_read > 0)
+        {
+            bool send_success = false;
+            bool silent = false;
+
+            if (vad_gate_enabled())
+            {
+                samples_read = gate_block(&span, samples_read, send_samples,
+                                          encoded ? audio_encoder_frame_samples() : channels, channels, &silent);
+            }
+            last_block_silent = silent;
+            size_t samples_sent = samples_read;
+
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+            // ✅ FAN-OUT: every sink sends from its own cursor, so the hand-off always succeeds
+            samples_sent = fanout_block(&span, samples_read, silent, encoded, channels, &scratch);
+            send_success = true;
+            (void)reconnect_attempts; // Each sink counts its own
+#else
+            uint32_t send_start = pipeline_stats_start();
 
-        // ✅ FIX: Add timeout and periodic yield to prevent watchdog timeout
-        uint32_t wait_start = xTaskGetTickCount();
-        const uint32_t max_wait_ticks = pdMS_TO_TICKS(2000); // 5 second timeout
+            if (silent)
+            {
+                samples_sent = stream_silence_block(&span, samples_read, channels, &send_success);
+                pipeline_stats_record(PIPELINE_STAGE_SEND, send_start);
+            }
+            else if (encoded)
+            {
+                // Whole frames only; a partial frame waits in the ring for the next block
+                samples_sent = stream_encoded_block(&span, scratch.staging, scratch.buffer,
+                                                    scratch.buffer_size, &send_success);
+            }
+            else
+            {
+// Send data based on configured streaming protocol
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP
+            send_success = tcp_streamer_send_span(&span);
+            if (!send_success && tcp_streamer_is_connected())
+            {
+                // Refused by a backed-up socket: not a connection failure
+                samples_sent = tcp_refused_block_consume(&span, samples_read);
+                send_success = true;
+            }
+#elif STREAMING_PROTOCOL == STREAMING_PROTOCOL_UDP
+            send_success = udp_streamer_send_span(&span);
+#endif
+            pipeline_stats_record(PIPELINE_STAGE_SEND, send_start);
+            }
 
-        while (buffer_manager_available() < min_samples)
-        {
-            // ✅ Check if we've been waiting too long
-            if ((xTaskGetTickCount() - wait_start) > max_wait_ticks)
+            // Age of the oldest sample in the block as it leaves the device
+            if (send_success && samples_sent > 0 && span.capture_us != 0 && !silent)
             {
-                ESP_LOGW(TAG, "Buffer wait timeout, continuing with available data");
-                break;
+                latency_profile_record(esp_timer_get_time() - span.capture_us);
             }
+#endif
 
-            // ✅ Increase delay to give IDLE task more time
-            vTaskDelay(pdMS_TO_TICKS(20)); // Changed from 5ms to 20ms
-        }
-
-        // ✅ CHANGED: Use buffer_manager_read_16() for native 16-bit samples
-        size_t samples_read = buffer_manager_read_16(send_buffer, send_samples);
-
-        if (samples_read > 0)
-        {
-            bool send_success = false;
+            // Release the block before any reconnect wait so resize/reset are not held up
+            ring_start = pipeline_stats_start();
+            buffer_manager_consume_read(samples_sent);
+            pipeline_stats_record_cycles(PIPELINE_STAGE_RING_READ, ring_cycles + pipeline_stats_start() - ring_start);
 
-// Send data based on configured streaming protocol
-#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP
-            send_success = tcp_streamer_send_audio_16(send_buffer, samples_read);
-#elif STREAMING_PROTOCOL == STREAMING_PROTOCOL_UDP
-            send_success = udp_streamer_send_audio_16(send_buffer, samples_read);
-#elif STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
-            // Send to both TCP and UDP
-            bool tcp_success = tcp_streamer_send_audio_16(send_buffer, samples_read);
-            bool udp_success = udp_streamer_send_audio_16(send_buffer, samples_read);
-            send_success = tcp_success || udp_success; // Consider success if either works
-#endif
+            if (!send_success && !network_manager_is_connected())
+            {
+                // WiFi is gone: wait for it above instead of spending reconnect attempts
+                streams_up = false;
+                continue;
+            }
 
             if (!send_success)
             {
-// Handle connection failures based on active protocol(s)
-#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP || STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+                flash_spool_lend_ring(); // Reconnect waits and connect timeouts outlast the ring
+// Handle connection failures based on active protocol (fan-out sinks handle their own)
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP
                 if (!tcp_streamer_is_connected())
                 {
                     consecutive_tcp_failures++;
@@ -217,11 +1605,15 @@ static void network_sender_task(void *arg)
                     ESP_LOGI(TAG, "Waiting %lums before TCP reconnect...", reconnect_backoff_ms);
                     // ✅ Feed watchdog during TCP reconnect delay (split into smaller chunks)
                     uint32_t delay_chunks = reconnect_backoff_ms / 100;
-                    for (int j = 0; j < delay_chunks; j++)
+                    for (int j = 0; j < delay_chunks && !live_reconfig_pause_requested(RECONFIG_TASK_SENDER); j++)
                     {
                         esp_task_wdt_reset();
                         vTaskDelay(pdMS_TO_TICKS(100));
                     }
+                    if (live_reconfig_pause_requested(RECONFIG_TASK_SENDER))
+                    {
+                        continue; // Park now; a stream reconfiguration reopens the socket
+                    }
                     if (reconnect_backoff_ms % 100 != 0)
                     {
                         esp_task_wdt_reset();
@@ -232,6 +1624,7 @@ static void network_sender_task(void *arg)
                     {
                         ESP_LOGI(TAG, "TCP reconnected successfully");
                         consecutive_tcp_failures = 0;
+                        audio_encoder_reset(); // New peer starts a fresh decoder
                     }
                     else
                     {
@@ -259,7 +1652,7 @@ static void network_sender_task(void *arg)
                 }
 #endif
 
-#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_UDP || STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_UDP
                 if (!udp_streamer_is_connected())
                 {
                     consecutive_udp_failures++;
@@ -269,11 +1662,15 @@ static void network_sender_task(void *arg)
                     ESP_LOGI(TAG, "Waiting %lums before UDP reconnect...", reconnect_backoff_ms);
                     // ✅ Feed watchdog during UDP reconnect delay (split into smaller chunks)
                     uint32_t delay_chunks = reconnect_backoff_ms / 100;
-                    for (int j = 0; j < delay_chunks; j++)
+                    for (int j = 0; j < delay_chunks && !live_reconfig_pause_requested(RECONFIG_TASK_SENDER); j++)
                     {
                         esp_task_wdt_reset();
                         vTaskDelay(pdMS_TO_TICKS(100));
                     }
+                    if (live_reconfig_pause_requested(RECONFIG_TASK_SENDER))
+                    {
+                        continue; // Park now; a stream reconfiguration reopens the socket
+                    }
                     if (reconnect_backoff_ms % 100 != 0)
                     {
                         esp_task_wdt_reset();
@@ -319,21 +1716,17 @@ static void network_sender_task(void *arg)
                 reconnect_backoff_ms = RECONNECT_BACKOFF_MS;
                 reconnect_attempts = 0;
                 tcp_sender_last_feed = xTaskGetTickCount();
+#if STREAMING_PROTOCOL != STREAMING_PROTOCOL_BOTH
+                boot_profile_mark(BOOT_PHASE_FIRST_AUDIO); // Fan-out: marked by the first sink send
+                replay_backfill();
+#endif
             }
         }
-        else
-        {
-            // ✅ ADD: If no data available, yield and try again
-            vTaskDelay(pdMS_TO_TICKS(10));
-        }
 
         if (buffer_manager_check_overflow())
         {
             ESP_LOGW(TAG, "Buffer overflow detected!");
         }
-
-        // ✅ ADD: Explicit yield instead of taskYIELD() macro
-        vTaskDelay(pdMS_TO_TICKS(1)); // Small delay to ensure IDLE task runs
     }
 
     // ✅ FIX: No need to free - using static allocation
@@ -362,28 +1755,22 @@ static void watchdog_task(void *arg)
             continue;
         }
 
+        // Boot: app_main runs the WiFi 3-strike check and the captive portal hand-over
+        if (!network_bring_up_done)
+        {
+            esp_task_wdt_reset();
+            vTaskDelay(pdMS_TO_TICKS(1000));
+            continue;
+        }
+
         bool wifi_connected = network_manager_is_connected();
 
         // Detect WiFi state change
         if (!wifi_connected && wifi_was_connected)
         {
-            ESP_LOGW(TAG, "WiFi lost, attempting reconnect...");
-            network_manager_reconnect();
-
-            // Force network reconnect after WiFi recovery
-            vTaskDelay(pdMS_TO_TICKS(2000)); // Wait for WiFi to stabilize
-            if (network_manager_is_connected())
-            {
-                ESP_LOGI(TAG, "WiFi recovered, reconnecting network streams...");
-
-#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP || STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
-                tcp_streamer_reconnect();
-#endif
-
-#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_UDP || STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
-                udp_streamer_reconnect();
-#endif
-            }
+            // The disconnect handler already rejoins (cached AP first) and the sender
+            // reconnects its streams on IP_EVENT_STA_GOT_IP; nothing to poll here
+            ESP_LOGW(TAG, "WiFi lost, driver reconnecting...");
         }
         else if (!wifi_connected)
         {
@@ -426,10 +1813,6 @@ static void watchdog_task(void *arg)
             tcp_streamer_get_stats(&tcp_bytes_sent, &tcp_reconnects);
 #endif
 
-#if STREAMING_PROTOCOL == STREAMING_PROTOCOL_UDP || STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
-            udp_streamer_get_stats(&udp_bytes_sent, &udp_packets_sent, &udp_lost);
-#endif
-
 // Log protocol-specific stats
 #if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP
             ESP_LOGI(TAG, "TCP B:%llu R:%u OF:%lu", tcp_bytes_sent, tcp_reconnects, buffer_overflow_count);
@@ -444,6 +1827,16 @@ static void watchdog_task(void *arg)
             udp_streamer_get_stats(&udp_bytes_sent, &udp_packets_sent, &udp_lost);
             ESP_LOGI(TAG, "TCP B:%llu R:%u | UDP B:%llu P:%u L:%u OF:%lu",
                      tcp_bytes_sent, tcp_reconnects, udp_bytes_sent, udp_packets_sent, udp_lost, buffer_overflow_count);
+            for (size_t i = 0; i < stream_sink_count(); i++)
+            {
+                stream_sink_stats_t sink;
+                if (stream_sink_get_stats(i, &sink))
+                {
+                    ESP_LOGI(TAG, "Sink %s: %s backlog %zu B, dropped %llu B, overruns %lu",
+                             sink.name, sink.connected ? "up" : "down", sink.backlog_bytes,
+                             sink.bytes_dropped, sink.overruns);
+                }
+            }
 #endif
 
             // Memory monitoring
@@ -541,6 +1934,10 @@ static void watchdog_task(void *arg)
             ntp_counter = 0;
         }
 
+        // Step the stream quality with the link and undo overflow codec steps
+        // (evaluates every ADAPTIVE_QUALITY_INTERVAL_MS)
+        adaptive_quality_update();
+
 #if ADAPTIVE_BUFFERING_ENABLED
         // Check adaptive buffering every ADAPTIVE_CHECK_INTERVAL_MS
         static uint32_t adaptive_counter = 0;
@@ -717,8 +2114,56 @@ static void start_captive_portal(bool with_timeout)
     }
 }
 
+#if PIPELINE_BENCH_ENABLED
+/**
+ * Benchmark the capture-to-send path before the audio tasks start (bench env)
+ *
+ * Runs on the configured protocol and ring format against the configured
+ * server; the stream then starts as usual.
+ */
+static void run_pipeline_benchmark(void)
+{
+    // The network wait and the paced run outlast the watchdog period
+    esp_task_wdt_delete(xTaskGetCurrentTaskHandle());
+
+    if (!network_manager_wait_connected(PIPELINE_BENCH_NETWORK_WAIT_MS))
+    {
+        ESP_LOGW(TAG, "Benchmark skipped: network not connected");
+    }
+    else
+    {
+        pipeline_bench_params_t params;
+        pipeline_bench_default_params(&params);
+        if (params.protocol == PIPELINE_BENCH_UDP)
+        {
+            udp_streamer_reconnect();
+        }
+        else
+        {
+            tcp_streamer_reconnect();
+        }
+
+        pipeline_bench_report_t report;
+        if (pipeline_bench_run(&params, &report))
+        {
+            pipeline_bench_log_report(&params, &report);
+        }
+        else
+        {
+            ESP_LOGW(TAG, "Benchmark could not run");
+        }
+    }
+
+    esp_task_wdt_add(xTaskGetCurrentTaskHandle());
+    esp_task_wdt_reset();
+}
+#endif
+
 extern "C" void app_main(void)
 {
+    // Capture log lines for the web UI (/ws) from the very first one
+    log_manager_init();
+
     ESP_LOGI(TAG, "=== Audio Streamer Starting ===");
     ESP_LOGI(TAG, "ESP-IDF Version: %s", esp_get_idf_version());
 
@@ -747,6 +2192,7 @@ extern "C" void app_main(void)
         esp_restart();
     }
     ESP_LOGI(TAG, "NVS flash initialized successfully");
+    boot_profile_mark(BOOT_PHASE_NVS);
 
     esp_task_wdt_reset();
     // Initialize configuration manager v2
@@ -779,7 +2225,7 @@ extern "C" void app_main(void)
     if (config_manager_v2_is_first_boot())
     {
         ESP_LOGI(TAG, "First boot detected - using default configuration");
-        if (!config_manager_v2_save())
+        if (!config_manager_v2_save() || !config_manager_v2_flush())
         {
             ESP_LOGE(TAG, "CRITICAL: Failed to save default configuration, rebooting...");
             // ✅ Feed watchdog during delay to prevent timeout
@@ -791,91 +2237,34 @@ extern "C" void app_main(void)
             esp_restart();
         }
     }
+    boot_profile_mark(BOOT_PHASE_CONFIG);
 
-    // ✅ NEW 3-STRIKE APPROACH: Start WiFi and monitor for 3 consecutive failures
-    esp_task_wdt_reset();
-    ESP_LOGI(TAG, "Initializing WiFi with 3-strike failure detection...");
-    if (!network_manager_init())
+    // Before WiFi: SNTP feeds the capture clock as soon as it syncs
+    if (!media_clock_init())
     {
-        ESP_LOGE(TAG, "WiFi initialization failed, starting captive portal immediately");
-        start_captive_portal(true);
+        ESP_LOGW(TAG, "Media clock exchange unavailable, capture times follow SNTP only");
     }
-    else
-    {
-        // ✅ Monitor WiFi connection attempts for 3-strike rule
-        esp_task_wdt_reset();
-        ESP_LOGI(TAG, "Monitoring WiFi connection attempts (3-strike rule)...");
-
-        // Give WiFi up to 15 seconds (3 attempts × 5 seconds each)
-        int wifi_monitor_count = 0;
-        const int max_monitor_cycles = 30; // 30 × 500ms = 15 seconds
-
-        while (wifi_monitor_count < max_monitor_cycles)
-        {
-            vTaskDelay(pdMS_TO_TICKS(500));
-            wifi_monitor_count++;
-
-            // Check if WiFi connected successfully
-            if (network_manager_is_connected())
-            {
-                ESP_LOGI(TAG, "WiFi connected successfully!");
-
-                // Check if this is first boot or needs configuration
-                if (config_manager_v2_is_first_boot() || !captive_portal_is_configured())
-                {
-                    ESP_LOGI(TAG, "Configuration needed, starting captive portal");
-                    start_captive_portal(true);
-                }
-                else
-                {
-                    ESP_LOGI(TAG, "Device fully configured, continuing normally");
-                }
-                break;
-            }
-
-            // Check if 3-strike threshold reached
-            if (network_manager_should_start_captive_portal())
-            {
-                ESP_LOGW(TAG, "3 WiFi connection failures detected, starting captive portal");
-                start_captive_portal(true);
-                break;
-            }
-
-            // Log progress every 2 seconds
-            if (wifi_monitor_count % 4 == 0)
-            {
-                uint32_t failures = network_manager_get_failure_count();
-                ESP_LOGI(TAG, "WiFi monitoring... failures: %lu/3", failures);
-            }
-        }
 
-        // If we exited monitoring without connection or captive portal, continue anyway
-        if (!network_manager_is_connected() && !network_manager_should_start_captive_portal())
-        {
-            ESP_LOGW(TAG, "WiFi monitoring timeout, continuing without connection");
-        }
+    // ✅ FAST BOOT: WiFi connects in the background while capture starts
+    esp_task_wdt_reset();
+    ESP_LOGI(TAG, "Initializing WiFi with 3-strike failure detection...");
+    bool wifi_started = network_manager_init();
+    if (!wifi_started)
+    {
+        ESP_LOGE(TAG, "WiFi initialization failed, captive portal will start after capture");
     }
 
-    ESP_LOGI("MAIN", "Free heap: %lu bytes", esp_get_free_heap_size());
-    ESP_LOGI("MAIN", "Largest free block: %lu bytes",
-             heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
-
-    ESP_LOGI(TAG, "Initializing mDNS...");
-    network_manager_init_mdns(); // Non-critical, continue if fails
-
-    ESP_LOGI(TAG, "Initializing NTP...");
-    network_manager_init_ntp();
+    // Select conversion kernels (SIMD self-test) before any audio is converted
+    audio_convert_init();
+#if AUDIO_CONVERT_BENCHMARK_ENABLED
+    audio_convert_run_benchmark();
+#endif
 
-    // Initialize web server
-    ESP_LOGI(TAG, "Initializing web server v2...");
-    if (!web_server_v2_init())
-    {
-        ESP_LOGW(TAG, "Web server v2 init failed, continuing without web UI");
-    }
-    else
-    {
-        ESP_LOGI(TAG, "Web UI v2 available at http://audiostreamer.local or device IP");
-    }
+    // Capture format must be known before the ring is sized
+    apply_audio_format();
+    apply_dsp_config();
+    apply_latency_profile();
+    apply_overflow_policy();
 
     ESP_LOGI(TAG, "Initializing ring buffer...");
     size_t buffer_size = RING_BUFFER_SIZE;
@@ -934,39 +2323,157 @@ extern "C" void app_main(void)
     }
 
     esp_task_wdt_reset();
-    ESP_LOGI(TAG, "Connecting to streaming servers...");
+    ESP_LOGI(TAG, "Preparing streamers (the sender connects once WiFi is up)...");
 
 // Initialize TCP streamer if configured
 #if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP || STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+    apply_tcp_config();
     if (!tcp_streamer_init())
     {
-        ESP_LOGW(TAG, "Initial TCP connection failed, will retry in background");
+        ESP_LOGE(TAG, "TCP streamer buffer allocation failed");
     }
 #endif
 
 // Initialize UDP streamer if configured
 #if STREAMING_PROTOCOL == STREAMING_PROTOCOL_UDP || STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
+    apply_udp_config();
     if (!udp_streamer_init())
     {
-        ESP_LOGW(TAG, "Initial UDP initialization failed, will retry in background");
+        ESP_LOGE(TAG, "UDP streamer buffer allocation failed");
     }
 #endif
 
+#if STREAMING_PROTOCOL != STREAMING_PROTOCOL_BOTH
+    // Outage audio goes to flash and is replayed as backfill once the stream is back
+    flash_spool_init();
+#endif
+
 // Log the active streaming protocol
 #if STREAMING_PROTOCOL == STREAMING_PROTOCOL_TCP
     ESP_LOGI(TAG, "TCP streaming enabled");
 #elif STREAMING_PROTOCOL == STREAMING_PROTOCOL_UDP
     ESP_LOGI(TAG, "UDP streaming enabled");
 #elif STREAMING_PROTOCOL == STREAMING_PROTOCOL_BOTH
-    ESP_LOGI(TAG, "TCP and UDP streaming enabled");
+    // ✅ FAN-OUT: each destination gets its own task, ring cursor and reconnect backoff
+    if (!stream_sink_init(STREAM_SINK_BUFFER_SIZE) ||
+        stream_sink_register(&udp_sink_ops, STREAM_SINK_REALTIME_PRIORITY) < 0 ||
+        stream_sink_register(&tcp_sink_ops, STREAM_SINK_ARCHIVE_PRIORITY) < 0)
+    {
+        ESP_LOGE(TAG, "Fan-out sinks failed to start, audio will not be streamed");
+    }
+    ESP_LOGI(TAG, "TCP and UDP streaming enabled (independent sinks)");
+#endif
+
+    apply_vad_config();
+
+#if PIPELINE_BENCH_ENABLED
+    if (wifi_started)
+    {
+        run_pipeline_benchmark();
+    }
 #endif
 
     // Initialize watchdog feed timestamps
     i2s_reader_last_feed = xTaskGetTickCount();
     tcp_sender_last_feed = xTaskGetTickCount();
 
+    // Audio and stream settings now apply without a reboot
+    if (!live_reconfig_init(apply_live_config))
+    {
+        ESP_LOGW(TAG, "Live reconfiguration unavailable, changes need a restart");
+    }
+
+    // ✅ FAST BOOT: capture fills the ring from here on, whatever the network is doing
     create_tasks();
 
+    // ✅ NEW 3-STRIKE APPROACH: monitor WiFi for 3 consecutive failures (capture is already running)
+    if (!wifi_started)
+    {
+        ESP_LOGE(TAG, "WiFi initialization failed, starting captive portal immediately");
+        start_captive_portal(true);
+    }
+    else
+    {
+        // ✅ Monitor WiFi connection attempts for 3-strike rule
+        esp_task_wdt_reset();
+        ESP_LOGI(TAG, "Monitoring WiFi connection attempts (3-strike rule)...");
+
+        // Give WiFi up to 15 seconds (3 attempts × 5 seconds each)
+        int wifi_monitor_count = 0;
+        const int max_monitor_cycles = 30; // 30 × 500ms = 15 seconds
+
+        while (wifi_monitor_count < max_monitor_cycles)
+        {
+            vTaskDelay(pdMS_TO_TICKS(500));
+            wifi_monitor_count++;
+
+            // Check if WiFi connected successfully
+            if (network_manager_is_connected())
+            {
+                ESP_LOGI(TAG, "WiFi connected successfully!");
+
+                // Check if this is first boot or needs configuration
+                if (config_manager_v2_is_first_boot() || !captive_portal_is_configured())
+                {
+                    ESP_LOGI(TAG, "Configuration needed, starting captive portal");
+                    start_captive_portal(true);
+                }
+                else
+                {
+                    ESP_LOGI(TAG, "Device fully configured, continuing normally");
+                }
+                break;
+            }
+
+            // Check if 3-strike threshold reached
+            if (network_manager_should_start_captive_portal())
+            {
+                ESP_LOGW(TAG, "3 WiFi connection failures detected, starting captive portal");
+                start_captive_portal(true);
+                break;
+            }
+
+            // Log progress every 2 seconds
+            if (wifi_monitor_count % 4 == 0)
+            {
+                uint32_t failures = network_manager_get_failure_count();
+                ESP_LOGI(TAG, "WiFi monitoring... failures: %lu/3", failures);
+            }
+        }
+
+        // If we exited monitoring without connection or captive portal, continue anyway
+        if (!network_manager_is_connected() && !network_manager_should_start_captive_portal())
+        {
+            ESP_LOGW(TAG, "WiFi monitoring timeout, continuing without connection");
+        }
+    }
+
+    network_bring_up_done = true; // Watchdog may now take over WiFi recovery
+
+    ESP_LOGI("MAIN", "Free heap: %lu bytes", esp_get_free_heap_size());
+    ESP_LOGI("MAIN", "Largest free block: %lu bytes",
+             heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+
+    ESP_LOGI(TAG, "Initializing mDNS...");
+    network_manager_init_mdns(); // Non-critical, continue if fails
+
+    // Initialize web server
+    ESP_LOGI(TAG, "Initializing web server v2...");
+    if (!web_server_v2_init())
+    {
+        ESP_LOGW(TAG, "Web server v2 init failed, continuing without web UI");
+    }
+    else
+    {
+        ESP_LOGI(TAG, "Web UI v2 available at http://audiostreamer.local or device IP");
+        boot_profile_mark(BOOT_PHASE_WEB);
+    }
+
+    // Last: blocks until the first sync or its timeout, while audio is already streaming
+    ESP_LOGI(TAG, "Initializing NTP...");
+    network_manager_init_ntp();
+    boot_profile_mark(BOOT_PHASE_NTP);
+
     ESP_LOGI(TAG, "=== Audio Streamer Running ===");
 
     // ✅ Keep app_main alive with watchdog resets
@@ -0,0 +1,425 @@
+#include "adaptive_quality.h"
+#include "audio_encoder.h"
+#include "live_reconfig.h"
+#include "performance_monitor.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
+#include <atomic>
+
+static const char *TAG = "ADAPTIVE_QUALITY";
+
+#define CODEC_STEPS_MAX 2 // PCM -> IMA-ADPCM -> Opus
+
+// Limits applied on top of the configured settings (0 = keep the configured value)
+typedef struct
+{
+    uint32_t max_sample_rate;
+    uint8_t max_bits;
+    bool compress;     // PCM becomes IMA-ADPCM
+    uint8_t fec_group; // Parity at least every this many packets
+    int8_t rssi_below; // Entered below this RSSI
+} quality_tier_t;
+
+static const quality_tier_t tiers[ADAPTIVE_QUALITY_TIER_COUNT] = {
+    {0, 0, false, 0, 0},
+    {0, 16, true, 8, ADAPTIVE_QUALITY_RSSI_TIER1},
+    {AUDIO_SAMPLE_RATE_16K, 16, true, 4, ADAPTIVE_QUALITY_RSSI_TIER2},
+    {AUDIO_SAMPLE_RATE_8K, 16, true, 2, ADAPTIVE_QUALITY_RSSI_TIER3},
+};
+
+// Configured settings (set by the apply path, read by the controller)
+static portMUX_TYPE state_lock = portMUX_INITIALIZER_UNLOCKED;
+static i2s_audio_format_t base_format = {AUDIO_SAMPLE_RATE_DEFAULT, BITS_PER_SAMPLE, AUDIO_CHANNELS_MONO};
+static audio_codec_t base_codec = AUDIO_CODEC_DEFAULT;
+static bool base_fec_enabled = UDP_FEC_ENABLED;
+static uint8_t base_fec_group = UDP_FEC_GROUP_SIZE;
+static adaptive_quality_status_t status;
+
+static std::atomic<bool> signalled(true); // Stream headers carry the format and codec
+static std::atomic<uint8_t> active_tier(0);
+static std::atomic<uint8_t> codec_steps(0); // Overflow degrade steps on top of the tier
+
+static int64_t last_switch_us = 0;     // Under state_lock
+static int64_t last_codec_step_us = 0; // Under state_lock
+
+// Controller state (only touched by adaptive_quality_update)
+static int64_t last_eval_us = 0;
+static int32_t rssi_avg = 0; // Smoothed RSSI, dBm
+static int32_t rssi_x16 = 0; // Same x16 (whole-dBm steps would stall short of the input)
+static uint32_t bad_windows = 0;
+static uint32_t good_windows = 0;
+static uint32_t last_udp_sent = 0;
+static uint32_t last_udp_lost = 0;
+static uint32_t last_tcp_reconnects = 0;
+static int64_t codec_clean_since_us = 0; // Start of the current run of clean windows (0 = none)
+
+static inline bool tiers_enabled(void)
+{
+    return ADAPTIVE_QUALITY_ENABLED && signalled.load();
+}
+
+// Caller holds state_lock
+static void tier_format(uint8_t tier, uint8_t steps, i2s_audio_format_t *format, audio_codec_t *codec)
+{
+    const quality_tier_t *t = &tiers[tier];
+    *format = base_format;
+    *codec = base_codec;
+
+    if (t->max_sample_rate != 0 && format->sample_rate > t->max_sample_rate)
+    {
+        format->sample_rate = t->max_sample_rate;
+    }
+    if (t->max_bits != 0 && format->bits_per_sample > t->max_bits)
+    {
+        format->bits_per_sample = t->max_bits;
+    }
+    if (t->compress && *codec == AUDIO_CODEC_PCM)
+    {
+        *codec = AUDIO_CODEC_IMA_ADPCM;
+    }
+
+    // Overflow degrade steps, as far as the format allows (never back to PCM)
+    for (uint8_t i = 0; i < steps; i++)
+    {
+        audio_codec_t next = audio_encoder_cheaper_codec(*codec);
+        if (next == *codec || !audio_encoder_codec_supports(next, format))
+        {
+            break;
+        }
+        *codec = next;
+    }
+}
+
+// Caller holds state_lock
+static void tier_fec(uint8_t tier, bool *fec_enabled, uint8_t *group_size)
+{
+    *fec_enabled = base_fec_enabled;
+    *group_size = base_fec_group;
+
+    uint8_t group = tiers[tier].fec_group;
+    if (group != 0 && (!*fec_enabled || *group_size > group))
+    {
+        *fec_enabled = true;
+        *group_size = group;
+    }
+}
+
+// Lowest-quality tier the RSSI calls for; leaving a tier upwards needs the hysteresis margin
+static uint8_t rssi_tier(int32_t rssi, uint8_t current)
+{
+    for (int i = ADAPTIVE_QUALITY_TIER_COUNT - 1; i > 0; i--)
+    {
+        int32_t threshold = tiers[i].rssi_below;
+        if (i <= current)
+        {
+            threshold += ADAPTIVE_QUALITY_RSSI_HYSTERESIS_DB;
+        }
+        if (rssi < threshold)
+        {
+            return (uint8_t)i;
+        }
+    }
+    return 0;
+}
+
+static void switch_tier(uint8_t from, uint8_t to, uint8_t loss, uint8_t buffer)
+{
+    i2s_audio_format_t old_format, new_format;
+    audio_codec_t old_codec, new_codec;
+    uint8_t steps = codec_steps.load();
+    portENTER_CRITICAL(&state_lock);
+    tier_format(from, steps, &old_format, &old_codec);
+    tier_format(to, steps, &new_format, &new_codec);
+    portEXIT_CRITICAL(&state_lock);
+
+    // Same clock: only the sender parks (codec, FEC and the header tier)
+    uint32_t parts = RECONFIG_PART_CODEC;
+    if (old_format.sample_rate != new_format.sample_rate ||
+        old_format.bits_per_sample != new_format.bits_per_sample)
+    {
+        parts |= RECONFIG_PART_AUDIO;
+    }
+
+    active_tier.store(to);
+    if (!live_reconfig_request(parts))
+    {
+        active_tier.store(from);
+        ESP_LOGW(TAG, "Live reconfiguration unavailable, staying at tier %d", from);
+        return;
+    }
+
+    portENTER_CRITICAL(&state_lock);
+    last_switch_us = esp_timer_get_time();
+    status.switches++;
+    portEXIT_CRITICAL(&state_lock);
+
+    ESP_LOGW(TAG, "Quality tier %d -> %d (RSSI %ld dBm, loss %u%%, ring %u%%): %lu Hz %d-bit %s",
+             from, to, (long)rssi_avg, loss, buffer, new_format.sample_rate, new_format.bits_per_sample,
+             audio_encoder_codec_name(new_codec));
+}
+
+// Undo one overflow codec step (from the controller)
+static void restore_codec_step(uint8_t steps, uint8_t buffer)
+{
+    codec_steps.store(steps - 1);
+    if (!live_reconfig_request(RECONFIG_PART_CODEC))
+    {
+        codec_steps.store(steps);
+        return;
+    }
+
+    portENTER_CRITICAL(&state_lock);
+    last_codec_step_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&state_lock);
+    ESP_LOGI(TAG, "Overflow cleared (ring %u%%), codec step %d -> %d", buffer, steps, steps - 1);
+}
+
+void adaptive_quality_set_signalled(bool signal)
+{
+    if (!signal && signalled.load())
+    {
+        bool stepped = active_tier.exchange(0) != 0;
+        stepped = codec_steps.exchange(0) != 0 || stepped;
+        if (stepped)
+        {
+            ESP_LOGI(TAG, "Format changes not signalled, back to configured quality");
+        }
+    }
+    signalled.store(signal);
+}
+
+void adaptive_quality_update(void)
+{
+    const bool tiers_on = tiers_enabled();
+    if (!tiers_on && codec_steps.load() == 0)
+    {
+        return;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    if (now_us - last_eval_us < (int64_t)ADAPTIVE_QUALITY_INTERVAL_MS * 1000)
+    {
+        return;
+    }
+    last_eval_us = now_us;
+
+    performance_metrics_t metrics = performance_monitor_collect_metrics();
+
+    // Window deltas (send failures count against the attempts)
+    uint32_t sent = metrics.udp_packets_sent - last_udp_sent;
+    uint32_t lost = metrics.udp_lost_packets - last_udp_lost;
+    bool reconnected = metrics.tcp_reconnects != last_tcp_reconnects;
+    last_udp_sent = metrics.udp_packets_sent;
+    last_udp_lost = metrics.udp_lost_packets;
+    last_tcp_reconnects = metrics.tcp_reconnects;
+    uint8_t loss = (sent + lost) > 0 ? (uint8_t)((lost * 100) / (sent + lost)) : 0;
+    uint8_t buffer = metrics.buffer_usage_percent;
+
+    if (metrics.wifi_rssi == 0 || !(metrics.tcp_connected || metrics.udp_connected))
+    {
+        // Link down: the ring covers the outage, judge it once audio flows again
+        rssi_avg = 0;
+        rssi_x16 = 0;
+        bad_windows = 0;
+        good_windows = 0;
+        codec_clean_since_us = 0;
+        return;
+    }
+    rssi_x16 = (rssi_x16 == 0) ? metrics.wifi_rssi * 16 : rssi_x16 + (metrics.wifi_rssi * 16 - rssi_x16) / 4;
+    rssi_avg = (rssi_x16 - 8) / 16; // Round to nearest dBm (negative)
+
+    uint8_t tier = active_tier.load();
+    uint8_t floor_tier = rssi_tier(rssi_avg, tier);
+    bool congested = buffer >= ADAPTIVE_QUALITY_BUFFER_HIGH_PERCENT || loss >= ADAPTIVE_QUALITY_LOSS_HIGH_PERCENT ||
+                     reconnected || metrics.buffer_overflow_detected;
+    bool clean = buffer < ADAPTIVE_QUALITY_BUFFER_CLEAN_PERCENT && loss < ADAPTIVE_QUALITY_LOSS_CLEAN_PERCENT &&
+                 !reconnected;
+    portENTER_CRITICAL(&state_lock);
+    int64_t switched_us = last_switch_us;
+    int64_t codec_step_us = last_codec_step_us;
+    portEXIT_CRITICAL(&state_lock);
+    bool dwelled = switched_us == 0 || now_us - switched_us >= (int64_t)ADAPTIVE_QUALITY_MIN_DWELL_MS * 1000;
+
+    // Codec steps come back only after the ring has stayed drained for a while
+    bool drained = buffer < OVERFLOW_DEGRADE_RECOVER_PERCENT && !metrics.buffer_overflow_detected;
+    if (!drained)
+    {
+        codec_clean_since_us = 0;
+    }
+    else if (codec_clean_since_us == 0)
+    {
+        codec_clean_since_us = now_us;
+    }
+
+    uint8_t target = tier;
+    if (!tiers_on)
+    {
+        bad_windows = 0;
+        good_windows = 0;
+    }
+    else if (floor_tier > tier || (congested && tier < ADAPTIVE_QUALITY_TIER_COUNT - 1))
+    {
+        good_windows = 0;
+        if (++bad_windows >= ADAPTIVE_QUALITY_DOWN_WINDOWS)
+        {
+            // Weak signal steps straight down; congestion alone one tier at a time,
+            // after the last switch had time to drain the ring
+            if (floor_tier > tier)
+            {
+                target = floor_tier;
+            }
+            if (congested && dwelled && target == tier)
+            {
+                target = tier + 1;
+            }
+            bad_windows = 0;
+        }
+    }
+    else if (floor_tier < tier && clean)
+    {
+        bad_windows = 0;
+        if (++good_windows >= ADAPTIVE_QUALITY_UP_WINDOWS && dwelled)
+        {
+            target = tier - 1;
+            good_windows = 0;
+        }
+    }
+    else
+    {
+        bad_windows = 0;
+        good_windows = 0;
+    }
+
+    const int64_t recover_us = (int64_t)OVERFLOW_DEGRADE_RECOVER_MS * 1000;
+    uint8_t steps = codec_steps.load();
+    if (target != tier)
+    {
+        switch_tier(tier, target, loss, buffer);
+    }
+    else if (steps > 0 && codec_clean_since_us != 0 && now_us - codec_clean_since_us >= recover_us &&
+             now_us - codec_step_us >= recover_us)
+    {
+        restore_codec_step(steps, buffer);
+        codec_clean_since_us = now_us; // The next step back needs its own clean run
+    }
+
+    portENTER_CRITICAL(&state_lock);
+    status.rssi = (int8_t)rssi_avg;
+    status.loss_percent = loss;
+    status.buffer_percent = buffer;
+    status.bitrate_bps = metrics.audio_data_rate_bps;
+    portEXIT_CRITICAL(&state_lock);
+}
+
+uint8_t adaptive_quality_get_tier(void)
+{
+    return active_tier.load();
+}
+
+void adaptive_quality_set_base(const i2s_audio_format_t *format, audio_codec_t codec)
+{
+    if (format == NULL)
+    {
+        return;
+    }
+
+    portENTER_CRITICAL(&state_lock);
+    base_format = *format;
+    base_codec = codec;
+    portEXIT_CRITICAL(&state_lock);
+}
+
+void adaptive_quality_set_base_fec(bool fec_enabled, uint8_t group_size)
+{
+    portENTER_CRITICAL(&state_lock);
+    base_fec_enabled = fec_enabled;
+    base_fec_group = group_size;
+    portEXIT_CRITICAL(&state_lock);
+}
+
+void adaptive_quality_get_format(i2s_audio_format_t *format, audio_codec_t *codec)
+{
+    if (format == NULL || codec == NULL)
+    {
+        return;
+    }
+
+    uint8_t tier = active_tier.load();
+    uint8_t steps = codec_steps.load();
+    portENTER_CRITICAL(&state_lock);
+    tier_format(tier, steps, format, codec);
+    portEXIT_CRITICAL(&state_lock);
+}
+
+bool adaptive_quality_degrade_codec(const i2s_audio_format_t *format)
+{
+    if (format == NULL || !signalled.load())
+    {
+        return false; // The server could not tell the codec changed
+    }
+
+    uint8_t tier = active_tier.load();
+    uint8_t steps = codec_steps.load();
+    if (steps >= CODEC_STEPS_MAX)
+    {
+        return false;
+    }
+
+    i2s_audio_format_t current_format, next_format;
+    audio_codec_t current, next;
+    portENTER_CRITICAL(&state_lock);
+    tier_format(tier, steps, &current_format, &current);
+    tier_format(tier, steps + 1, &next_format, &next);
+    portEXIT_CRITICAL(&state_lock);
+    if (next == current || !audio_encoder_codec_supports(next, format))
+    {
+        return false;
+    }
+
+    codec_steps.store(steps + 1);
+    if (!live_reconfig_request(RECONFIG_PART_CODEC))
+    {
+        codec_steps.store(steps);
+        ESP_LOGW(TAG, "Live reconfiguration unavailable, codec stays %s", audio_encoder_codec_name(current));
+        return false;
+    }
+
+    portENTER_CRITICAL(&state_lock);
+    last_codec_step_us = esp_timer_get_time();
+    status.codec_degrades++;
+    portEXIT_CRITICAL(&state_lock);
+    ESP_LOGW(TAG, "Sustained overflow, codec %s -> %s", audio_encoder_codec_name(current),
+             audio_encoder_codec_name(next));
+    return true;
+}
+
+void adaptive_quality_get_fec(bool *fec_enabled, uint8_t *group_size)
+{
+    if (fec_enabled == NULL || group_size == NULL)
+    {
+        return;
+    }
+
+    portENTER_CRITICAL(&state_lock);
+    tier_fec(active_tier.load(), fec_enabled, group_size);
+    portEXIT_CRITICAL(&state_lock);
+}
+
+void adaptive_quality_get_status(adaptive_quality_status_t *out)
+{
+    if (out == NULL)
+    {
+        return;
+    }
+
+    portENTER_CRITICAL(&state_lock);
+    *out = status;
+    int64_t switched_us = last_switch_us;
+    portEXIT_CRITICAL(&state_lock);
+    out->enabled = tiers_enabled();
+    out->tier = active_tier.load();
+    out->codec_steps = codec_steps.load();
+    out->since_switch_ms = switched_us != 0 ? (uint32_t)((esp_timer_get_time() - switched_us) / 1000) : 0;
+}
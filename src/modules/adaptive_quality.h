@@ -0,0 +1,122 @@
+#ifndef ADAPTIVE_QUALITY_H
+#define ADAPTIVE_QUALITY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config.h"
+#include "i2s_handler.h"
+
+/**
+ * Link-quality-adaptive stream tiers
+ *
+ * A closed loop on the performance monitor signals (RSSI, UDP send loss,
+ * ring usage and overflow, TCP reconnects) steps the stream between tiers:
+ *   0: the configured format, codec and FEC
+ *   1: 16-bit, IMA-ADPCM (unless a cheaper codec is configured), FEC 1/8
+ *   2: as 1, at most 16 kHz, FEC 1/4
+ *   3: as 1, at most 8 kHz, FEC 1/2
+ * A tier never raises a setting above the configured one. Stepping down
+ * takes ADAPTIVE_QUALITY_DOWN_WINDOWS bad evaluations in a row, stepping up
+ * (one tier at a time) ADAPTIVE_QUALITY_UP_WINDOWS clean ones and RSSI
+ * ADAPTIVE_QUALITY_RSSI_HYSTERESIS_DB above the threshold, so a marginal
+ * link does not flap.
+ *
+ * Switches go through live_reconfig: a sample rate or bit depth change
+ * restarts capture, a codec/FEC change only parks the sender. The active
+ * tier is carried in every UDP header (flags bits 9-10) and TCP frame
+ * header (quality_tier); unframed TCP cannot signal a format change, so
+ * the controller stays at tier 0 there.
+ *
+ * The controller is also the one owner of the codec choice under the
+ * overflow degrade policy: adaptive_quality_degrade_codec() adds a codec
+ * step on top of the tier (PCM -> IMA-ADPCM -> Opus), and a step is undone
+ * one at a time once the ring has stayed below
+ * OVERFLOW_DEGRADE_RECOVER_PERCENT, without overflow, for
+ * OVERFLOW_DEGRADE_RECOVER_MS. Steps are refused while the stream cannot
+ * signal the codec in-band.
+ */
+
+#define ADAPTIVE_QUALITY_TIER_COUNT 4
+
+/**
+ * Controller status
+ */
+typedef struct
+{
+    bool enabled;
+    uint8_t tier;            // Active tier (0 = configured quality)
+    int8_t rssi;             // Smoothed RSSI, dBm (0 while not associated)
+    uint8_t loss_percent;    // UDP send loss over the last window
+    uint8_t buffer_percent;  // Ring usage at the last evaluation
+    uint32_t bitrate_bps;    // Encoder payload bitrate
+    uint32_t switches;       // Tier changes since boot
+    uint32_t since_switch_ms;
+    uint8_t codec_steps;     // Overflow degrade steps on top of the tier
+    uint32_t codec_degrades; // Overflow degrade steps taken since boot
+} adaptive_quality_status_t;
+
+/**
+ * Tell the controller whether the stream signals format changes in-band
+ *
+ * Tiers adapt only with ADAPTIVE_QUALITY_ENABLED and a signalled stream.
+ * Clearing it returns to tier 0 and drops the codec steps; like the base
+ * settings, it takes effect with the next apply of the format and FEC.
+ *
+ * @param signalled false for unframed TCP
+ */
+void adaptive_quality_set_signalled(bool signalled);
+
+/**
+ * Evaluate the link and switch tiers or undo codec steps if needed
+ *
+ * Call about once a second; evaluates every ADAPTIVE_QUALITY_INTERVAL_MS.
+ */
+void adaptive_quality_update(void);
+
+/**
+ * Step the codec down one rung under sustained overflow (degrade policy)
+ *
+ * Queues a codec-only live reconfiguration; the sender picks the new codec
+ * up from adaptive_quality_get_format() when it parks.
+ *
+ * @param format Running capture format
+ * @return false if the stream cannot signal the codec or no cheaper codec fits the format
+ */
+bool adaptive_quality_degrade_codec(const i2s_audio_format_t *format);
+
+/**
+ * Get the active tier
+ */
+uint8_t adaptive_quality_get_tier(void);
+
+/**
+ * Record the configured capture format and codec (tier 0)
+ */
+void adaptive_quality_set_base(const i2s_audio_format_t *format, audio_codec_t codec);
+
+/**
+ * Record the configured UDP FEC settings (tier 0)
+ */
+void adaptive_quality_set_base_fec(bool enabled, uint8_t group_size);
+
+/**
+ * Get the configured format and codec limited by the active tier and codec steps
+ * @param format Output
+ * @param codec Output
+ */
+void adaptive_quality_get_format(i2s_audio_format_t *format, audio_codec_t *codec);
+
+/**
+ * Get the configured FEC settings raised to the active tier's protection
+ * @param enabled Output
+ * @param group_size Output
+ */
+void adaptive_quality_get_fec(bool *enabled, uint8_t *group_size);
+
+/**
+ * Get controller status
+ * @param status Output
+ */
+void adaptive_quality_get_status(adaptive_quality_status_t *status);
+
+#endif // ADAPTIVE_QUALITY_H
@@ -0,0 +1,401 @@
+#include "audio_convert.h"
+#include "../config.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "sdkconfig.h"
+#include <string.h>
+
+static const char *TAG = "AUDIO_CONVERT";
+
+#if AUDIO_CONVERT_SIMD_ENABLED && CONFIG_IDF_TARGET_ESP32S3
+#define AUDIO_CONVERT_HAVE_PIE 1
+#else
+#define AUDIO_CONVERT_HAVE_PIE 0
+#endif
+
+#define SIMD_ALIGN 16          // PIE 128-bit loads/stores ignore the low 4 address bits
+#define SIMD_BLOCK_SAMPLES 8   // Two q registers of int32 in, one q register of int16 out
+#define BENCH_ROUNDS 16        // Best-of-N filters out interrupts and cache misses
+
+static audio_convert_params_t params = {
+    .dc_offset = 0,
+    .gain_q8 = AUDIO_CONVERT_GAIN_UNITY};
+static bool simd_active = false;
+
+// Subtract DC, apply gain, saturate to the 32-bit slot range
+static inline int32_t scale_slot(int32_t x, int32_t dc, int32_t gain_q8)
+{
+    int64_t v = (((int64_t)x - dc) * gain_q8) >> 8;
+    if (v > INT32_MAX)
+    {
+        return INT32_MAX;
+    }
+    if (v < INT32_MIN)
+    {
+        return INT32_MIN;
+    }
+    return (int32_t)v;
+}
+
+// Subtract DC only, saturating (matches ee.vsubs.s32)
+static inline int32_t sub_dc(int32_t x, int32_t dc)
+{
+    int64_t v = (int64_t)x - dc;
+    if (v > INT32_MAX)
+    {
+        return INT32_MAX;
+    }
+    if (v < INT32_MIN)
+    {
+        return INT32_MIN;
+    }
+    return (int32_t)v;
+}
+
+static inline void store_24(uint8_t *out, int32_t slot)
+{
+    int32_t v = slot >> 8;
+    out[0] = (uint8_t)v;
+    out[1] = (uint8_t)(v >> 8);
+    out[2] = (uint8_t)(v >> 16);
+}
+
+static void scalar_16(const int32_t *in, int16_t *out, size_t samples, int32_t dc, int32_t gain_q8)
+{
+    size_t i = 0;
+
+    if (gain_q8 == AUDIO_CONVERT_GAIN_UNITY && dc == 0)
+    {
+        // Plain shift, unrolled: 24-bit data is left-aligned, keep the top 16 bits
+        for (; i + 4 <= samples; i += 4)
+        {
+            out[i] = (int16_t)(in[i] >> 16);
+            out[i + 1] = (int16_t)(in[i + 1] >> 16);
+            out[i + 2] = (int16_t)(in[i + 2] >> 16);
+            out[i + 3] = (int16_t)(in[i + 3] >> 16);
+        }
+        for (; i < samples; ++i)
+        {
+            out[i] = (int16_t)(in[i] >> 16);
+        }
+        return;
+    }
+
+    if (gain_q8 == AUDIO_CONVERT_GAIN_UNITY)
+    {
+        for (; i < samples; ++i)
+        {
+            out[i] = (int16_t)(sub_dc(in[i], dc) >> 16);
+        }
+        return;
+    }
+
+    for (; i < samples; ++i)
+    {
+        out[i] = (int16_t)(scale_slot(in[i], dc, gain_q8) >> 16);
+    }
+}
+
+#if AUDIO_CONVERT_HAVE_PIE
+/**
+ * PIE kernel: 8 slots per iteration
+ *
+ * q0/q1 hold 8 int32 slots, ee.vsubs.s32 removes DC with saturation,
+ * ee.vunzip.16 splits the 16-bit halves so q1 holds the 8 high halves
+ * (== slot >> 16), which are stored in one 128-bit write.
+ * Both pointers must be 16-byte aligned.
+ */
+static void pie_16_blocks(const int32_t *in, int16_t *out, size_t blocks, int32_t dc)
+{
+    const int32_t dc_word = dc;
+
+    for (size_t b = 0; b < blocks; ++b)
+    {
+        // q registers are not compiler-managed: reload the DC broadcast in the same statement
+        asm volatile(
+            "ee.vldbc.32 q2, %2\n"
+            "ee.vld.128.ip q0, %0, 16\n"
+            "ee.vld.128.ip q1, %0, 16\n"
+            "ee.vsubs.s32 q0, q0, q2\n"
+            "ee.vsubs.s32 q1, q1, q2\n"
+            "ee.vunzip.16 q0, q1\n"
+            "ee.vst.128.ip q1, %1, 16\n"
+            : "+r"(in), "+r"(out)
+            : "r"(&dc_word)
+            : "memory");
+    }
+}
+
+// Scalar head until out is aligned, PIE body if in is aligned too, scalar tail
+static void simd_16(const int32_t *in, int16_t *out, size_t samples, int32_t dc)
+{
+    while (samples > 0 && ((uintptr_t)out & (SIMD_ALIGN - 1)) != 0)
+    {
+        *out++ = (int16_t)(sub_dc(*in++, dc) >> 16);
+        --samples;
+    }
+
+    if (((uintptr_t)in & (SIMD_ALIGN - 1)) == 0)
+    {
+        size_t blocks = samples / SIMD_BLOCK_SAMPLES;
+        pie_16_blocks(in, out, blocks, dc);
+        in += blocks * SIMD_BLOCK_SAMPLES;
+        out += blocks * SIMD_BLOCK_SAMPLES;
+        samples -= blocks * SIMD_BLOCK_SAMPLES;
+    }
+
+    scalar_16(in, out, samples, dc, AUDIO_CONVERT_GAIN_UNITY);
+}
+
+// Compare PIE output with the scalar reference on awkward values
+static bool simd_self_test(void)
+{
+    static const int32_t pattern[] = {
+        0, 1, -1, 0x00010000, -0x00010000, 0x7FFFFF00, (int32_t)0x80000000, 0x12345600,
+        (int32_t)0xFEDCBA00, 0x00FFFF00, (int32_t)0xFF000100, 0x40000000, -0x40000000, 0x0000FF00,
+        0x7FFFFFFF, (int32_t)0x80000100};
+    const int32_t dc_values[] = {0, 0x00123400, -0x7FFF0000};
+    const size_t n = 64;
+
+    int32_t *in = (int32_t *)heap_caps_aligned_alloc(SIMD_ALIGN, n * sizeof(int32_t), MALLOC_CAP_8BIT);
+    int16_t *expected = (int16_t *)heap_caps_aligned_alloc(SIMD_ALIGN, n * sizeof(int16_t), MALLOC_CAP_8BIT);
+    int16_t *actual = (int16_t *)heap_caps_aligned_alloc(SIMD_ALIGN, n * sizeof(int16_t), MALLOC_CAP_8BIT);
+    bool ok = (in != NULL && expected != NULL && actual != NULL);
+
+    for (size_t i = 0; ok && i < n; ++i)
+    {
+        in[i] = pattern[i % (sizeof(pattern) / sizeof(pattern[0]))] ^ (int32_t)(i << 12);
+    }
+
+    for (size_t d = 0; ok && d < sizeof(dc_values) / sizeof(dc_values[0]); ++d)
+    {
+        scalar_16(in, expected, n, dc_values[d], AUDIO_CONVERT_GAIN_UNITY);
+        simd_16(in, actual, n, dc_values[d]);
+        ok = (memcmp(expected, actual, n * sizeof(int16_t)) == 0);
+    }
+
+    heap_caps_free(in);
+    heap_caps_free(expected);
+    heap_caps_free(actual);
+    return ok;
+}
+#endif
+
+bool audio_convert_init(void)
+{
+#if AUDIO_CONVERT_HAVE_PIE
+    simd_active = simd_self_test();
+    if (simd_active)
+    {
+        ESP_LOGI(TAG, "PIE SIMD conversion kernels enabled");
+    }
+    else
+    {
+        ESP_LOGW(TAG, "PIE self-test failed, using scalar conversion kernels");
+    }
+#else
+    simd_active = false;
+    ESP_LOGI(TAG, "Using scalar conversion kernels");
+#endif
+    return simd_active;
+}
+
+void audio_convert_set_params(const audio_convert_params_t *new_params)
+{
+    if (new_params == NULL)
+    {
+        return;
+    }
+
+    params.dc_offset = new_params->dc_offset;
+    params.gain_q8 = new_params->gain_q8 < 0 ? 0 : new_params->gain_q8;
+}
+
+void audio_convert_get_params(audio_convert_params_t *out_params)
+{
+    if (out_params)
+    {
+        *out_params = params;
+    }
+}
+
+bool audio_convert_simd_active(void)
+{
+    return simd_active;
+}
+
+void audio_convert_to_16(const int32_t *in, int16_t *out, size_t samples)
+{
+#if AUDIO_CONVERT_HAVE_PIE
+    if (simd_active && params.gain_q8 == AUDIO_CONVERT_GAIN_UNITY && samples >= 2 * SIMD_BLOCK_SAMPLES)
+    {
+        simd_16(in, out, samples, params.dc_offset);
+        return;
+    }
+#endif
+    scalar_16(in, out, samples, params.dc_offset, params.gain_q8);
+}
+
+void audio_convert_to_16_scalar(const int32_t *in, int16_t *out, size_t samples)
+{
+    scalar_16(in, out, samples, params.dc_offset, params.gain_q8);
+}
+
+void audio_convert_to_24_scalar(const int32_t *in, uint8_t *out, size_t samples)
+{
+    const int32_t dc = params.dc_offset;
+    const int32_t gain_q8 = params.gain_q8;
+    size_t i = 0;
+
+    if (gain_q8 == AUDIO_CONVERT_GAIN_UNITY && dc == 0)
+    {
+        // Keep all 24 data bits, drop the empty low byte, pack little-endian
+        for (; i + 4 <= samples; i += 4)
+        {
+            store_24(out, in[i]);
+            store_24(out + 3, in[i + 1]);
+            store_24(out + 6, in[i + 2]);
+            store_24(out + 9, in[i + 3]);
+            out += 12;
+        }
+        for (; i < samples; ++i)
+        {
+            store_24(out, in[i]);
+            out += 3;
+        }
+        return;
+    }
+
+    for (; i < samples; ++i)
+    {
+        store_24(out, scale_slot(in[i], dc, gain_q8));
+        out += 3;
+    }
+}
+
+void audio_convert_to_24(const int32_t *in, uint8_t *out, size_t samples)
+{
+    // 3-byte packing does not map onto 128-bit lanes; the unrolled scalar path is used
+    audio_convert_to_24_scalar(in, out, samples);
+}
+
+void audio_convert_to_32_scalar(const int32_t *in, uint8_t *out, size_t samples)
+{
+    const int32_t dc = params.dc_offset;
+    const int32_t gain_q8 = params.gain_q8;
+
+    if (gain_q8 == AUDIO_CONVERT_GAIN_UNITY && dc == 0)
+    {
+        memcpy(out, in, samples * sizeof(int32_t));
+        return;
+    }
+
+    for (size_t i = 0; i < samples; ++i)
+    {
+        int32_t v = scale_slot(in[i], dc, gain_q8);
+        memcpy(out, &v, sizeof(v)); // out may be unaligned
+        out += sizeof(v);
+    }
+}
+
+void audio_convert_to_32(const int32_t *in, uint8_t *out, size_t samples)
+{
+    audio_convert_to_32_scalar(in, out, samples);
+}
+
+typedef void (*bench_kernel_t)(const int32_t *in, uint8_t *out, size_t samples);
+
+static void bench_16(const int32_t *in, uint8_t *out, size_t samples)
+{
+    audio_convert_to_16(in, (int16_t *)out, samples);
+}
+
+static void bench_16_scalar(const int32_t *in, uint8_t *out, size_t samples)
+{
+    audio_convert_to_16_scalar(in, (int16_t *)out, samples);
+}
+
+static uint32_t bench_cycles(bench_kernel_t kernel, const int32_t *in, uint8_t *out, size_t samples)
+{
+    uint32_t best = UINT32_MAX;
+
+    kernel(in, out, samples); // Warm caches
+    for (int round = 0; round < BENCH_ROUNDS; ++round)
+    {
+        uint32_t start = esp_cpu_get_cycle_count();
+        kernel(in, out, samples);
+        uint32_t cycles = esp_cpu_get_cycle_count() - start;
+        if (cycles < best)
+        {
+            best = cycles;
+        }
+    }
+    return best;
+}
+
+void audio_convert_run_benchmark(void)
+{
+    const size_t samples = I2S_READ_SAMPLES;
+    const struct
+    {
+        const char *name;
+        bench_kernel_t kernel;
+    } kernels[] = {
+        {"16-bit scalar", bench_16_scalar},
+        {"16-bit", bench_16},
+        {"24-bit scalar", audio_convert_to_24_scalar},
+        {"24-bit", audio_convert_to_24},
+        {"32-bit scalar", audio_convert_to_32_scalar},
+        {"32-bit", audio_convert_to_32},
+    };
+    const struct
+    {
+        const char *name;
+        audio_convert_params_t params;
+    } cases[] = {
+        {"shift", {0, AUDIO_CONVERT_GAIN_UNITY}},
+        {"dc", {0x00012300, AUDIO_CONVERT_GAIN_UNITY}},
+        {"dc+gain", {0x00012300, 3 * AUDIO_CONVERT_GAIN_UNITY / 2}},
+    };
+
+    int32_t *in = (int32_t *)heap_caps_aligned_alloc(SIMD_ALIGN, samples * sizeof(int32_t),
+                                                     MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    uint8_t *out = (uint8_t *)heap_caps_aligned_alloc(SIMD_ALIGN, samples * sizeof(int32_t),
+                                                      MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (in == NULL || out == NULL)
+    {
+        ESP_LOGE(TAG, "Benchmark: failed to allocate buffers");
+        heap_caps_free(in);
+        heap_caps_free(out);
+        return;
+    }
+
+    // Full-scale pseudo-random slots so saturation paths are exercised
+    uint32_t lfsr = 0xACE1u;
+    for (size_t i = 0; i < samples; ++i)
+    {
+        lfsr = lfsr * 1664525u + 1013904223u;
+        in[i] = (int32_t)(lfsr & 0xFFFFFF00u);
+    }
+
+    audio_convert_params_t saved = params;
+
+    ESP_LOGI(TAG, "Conversion benchmark (%zu samples, best of %d, SIMD %s):",
+             samples, BENCH_ROUNDS, simd_active ? "on" : "off");
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c)
+    {
+        audio_convert_set_params(&cases[c].params);
+        for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k)
+        {
+            uint32_t cycles = bench_cycles(kernels[k].kernel, in, out, samples);
+            uint32_t centi = (uint32_t)(((uint64_t)cycles * 100) / samples);
+            ESP_LOGI(TAG, "  %-8s %-14s %5lu cycles  %lu.%02lu cycles/sample",
+                     cases[c].name, kernels[k].name, cycles, centi / 100, centi % 100);
+        }
+    }
+
+    params = saved;
+    heap_caps_free(in);
+    heap_caps_free(out);
+}
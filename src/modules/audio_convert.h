@@ -0,0 +1,110 @@
+#ifndef AUDIO_CONVERT_H
+#define AUDIO_CONVERT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Sample conversion kernels: raw INMP441 slots -> transport format
+ *
+ * Input is always 24-bit data left-aligned in a 32-bit slot. Each kernel
+ * optionally subtracts a DC offset and applies a gain, saturates, then
+ * narrows to the output width:
+ * - 16: top 16 bits (int16_t, native endian)
+ * - 24: 24 data bits, packed little-endian, 3 bytes per sample
+ * - 32: full slot
+ *
+ * On ESP32-S3 the unity-gain 16-bit path uses the 128-bit PIE vector unit
+ * (8 samples per iteration, DC offset included). Everything else, and any
+ * unaligned head/tail, runs the scalar fallback.
+ */
+
+/**
+ * Conversion parameters
+ *
+ * Defaults (0 / AUDIO_CONVERT_GAIN_UNITY) make every kernel a plain shift.
+ */
+typedef struct
+{
+    int32_t dc_offset; // Subtracted from the raw 32-bit slot before scaling
+    int32_t gain_q8;   // Linear gain in Q8 (256 = unity)
+} audio_convert_params_t;
+
+#define AUDIO_CONVERT_GAIN_UNITY 256
+
+/**
+ * Initialize conversion kernels
+ *
+ * Runs a short self-test of the SIMD kernels against the scalar reference
+ * and falls back to scalar code if they disagree.
+ *
+ * @return true if SIMD kernels are active, false if scalar only
+ */
+bool audio_convert_init(void);
+
+/**
+ * Set DC offset and gain used by all kernels
+ *
+ * Call from the capture task or before streaming starts.
+ *
+ * @param params New parameters (gain clamped to >= 0)
+ */
+void audio_convert_set_params(const audio_convert_params_t *params);
+
+/**
+ * Get current DC offset and gain
+ *
+ * @param params Output parameters
+ */
+void audio_convert_get_params(audio_convert_params_t *params);
+
+/**
+ * Check whether SIMD kernels are in use
+ */
+bool audio_convert_simd_active(void);
+
+/**
+ * Convert raw slots to 16-bit samples
+ *
+ * @param in Raw 32-bit slots
+ * @param out Destination (may point into the ring buffer)
+ * @param samples Number of samples to convert
+ */
+void audio_convert_to_16(const int32_t *in, int16_t *out, size_t samples);
+
+/**
+ * Convert raw slots to packed 24-bit little-endian samples
+ *
+ * @param in Raw 32-bit slots
+ * @param out Destination, 3 bytes per sample (no alignment required)
+ * @param samples Number of samples to convert
+ */
+void audio_convert_to_24(const int32_t *in, uint8_t *out, size_t samples);
+
+/**
+ * Convert raw slots to 32-bit samples (passthrough at unity gain)
+ *
+ * @param in Raw 32-bit slots
+ * @param out Destination, 4 bytes per sample (no alignment required)
+ * @param samples Number of samples to convert
+ */
+void audio_convert_to_32(const int32_t *in, uint8_t *out, size_t samples);
+
+/**
+ * Scalar reference kernels (same contract as above, never vectorized)
+ */
+void audio_convert_to_16_scalar(const int32_t *in, int16_t *out, size_t samples);
+void audio_convert_to_24_scalar(const int32_t *in, uint8_t *out, size_t samples);
+void audio_convert_to_32_scalar(const int32_t *in, uint8_t *out, size_t samples);
+
+/**
+ * Microbenchmark: log cycles per sample for every kernel
+ *
+ * Runs each kernel (scalar and dispatched, unity and with DC/gain) over a
+ * block of I2S_READ_SAMPLES on the calling core and logs the result.
+ * Takes a few milliseconds; current parameters are restored afterwards.
+ */
+void audio_convert_run_benchmark(void);
+
+#endif // AUDIO_CONVERT_H
@@ -0,0 +1,433 @@
+#include "audio_encoder.h"
+#include "esp_log.h"
+#include <string.h>
+
+#if AUDIO_CODEC_OPUS_ENABLED
+#include "opus.h"
+#endif
+
+static const char *TAG = "AUDIO_ENCODER";
+
+// What the active codec produces for the current format
+typedef struct
+{
+    size_t frame_samples;   // Interleaved samples per frame (0 = unframed PCM)
+    size_t max_frame_bytes; // Worst-case encoded frame size
+    bool fixed_frame_size;  // Every frame encodes to max_frame_bytes
+    uint32_t bitrate_bps;   // Payload bits per second
+} codec_info_t;
+
+// Pluggable codec interface
+typedef struct
+{
+    audio_codec_t id;
+    const char *name;
+    bool (*init)(const i2s_audio_format_t *format, codec_info_t *info);
+    void (*deinit)(void);
+    size_t (*encode)(const int16_t *in, uint8_t *out, size_t out_size);
+    void (*reset)(void);
+} codec_ops_t;
+
+static const codec_ops_t *active_codec = NULL;
+static codec_info_t active_info;
+static uint8_t active_channels = 1;
+
+// ============================================================================
+// PCM (passthrough, no framing)
+// ============================================================================
+
+static bool pcm_init(const i2s_audio_format_t *format, codec_info_t *info)
+{
+    info->frame_samples = 0;
+    info->max_frame_bytes = 0;
+    info->fixed_frame_size = true;
+    info->bitrate_bps = format->sample_rate * format->channels * format->bits_per_sample;
+    return true;
+}
+
+// ============================================================================
+// IMA-ADPCM
+// ============================================================================
+
+static const int8_t ima_index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8};
+
+static const int16_t ima_step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+
+static audio_adpcm_state_t ima_state[AUDIO_CHANNELS_MAX];
+
+static inline uint8_t ima_encode_sample(audio_adpcm_state_t *st, int16_t sample)
+{
+    int32_t step = ima_step_table[st->index];
+    int32_t diff = sample - st->predictor;
+    uint8_t code = 0;
+
+    if (diff < 0)
+    {
+        code = 8;
+        diff = -diff;
+    }
+
+    // Successive approximation of diff / step, mirroring the decoder exactly
+    int32_t delta = step >> 3;
+    if (diff >= step)
+    {
+        code |= 4;
+        diff -= step;
+        delta += step;
+    }
+    step >>= 1;
+    if (diff >= step)
+    {
+        code |= 2;
+        diff -= step;
+        delta += step;
+    }
+    step >>= 1;
+    if (diff >= step)
+    {
+        code |= 1;
+        delta += step;
+    }
+
+    int32_t predictor = st->predictor + ((code & 8) ? -delta : delta);
+    if (predictor > INT16_MAX)
+    {
+        predictor = INT16_MAX;
+    }
+    else if (predictor < INT16_MIN)
+    {
+        predictor = INT16_MIN;
+    }
+    st->predictor = predictor;
+
+    int index = st->index + ima_index_table[code];
+    st->index = (int8_t)(index < 0 ? 0 : (index > 88 ? 88 : index));
+
+    return code;
+}
+
+static void ima_reset(void)
+{
+    memset(ima_state, 0, sizeof(ima_state));
+}
+
+static bool ima_init(const i2s_audio_format_t *format, codec_info_t *info)
+{
+    if (format->bits_per_sample != 16)
+    {
+        ESP_LOGW(TAG, "IMA-ADPCM needs 16-bit samples (configured %d-bit)", format->bits_per_sample);
+        return false;
+    }
+
+    ima_reset();
+    info->frame_samples = AUDIO_ADPCM_FRAME_SAMPLES * format->channels;
+    info->max_frame_bytes = audio_encoder_adpcm_frame_bytes(format->channels);
+    info->fixed_frame_size = true;
+    info->bitrate_bps = (uint32_t)(((uint64_t)info->max_frame_bytes * 8 * format->sample_rate) /
+                                   AUDIO_ADPCM_FRAME_SAMPLES);
+    return true;
+}
+
+static size_t ima_encode(const int16_t *in, uint8_t *out, size_t out_size)
+{
+    return audio_encoder_adpcm_encode_frame(ima_state, active_channels, in, out, out_size);
+}
+
+size_t audio_encoder_adpcm_frame_bytes(uint8_t channels)
+{
+    // Header per channel + one nibble per remaining sample
+    return channels * 4 + ((AUDIO_ADPCM_FRAME_SAMPLES - 1) * channels + 1) / 2;
+}
+
+size_t audio_encoder_adpcm_encode_frame(audio_adpcm_state_t *state, uint8_t channels, const int16_t *in,
+                                        uint8_t *out, size_t out_size)
+{
+    const size_t frame_bytes = audio_encoder_adpcm_frame_bytes(channels);
+
+    if (state == NULL || in == NULL || out == NULL || out_size < frame_bytes)
+    {
+        return 0;
+    }
+
+    // Frame header: first sample verbatim + current step index, per channel
+    uint8_t *p = out;
+    for (uint8_t ch = 0; ch < channels; ch++)
+    {
+        int16_t first = in[ch];
+        state[ch].predictor = first;
+        p[0] = (uint8_t)(first & 0xFF);
+        p[1] = (uint8_t)((uint16_t)first >> 8);
+        p[2] = (uint8_t)state[ch].index;
+        p[3] = 0;
+        p += 4;
+    }
+
+    // Channel-interleaved codes, two per byte, low nibble first
+    const size_t codes = (AUDIO_ADPCM_FRAME_SAMPLES - 1) * channels;
+    const int16_t *src = in + channels;
+    for (size_t i = 0; i < codes; i += 2)
+    {
+        uint8_t lo = ima_encode_sample(&state[i % channels], src[i]);
+        uint8_t hi = 0;
+        if (i + 1 < codes)
+        {
+            hi = ima_encode_sample(&state[(i + 1) % channels], src[i + 1]);
+        }
+        *p++ = (uint8_t)(lo | (hi << 4));
+    }
+
+    return frame_bytes;
+}
+
+// ============================================================================
+// Opus (optional component)
+// ============================================================================
+
+#if AUDIO_CODEC_OPUS_ENABLED
+static OpusEncoder *opus_encoder = NULL;
+static size_t opus_frame_per_channel = 0;
+
+static bool opus_init(const i2s_audio_format_t *format, codec_info_t *info)
+{
+    if (format->bits_per_sample != 16)
+    {
+        ESP_LOGW(TAG, "Opus needs 16-bit samples (configured %d-bit)", format->bits_per_sample);
+        return false;
+    }
+
+    switch (format->sample_rate)
+    {
+    case 8000:
+    case 12000:
+    case 16000:
+    case 24000:
+    case 48000:
+        break;
+    default:
+        ESP_LOGW(TAG, "Opus does not support %lu Hz", format->sample_rate);
+        return false;
+    }
+
+    int err = 0;
+    opus_encoder = opus_encoder_create(format->sample_rate, format->channels, OPUS_APPLICATION_VOIP, &err);
+    if (opus_encoder == NULL || err != OPUS_OK)
+    {
+        ESP_LOGE(TAG, "Failed to create Opus encoder: %d", err);
+        opus_encoder = NULL;
+        return false;
+    }
+
+    opus_encoder_ctl(opus_encoder, OPUS_SET_BITRATE(AUDIO_OPUS_BITRATE));
+    opus_encoder_ctl(opus_encoder, OPUS_SET_COMPLEXITY(AUDIO_OPUS_COMPLEXITY));
+
+    opus_frame_per_channel = (format->sample_rate * AUDIO_OPUS_FRAME_MS) / 1000;
+    info->frame_samples = opus_frame_per_channel * format->channels;
+    info->max_frame_bytes = 1275; // Largest single Opus frame (RFC 6716)
+    info->fixed_frame_size = false;
+    info->bitrate_bps = AUDIO_OPUS_BITRATE;
+    return true;
+}
+
+static void opus_deinit(void)
+{
+    if (opus_encoder != NULL)
+    {
+        opus_encoder_destroy(opus_encoder);
+        opus_encoder = NULL;
+    }
+}
+
+static size_t opus_encode_frame(const int16_t *in, uint8_t *out, size_t out_size)
+{
+    opus_int32 bytes = opus_encode(opus_encoder, in, opus_frame_per_channel, out, out_size);
+    if (bytes < 0)
+    {
+        ESP_LOGW(TAG, "Opus encode failed: %ld", (long)bytes);
+        return 0;
+    }
+    return (size_t)bytes;
+}
+
+static void opus_reset(void)
+{
+    if (opus_encoder != NULL)
+    {
+        opus_encoder_ctl(opus_encoder, OPUS_RESET_STATE);
+    }
+}
+#endif
+
+// ============================================================================
+// Codec registry
+// ============================================================================
+
+static const codec_ops_t codecs[] = {
+    {AUDIO_CODEC_PCM, "pcm", pcm_init, NULL, NULL, NULL},
+    {AUDIO_CODEC_IMA_ADPCM, "ima-adpcm", ima_init, NULL, ima_encode, ima_reset},
+#if AUDIO_CODEC_OPUS_ENABLED
+    {AUDIO_CODEC_OPUS, "opus", opus_init, opus_deinit, opus_encode_frame, opus_reset},
+#endif
+};
+
+static const codec_ops_t *find_codec(audio_codec_t codec)
+{
+    for (size_t i = 0; i < sizeof(codecs) / sizeof(codecs[0]); i++)
+    {
+        if (codecs[i].id == codec)
+        {
+            return &codecs[i];
+        }
+    }
+    return NULL;
+}
+
+bool audio_encoder_init(audio_codec_t codec, const i2s_audio_format_t *format)
+{
+    if (format == NULL)
+    {
+        return false;
+    }
+
+    audio_encoder_deinit();
+    active_channels = format->channels;
+
+    const codec_ops_t *ops = find_codec(codec);
+    if (ops == NULL)
+    {
+        ESP_LOGW(TAG, "Codec %d not available in this build", codec);
+    }
+    else if (ops->init(format, &active_info))
+    {
+        active_codec = ops;
+        ESP_LOGI(TAG, "Encoder: %s, %lu bps, %zu samples/frame",
+                 ops->name, active_info.bitrate_bps, active_info.frame_samples);
+        return true;
+    }
+
+    // Fall back to raw PCM
+    active_codec = find_codec(AUDIO_CODEC_PCM);
+    active_codec->init(format, &active_info);
+    ESP_LOGW(TAG, "Falling back to PCM (%lu bps)", active_info.bitrate_bps);
+    return codec == AUDIO_CODEC_PCM;
+}
+
+void audio_encoder_deinit(void)
+{
+    if (active_codec != NULL && active_codec->deinit != NULL)
+    {
+        active_codec->deinit();
+    }
+    active_codec = NULL;
+    memset(&active_info, 0, sizeof(active_info));
+}
+
+audio_codec_t audio_encoder_get_codec(void)
+{
+    return active_codec ? active_codec->id : AUDIO_CODEC_PCM;
+}
+
+const char *audio_encoder_codec_name(audio_codec_t codec)
+{
+    switch (codec)
+    {
+    case AUDIO_CODEC_PCM:
+        return "pcm";
+    case AUDIO_CODEC_IMA_ADPCM:
+        return "ima-adpcm";
+    case AUDIO_CODEC_OPUS:
+        return "opus";
+    case AUDIO_CODEC_SILENCE:
+        return "silence";
+    default:
+        return "unknown";
+    }
+}
+
+bool audio_encoder_codec_available(audio_codec_t codec)
+{
+    return find_codec(codec) != NULL;
+}
+
+size_t audio_encoder_frame_samples(void)
+{
+    return active_info.frame_samples;
+}
+
+size_t audio_encoder_max_frame_bytes(void)
+{
+    return active_info.max_frame_bytes;
+}
+
+bool audio_encoder_fixed_frame_size(void)
+{
+    return active_info.fixed_frame_size;
+}
+
+size_t audio_encoder_encode_frame(const int16_t *in, uint8_t *out, size_t out_size)
+{
+    if (active_codec == NULL || active_codec->encode == NULL || in == NULL || out == NULL)
+    {
+        return 0;
+    }
+    return active_codec->encode(in, out, out_size);
+}
+
+void audio_encoder_reset(void)
+{
+    if (active_codec != NULL && active_codec->reset != NULL)
+    {
+        active_codec->reset();
+    }
+}
+
+uint32_t audio_encoder_get_bitrate(void)
+{
+    return active_info.bitrate_bps;
+}
+
+audio_codec_t audio_encoder_cheaper_codec(audio_codec_t codec)
+{
+    // Ladder: PCM -> IMA-ADPCM (1/4 of 16-bit PCM, negligible CPU) -> Opus if built in
+    if (codec == AUDIO_CODEC_PCM)
+    {
+        return AUDIO_CODEC_IMA_ADPCM;
+    }
+    if (codec == AUDIO_CODEC_IMA_ADPCM && audio_encoder_codec_available(AUDIO_CODEC_OPUS))
+    {
+        return AUDIO_CODEC_OPUS;
+    }
+    return codec;
+}
+
+bool audio_encoder_codec_supports(audio_codec_t codec, const i2s_audio_format_t *format)
+{
+    if (format == NULL || !audio_encoder_codec_available(codec))
+    {
+        return false;
+    }
+
+    switch (codec)
+    {
+    case AUDIO_CODEC_PCM:
+        return true;
+    case AUDIO_CODEC_IMA_ADPCM:
+        return format->bits_per_sample == 16;
+    case AUDIO_CODEC_OPUS:
+        return format->bits_per_sample == 16 &&
+               (format->sample_rate == 8000 || format->sample_rate == 12000 || format->sample_rate == 16000 ||
+                format->sample_rate == 24000 || format->sample_rate == 48000);
+    default:
+        return false;
+    }
+}
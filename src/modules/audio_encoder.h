@@ -0,0 +1,150 @@
+#ifndef AUDIO_ENCODER_H
+#define AUDIO_ENCODER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../config.h"
+#include "i2s_handler.h"
+
+/**
+ * Audio encoder stage between the ring buffer and the streamers
+ *
+ * Encoders work on whole frames of 16-bit interleaved samples and run in the
+ * network sender task, so they never hold up I2S capture. Every encoded
+ * frame decodes on its own, so a lost UDP packet only loses its own frames.
+ *
+ * IMA-ADPCM frame layout (AUDIO_ADPCM_FRAME_SAMPLES = N per channel):
+ * - Per channel: int16 first sample (LE), uint8 step index, uint8 0
+ * - (N - 1) * channels 4-bit codes, channel-interleaved, low nibble first
+ * Mono N = 505 is 256 bytes, the same block layout as WAV IMA-ADPCM.
+ *
+ * Opus (AUDIO_CODEC_OPUS_ENABLED): one AUDIO_OPUS_FRAME_MS packet per frame.
+ */
+
+/**
+ * IMA-ADPCM coder state for one channel
+ */
+typedef struct
+{
+    int32_t predictor;
+    int8_t index;
+} audio_adpcm_state_t;
+
+/**
+ * Initialize the encoder for a capture format
+ *
+ * Falls back to AUDIO_CODEC_PCM if the codec is unavailable or does not
+ * support the format (ADPCM/Opus need 16-bit samples, Opus needs
+ * 8/12/16/24/48 kHz).
+ *
+ * @param codec Requested codec
+ * @param format Capture format produced by the ring buffer
+ * @return true if the requested codec is active
+ */
+bool audio_encoder_init(audio_codec_t codec, const i2s_audio_format_t *format);
+
+/**
+ * Release encoder state
+ */
+void audio_encoder_deinit(void);
+
+/**
+ * Get active codec
+ */
+audio_codec_t audio_encoder_get_codec(void);
+
+/**
+ * Get printable codec name
+ */
+const char *audio_encoder_codec_name(audio_codec_t codec);
+
+/**
+ * Check whether a codec is compiled in
+ */
+bool audio_encoder_codec_available(audio_codec_t codec);
+
+/**
+ * Get samples per encoded frame (all channels, interleaved)
+ *
+ * @return Frame size in samples, 0 for PCM (no framing)
+ */
+size_t audio_encoder_frame_samples(void);
+
+/**
+ * Get worst-case encoded frame size in bytes
+ */
+size_t audio_encoder_max_frame_bytes(void);
+
+/**
+ * Check whether every frame has the same encoded size
+ *
+ * Fixed-size frames may be packed several per datagram; variable-size
+ * frames are sent one per datagram (or length-prefixed on TCP).
+ */
+bool audio_encoder_fixed_frame_size(void);
+
+/**
+ * Encode exactly one frame
+ *
+ * @param in audio_encoder_frame_samples() interleaved 16-bit samples
+ * @param out Output buffer
+ * @param out_size Size of output buffer
+ * @return Encoded bytes, 0 on failure
+ */
+size_t audio_encoder_encode_frame(const int16_t *in, uint8_t *out, size_t out_size);
+
+/**
+ * Reset codec history (e.g. after a reconnect)
+ */
+void audio_encoder_reset(void);
+
+/**
+ * Get encoded bitrate for the active codec and format
+ *
+ * @return Bits per second on the wire (payload only)
+ */
+uint32_t audio_encoder_get_bitrate(void);
+
+/**
+ * Get the next cheaper codec on the overflow degrade ladder
+ *
+ * PCM steps to IMA-ADPCM, IMA-ADPCM to Opus when it is built in. The
+ * choice itself belongs to adaptive_quality, which applies it through
+ * audio_encoder_init().
+ *
+ * @param codec Codec in use
+ * @return The cheaper codec, or codec itself at the bottom of the ladder
+ */
+audio_codec_t audio_encoder_cheaper_codec(audio_codec_t codec);
+
+/**
+ * Check whether a codec is built in and can encode a capture format
+ *
+ * Same rules as audio_encoder_init(), without touching the active encoder.
+ */
+bool audio_encoder_codec_supports(audio_codec_t codec, const i2s_audio_format_t *format);
+
+/**
+ * Get the size of one IMA-ADPCM frame
+ * @param channels Interleaved channels
+ */
+size_t audio_encoder_adpcm_frame_bytes(uint8_t channels);
+
+/**
+ * Encode one IMA-ADPCM frame with caller-owned state
+ *
+ * The IMA-ADPCM codec's frame layout, independent of the active encoder,
+ * so another task (the flash spool) can encode while the sender does.
+ *
+ * @param state One entry per channel, zeroed before the first frame
+ * @param channels Interleaved channels
+ * @param in AUDIO_ADPCM_FRAME_SAMPLES * channels interleaved 16-bit samples
+ * @param out Output buffer
+ * @param out_size Size of output buffer
+ * @return audio_encoder_adpcm_frame_bytes(channels), 0 if out is too small
+ */
+size_t audio_encoder_adpcm_encode_frame(audio_adpcm_state_t *state, uint8_t channels, const int16_t *in,
+                                        uint8_t *out, size_t out_size);
+
+#endif // AUDIO_ENCODER_H
@@ -0,0 +1,71 @@
+#include "boot_profile.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <atomic>
+
+static const char *TAG = "BOOT";
+
+static const char *phase_names[BOOT_PHASE_COUNT] = {
+    "nvs", "config", "capture", "wifi", "stream", "first_audio", "ntp", "web"};
+static std::atomic<int64_t> phase_us[BOOT_PHASE_COUNT];
+static std::atomic<bool> summary_logged(false);
+
+static void log_summary(void)
+{
+    char line[160];
+    size_t used = 0;
+    for (int i = 0; i < BOOT_PHASE_COUNT && used < sizeof(line); i++)
+    {
+        int32_t ms = boot_profile_get_ms((boot_phase_t)i);
+        if (ms < 0)
+        {
+            continue;
+        }
+        used += snprintf(line + used, sizeof(line) - used, "%s%s %ld", used > 0 ? ", " : "", phase_names[i], (long)ms);
+    }
+    ESP_LOGI(TAG, "Boot phases (ms since boot): %s", line);
+}
+
+void boot_profile_mark(boot_phase_t phase)
+{
+    if (phase >= BOOT_PHASE_COUNT)
+    {
+        return;
+    }
+    if (phase_us[phase].load(std::memory_order_relaxed) != 0)
+    {
+        return; // Hot path (first audio is marked on every send)
+    }
+
+    int64_t expected = 0;
+    int64_t now = esp_timer_get_time();
+    if (!phase_us[phase].compare_exchange_strong(expected, now, std::memory_order_relaxed))
+    {
+        return; // Reached before
+    }
+    ESP_LOGI(TAG, "%s at %lld ms", phase_names[phase], now / 1000);
+
+    // Everything after these is background work
+    if (boot_profile_get_ms(BOOT_PHASE_FIRST_AUDIO) >= 0 && boot_profile_get_ms(BOOT_PHASE_WEB) >= 0 &&
+        !summary_logged.exchange(true))
+    {
+        log_summary();
+    }
+}
+
+int32_t boot_profile_get_ms(boot_phase_t phase)
+{
+    if (phase >= BOOT_PHASE_COUNT)
+    {
+        return -1;
+    }
+
+    int64_t us = phase_us[phase].load(std::memory_order_relaxed);
+    return us != 0 ? (int32_t)(us / 1000) : -1;
+}
+
+const char *boot_profile_phase_name(boot_phase_t phase)
+{
+    return phase < BOOT_PHASE_COUNT ? phase_names[phase] : "unknown";
+}
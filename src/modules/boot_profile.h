@@ -0,0 +1,52 @@
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config.h"
+
+/**
+ * Boot phase timing
+ *
+ * Capture starts right after the config is loaded; WiFi, NTP and the web
+ * UI come up alongside it and the sender connects once the network is up.
+ * Each phase records when it was first reached (esp_timer, microseconds
+ * since boot), from whichever task gets there. The breakdown is logged
+ * once the first audio block has gone out and the web UI is up.
+ */
+
+typedef enum
+{
+    BOOT_PHASE_NVS = 0,         // NVS flash ready
+    BOOT_PHASE_CONFIG = 1,      // Configuration loaded
+    BOOT_PHASE_CAPTURE = 2,     // I2S capturing into the ring
+    BOOT_PHASE_WIFI = 3,        // Station connected
+    BOOT_PHASE_STREAM = 4,      // First streamer connected
+    BOOT_PHASE_FIRST_AUDIO = 5, // First audio block sent
+    BOOT_PHASE_NTP = 6,         // NTP sync finished (or timed out)
+    BOOT_PHASE_WEB = 7,         // Web UI serving
+    BOOT_PHASE_COUNT
+} boot_phase_t;
+
+/**
+ * Record that a phase was reached (later calls for the same phase are ignored)
+ *
+ * Lock-free; callable from any task.
+ *
+ * @param phase Phase reached
+ */
+void boot_profile_mark(boot_phase_t phase);
+
+/**
+ * Get when a phase was reached
+ * @param phase Phase to query
+ * @return Milliseconds since boot, or -1 if not reached yet
+ */
+int32_t boot_profile_get_ms(boot_phase_t phase);
+
+/**
+ * Get a phase name ("nvs", "config", ...)
+ */
+const char *boot_profile_phase_name(boot_phase_t phase);
+
+#endif // BOOT_PROFILE_H
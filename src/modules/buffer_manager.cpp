@@ -1,24 +1,82 @@
 #include "buffer_manager.h"
+#include "audio_convert.h"
 #include "../config.h"
 #include "esp_log.h"
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
 #include <string.h>
+#include <atomic>
 
 static const char *TAG = "BUFFER_MANAGER";
 
 // Mutex timeout constant (5 seconds) to prevent deadlocks
 #define BUFFER_MUTEX_TIMEOUT_MS 5000
 
-static int16_t *ring_buffer = NULL; // ✅ CHANGED: Use int16_t for 50% memory savings
+// ✅ LOCK-FREE SPSC: exactly one producer (I2S reader) and one consumer (network sender).
+// write_pos is only advanced by the producer, read_pos only by the consumer. Both run
+// over [0, 2 * buffer_size_samples) so a full ring can be told apart from an empty one
+// without a shared counter, and the ring size does not need to be a power of two.
+static uint8_t *ring_buffer = NULL; // Byte storage, sample_bytes per sample
+static size_t buffer_capacity_bytes = 0;
 static size_t buffer_size_samples = 0;
-static size_t read_index = 0;
-static size_t write_index = 0;
-static size_t available_samples = 0;
-static SemaphoreHandle_t buffer_mutex = NULL;
-static bool overflow_occurred = false;
+static size_t sample_bytes = sizeof(int16_t); // 2, 3 (packed 24-bit) or 4
+static size_t frame_samples = 1;              // Channels; ring ops stay frame-aligned
+static std::atomic<size_t> write_pos(0);
+static std::atomic<size_t> read_pos(0);
+static std::atomic<bool> overflow_occurred(false);
+
+// Quiesce handshake for control operations (resize/reset) that swap the storage or move
+// both positions. The data path never waits on a lock: it announces itself in *_active
+// and backs off while its gate is set. The consumer is held first (consumer_hold) so a
+// slow network send never keeps capture waiting; quiesce_requested then holds the producer.
+static std::atomic<bool> quiesce_requested(false);
+static std::atomic<bool> consumer_hold(false);
+static std::atomic<bool> producer_active(false);
+static std::atomic<bool> consumer_active(false);
+static SemaphoreHandle_t control_mutex = NULL; // Serializes control operations only
+
+// ✅ EVENT-DRIVEN: the consumer arms a watermark and sleeps on its task notification;
+// the producer notifies once when the fill reaches it. 0 = nobody waiting.
+static std::atomic<TaskHandle_t> consumer_task(NULL);
+static std::atomic<size_t> wake_watermark(0);
+
+// Outstanding zero-copy windows (each owned by its side, no sharing)
+static size_t reserved_samples = 0;
+static size_t reserved_dropped = 0; // Samples the reservation could not take (overflow)
+static size_t peeked_samples = 0;
+
+// Overflow handling. Drop-oldest moves the read side forward from the producer when the
+// consumer is idle (claiming consumer_active), otherwise leaves a trim request that the
+// consumer applies as it releases its block. trim_fill is the fill to trim down to, + 1.
+static overflow_policy_t configured_policy = OVERFLOW_POLICY_DEFAULT;
+static std::atomic<uint8_t> drop_policy(OVERFLOW_POLICY_DEFAULT == OVERFLOW_POLICY_DROP_NEWEST
+                                            ? OVERFLOW_POLICY_DROP_NEWEST
+                                            : OVERFLOW_POLICY_DROP_OLDEST);
+static std::atomic<size_t> trim_fill(0);
+static std::atomic<uint64_t> dropped_oldest(0);
+static std::atomic<uint64_t> dropped_newest(0);
+static std::atomic<uint32_t> drop_events(0);
+
+// Capture marks: the producer periodically records which capture-stream sample and
+// capture time a ring position corresponds to; the consumer interpolates between
+// them. ring_total/read_total count samples that entered/left the ring, while
+// stream_total also counts samples dropped on overflow, so gaps stay visible.
+typedef struct
+{
+    uint64_t ring_index;
+    uint64_t stream_index;
+    int64_t capture_us;
+} capture_mark_t;
+
+static capture_mark_t capture_marks[BUFFER_CAPTURE_MARKS];
+static std::atomic<uint32_t> capture_mark_count(0); // Marks ever written (producer)
+static uint64_t ring_total = 0;                     // Producer-owned
+static uint64_t stream_total = 0;                   // Producer-owned
+static bool capture_gap = false;                    // Producer-owned: last block lost its tail
+static uint64_t read_total = 0;                     // Consumer-owned
 
 #if ADAPTIVE_BUFFERING_ENABLED
 // Adaptive buffering state
@@ -29,6 +87,10 @@ static uint32_t last_check_time = 0;
 static uint8_t usage_history[12]; // 1 minute of history (12 samples × 5 seconds)
 static uint8_t history_index = 0;
 static bool resize_in_progress = false;
+static uint32_t resize_last_us = 0;       // Whole resize, allocation to free
+static uint32_t resize_max_us = 0;
+static uint32_t resize_last_stall_us = 0; // Time the data path was held off
+static uint32_t resize_max_stall_us = 0;
 
 // Forward declarations for adaptive functions
 static bool buffer_manager_resize_internal(size_t new_size_bytes);
@@ -37,20 +99,339 @@ static bool should_resize_up(uint8_t current_usage, int8_t trend);
 static bool should_resize_down(uint8_t current_usage, int8_t trend);
 #endif
 
+// Byte address of a ring index
+static inline uint8_t *ring_ptr(size_t index)
+{
+    return ring_buffer + index * sample_bytes;
+}
+
+// Round a sample count down to whole frames (keeps stereo L/R pairs together)
+static inline size_t align_frames(size_t samples)
+{
+    return samples - (samples % frame_samples);
+}
+
+// Map a position in [0, 2N) to a ring index in [0, N)
+static inline size_t ring_index(size_t pos)
+{
+    return (pos >= buffer_size_samples) ? pos - buffer_size_samples : pos;
+}
+
+// Advance a position by count samples (count <= N), wrapping at 2N
+static inline size_t ring_advance(size_t pos, size_t count)
+{
+    pos += count;
+    if (pos >= 2 * buffer_size_samples)
+    {
+        pos -= 2 * buffer_size_samples;
+    }
+    return pos;
+}
+
+// Number of samples between read and write positions
+static inline size_t ring_fill(size_t wpos, size_t rpos)
+{
+    return (wpos >= rpos) ? wpos - rpos : wpos + 2 * buffer_size_samples - rpos;
+}
+
+// Describe count samples starting at pos as up to two contiguous spans
+static void ring_spans(size_t pos, size_t count, buffer_span_t *span)
+{
+    size_t index = ring_index(pos);
+    size_t chunk1 = count;
+    if (index + count > buffer_size_samples)
+    {
+        chunk1 = buffer_size_samples - index;
+    }
+
+    span->data[0] = ring_ptr(index);
+    span->samples[0] = chunk1;
+    span->data[1] = (chunk1 < count) ? ring_buffer : NULL;
+    span->samples[1] = count - chunk1;
+    span->sample_bytes = sample_bytes;
+}
+
+/**
+ * Record a capture mark for the samples about to be published (producer only).
+ * Marks are only taken every BUFFER_CAPTURE_MARK_SAMPLES or right after a drop
+ * (overflow cuts the tail of a block), so a small table spans the whole ring.
+ */
+static void capture_mark(size_t written, size_t dropped, int64_t capture_us)
+{
+    uint32_t count = capture_mark_count.load(std::memory_order_relaxed);
+    bool need_mark = (count == 0) || capture_gap;
+    if (!need_mark)
+    {
+        const capture_mark_t *last = &capture_marks[(count - 1) % BUFFER_CAPTURE_MARKS];
+        need_mark = (ring_total - last->ring_index) >= BUFFER_CAPTURE_MARK_SAMPLES;
+    }
+
+    if (need_mark && written > 0)
+    {
+        capture_mark_t *mark = &capture_marks[count % BUFFER_CAPTURE_MARKS];
+        mark->ring_index = ring_total;
+        mark->stream_index = stream_total;
+        mark->capture_us = capture_us;
+        // Published before write_pos so the consumer never sees samples without a mark
+        capture_mark_count.store(count + 1, std::memory_order_release);
+        capture_gap = false;
+    }
+
+    if (dropped > 0)
+    {
+        capture_gap = true;
+    }
+    ring_total += written;
+    stream_total += written + dropped;
+}
+
+/**
+ * Map a ring-stream position to its capture index and time (consumer only).
+ * Uses the newest mark at or before the position; the slope comes from the
+ * following mark, or the preceding one past the newest mark.
+ */
+static bool capture_lookup(uint64_t ring_index, uint64_t *stream_index, int64_t *capture_us)
+{
+    uint32_t count = capture_mark_count.load(std::memory_order_acquire);
+    if (count == 0)
+    {
+        return false;
+    }
+
+    // Keep clear of the slots the producer may be overwriting
+    uint32_t usable = (count < BUFFER_CAPTURE_MARKS - 4) ? count : BUFFER_CAPTURE_MARKS - 4;
+    uint32_t oldest = count - usable;
+    uint32_t found = oldest;
+    for (uint32_t i = count; i > oldest; i--)
+    {
+        if (capture_marks[(i - 1) % BUFFER_CAPTURE_MARKS].ring_index <= ring_index)
+        {
+            found = i - 1;
+            break;
+        }
+    }
+
+    const capture_mark_t *mark = &capture_marks[found % BUFFER_CAPTURE_MARKS];
+    const capture_mark_t *a = NULL;
+    const capture_mark_t *b = NULL;
+    if (found + 1 < count)
+    {
+        a = mark;
+        b = &capture_marks[(found + 1) % BUFFER_CAPTURE_MARKS];
+    }
+    else if (found > oldest)
+    {
+        a = &capture_marks[(found - 1) % BUFFER_CAPTURE_MARKS];
+        b = mark;
+    }
+
+    int64_t delta = (int64_t)(ring_index - mark->ring_index); // Negative before the oldest mark
+    int64_t us = mark->capture_us;
+    if (a != NULL && b->stream_index > a->stream_index)
+    {
+        us += (delta * (b->capture_us - a->capture_us)) / (int64_t)(b->stream_index - a->stream_index);
+    }
+
+    if (stream_index)
+    {
+        *stream_index = mark->stream_index + delta;
+    }
+    if (capture_us)
+    {
+        *capture_us = us;
+    }
+    return true;
+}
+
+/**
+ * Wake the waiting consumer once the ring holds its watermark (producer only).
+ * Called after publishing write_pos; costs one atomic load when nobody waits.
+ */
+static inline void notify_consumer(size_t wpos)
+{
+    size_t mark = wake_watermark.load(std::memory_order_acquire);
+    if (mark == 0)
+    {
+        return;
+    }
+
+    if (ring_fill(wpos, read_pos.load(std::memory_order_acquire)) >= mark &&
+        wake_watermark.exchange(0) != 0)
+    {
+        TaskHandle_t task = consumer_task.load(std::memory_order_acquire);
+        if (task != NULL)
+        {
+            xTaskNotifyGive(task);
+        }
+    }
+}
+
+/**
+ * Enter the data path as producer (gate = quiesce_requested) or consumer (gate = consumer_hold).
+ * Returns false if a control operation holds the ring longer than BUFFER_QUIESCE_TIMEOUT_MS.
+ */
+static bool data_path_enter(std::atomic<bool> &active, std::atomic<bool> &gate)
+{
+    uint32_t start = xTaskGetTickCount();
+
+    while (true)
+    {
+        // CAS: the producer briefly claims the consumer side to drop the oldest samples
+        bool idle = false;
+        if (active.compare_exchange_strong(idle, true))
+        {
+            if (!gate.load())
+            {
+                return true;
+            }
+
+            // Control operation pending: step aside so it can finish
+            active.store(false);
+        }
+
+        if ((xTaskGetTickCount() - start) > pdMS_TO_TICKS(BUFFER_QUIESCE_TIMEOUT_MS))
+        {
+            return false;
+        }
+        vTaskDelay(1);
+    }
+}
+
+static inline void data_path_leave(std::atomic<bool> &active)
+{
+    active.store(false);
+}
+
+// Move the read side forward so the fill is at most keep (caller owns the consumer side)
+static size_t trim_oldest(size_t rpos, size_t wpos, size_t keep)
+{
+    size_t fill = ring_fill(wpos, rpos);
+    if (fill <= keep)
+    {
+        return rpos;
+    }
+
+    size_t drop = fill - keep;
+    read_total += drop;
+    dropped_oldest.fetch_add(drop, std::memory_order_relaxed);
+    return ring_advance(rpos, drop);
+}
+
+/**
+ * Make room for a block that does not fit (producer only, inside the data path).
+ * Under drop-oldest the fill is cut to BUFFER_DROP_OLDEST_TARGET_PERCENT so the
+ * next blocks fit too, instead of clipping every block at the edge.
+ *
+ * @return Free space after any trimming
+ */
+static size_t make_room(size_t wpos, size_t rpos, size_t samples)
+{
+    size_t free_space = buffer_size_samples - ring_fill(wpos, rpos);
+    if (samples <= free_space)
+    {
+        return free_space;
+    }
+
+    overflow_occurred.store(true, std::memory_order_relaxed);
+    drop_events.fetch_add(1, std::memory_order_relaxed);
+    if (drop_policy.load(std::memory_order_relaxed) == OVERFLOW_POLICY_DROP_NEWEST)
+    {
+        return free_space;
+    }
+
+    size_t keep = align_frames((buffer_size_samples * BUFFER_DROP_OLDEST_TARGET_PERCENT) / 100);
+    size_t limit = (samples < buffer_size_samples) ? align_frames(buffer_size_samples - samples) : 0;
+    if (keep > limit)
+    {
+        keep = limit;
+    }
+
+    bool idle = false;
+    if (consumer_active.compare_exchange_strong(idle, true))
+    {
+        // Consumer is between blocks: drop the oldest samples right away
+        rpos = read_pos.load(std::memory_order_relaxed);
+        rpos = trim_oldest(rpos, wpos, keep);
+        read_pos.store(rpos, std::memory_order_release);
+        consumer_active.store(false);
+        return buffer_size_samples - ring_fill(wpos, rpos);
+    }
+
+    // Consumer holds a block: it trims when releasing it; this block loses its tail
+    trim_fill.store(keep + 1, std::memory_order_release);
+    return free_space;
+}
+
+// Release samples to the producer, applying a pending drop-oldest request (consumer only)
+static inline void consumer_release(size_t rpos, size_t samples)
+{
+    read_total += samples;
+    rpos = ring_advance(rpos, samples);
+
+    size_t keep = trim_fill.exchange(0, std::memory_order_acquire);
+    if (keep > 0)
+    {
+        rpos = trim_oldest(rpos, write_pos.load(std::memory_order_acquire), keep - 1);
+    }
+    read_pos.store(rpos, std::memory_order_release);
+}
+
+/**
+ * Stop the producer and consumer at their next entry and wait for both to leave.
+ * Caller must hold control_mutex.
+ */
+static bool quiesce_begin(uint32_t timeout_ms)
+{
+    uint32_t start = xTaskGetTickCount();
+
+    // Let the consumer finish its block while capture keeps running
+    consumer_hold.store(true);
+    while (consumer_active.load())
+    {
+        if ((xTaskGetTickCount() - start) > pdMS_TO_TICKS(timeout_ms))
+        {
+            consumer_hold.store(false);
+            return false;
+        }
+        vTaskDelay(1);
+    }
+
+    // Then the producer, whose sections are short (consumer_active may be its drop-oldest claim)
+    quiesce_requested.store(true);
+    while (producer_active.load() || consumer_active.load())
+    {
+        if ((xTaskGetTickCount() - start) > pdMS_TO_TICKS(timeout_ms))
+        {
+            quiesce_requested.store(false);
+            consumer_hold.store(false);
+            return false;
+        }
+        vTaskDelay(1);
+    }
+    return true;
+}
+
+static inline void quiesce_end(void)
+{
+    quiesce_requested.store(false);
+    consumer_hold.store(false);
+}
+
 bool buffer_manager_init(size_t size_bytes)
 {
-    // ✅ CHANGED: Calculate size for int16_t samples (2 bytes per sample)
-    buffer_size_samples = size_bytes / sizeof(int16_t);
+    // Capacity in whole frames of the configured sample format
+    buffer_capacity_bytes = size_bytes;
+    buffer_size_samples = align_frames(size_bytes / sample_bytes);
 
-    ESP_LOGI(TAG, "Initializing %d KB ring buffer (%d samples @ 16-bit)",
-             size_bytes / 1024, buffer_size_samples);
+    ESP_LOGI(TAG, "Initializing %d KB ring buffer (%d samples @ %d bytes, %d ch)",
+             size_bytes / 1024, buffer_size_samples, sample_bytes, frame_samples);
 
     // Try to allocate buffer in PSRAM first (if available)
-    ring_buffer = (int16_t *)heap_caps_malloc(size_bytes, MALLOC_CAP_SPIRAM);
+    ring_buffer = (uint8_t *)heap_caps_aligned_alloc(16, size_bytes, MALLOC_CAP_SPIRAM); // 16-byte aligned for SIMD kernels
     if (ring_buffer == NULL)
     {
         // PSRAM not available, use internal SRAM
-        ring_buffer = (int16_t *)malloc(size_bytes);
+        ring_buffer = (uint8_t *)malloc(size_bytes);
         if (ring_buffer == NULL)
         {
             ESP_LOGE(TAG, "Failed to allocate ring buffer");
@@ -63,80 +444,135 @@ bool buffer_manager_init(size_t size_bytes)
         ESP_LOGI(TAG, "Ring buffer allocated in PSRAM");
     }
 
-    // Create mutex for thread-safe access
-    buffer_mutex = xSemaphoreCreateMutex();
-    if (buffer_mutex == NULL)
+    // Mutex only guards control operations; the audio data path is lock-free
+    control_mutex = xSemaphoreCreateMutex();
+    if (control_mutex == NULL)
     {
-        ESP_LOGE(TAG, "Failed to create buffer mutex");
+        ESP_LOGE(TAG, "Failed to create buffer control mutex");
         free(ring_buffer);
         ring_buffer = NULL;
         return false;
     }
 
-    // Initialize indices
-    read_index = 0;
-    write_index = 0;
-    available_samples = 0;
-    overflow_occurred = false;
+    // Initialize positions
+    write_pos.store(0);
+    read_pos.store(0);
+    overflow_occurred.store(false);
+    quiesce_requested.store(false);
+    consumer_hold.store(false);
+    producer_active.store(false);
+    consumer_active.store(false);
 
-    ESP_LOGI(TAG, "Buffer manager initialized successfully");
+    ESP_LOGI(TAG, "Buffer manager initialized successfully (lock-free SPSC)");
     return true;
 }
 
+bool buffer_manager_set_format(size_t bytes_per_sample, size_t channels)
+{
+    if (bytes_per_sample < 2 || bytes_per_sample > 4 || channels < 1 || channels > 2)
+    {
+        ESP_LOGE(TAG, "Invalid ring format: %d bytes/sample, %d channels", bytes_per_sample, channels);
+        return false;
+    }
+
+    if (ring_buffer == NULL)
+    {
+        // Not allocated yet: takes effect in buffer_manager_init()
+        sample_bytes = bytes_per_sample;
+        frame_samples = channels;
+        return true;
+    }
+
+    if (xSemaphoreTake(control_mutex, pdMS_TO_TICKS(BUFFER_MUTEX_TIMEOUT_MS)) != pdTRUE)
+    {
+        ESP_LOGE(TAG, "Mutex timeout in set_format");
+        return false;
+    }
+
+    if (!quiesce_begin(BUFFER_QUIESCE_TIMEOUT_MS))
+    {
+        ESP_LOGE(TAG, "Quiesce timeout in set_format");
+        xSemaphoreGive(control_mutex);
+        return false;
+    }
+
+    // Buffered audio is in the old format, so it is discarded
+    sample_bytes = bytes_per_sample;
+    frame_samples = channels;
+    buffer_size_samples = align_frames(buffer_capacity_bytes / sample_bytes);
+    read_pos.store(0);
+    write_pos.store(0);
+    read_total = ring_total;
+    trim_fill.store(0);
+
+    quiesce_end();
+    xSemaphoreGive(control_mutex);
+
+    ESP_LOGI(TAG, "Ring format changed: %d bytes/sample, %d ch (%d samples)",
+             sample_bytes, frame_samples, buffer_size_samples);
+    return true;
+}
+
+size_t buffer_manager_get_sample_bytes(void)
+{
+    return sample_bytes;
+}
+
 // ✅ NEW: Native 16-bit write function
 size_t buffer_manager_write_16(const int16_t *data, size_t samples)
 {
-    if (ring_buffer == NULL || data == NULL || samples == 0)
+    if (data == NULL || samples == 0)
     {
         return 0;
     }
 
-    if (xSemaphoreTake(buffer_mutex, pdMS_TO_TICKS(5000)) != pdTRUE)
+    // ring_buffer may only be inspected once inside the data path
+    if (!data_path_enter(producer_active, quiesce_requested))
     {
-        ESP_LOGE(TAG, "CRITICAL: Mutex timeout in write");
         return 0;
     }
+    if (ring_buffer == NULL || sample_bytes != sizeof(int16_t))
+    {
+        data_path_leave(producer_active);
+        return 0; // 16-bit interface needs the 16-bit ring format
+    }
 
-    size_t free_space = buffer_size_samples - available_samples;
+    size_t wpos = write_pos.load(std::memory_order_relaxed);
+    size_t rpos = read_pos.load(std::memory_order_acquire);
+    size_t free_space = make_room(wpos, rpos, samples);
     size_t samples_to_write = samples;
 
-    // Check for overflow
+    // Check for overflow (logged by the caller, not here on the audio core)
     if (samples_to_write > free_space)
     {
-        ESP_LOGW(TAG, "Buffer overflow! Requested: %d, Available: %d", samples_to_write, free_space);
-        samples_to_write = free_space;
-        overflow_occurred = true;
+        samples_to_write = align_frames(free_space);
+        dropped_newest.fetch_add(samples - samples_to_write, std::memory_order_relaxed);
     }
 
     // ✅ OPTIMIZED: Write samples using memcpy (3-5× faster than loop)
+    size_t index = ring_index(wpos);
     size_t chunk1 = samples_to_write;
-    if (write_index + samples_to_write > buffer_size_samples)
+    if (index + samples_to_write > buffer_size_samples)
     {
-        chunk1 = buffer_size_samples - write_index;
+        chunk1 = buffer_size_samples - index;
     }
 
     // Copy first chunk (up to end of buffer)
-    memcpy(&ring_buffer[write_index], data, chunk1 * sizeof(int16_t));
+    memcpy(ring_ptr(index), data, chunk1 * sizeof(int16_t));
 
     // Copy second chunk if wrapping around
     if (chunk1 < samples_to_write)
     {
-        size_t chunk2 = samples_to_write - chunk1;
-        memcpy(&ring_buffer[0], &data[chunk1], chunk2 * sizeof(int16_t));
-        write_index = chunk2;
-    }
-    else
-    {
-        write_index += chunk1;
-        if (write_index >= buffer_size_samples)
-        {
-            write_index = 0;
-        }
+        memcpy(ring_buffer, &data[chunk1], (samples_to_write - chunk1) * sizeof(int16_t));
     }
 
-    available_samples += samples_to_write;
+    // Publish samples to the consumer
+    capture_mark(samples_to_write, samples - samples_to_write, esp_timer_get_time());
+    wpos = ring_advance(wpos, samples_to_write);
+    write_pos.store(wpos, std::memory_order_release);
 
-    xSemaphoreGive(buffer_mutex);
+    data_path_leave(producer_active);
+    notify_consumer(wpos);
 
     return samples_to_write;
 }
@@ -144,64 +580,54 @@ size_t buffer_manager_write_16(const int16_t *data, size_t samples)
 // ✅ LEGACY: 32-bit write function (converts to 16-bit)
 size_t buffer_manager_write(const int32_t *data, size_t samples)
 {
-    if (ring_buffer == NULL || data == NULL || samples == 0)
+    if (data == NULL || samples == 0)
     {
         return 0;
     }
 
-    // ✅ Add timeout instead of blocking forever
-    if (xSemaphoreTake(buffer_mutex, pdMS_TO_TICKS(5000)) != pdTRUE)
+    // ring_buffer may only be inspected once inside the data path
+    if (!data_path_enter(producer_active, quiesce_requested))
     {
-        ESP_LOGE(TAG, "CRITICAL: Mutex timeout in write");
-        return 0; // Or trigger recovery
+        return 0;
+    }
+    if (ring_buffer == NULL || sample_bytes != sizeof(int16_t))
+    {
+        data_path_leave(producer_active);
+        return 0; // 16-bit interface needs the 16-bit ring format
     }
 
-    size_t free_space = buffer_size_samples - available_samples;
+    size_t wpos = write_pos.load(std::memory_order_relaxed);
+    size_t rpos = read_pos.load(std::memory_order_acquire);
+    size_t free_space = make_room(wpos, rpos, samples);
     size_t samples_to_write = samples;
 
     // Check for overflow
     if (samples_to_write > free_space)
     {
-        ESP_LOGW(TAG, "Buffer overflow! Requested: %d, Available: %d", samples_to_write, free_space);
-        samples_to_write = free_space;
-        overflow_occurred = true;
+        samples_to_write = align_frames(free_space);
+        dropped_newest.fetch_add(samples - samples_to_write, std::memory_order_relaxed);
     }
 
-    // ✅ OPTIMIZED: Write samples using memcpy (3-5× faster than loop)
+    size_t index = ring_index(wpos);
     size_t chunk1 = samples_to_write;
-    if (write_index + samples_to_write > buffer_size_samples)
+    if (index + samples_to_write > buffer_size_samples)
     {
-        chunk1 = buffer_size_samples - write_index;
+        chunk1 = buffer_size_samples - index;
     }
 
     // Copy first chunk (up to end of buffer), converting 32→16 bit
-    for (size_t i = 0; i < chunk1; i++)
-    {
-        ring_buffer[write_index + i] = (int16_t)(data[i] >> 16);
-    }
+    int16_t *ring16 = (int16_t *)ring_buffer;
+    audio_convert_to_16(data, &ring16[index], chunk1);
 
     // Copy second chunk if wrapping around
-    if (chunk1 < samples_to_write)
-    {
-        size_t chunk2 = samples_to_write - chunk1;
-        for (size_t i = 0; i < chunk2; i++)
-        {
-            ring_buffer[i] = (int16_t)(data[chunk1 + i] >> 16);
-        }
-        write_index = chunk2;
-    }
-    else
-    {
-        write_index += chunk1;
-        if (write_index >= buffer_size_samples)
-        {
-            write_index = 0;
-        }
-    }
+    audio_convert_to_16(&data[chunk1], ring16, samples_to_write - chunk1);
 
-    available_samples += samples_to_write;
+    capture_mark(samples_to_write, samples - samples_to_write, esp_timer_get_time());
+    wpos = ring_advance(wpos, samples_to_write);
+    write_pos.store(wpos, std::memory_order_release);
 
-    xSemaphoreGive(buffer_mutex);
+    data_path_leave(producer_active);
+    notify_consumer(wpos);
 
     return samples_to_write;
 }
@@ -209,48 +635,48 @@ size_t buffer_manager_write(const int32_t *data, size_t samples)
 // ✅ NEW: Native 16-bit read function
 size_t buffer_manager_read_16(int16_t *data, size_t samples)
 {
-    if (ring_buffer == NULL || data == NULL || samples == 0)
+    if (data == NULL || samples == 0)
     {
         return 0;
     }
 
-    if (xSemaphoreTake(buffer_mutex, pdMS_TO_TICKS(BUFFER_MUTEX_TIMEOUT_MS)) != pdTRUE)
+    // ring_buffer may only be inspected once inside the data path
+    if (!data_path_enter(consumer_active, consumer_hold))
     {
-        ESP_LOGE(TAG, "Mutex timeout in read");
         return 0;
     }
+    if (ring_buffer == NULL || sample_bytes != sizeof(int16_t))
+    {
+        data_path_leave(consumer_active);
+        return 0; // 16-bit interface needs the 16-bit ring format
+    }
 
-    size_t samples_to_read = (samples > available_samples) ? available_samples : samples;
+    size_t rpos = read_pos.load(std::memory_order_relaxed);
+    size_t wpos = write_pos.load(std::memory_order_acquire);
+    size_t available = ring_fill(wpos, rpos);
+    size_t samples_to_read = (samples > available) ? available : samples;
 
     // ✅ OPTIMIZED: Read samples using memcpy (3-5× faster than loop)
+    size_t index = ring_index(rpos);
     size_t chunk1 = samples_to_read;
-    if (read_index + samples_to_read > buffer_size_samples)
+    if (index + samples_to_read > buffer_size_samples)
     {
-        chunk1 = buffer_size_samples - read_index;
+        chunk1 = buffer_size_samples - index;
     }
 
     // Copy first chunk (up to end of buffer)
-    memcpy(data, &ring_buffer[read_index], chunk1 * sizeof(int16_t));
+    memcpy(data, ring_ptr(index), chunk1 * sizeof(int16_t));
 
     // Copy second chunk if wrapping around
     if (chunk1 < samples_to_read)
     {
-        size_t chunk2 = samples_to_read - chunk1;
-        memcpy(&data[chunk1], &ring_buffer[0], chunk2 * sizeof(int16_t));
-        read_index = chunk2;
-    }
-    else
-    {
-        read_index += chunk1;
-        if (read_index >= buffer_size_samples)
-        {
-            read_index = 0;
-        }
+        memcpy(&data[chunk1], ring_buffer, (samples_to_read - chunk1) * sizeof(int16_t));
     }
 
-    available_samples -= samples_to_read;
+    // Hand the space back to the producer
+    consumer_release(rpos, samples_to_read);
 
-    xSemaphoreGive(buffer_mutex);
+    data_path_leave(consumer_active);
 
     return samples_to_read;
 }
@@ -258,128 +684,325 @@ size_t buffer_manager_read_16(int16_t *data, size_t samples)
 // ✅ LEGACY: 32-bit read function (converts from 16-bit)
 size_t buffer_manager_read(int32_t *data, size_t samples)
 {
-    if (ring_buffer == NULL || data == NULL || samples == 0)
+    if (data == NULL || samples == 0)
     {
         return 0;
     }
 
-    if (xSemaphoreTake(buffer_mutex, pdMS_TO_TICKS(BUFFER_MUTEX_TIMEOUT_MS)) != pdTRUE)
+    // ring_buffer may only be inspected once inside the data path
+    if (!data_path_enter(consumer_active, consumer_hold))
     {
-        ESP_LOGE(TAG, "Mutex timeout in read");
         return 0;
     }
+    if (ring_buffer == NULL || sample_bytes != sizeof(int16_t))
+    {
+        data_path_leave(consumer_active);
+        return 0; // 16-bit interface needs the 16-bit ring format
+    }
 
-    size_t samples_to_read = (samples > available_samples) ? available_samples : samples;
+    size_t rpos = read_pos.load(std::memory_order_relaxed);
+    size_t wpos = write_pos.load(std::memory_order_acquire);
+    size_t available = ring_fill(wpos, rpos);
+    size_t samples_to_read = (samples > available) ? available : samples;
 
-    // ✅ OPTIMIZED: Read samples using memcpy (3-5× faster than loop)
+    size_t index = ring_index(rpos);
     size_t chunk1 = samples_to_read;
-    if (read_index + samples_to_read > buffer_size_samples)
+    if (index + samples_to_read > buffer_size_samples)
     {
-        chunk1 = buffer_size_samples - read_index;
+        chunk1 = buffer_size_samples - index;
     }
 
     // Copy first chunk (up to end of buffer), converting 16→32 bit
+    const int16_t *ring16 = (const int16_t *)ring_buffer;
     for (size_t i = 0; i < chunk1; i++)
     {
-        data[i] = (int32_t)ring_buffer[read_index + i] << 16;
+        data[i] = (int32_t)ring16[index + i] << 16;
     }
 
     // Copy second chunk if wrapping around
-    if (chunk1 < samples_to_read)
+    for (size_t i = 0; i < samples_to_read - chunk1; i++)
     {
-        size_t chunk2 = samples_to_read - chunk1;
-        for (size_t i = 0; i < chunk2; i++)
-        {
-            data[chunk1 + i] = (int32_t)ring_buffer[i] << 16;
-        }
-        read_index = chunk2;
+        data[chunk1 + i] = (int32_t)ring16[i] << 16;
     }
-    else
+
+    consumer_release(rpos, samples_to_read);
+
+    data_path_leave(consumer_active);
+
+    return samples_to_read;
+}
+
+// ✅ ZERO-COPY: Producer reserves ring space, fills it in place, then publishes it
+size_t buffer_manager_reserve_write(size_t samples, buffer_span_t *span)
+{
+    if (span == NULL)
     {
-        read_index += chunk1;
-        if (read_index >= buffer_size_samples)
-        {
-            read_index = 0;
-        }
+        return 0;
+    }
+    memset(span, 0, sizeof(*span));
+    if (samples == 0)
+    {
+        return 0;
     }
 
-    available_samples -= samples_to_read;
+    if (!data_path_enter(producer_active, quiesce_requested))
+    {
+        return 0;
+    }
+    if (ring_buffer == NULL)
+    {
+        data_path_leave(producer_active);
+        return 0;
+    }
 
-    xSemaphoreGive(buffer_mutex);
+    size_t wpos = write_pos.load(std::memory_order_relaxed);
+    size_t rpos = read_pos.load(std::memory_order_acquire);
+    size_t free_space = make_room(wpos, rpos, samples);
+    size_t samples_to_reserve = samples;
 
-    return samples_to_read;
+    if (samples_to_reserve > free_space)
+    {
+        samples_to_reserve = align_frames(free_space);
+        dropped_newest.fetch_add(samples - samples_to_reserve, std::memory_order_relaxed);
+    }
+
+    if (samples_to_reserve == 0)
+    {
+        capture_mark(0, samples, 0); // Whole block dropped
+        data_path_leave(producer_active);
+        return 0;
+    }
+
+    // Stay inside the data path until commit_write()
+    ring_spans(wpos, samples_to_reserve, span);
+    reserved_samples = samples_to_reserve;
+    reserved_dropped = samples - samples_to_reserve;
+    return samples_to_reserve;
+}
+
+void buffer_manager_commit_write(size_t samples)
+{
+    buffer_manager_commit_write_at(samples, esp_timer_get_time());
+}
+
+void buffer_manager_commit_write_at(size_t samples, int64_t capture_us)
+{
+    if (reserved_samples == 0)
+    {
+        return; // No outstanding reservation
+    }
+
+    if (samples > reserved_samples)
+    {
+        samples = reserved_samples;
+    }
+    reserved_samples = 0;
+
+    capture_mark(samples, reserved_dropped, capture_us);
+    reserved_dropped = 0;
+
+    size_t wpos = ring_advance(write_pos.load(std::memory_order_relaxed), samples);
+    write_pos.store(wpos, std::memory_order_release);
+
+    data_path_leave(producer_active);
+    notify_consumer(wpos);
+}
+
+// ✅ ZERO-COPY: Consumer borrows readable spans, then releases them
+size_t buffer_manager_peek_read(size_t samples, buffer_span_t *span)
+{
+    if (span == NULL)
+    {
+        return 0;
+    }
+    memset(span, 0, sizeof(*span));
+    if (samples == 0)
+    {
+        return 0;
+    }
+
+    if (!data_path_enter(consumer_active, consumer_hold))
+    {
+        return 0;
+    }
+    if (ring_buffer == NULL)
+    {
+        data_path_leave(consumer_active);
+        return 0;
+    }
+
+    size_t rpos = read_pos.load(std::memory_order_relaxed);
+    size_t wpos = write_pos.load(std::memory_order_acquire);
+    size_t available = ring_fill(wpos, rpos);
+    size_t samples_to_peek = align_frames((samples > available) ? available : samples);
+
+    if (samples_to_peek == 0)
+    {
+        data_path_leave(consumer_active);
+        return 0;
+    }
+
+    // Stay inside the data path until consume_read()
+    ring_spans(rpos, samples_to_peek, span);
+    capture_lookup(read_total, &span->sample_index, &span->capture_us);
+    peeked_samples = samples_to_peek;
+    return samples_to_peek;
+}
+
+bool buffer_manager_peek_capture(size_t offset, uint64_t *sample_index, int64_t *capture_us)
+{
+    return capture_lookup(read_total + offset, sample_index, capture_us);
+}
+
+uint64_t buffer_manager_stream_index(void)
+{
+    return stream_total;
+}
+
+void buffer_manager_consume_read(size_t samples)
+{
+    if (peeked_samples == 0)
+    {
+        return; // No outstanding peek
+    }
+
+    if (samples > peeked_samples)
+    {
+        samples = peeked_samples;
+    }
+    peeked_samples = 0;
+
+    consumer_release(read_pos.load(std::memory_order_relaxed), samples);
+
+    data_path_leave(consumer_active);
 }
 
 size_t buffer_manager_available(void)
 {
-    if (xSemaphoreTake(buffer_mutex, pdMS_TO_TICKS(BUFFER_MUTEX_TIMEOUT_MS)) != pdTRUE)
+    if (ring_buffer == NULL)
     {
-        ESP_LOGE(TAG, "Mutex timeout in available");
         return 0;
     }
-    size_t avail = available_samples;
-    xSemaphoreGive(buffer_mutex);
-    return avail;
+    return ring_fill(write_pos.load(std::memory_order_acquire),
+                     read_pos.load(std::memory_order_acquire));
+}
+
+size_t buffer_manager_wait_available(size_t samples, uint32_t timeout_ms)
+{
+    size_t available = buffer_manager_available();
+    if (available >= samples || ring_buffer == NULL)
+    {
+        return available;
+    }
+
+    // A watermark above capacity would never trigger
+    if (samples > buffer_size_samples)
+    {
+        samples = buffer_size_samples;
+    }
+
+    consumer_task.store(xTaskGetCurrentTaskHandle(), std::memory_order_release);
+    ulTaskNotifyTake(pdTRUE, 0); // Drop a stale wake from an earlier wait
+    wake_watermark.store(samples, std::memory_order_release);
+
+    // Re-check after arming so a write between the first check and now is not missed
+    available = buffer_manager_available();
+    if (available < samples)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms));
+        available = buffer_manager_available();
+    }
+
+    wake_watermark.store(0, std::memory_order_release);
+    return available;
 }
 
 size_t buffer_manager_free_space(void)
 {
-    if (xSemaphoreTake(buffer_mutex, pdMS_TO_TICKS(BUFFER_MUTEX_TIMEOUT_MS)) != pdTRUE)
+    if (ring_buffer == NULL)
     {
-        ESP_LOGE(TAG, "Mutex timeout in free_space");
         return 0;
     }
-    size_t free_space = buffer_size_samples - available_samples;
-    xSemaphoreGive(buffer_mutex);
-    return free_space;
+    return buffer_size_samples - buffer_manager_available();
 }
 
 uint8_t buffer_manager_usage_percent(void)
 {
-    if (xSemaphoreTake(buffer_mutex, pdMS_TO_TICKS(BUFFER_MUTEX_TIMEOUT_MS)) != pdTRUE)
+    if (ring_buffer == NULL || buffer_size_samples == 0)
     {
-        ESP_LOGE(TAG, "Mutex timeout in usage_percent");
         return 0;
     }
-    uint8_t usage = (available_samples * 100) / buffer_size_samples;
-    xSemaphoreGive(buffer_mutex);
-    return usage;
+    return (buffer_manager_available() * 100) / buffer_size_samples;
 }
 
 bool buffer_manager_check_overflow(void)
 {
-    if (xSemaphoreTake(buffer_mutex, pdMS_TO_TICKS(BUFFER_MUTEX_TIMEOUT_MS)) != pdTRUE)
-    {
-        ESP_LOGE(TAG, "Mutex timeout in check_overflow");
-        return false;
-    }
-    bool overflow = overflow_occurred;
-    overflow_occurred = false; // Reset flag after reading
-    xSemaphoreGive(buffer_mutex);
-    return overflow;
+    // Reset flag after reading
+    return overflow_occurred.exchange(false);
+}
+
+void buffer_manager_set_overflow_policy(overflow_policy_t policy)
+{
+    configured_policy = policy;
+
+    // Degrade is decided by the application; the ring keeps the freshest audio meanwhile
+    drop_policy.store((policy == OVERFLOW_POLICY_DROP_NEWEST) ? OVERFLOW_POLICY_DROP_NEWEST
+                                                               : OVERFLOW_POLICY_DROP_OLDEST);
+    trim_fill.store(0);
+}
+
+overflow_policy_t buffer_manager_get_overflow_policy(void)
+{
+    return configured_policy;
+}
+
+void buffer_manager_get_drop_stats(uint64_t *oldest_samples, uint64_t *newest_samples, uint32_t *events)
+{
+    if (oldest_samples)
+        *oldest_samples = dropped_oldest.load(std::memory_order_relaxed);
+    if (newest_samples)
+        *newest_samples = dropped_newest.load(std::memory_order_relaxed);
+    if (events)
+        *events = drop_events.load(std::memory_order_relaxed);
 }
 
 void buffer_manager_reset(void)
 {
-    if (xSemaphoreTake(buffer_mutex, pdMS_TO_TICKS(BUFFER_MUTEX_TIMEOUT_MS)) != pdTRUE)
+    if (control_mutex == NULL)
+    {
+        return;
+    }
+
+    if (xSemaphoreTake(control_mutex, pdMS_TO_TICKS(BUFFER_MUTEX_TIMEOUT_MS)) != pdTRUE)
     {
         ESP_LOGE(TAG, "Mutex timeout in reset");
         return;
     }
-    read_index = 0;
-    write_index = 0;
-    available_samples = 0;
-    overflow_occurred = false;
-    xSemaphoreGive(buffer_mutex);
+
+    if (!quiesce_begin(BUFFER_QUIESCE_TIMEOUT_MS))
+    {
+        ESP_LOGE(TAG, "Quiesce timeout in reset");
+        xSemaphoreGive(control_mutex);
+        return;
+    }
+
+    read_pos.store(0);
+    write_pos.store(0);
+    read_total = ring_total; // Discarded samples count as consumed
+    trim_fill.store(0);
+    overflow_occurred.store(false);
+
+    quiesce_end();
+    xSemaphoreGive(control_mutex);
     ESP_LOGI(TAG, "Buffer reset");
 }
 
 void buffer_manager_deinit(void)
 {
-    if (buffer_mutex != NULL)
+    if (control_mutex != NULL)
     {
-        vSemaphoreDelete(buffer_mutex);
-        buffer_mutex = NULL;
+        vSemaphoreDelete(control_mutex);
+        control_mutex = NULL;
     }
 
     if (ring_buffer != NULL)
@@ -401,6 +1024,10 @@ bool buffer_manager_adaptive_init(void)
     history_index = 0;
     resize_count = 0;
     last_resize_time = 0;
+    resize_last_us = 0;
+    resize_max_us = 0;
+    resize_last_stall_us = 0;
+    resize_max_stall_us = 0;
     last_check_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
     resize_in_progress = false;
 
@@ -442,7 +1069,7 @@ void buffer_manager_adaptive_check(void)
     }
 
     // Determine if resize is needed
-    size_t current_size = buffer_size_samples * sizeof(int16_t);
+    size_t current_size = buffer_size_samples * sample_bytes;
     size_t new_size = current_size;
 
     if (should_resize_up(current_usage, trend))
@@ -461,7 +1088,6 @@ void buffer_manager_adaptive_check(void)
 
             if (buffer_manager_resize_internal(new_size))
             {
-                resize_count++;
                 last_resize_time = current_time;
             }
         }
@@ -482,7 +1108,6 @@ void buffer_manager_adaptive_check(void)
 
             if (buffer_manager_resize_internal(new_size))
             {
-                resize_count++;
                 last_resize_time = current_time;
             }
         }
@@ -493,13 +1118,26 @@ void buffer_manager_adaptive_get_stats(size_t *current_size, uint32_t *resize_cn
                                      uint32_t *last_resize_time_ms)
 {
     if (current_size)
-        *current_size = buffer_size_samples * sizeof(int16_t);
+        *current_size = buffer_size_samples * sample_bytes;
     if (resize_cnt)
         *resize_cnt = resize_count;
     if (last_resize_time_ms)
         *last_resize_time_ms = last_resize_time;
 }
 
+void buffer_manager_adaptive_get_resize_timing(uint32_t *last_us, uint32_t *max_us,
+                                               uint32_t *last_stall_us, uint32_t *max_stall_us)
+{
+    if (last_us)
+        *last_us = resize_last_us;
+    if (max_us)
+        *max_us = resize_max_us;
+    if (last_stall_us)
+        *last_stall_us = resize_last_stall_us;
+    if (max_stall_us)
+        *max_stall_us = resize_max_stall_us;
+}
+
 bool buffer_manager_adaptive_set_size(size_t new_size_bytes)
 {
     if (new_size_bytes < ADAPTIVE_BUFFER_MIN_SIZE || new_size_bytes > ADAPTIVE_BUFFER_MAX_SIZE)
@@ -524,37 +1162,83 @@ bool buffer_manager_adaptive_is_enabled(void)
 }
 
 // Static helper functions
+
+/**
+ * Copy count samples from the live ring, starting at ring position pos, into
+ * new_buffer laid out by absolute ring-stream index (abs mod new_samples).
+ * Both rings may wrap, so this is up to four memcpy calls.
+ */
+static void resize_copy(uint8_t *new_buffer, size_t new_samples, size_t pos, uint64_t abs_index,
+                        size_t count)
+{
+    while (count > 0)
+    {
+        size_t src = ring_index(pos);
+        size_t dst = (size_t)(abs_index % new_samples);
+        size_t chunk = count;
+        if (chunk > buffer_size_samples - src)
+        {
+            chunk = buffer_size_samples - src;
+        }
+        if (chunk > new_samples - dst)
+        {
+            chunk = new_samples - dst;
+        }
+
+        memcpy(new_buffer + dst * sample_bytes, ring_ptr(src), chunk * sample_bytes);
+        pos = ring_advance(pos, chunk);
+        abs_index += chunk;
+        count -= chunk;
+    }
+}
+
+/**
+ * ✅ NON-BLOCKING RESIZE: double-buffer handover without a bulk copy under quiesce.
+ *
+ * 1. Brief quiesce to snapshot positions and stream counters consistently.
+ * 2. Copy the buffered window into the new buffer while the I2S reader and the
+ *    network sender keep running. Readable samples are never overwritten by
+ *    the producer, so the copy stays valid; samples consumed meanwhile are
+ *    simply not carried over.
+ * 3. Brief quiesce to copy only what was written during step 2 and swap.
+ *
+ * The new ring is laid out by absolute stream index (ring_total), so samples
+ * copied in step 2 are already in place regardless of how far either side
+ * moved. Each quiesce covers a few ms of audio at most, well inside the DMA
+ * depth, instead of a full-buffer memcpy.
+ */
 static bool buffer_manager_resize_internal(size_t new_size_bytes)
 {
-    if (resize_in_progress)
+    if (xSemaphoreTake(control_mutex, pdMS_TO_TICKS(10000)) != pdTRUE)
     {
-        ESP_LOGW(TAG, "Resize already in progress");
+        ESP_LOGE(TAG, "Failed to acquire mutex for resize");
         return false;
     }
 
-    resize_in_progress = true;
-
-    if (xSemaphoreTake(buffer_mutex, pdMS_TO_TICKS(10000)) != pdTRUE)
+    if (resize_in_progress)
     {
-        ESP_LOGE(TAG, "Failed to acquire mutex for resize");
-        resize_in_progress = false;
+        ESP_LOGW(TAG, "Resize already in progress");
+        xSemaphoreGive(control_mutex);
         return false;
     }
 
-    // Allocate new buffer
-    int16_t *new_buffer = NULL;
+    resize_in_progress = true;
+    int64_t resize_start_us = esp_timer_get_time();
+
+    // Allocate new buffer before touching the data path
+    uint8_t *new_buffer = NULL;
 
     // Try PSRAM first
-    new_buffer = (int16_t *)heap_caps_malloc(new_size_bytes, MALLOC_CAP_SPIRAM);
+    new_buffer = (uint8_t *)heap_caps_aligned_alloc(16, new_size_bytes, MALLOC_CAP_SPIRAM);
     if (new_buffer == NULL)
     {
         // Fall back to internal SRAM
-        new_buffer = (int16_t *)malloc(new_size_bytes);
+        new_buffer = (uint8_t *)malloc(new_size_bytes);
         if (new_buffer == NULL)
         {
             ESP_LOGE(TAG, "Failed to allocate new buffer for resize");
-            xSemaphoreGive(buffer_mutex);
             resize_in_progress = false;
+            xSemaphoreGive(control_mutex);
             return false;
         }
         ESP_LOGI(TAG, "New buffer allocated in internal SRAM");
@@ -564,51 +1248,74 @@ static bool buffer_manager_resize_internal(size_t new_size_bytes)
         ESP_LOGI(TAG, "New buffer allocated in PSRAM");
     }
 
-    size_t new_size_samples = new_size_bytes / sizeof(int16_t);
-    size_t samples_to_copy = available_samples;
-    size_t samples_lost = 0;
+    size_t new_size_samples = align_frames(new_size_bytes / sample_bytes);
 
-    if (samples_to_copy > new_size_samples)
+    // Step 1: consistent snapshot (no copying)
+    int64_t stall_start_us = esp_timer_get_time();
+    if (!quiesce_begin(BUFFER_QUIESCE_TIMEOUT_MS))
     {
-        // New buffer is smaller, we'll lose some data
-        samples_lost = samples_to_copy - new_size_samples;
-        samples_to_copy = new_size_samples;
-
-        // Discard oldest samples (from read position)
-        read_index = (read_index + samples_lost) % buffer_size_samples;
-        available_samples = samples_to_copy;
-
-        ESP_LOGW(TAG, "Lost %d samples due to buffer shrinkage", samples_lost);
+        ESP_LOGE(TAG, "Quiesce timeout, resize aborted");
+        free(new_buffer);
+        resize_in_progress = false;
+        xSemaphoreGive(control_mutex);
+        return false;
+    }
+    size_t snap_rpos = read_pos.load();
+    uint64_t snap_read_total = read_total;
+    uint64_t snap_ring_total = ring_total;
+    quiesce_end();
+    int64_t stall_us = esp_timer_get_time() - stall_start_us;
+
+    // Step 2: pre-copy the newest window that fits, with the data path running
+    uint64_t copy_lo = snap_read_total;
+    if (snap_ring_total - copy_lo > new_size_samples)
+    {
+        copy_lo = snap_ring_total - new_size_samples; // Shrinking: oldest samples won't fit
     }
+    resize_copy(new_buffer, new_size_samples, ring_advance(snap_rpos, (size_t)(copy_lo - snap_read_total)),
+                copy_lo, (size_t)(snap_ring_total - copy_lo));
 
-    // Copy data to new buffer
-    if (samples_to_copy > 0)
+    // Step 3: catch up on samples written during the pre-copy, then swap
+    stall_start_us = esp_timer_get_time();
+    if (!quiesce_begin(BUFFER_QUIESCE_TIMEOUT_MS))
     {
-        size_t chunk1 = samples_to_copy;
-        if (read_index + samples_to_copy > buffer_size_samples)
-        {
-            chunk1 = buffer_size_samples - read_index;
-        }
+        ESP_LOGE(TAG, "Quiesce timeout, resize aborted");
+        free(new_buffer);
+        resize_in_progress = false;
+        xSemaphoreGive(control_mutex);
+        return false;
+    }
 
-        // Copy first chunk
-        memcpy(new_buffer, &ring_buffer[read_index], chunk1 * sizeof(int16_t));
+    size_t rpos = read_pos.load();
+    uint64_t lo = read_total;
+    uint64_t hi = ring_total;
+    size_t samples_lost = 0;
+    if (hi - lo > new_size_samples)
+    {
+        // New buffer is smaller, discard oldest samples (from read position)
+        samples_lost = (size_t)(hi - lo - new_size_samples);
+        lo = hi - new_size_samples;
+    }
 
-        // Copy second chunk if wrapping
-        if (chunk1 < samples_to_copy)
-        {
-            size_t chunk2 = samples_to_copy - chunk1;
-            memcpy(&new_buffer[chunk1], &ring_buffer[0], chunk2 * sizeof(int16_t));
-        }
+    uint64_t catch_up_from = (snap_ring_total > lo) ? snap_ring_total : lo;
+    size_t catch_up = (size_t)(hi - catch_up_from);
+    if (catch_up > 0)
+    {
+        resize_copy(new_buffer, new_size_samples, ring_advance(rpos, (size_t)(catch_up_from - read_total)),
+                    catch_up_from, catch_up);
     }
 
-    // Swap buffers
-    int16_t *old_buffer = ring_buffer;
+    // Swap buffers; positions keep ring_index(pos) == stream index mod N
+    uint8_t *old_buffer = ring_buffer;
     ring_buffer = new_buffer;
+    buffer_capacity_bytes = new_size_bytes;
     buffer_size_samples = new_size_samples;
-    read_index = 0;
-    write_index = samples_to_copy;
+    read_total = lo;
+    read_pos.store((size_t)(lo % (2 * (uint64_t)new_size_samples)));
+    write_pos.store((size_t)(hi % (2 * (uint64_t)new_size_samples)));
 
-    xSemaphoreGive(buffer_mutex);
+    quiesce_end();
+    stall_us += esp_timer_get_time() - stall_start_us;
 
     // Free old buffer
     if (old_buffer != NULL)
@@ -616,10 +1323,29 @@ static bool buffer_manager_resize_internal(size_t new_size_bytes)
         free(old_buffer);
     }
 
-    ESP_LOGI(TAG, "Buffer resize completed: %d samples (%d bytes)",
-             buffer_size_samples, new_size_bytes);
+    if (samples_lost > 0)
+    {
+        ESP_LOGW(TAG, "Lost %d samples due to buffer shrinkage", samples_lost);
+    }
+
+    uint32_t duration_us = (uint32_t)(esp_timer_get_time() - resize_start_us);
+    resize_count++;
+    resize_last_us = duration_us;
+    resize_last_stall_us = (uint32_t)stall_us;
+    if (duration_us > resize_max_us)
+    {
+        resize_max_us = duration_us;
+    }
+    if (resize_last_stall_us > resize_max_stall_us)
+    {
+        resize_max_stall_us = resize_last_stall_us;
+    }
+
+    ESP_LOGI(TAG, "Buffer resize completed: %d samples (%d bytes) in %lu us, data path held %lu us (%d caught up)",
+             buffer_size_samples, new_size_bytes, duration_us, resize_last_stall_us, catch_up);
 
     resize_in_progress = false;
+    xSemaphoreGive(control_mutex);
     return true;
 }
 
@@ -655,7 +1381,7 @@ static int8_t calculate_usage_trend(void)
 
 static bool should_resize_up(uint8_t current_usage, int8_t trend)
 {
-    size_t current_size = buffer_size_samples * sizeof(int16_t);
+    size_t current_size = buffer_size_samples * sample_bytes;
 
     // Don't resize up if already at maximum
     if (current_size >= ADAPTIVE_BUFFER_MAX_SIZE)
@@ -680,7 +1406,7 @@ static bool should_resize_up(uint8_t current_usage, int8_t trend)
 
 static bool should_resize_down(uint8_t current_usage, int8_t trend)
 {
-    size_t current_size = buffer_size_samples * sizeof(int16_t);
+    size_t current_size = buffer_size_samples * sample_bytes;
 
     // Don't resize down if already at minimum
     if (current_size <= ADAPTIVE_BUFFER_MIN_SIZE)
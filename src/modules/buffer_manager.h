@@ -4,22 +4,66 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include "../config.h"
+
+/**
+ * Contiguous view into the ring buffer
+ *
+ * A region that wraps the end of the ring is described by two spans;
+ * data[1] is NULL and samples[1] is 0 when the region is contiguous.
+ * Each span holds samples[i] * sample_bytes bytes in the ring format.
+ *
+ * buffer_manager_peek_read() also reports where the first sample sits in the
+ * capture stream: sample_index counts every sample the I2S reader produced
+ * (including ones dropped on overflow), capture_us is its esp_timer time.
+ */
+typedef struct
+{
+    uint8_t *data[2];
+    size_t samples[2];
+    size_t sample_bytes;
+    uint64_t sample_index;
+    int64_t capture_us;
+} buffer_span_t;
 
 /**
  * Initialize ring buffer for audio samples
  *
  * Allocates buffer in PSRAM for large capacity (512 KB).
- * Uses mutex for thread-safe access between I2S reader and TCP sender.
+ * Lock-free single-producer/single-consumer ring: the I2S reader is the only
+ * writer and the network sender the only reader. Resize and reset briefly
+ * quiesce both sides instead of locking every access.
  *
  * @param size Buffer size in bytes
  * @return true on success, false on failure
  */
 bool buffer_manager_init(size_t size);
 
+/**
+ * Set the ring sample format
+ *
+ * Called before buffer_manager_init() to size the ring for the capture format.
+ * Calling it on a live buffer discards its contents. Sample counts in this API
+ * are per-channel samples; writes, reservations and peeks stay frame-aligned.
+ *
+ * @param bytes_per_sample 2 (16-bit), 3 (packed 24-bit) or 4 (32-bit)
+ * @param channels 1 (mono) or 2 (stereo interleaved)
+ * @return true on success, false on invalid format or timeout
+ */
+bool buffer_manager_set_format(size_t bytes_per_sample, size_t channels);
+
+/**
+ * Get bytes per stored sample for the current ring format
+ */
+size_t buffer_manager_get_sample_bytes(void);
+
 /**
  * Write samples to ring buffer
  *
- * Thread-safe write operation. Blocks if buffer is full (backpressure).
+ * Only valid with the 16-bit ring format.
+ *
+ * Producer-side operation (I2S reader only). Never blocks on the consumer;
+ * excess samples are dropped and flagged as overflow when the buffer is full.
  *
  * @param data Pointer to int16_t samples
  * @param samples Number of samples to write
@@ -30,7 +74,7 @@ size_t buffer_manager_write_16(const int16_t *data, size_t samples);
 /**
  * Write samples to ring buffer (legacy 32-bit interface)
  *
- * Thread-safe write operation. Blocks if buffer is full (backpressure).
+ * Producer-side operation (I2S reader only). Never blocks on the consumer.
  *
  * @param data Pointer to int32_t samples
  * @param samples Number of samples to write
@@ -41,7 +85,8 @@ size_t buffer_manager_write(const int32_t *data, size_t samples);
 /**
  * Read samples from ring buffer
  *
- * Thread-safe read operation. Blocks if buffer is empty.
+ * Consumer-side operation (network sender only). Returns immediately with
+ * whatever is available, possibly 0.
  *
  * @param data Output buffer for int16_t samples
  * @param samples Number of samples to read
@@ -52,7 +97,7 @@ size_t buffer_manager_read_16(int16_t *data, size_t samples);
 /**
  * Read samples from ring buffer (legacy 32-bit interface)
  *
- * Thread-safe read operation. Blocks if buffer is empty.
+ * Consumer-side operation (network sender only). Returns immediately.
  *
  * @param data Output buffer for int32_t samples
  * @param samples Number of samples to read
@@ -60,6 +105,78 @@ size_t buffer_manager_read_16(int16_t *data, size_t samples);
  */
 size_t buffer_manager_read(int32_t *data, size_t samples);
 
+/**
+ * Reserve ring space for in-place writing (zero-copy producer path)
+ *
+ * Producer-side operation (I2S reader only). The caller fills the returned
+ * spans directly and publishes them with buffer_manager_commit_write().
+ * A non-zero return must be followed by exactly one commit; resize and
+ * reset wait until then, so keep the window short.
+ *
+ * @param samples Number of samples wanted
+ * @param span Output spans pointing into the ring
+ * @return Number of samples reserved (less than requested on overflow)
+ */
+size_t buffer_manager_reserve_write(size_t samples, buffer_span_t *span);
+
+/**
+ * Publish samples written into a reservation
+ *
+ * Timestamps the block with the current time; prefer
+ * buffer_manager_commit_write_at() when the capture time is known.
+ *
+ * @param samples Number of samples filled (at most the reserved count)
+ */
+void buffer_manager_commit_write(size_t samples);
+
+/**
+ * Publish samples written into a reservation with their capture time
+ *
+ * @param samples Number of samples filled (at most the reserved count)
+ * @param capture_us esp_timer time at which the first sample was captured
+ */
+void buffer_manager_commit_write_at(size_t samples, int64_t capture_us);
+
+/**
+ * Borrow readable ring data in place (zero-copy consumer path)
+ *
+ * Consumer-side operation (network sender only). The returned spans stay
+ * valid until buffer_manager_consume_read(). A non-zero return must be
+ * followed by exactly one consume.
+ *
+ * @param samples Maximum number of samples wanted
+ * @param span Output spans pointing into the ring
+ * @return Number of samples available in the spans
+ */
+size_t buffer_manager_peek_read(size_t samples, buffer_span_t *span);
+
+/**
+ * Get capture position of a sample inside the current peek
+ *
+ * Consumer-side operation. Interpolates between the capture marks recorded
+ * by the producer, so any offset into the peeked block can be timestamped.
+ *
+ * @param offset Samples from the start of the peeked block
+ * @param sample_index Output capture stream index (may be NULL)
+ * @param capture_us Output capture time in microseconds (may be NULL)
+ * @return false if nothing has been captured yet
+ */
+bool buffer_manager_peek_capture(size_t offset, uint64_t *sample_index, int64_t *capture_us);
+
+/**
+ * Get the capture stream index the next written sample will get
+ *
+ * Producer-side operation, for tagging a block before reserve_write().
+ */
+uint64_t buffer_manager_stream_index(void);
+
+/**
+ * Release samples obtained from buffer_manager_peek_read()
+ *
+ * @param samples Number of samples consumed (at most the peeked count)
+ */
+void buffer_manager_consume_read(size_t samples);
+
 /**
  * Get available samples for reading
  *
@@ -67,6 +184,19 @@ size_t buffer_manager_read(int32_t *data, size_t samples);
  */
 size_t buffer_manager_available(void);
 
+/**
+ * Block until at least samples are buffered or the timeout expires
+ *
+ * Consumer-side operation (network sender only). The producer wakes the
+ * caller with a task notification as soon as the watermark is reached, so
+ * there is no polling; the caller's notification value (index 0) is used.
+ *
+ * @param samples Watermark (clamped to the ring capacity)
+ * @param timeout_ms Longest time to sleep
+ * @return Number of samples available on return (may be below the watermark on timeout)
+ */
+size_t buffer_manager_wait_available(size_t samples, uint32_t timeout_ms);
+
 /**
  * Get free space for writing
  *
@@ -88,8 +218,36 @@ uint8_t buffer_manager_usage_percent(void);
  */
 bool buffer_manager_check_overflow(void);
 
+/**
+ * Select what a full ring does with an incoming block
+ *
+ * Drop-oldest (and degrade, which uses it on the ring) discards buffered audio
+ * down to BUFFER_DROP_OLDEST_TARGET_PERCENT so fresh audio always gets in;
+ * drop-newest clips the incoming block. A full reset is never done.
+ *
+ * @param policy Overflow policy
+ */
+void buffer_manager_set_overflow_policy(overflow_policy_t policy);
+
+/**
+ * Get the configured overflow policy
+ */
+overflow_policy_t buffer_manager_get_overflow_policy(void);
+
+/**
+ * Get overflow counters since boot
+ *
+ * @param oldest_samples Buffered samples discarded by drop-oldest (may be NULL)
+ * @param newest_samples Incoming samples that did not fit (may be NULL)
+ * @param events Writes that found the ring full (may be NULL)
+ */
+void buffer_manager_get_drop_stats(uint64_t *oldest_samples, uint64_t *newest_samples, uint32_t *events);
+
 /**
  * Reset buffer (clear all data)
+ *
+ * Waits for the producer and consumer to leave the data path before
+ * clearing both positions.
  */
 void buffer_manager_reset(void);
 
@@ -115,6 +273,20 @@ void buffer_manager_adaptive_check(void);
 void buffer_manager_adaptive_get_stats(size_t *current_size, uint32_t *resize_count,
                                      uint32_t *last_resize_time_ms);
 
+/**
+ * Get resize timing (microseconds)
+ *
+ * A resize copies the buffered audio while capture keeps running and only
+ * holds the data path off for a short catch-up and the swap (stall).
+ *
+ * @param last_us Duration of the last resize (may be NULL)
+ * @param max_us Longest resize since init (may be NULL)
+ * @param last_stall_us Data path hold-off during the last resize (may be NULL)
+ * @param max_stall_us Longest hold-off since init (may be NULL)
+ */
+void buffer_manager_adaptive_get_resize_timing(uint32_t *last_us, uint32_t *max_us,
+                                               uint32_t *last_stall_us, uint32_t *max_stall_us);
+
 /**
  * Set adaptive buffer size manually
  */
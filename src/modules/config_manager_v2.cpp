@@ -4,8 +4,13 @@
 #include "nvs_flash.h"
 #include "nvs.h"
 #include "esp_timer.h"
+#include "esp_system.h"
 #include "cJSON.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 #include <string.h>
+#include <atomic>
 
 static const char* TAG = "CONFIG_MANAGER_V2";
 static const char* NAMESPACE = "unified_config";
@@ -16,14 +21,301 @@ static unified_config_t saved_config;
 static bool config_initialized = false;
 static bool has_unsaved_changes = false;
 
-// NVS key for storing configuration
+// NVS key for storing configuration (single blob, read for migration only)
 static const char* CONFIG_KEY = "unified_config";
 
+// Incremental persistence: one blob per category ("c_<category>"), rewritten
+// only when that category differs from flash, committed by config_save_task
+// once saves stop arriving for CONFIG_SAVE_DEBOUNCE_MS.
+static const char* VERSION_KEY = "c_version";
+static const char* UPDATED_KEY = "c_updated";
+static unified_config_t persisted_config; // What NVS holds (save_mutex)
+static bool persisted_valid = false;      // false = rewrite every category
+static bool legacy_blob_present = false;
+static volatile bool save_pending = false;
+static SemaphoreHandle_t save_mutex = NULL;
+static TaskHandle_t save_task_handle = NULL;
+
 // Available categories
 static const char* AVAILABLE_CATEGORIES[] = {
     "network", "server", "audio", "buffer", "task",
-    "error", "debug", "auth", "ntp", "udp", "tcp", "performance"
+    "error", "debug", "auth", "ntp", "udp", "tcp", "performance", "dsp"
 };
+#define CATEGORY_COUNT (sizeof(AVAILABLE_CATEGORIES) / sizeof(AVAILABLE_CATEGORIES[0]))
+#define CATEGORY_ANY 0xFFFFFFFFu
+
+// Published snapshots (read-copy-update): readers pin a slot with a reference
+// count, a writer fills a slot nobody holds and swaps the published index.
+static unified_config_t snapshot_slots[CONFIG_SNAPSHOT_SLOTS];
+static std::atomic<uint32_t> snapshot_refs[CONFIG_SNAPSHOT_SLOTS];
+static std::atomic<int> published_slot(0);
+static std::atomic<uint32_t> snapshot_generation(0);
+static SemaphoreHandle_t publish_mutex = NULL;
+
+// Change subscribers
+typedef struct {
+    uint32_t category_mask;
+    config_change_cb_t callback;
+    void* ctx;
+} config_subscriber_t;
+
+static config_subscriber_t subscribers[CONFIG_MAX_SUBSCRIBERS];
+static size_t subscriber_count = 0;
+
+static int category_index(const char* category) {
+    for (size_t i = 0; i < CATEGORY_COUNT; i++) {
+        if (strcmp(AVAILABLE_CATEGORIES[i], category) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// Bit per category whose fields differ (field strings compared; writes are rare)
+static uint32_t changed_categories(const unified_config_t* a, const unified_config_t* b) {
+    uint32_t mask = 0;
+    char value_a[128];
+    char value_b[128];
+    for (int i = 0; i < CONFIG_FIELD_COUNT; i++) {
+        const config_field_meta_t* meta = config_schema_get_field_meta((config_field_id_t)i);
+        if (!meta) continue;
+        int index = category_index(meta->category);
+        if (index < 0 || (mask & (1u << index))) continue;
+
+        if (!config_schema_get_field_value(a, meta->id, value_a, sizeof(value_a)) ||
+            !config_schema_get_field_value(b, meta->id, value_b, sizeof(value_b)) ||
+            strcmp(value_a, value_b) != 0) {
+            mask |= 1u << index;
+        }
+    }
+    return mask;
+}
+
+/**
+ * Publish current_config as the new snapshot and notify subscribers
+ * Called after every change to current_config.
+ */
+static void publish_config(void) {
+    if (publish_mutex == NULL || xSemaphoreTake(publish_mutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+
+    int old_slot = published_slot.load(std::memory_order_relaxed);
+    int new_slot = -1;
+    // Readers hold slots only briefly; wait for one to come free
+    for (int attempt = 0; new_slot < 0; attempt++) {
+        for (int i = 0; i < CONFIG_SNAPSHOT_SLOTS; i++) {
+            if (i != old_slot && snapshot_refs[i].load(std::memory_order_acquire) == 0) {
+                new_slot = i;
+                break;
+            }
+        }
+        if (new_slot < 0) {
+            if (attempt == 100) {
+                ESP_LOGW(TAG, "Waiting for config snapshot readers");
+            }
+            vTaskDelay(1);
+        }
+    }
+
+    memcpy(&snapshot_slots[new_slot], &current_config, sizeof(unified_config_t));
+    published_slot.store(new_slot, std::memory_order_release);
+    snapshot_generation.fetch_add(1, std::memory_order_release);
+
+    const unified_config_t* previous = &snapshot_slots[old_slot];
+    const unified_config_t* current = &snapshot_slots[new_slot];
+    if (subscriber_count > 0 && memcmp(previous, current, sizeof(unified_config_t)) != 0) {
+        // The lock keeps the previous slot from being refilled while callbacks run
+        uint32_t mask = changed_categories(previous, current);
+        for (size_t i = 0; i < subscriber_count && mask != 0; i++) {
+            if (subscribers[i].category_mask & mask) {
+                subscribers[i].callback(previous, current, subscribers[i].ctx);
+            }
+        }
+    }
+
+    xSemaphoreGive(publish_mutex);
+}
+
+static void category_key(size_t index, char* key, size_t size) {
+    snprintf(key, size, "c_%s", AVAILABLE_CATEGORIES[index]);
+}
+
+// Serialize one category as "name\0value\0" pairs
+static size_t serialize_category(const unified_config_t* config, size_t index, char* blob, size_t size) {
+    const config_field_meta_t* fields[32];
+    size_t field_count = config_schema_get_fields_by_category(AVAILABLE_CATEGORIES[index], fields, 32);
+    size_t used = 0;
+
+    for (size_t i = 0; i < field_count; i++) {
+        char value[128];
+        if (!config_schema_get_field_value(config, fields[i]->id, value, sizeof(value))) {
+            continue;
+        }
+        size_t name_len = strlen(fields[i]->name) + 1;
+        size_t value_len = strlen(value) + 1;
+        if (used + name_len + value_len > size) {
+            ESP_LOGE(TAG, "Category %s exceeds %d bytes", AVAILABLE_CATEGORIES[index], (int)size);
+            return 0;
+        }
+        memcpy(blob + used, fields[i]->name, name_len);
+        used += name_len;
+        memcpy(blob + used, value, value_len);
+        used += value_len;
+    }
+    return used;
+}
+
+// Apply "name\0value\0" pairs; unknown names (removed fields) are skipped
+static void deserialize_category(unified_config_t* config, size_t index, const char* blob, size_t len) {
+    const config_field_meta_t* fields[32];
+    size_t field_count = config_schema_get_fields_by_category(AVAILABLE_CATEGORIES[index], fields, 32);
+    size_t pos = 0;
+
+    while (pos < len) {
+        const char* name = blob + pos;
+        size_t name_len = strnlen(name, len - pos);
+        if (pos + name_len + 1 >= len) break;
+        const char* value = name + name_len + 1;
+        size_t value_len = strnlen(value, len - pos - name_len - 1);
+        if (pos + name_len + 1 + value_len >= len) break;
+        pos += name_len + 1 + value_len + 1;
+
+        for (size_t i = 0; i < field_count; i++) {
+            if (strcmp(fields[i]->name, name) == 0) {
+                config_validation_result_t validation;
+                if (!config_schema_set_field_value(config, fields[i]->id, value, &validation)) {
+                    ESP_LOGW(TAG, "Stored %s rejected: %s", name, validation.error_message);
+                }
+                break;
+            }
+        }
+    }
+}
+
+// Load per-category keys; false if this NVS predates them
+static bool load_categories(nvs_handle_t nvs_handle, unified_config_t* config) {
+    uint8_t version = 0;
+    if (nvs_get_u8(nvs_handle, VERSION_KEY, &version) != ESP_OK) {
+        return false;
+    }
+
+    static char blob[CONFIG_CATEGORY_BLOB_MAX];
+    config_schema_init_defaults(config);
+    for (size_t i = 0; i < CATEGORY_COUNT; i++) {
+        char key[16];
+        category_key(i, key, sizeof(key));
+        size_t len = sizeof(blob);
+        if (nvs_get_blob(nvs_handle, key, blob, &len) == ESP_OK) {
+            deserialize_category(config, i, blob, len);
+        }
+    }
+
+    uint32_t updated = 0;
+    nvs_get_u32(nvs_handle, UPDATED_KEY, &updated);
+    config->version = version;
+    config->last_updated = updated;
+    return true;
+}
+
+/**
+ * Write categories that differ from flash and commit
+ * Reads a published snapshot, so writers are never blocked meanwhile.
+ */
+static bool commit_dirty(void) {
+    if (save_mutex == NULL || xSemaphoreTake(save_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        return false;
+    }
+    save_pending = false; // A save from here on schedules another commit
+
+    const unified_config_t* snapshot = config_manager_v2_acquire();
+    uint32_t dirty = persisted_valid ? changed_categories(&persisted_config, snapshot) : CATEGORY_ANY;
+    if (dirty == 0 && !legacy_blob_present) {
+        config_manager_v2_release(snapshot);
+        xSemaphoreGive(save_mutex);
+        return true;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(err));
+        config_manager_v2_release(snapshot);
+        xSemaphoreGive(save_mutex);
+        return false;
+    }
+
+    static char blob[CONFIG_CATEGORY_BLOB_MAX];
+    int written = 0;
+    for (size_t i = 0; i < CATEGORY_COUNT && err == ESP_OK; i++) {
+        if (!(dirty & (1u << i))) continue;
+        char key[16];
+        category_key(i, key, sizeof(key));
+        size_t len = serialize_category(snapshot, i, blob, sizeof(blob));
+        err = (len > 0) ? nvs_set_blob(nvs_handle, key, blob, len) : ESP_ERR_INVALID_SIZE;
+        written++;
+    }
+    if (err == ESP_OK) {
+        err = nvs_set_u8(nvs_handle, VERSION_KEY, snapshot->version);
+    }
+    if (err == ESP_OK) {
+        err = nvs_set_u32(nvs_handle, UPDATED_KEY, snapshot->last_updated);
+    }
+    if (err == ESP_OK && legacy_blob_present) {
+        nvs_erase_key(nvs_handle, CONFIG_KEY); // Migrated, free its pages
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+
+    if (err == ESP_OK) {
+        memcpy(&persisted_config, snapshot, sizeof(unified_config_t));
+        persisted_valid = true;
+        legacy_blob_present = false;
+        ESP_LOGI(TAG, "Configuration saved (%d categories, %lld ms)",
+                 written, (long long)((esp_timer_get_time() - start_us) / 1000));
+    } else {
+        ESP_LOGE(TAG, "Failed to save configuration: %s", esp_err_to_name(err));
+        save_pending = true; // Retry on the next save or flush
+    }
+
+    config_manager_v2_release(snapshot);
+    xSemaphoreGive(save_mutex);
+    return err == ESP_OK;
+}
+
+// Commit once saves stop arriving
+static void config_save_task(void* arg) {
+    (void)arg;
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CONFIG_SAVE_DEBOUNCE_MS)) > 0) {
+            // Another save arrived, keep waiting
+        }
+        if (save_pending) {
+            commit_dirty();
+        }
+    }
+}
+
+// Hand the commit to config_save_task (or do it now if there is none)
+static bool schedule_save(void) {
+    save_pending = true;
+    if (save_task_handle == NULL) {
+        return commit_dirty();
+    }
+    xTaskNotifyGive(save_task_handle);
+    return true;
+}
+
+// esp_restart() hook: do not lose a debounced save
+static void flush_on_shutdown(void) {
+    if (save_pending) {
+        commit_dirty();
+    }
+}
 
 bool config_manager_v2_init(void) {
     if (config_initialized) {
@@ -46,9 +338,28 @@ bool config_manager_v2_init(void) {
         return false;
     }
 
+    publish_mutex = xSemaphoreCreateMutex();
+    save_mutex = xSemaphoreCreateMutex();
+    if (publish_mutex == NULL || save_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create config mutexes");
+        return false;
+    }
+
+    if (xTaskCreate(config_save_task, "config_save", CONFIG_SAVE_TASK_STACK_SIZE, NULL,
+                    CONFIG_SAVE_TASK_PRIORITY, &save_task_handle) != pdPASS) {
+        ESP_LOGW(TAG, "Failed to create config save task, saves will be synchronous");
+        save_task_handle = NULL;
+    }
+    esp_register_shutdown_handler(flush_on_shutdown);
+
     // Initialize configuration with defaults
     config_schema_init_defaults(&current_config);
     memcpy(&saved_config, &current_config, sizeof(unified_config_t));
+    for (int i = 0; i < CONFIG_SNAPSHOT_SLOTS; i++) {
+        snapshot_refs[i].store(0, std::memory_order_relaxed);
+    }
+    memcpy(&snapshot_slots[0], &current_config, sizeof(unified_config_t));
+    published_slot.store(0, std::memory_order_release);
 
     config_initialized = true;
     has_unsaved_changes = false;
@@ -74,6 +385,7 @@ bool config_manager_v2_load(void) {
             memcpy(&current_config, &legacy_config, sizeof(unified_config_t));
             memcpy(&saved_config, &current_config, sizeof(unified_config_t));
             has_unsaved_changes = true; // Mark as needing save to persist migration
+            publish_config();
 
             ESP_LOGI(TAG, "Legacy configuration migrated to unified format");
             return true;
@@ -83,10 +395,13 @@ bool config_manager_v2_load(void) {
         }
     }
 
+    bool from_categories = load_categories(nvs_handle, &current_config);
     size_t required_size = sizeof(unified_config_t);
-    err = nvs_get_blob(nvs_handle, CONFIG_KEY, &current_config, &required_size);
+    if (!from_categories) {
+        err = nvs_get_blob(nvs_handle, CONFIG_KEY, &current_config, &required_size);
+    }
 
-    if (err == ESP_OK && required_size == sizeof(unified_config_t)) {
+    if (from_categories || (err == ESP_OK && required_size == sizeof(unified_config_t))) {
         // Validate loaded configuration
         config_validation_result_t results[10];
         size_t issue_count = config_schema_validate_config(&current_config, results, 10);
@@ -100,9 +415,19 @@ bool config_manager_v2_load(void) {
 
         memcpy(&saved_config, &current_config, sizeof(unified_config_t));
         has_unsaved_changes = false;
+        publish_config();
+        nvs_close(nvs_handle);
+
+        if (from_categories) {
+            memcpy(&persisted_config, &current_config, sizeof(unified_config_t));
+            persisted_valid = true;
+        } else {
+            ESP_LOGI(TAG, "Moving configuration blob to per-category keys");
+            legacy_blob_present = true;
+            schedule_save();
+        }
 
         ESP_LOGI(TAG, "Configuration loaded successfully (version %d)", current_config.version);
-        nvs_close(nvs_handle);
         return true;
     } else {
         ESP_LOGW(TAG, "Failed to load configuration: %s", esp_err_to_name(err));
@@ -188,6 +513,7 @@ bool config_manager_v2_load(void) {
                     memcpy(&current_config, &legacy_config, sizeof(unified_config_t));
                     memcpy(&saved_config, &current_config, sizeof(unified_config_t));
                     has_unsaved_changes = true;
+                    publish_config();
 
                     ESP_LOGI(TAG, "Legacy configuration migrated successfully");
                     return true;
@@ -223,37 +549,23 @@ bool config_manager_v2_save(void) {
         return false;
     }
 
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open(NAMESPACE, NVS_READWRITE, &nvs_handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(err));
-        return false;
-    }
-
     // Update metadata
     current_config.last_updated = esp_timer_get_time() / 1000;
     current_config.version = CONFIG_SCHEMA_VERSION;
 
-    err = nvs_set_blob(nvs_handle, CONFIG_KEY, &current_config, sizeof(unified_config_t));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save configuration: %s", esp_err_to_name(err));
-        nvs_close(nvs_handle);
-        return false;
-    }
+    memcpy(&saved_config, &current_config, sizeof(unified_config_t));
+    has_unsaved_changes = false;
+    publish_config();
 
-    err = nvs_commit(nvs_handle);
-    nvs_close(nvs_handle);
+    // NVS write happens in config_save_task after the debounce
+    return schedule_save();
+}
 
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit NVS: %s", esp_err_to_name(err));
+bool config_manager_v2_flush(void) {
+    if (!config_initialized) {
         return false;
     }
-
-    memcpy(&saved_config, &current_config, sizeof(unified_config_t));
-    has_unsaved_changes = false;
-
-    ESP_LOGI(TAG, "Configuration saved successfully");
-    return true;
+    return commit_dirty();
 }
 
 bool config_manager_v2_reset_to_factory(void) {
@@ -265,6 +577,7 @@ bool config_manager_v2_reset_to_factory(void) {
     ESP_LOGI(TAG, "Resetting configuration to factory defaults");
     config_schema_init_defaults(&current_config);
     has_unsaved_changes = true;
+    publish_config();
 
     return config_manager_v2_save();
 }
@@ -297,10 +610,70 @@ bool config_manager_v2_set_config(const unified_config_t* config) {
 
     memcpy(&current_config, config, sizeof(unified_config_t));
     has_unsaved_changes = true;
+    publish_config();
 
     return true;
 }
 
+const unified_config_t* config_manager_v2_acquire(void) {
+    for (;;) {
+        int slot = published_slot.load(std::memory_order_acquire);
+        snapshot_refs[slot].fetch_add(1, std::memory_order_acq_rel);
+        // Still published after pinning: a writer can no longer pick this slot
+        if (published_slot.load(std::memory_order_acquire) == slot) {
+            return &snapshot_slots[slot];
+        }
+        snapshot_refs[slot].fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void config_manager_v2_release(const unified_config_t* snapshot) {
+    if (snapshot == NULL) {
+        return;
+    }
+    size_t slot = (size_t)(snapshot - snapshot_slots);
+    if (slot < CONFIG_SNAPSHOT_SLOTS) {
+        snapshot_refs[slot].fetch_sub(1, std::memory_order_release);
+    }
+}
+
+uint32_t config_manager_v2_get_generation(void) {
+    return snapshot_generation.load(std::memory_order_acquire);
+}
+
+bool config_manager_v2_subscribe(const char* category, config_change_cb_t callback, void* ctx) {
+    if (!config_initialized || !callback) {
+        return false;
+    }
+
+    uint32_t mask = CATEGORY_ANY;
+    if (category) {
+        int index = category_index(category);
+        if (index < 0) {
+            ESP_LOGE(TAG, "Unknown config category: %s", category);
+            return false;
+        }
+        mask = 1u << index;
+    }
+
+    if (xSemaphoreTake(publish_mutex, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+    bool added = false;
+    if (subscriber_count < CONFIG_MAX_SUBSCRIBERS) {
+        subscribers[subscriber_count].category_mask = mask;
+        subscribers[subscriber_count].callback = callback;
+        subscribers[subscriber_count].ctx = ctx;
+        subscriber_count++;
+        added = true;
+    } else {
+        ESP_LOGE(TAG, "No free config subscriber slot (max %d)", CONFIG_MAX_SUBSCRIBERS);
+    }
+    xSemaphoreGive(publish_mutex);
+
+    return added;
+}
+
 bool config_manager_v2_get_field(config_field_id_t field_id,
                                 char* buffer,
                                 size_t buffer_size) {
@@ -323,6 +696,7 @@ bool config_manager_v2_set_field(config_field_id_t field_id,
 
     if (config_schema_set_field_value(&current_config, field_id, value, validation_ptr)) {
         has_unsaved_changes = true;
+        publish_config();
         return true;
     }
 
@@ -399,6 +773,7 @@ size_t config_manager_v2_set_category(const char* category,
 
     if (has_changes) {
         has_unsaved_changes = true;
+        publish_config();
     }
 
     cJSON_Delete(root);
@@ -498,6 +873,7 @@ size_t config_manager_v2_import_json(const char* json_input,
 
     if (has_changes) {
         has_unsaved_changes = true;
+        publish_config();
     }
 
     cJSON_Delete(root);
@@ -516,14 +892,22 @@ bool config_manager_v2_is_first_boot(void) {
         return false;
     }
 
+    if (save_pending || persisted_valid) {
+        return false; // Saved, or about to be
+    }
+
     nvs_handle_t nvs_handle;
     esp_err_t err = nvs_open(NAMESPACE, NVS_READONLY, &nvs_handle);
     if (err != ESP_OK) {
         return true; // No NVS data = first boot
     }
 
-    size_t required_size = sizeof(unified_config_t);
-    err = nvs_get_blob(nvs_handle, CONFIG_KEY, NULL, &required_size);
+    uint8_t version = 0;
+    err = nvs_get_u8(nvs_handle, VERSION_KEY, &version);
+    if (err != ESP_OK) {
+        size_t required_size = sizeof(unified_config_t);
+        err = nvs_get_blob(nvs_handle, CONFIG_KEY, NULL, &required_size);
+    }
     nvs_close(nvs_handle);
 
     return (err != ESP_OK);
@@ -18,10 +18,21 @@ bool config_manager_v2_load(void);
 
 /**
  * Save configuration to NVS
- * @return true on success
+ *
+ * Validates now; the write is debounced (CONFIG_SAVE_DEBOUNCE_MS) and only
+ * categories that differ from flash are rewritten, each as its own NVS key.
+ * Pending writes are flushed on esp_restart().
+ *
+ * @return true if valid and scheduled
  */
 bool config_manager_v2_save(void);
 
+/**
+ * Write pending changes to NVS now
+ * @return true on success (also when nothing was pending)
+ */
+bool config_manager_v2_flush(void);
+
 /**
  * Reset configuration to factory defaults
  * @return true on success
@@ -42,6 +53,54 @@ bool config_manager_v2_get_config(unified_config_t* config);
  */
 bool config_manager_v2_set_config(const unified_config_t* config);
 
+/**
+ * Change notification, called after a new snapshot is published
+ *
+ * Runs in the task that changed the configuration, with the publish lock
+ * held: keep it short and do not change the configuration from it.
+ *
+ * @param previous Snapshot before the change (valid during the call only)
+ * @param current Snapshot after the change (valid during the call only)
+ * @param ctx Context given to config_manager_v2_subscribe()
+ */
+typedef void (*config_change_cb_t)(const unified_config_t* previous,
+                                   const unified_config_t* current,
+                                   void* ctx);
+
+/**
+ * Pin the current configuration snapshot
+ *
+ * Lock-free and copy-free: the snapshot is immutable and stays valid until
+ * released, even if the configuration changes meanwhile. Hold it briefly
+ * (one reconnect, one request); a writer waits for a free slot.
+ *
+ * @return Current snapshot (never NULL after init)
+ */
+const unified_config_t* config_manager_v2_acquire(void);
+
+/**
+ * Release a snapshot from config_manager_v2_acquire()
+ * @param snapshot Snapshot to release (NULL is ignored)
+ */
+void config_manager_v2_release(const unified_config_t* snapshot);
+
+/**
+ * Get the snapshot generation, bumped on every publish
+ *
+ * Lets a task check for changes with one load before acquiring.
+ * @return Generation counter
+ */
+uint32_t config_manager_v2_get_generation(void);
+
+/**
+ * Register a callback for changes in one category
+ * @param category Category name (see config_manager_v2_get_categories), NULL for any
+ * @param callback Function to call
+ * @param ctx Passed to callback
+ * @return false if the category is unknown or all CONFIG_MAX_SUBSCRIBERS are taken
+ */
+bool config_manager_v2_subscribe(const char* category, config_change_cb_t callback, void* ctx);
+
 /**
  * Get single field value
  * @param field_id Field identifier
@@ -35,11 +35,18 @@ static const config_field_meta_t field_meta[CONFIG_FIELD_COUNT] = {
     {CONFIG_FIELD_AUDIO_BCK_PIN, "audio_bck_pin", "audio", 2, 0, true, false},
     {CONFIG_FIELD_AUDIO_WS_PIN, "audio_ws_pin", "audio", 2, 0, true, false},
     {CONFIG_FIELD_AUDIO_DATA_IN_PIN, "audio_data_in_pin", "audio", 2, 0, true, false},
+    {CONFIG_FIELD_AUDIO_CODEC, "audio_codec", "audio", 2, 0, true, false},
+    {CONFIG_FIELD_VAD_ENABLED, "vad_enabled", "audio", 3, 0, true, false},
+    {CONFIG_FIELD_VAD_THRESHOLD_DB, "vad_threshold_db", "audio", 1, 0, true, false},
+    {CONFIG_FIELD_VAD_HANGOVER_MS, "vad_hangover_ms", "audio", 2, 0, true, false},
+    {CONFIG_FIELD_VAD_PREROLL_MS, "vad_preroll_ms", "audio", 2, 0, true, false},
 
     // Buffer fields
     {CONFIG_FIELD_BUFFER_RING_SIZE, "buffer_ring_size", "buffer", 2, 0, true, false},
     {CONFIG_FIELD_BUFFER_DMA_COUNT, "buffer_dma_count", "buffer", 2, 0, true, false},
     {CONFIG_FIELD_BUFFER_DMA_LENGTH, "buffer_dma_length", "buffer", 2, 0, true, false},
+    {CONFIG_FIELD_LATENCY_PROFILE, "latency_profile", "buffer", 2, 0, true, false},
+    {CONFIG_FIELD_BUFFER_OVERFLOW_POLICY, "buffer_overflow_policy", "buffer", 2, 0, true, false},
     {CONFIG_FIELD_BUFFER_ADAPTIVE_ENABLED, "buffer_adaptive_enabled", "buffer", 3, 0, true, false},
     {CONFIG_FIELD_BUFFER_ADAPTIVE_MIN_SIZE, "buffer_adaptive_min_size", "buffer", 2, 0, true, false},
     {CONFIG_FIELD_BUFFER_ADAPTIVE_MAX_SIZE, "buffer_adaptive_max_size", "buffer", 2, 0, true, false},
@@ -81,6 +88,7 @@ static const config_field_meta_t field_meta[CONFIG_FIELD_COUNT] = {
     // NTP fields
     {CONFIG_FIELD_NTP_SERVER, "ntp_server", "ntp", 0, 64, true, false},
     {CONFIG_FIELD_NTP_TIMEZONE, "ntp_timezone", "ntp", 0, 32, true, false},
+    {CONFIG_FIELD_MEDIA_CLOCK_PORT, "media_clock_port", "ntp", 2, 0, true, false},
 
     // UDP fields
     {CONFIG_FIELD_UDP_PACKET_MAX_SIZE, "udp_packet_max_size", "udp", 2, 0, true, false},
@@ -88,6 +96,10 @@ static const config_field_meta_t field_meta[CONFIG_FIELD_COUNT] = {
     {CONFIG_FIELD_UDP_BUFFER_COUNT, "udp_buffer_count", "udp", 2, 0, true, false},
     {CONFIG_FIELD_UDP_MULTICAST_GROUP, "udp_multicast_group", "udp", 0, 16, true, false},
     {CONFIG_FIELD_UDP_MULTICAST_PORT, "udp_multicast_port", "udp", 2, 0, true, false},
+    {CONFIG_FIELD_UDP_MULTICAST_ENABLED, "udp_multicast_enabled", "udp", 3, 0, true, false},
+    {CONFIG_FIELD_UDP_MULTICAST_TTL, "udp_multicast_ttl", "udp", 2, 0, true, false},
+    {CONFIG_FIELD_UDP_FEC_ENABLED, "udp_fec_enabled", "udp", 3, 0, true, false},
+    {CONFIG_FIELD_UDP_FEC_GROUP_SIZE, "udp_fec_group_size", "udp", 2, 0, true, false},
 
     // TCP optimization fields
     {CONFIG_FIELD_TCP_KEEPALIVE_ENABLED, "tcp_keepalive_enabled", "tcp", 3, 0, true, false},
@@ -97,10 +109,20 @@ static const config_field_meta_t field_meta[CONFIG_FIELD_COUNT] = {
     {CONFIG_FIELD_TCP_NODELAY_ENABLED, "tcp_nodelay_enabled", "tcp", 3, 0, true, false},
     {CONFIG_FIELD_TCP_TX_BUFFER_SIZE, "tcp_tx_buffer_size", "tcp", 2, 0, true, false},
     {CONFIG_FIELD_TCP_RX_BUFFER_SIZE, "tcp_rx_buffer_size", "tcp", 2, 0, true, false},
+    {CONFIG_FIELD_TCP_FRAMING_ENABLED, "tcp_framing_enabled", "tcp", 3, 0, true, false},
 
     // Performance monitoring fields
     {CONFIG_FIELD_PERF_INTERVAL_MS, "perf_interval_ms", "performance", 2, 0, false, true},
     {CONFIG_FIELD_PERF_MAX_ENTRIES, "perf_max_entries", "performance", 2, 0, false, true},
+
+    // DSP chain fields
+    {CONFIG_FIELD_DSP_CAPTURE_RATE, "dsp_capture_rate", "dsp", 2, 0, true, false},
+    {CONFIG_FIELD_DSP_HIGHPASS_ENABLED, "dsp_highpass_enabled", "dsp", 3, 0, true, false},
+    {CONFIG_FIELD_DSP_HIGHPASS_HZ, "dsp_highpass_hz", "dsp", 2, 0, true, false},
+    {CONFIG_FIELD_DSP_AGC_ENABLED, "dsp_agc_enabled", "dsp", 3, 0, true, false},
+    {CONFIG_FIELD_DSP_AGC_TARGET_DB, "dsp_agc_target_db", "dsp", 1, 0, true, false},
+    {CONFIG_FIELD_DSP_AGC_MAX_GAIN_DB, "dsp_agc_max_gain_db", "dsp", 2, 0, true, false},
+    {CONFIG_FIELD_DSP_LIMITER_DB, "dsp_limiter_db", "dsp", 1, 0, true, false},
 };
 
 // Helper function to validate IP address
@@ -216,7 +238,6 @@ bool config_schema_validate_field(config_field_id_t field_id,
     case CONFIG_FIELD_WIFI_DNS_SECONDARY:
     case CONFIG_FIELD_TCP_SERVER_IP:
     case CONFIG_FIELD_UDP_SERVER_IP:
-    case CONFIG_FIELD_UDP_MULTICAST_GROUP:
         if (!is_valid_ip(value))
         {
             strcpy(result->error_message, "Invalid IP address format");
@@ -226,9 +247,34 @@ bool config_schema_validate_field(config_field_id_t field_id,
         strcpy(result->error_message, "Valid IP address");
         break;
 
+    case CONFIG_FIELD_UDP_MULTICAST_GROUP:
+        // Must be an IPv4 multicast (class D) address: 224.0.0.0 - 239.255.255.255
+        if (!is_valid_ip(value) || atoi(value) < 224 || atoi(value) > 239)
+        {
+            strcpy(result->error_message, "Multicast group must be 224.0.0.0-239.255.255.255");
+            return false;
+        }
+        result->valid = true;
+        strcpy(result->error_message, "Valid multicast group");
+        break;
+
+    case CONFIG_FIELD_UDP_MULTICAST_TTL:
+    {
+        uint32_t ttl = strtoul(value, NULL, 10);
+        if (ttl < 1 || ttl > 255)
+        {
+            strcpy(result->error_message, "Multicast TTL must be 1-255");
+            return false;
+        }
+        result->valid = true;
+        strcpy(result->error_message, "Valid multicast TTL");
+        break;
+    }
+
     case CONFIG_FIELD_TCP_SERVER_PORT:
     case CONFIG_FIELD_UDP_SERVER_PORT:
     case CONFIG_FIELD_UDP_MULTICAST_PORT:
+    case CONFIG_FIELD_MEDIA_CLOCK_PORT:
     {
         uint16_t port = (uint16_t)strtoul(value, NULL, 10);
         if (!is_valid_port(port))
@@ -244,10 +290,12 @@ bool config_schema_validate_field(config_field_id_t field_id,
     case CONFIG_FIELD_AUDIO_SAMPLE_RATE:
     {
         uint32_t rate = strtoul(value, NULL, 10);
-        if (rate != SAMPLE_RATE)
+        if (rate != AUDIO_SAMPLE_RATE_8K && rate != AUDIO_SAMPLE_RATE_16K &&
+            rate != AUDIO_SAMPLE_RATE_22K && rate != AUDIO_SAMPLE_RATE_32K &&
+            rate != AUDIO_SAMPLE_RATE_44K && rate != AUDIO_SAMPLE_RATE_48K)
         {
-            snprintf(result->error_message, sizeof(result->error_message),
-                     "Sample rate must be %d Hz (fixed)", SAMPLE_RATE);
+            strcpy(result->error_message,
+                   "Sample rate must be 8000, 16000, 22050, 32000, 44100 or 48000 Hz");
             return false;
         }
         result->valid = true;
@@ -258,10 +306,9 @@ bool config_schema_validate_field(config_field_id_t field_id,
     case CONFIG_FIELD_AUDIO_BITS_PER_SAMPLE:
     {
         uint8_t bits = (uint8_t)strtoul(value, NULL, 10);
-        if (bits != BITS_PER_SAMPLE)
+        if (bits != 16 && bits != 24 && bits != 32)
         {
-            snprintf(result->error_message, sizeof(result->error_message),
-                     "Bits per sample must be %d (fixed)", BITS_PER_SAMPLE);
+            strcpy(result->error_message, "Bits per sample must be 16, 24 (packed) or 32");
             return false;
         }
         result->valid = true;
@@ -272,10 +319,10 @@ bool config_schema_validate_field(config_field_id_t field_id,
     case CONFIG_FIELD_AUDIO_CHANNELS:
     {
         uint8_t channels = (uint8_t)strtoul(value, NULL, 10);
-        if (channels != CHANNELS)
+        if (channels < AUDIO_CHANNELS_MIN || channels > AUDIO_CHANNELS_MAX)
         {
             snprintf(result->error_message, sizeof(result->error_message),
-                     "Channels must be %d (fixed)", CHANNELS);
+                     "Channels must be %d-%d", AUDIO_CHANNELS_MIN, AUDIO_CHANNELS_MAX);
             return false;
         }
         result->valid = true;
@@ -298,6 +345,154 @@ bool config_schema_validate_field(config_field_id_t field_id,
         break;
     }
 
+    case CONFIG_FIELD_AUDIO_CODEC:
+    {
+        uint32_t codec = strtoul(value, NULL, 10);
+        if (codec != AUDIO_CODEC_PCM && codec != AUDIO_CODEC_IMA_ADPCM &&
+            !(codec == AUDIO_CODEC_OPUS && AUDIO_CODEC_OPUS_ENABLED))
+        {
+            strcpy(result->error_message, AUDIO_CODEC_OPUS_ENABLED
+                                              ? "Codec must be 0 (PCM), 1 (IMA-ADPCM) or 2 (Opus)"
+                                              : "Codec must be 0 (PCM) or 1 (IMA-ADPCM)");
+            return false;
+        }
+        result->valid = true;
+        strcpy(result->error_message, "Valid codec");
+        break;
+    }
+
+    case CONFIG_FIELD_VAD_THRESHOLD_DB:
+    {
+        long db = strtol(value, NULL, 10);
+        if (db < -90 || db > 0)
+        {
+            strcpy(result->error_message, "VAD threshold must be -90 to 0 dBFS");
+            return false;
+        }
+        result->valid = true;
+        strcpy(result->error_message, "Valid VAD threshold");
+        break;
+    }
+
+    case CONFIG_FIELD_VAD_HANGOVER_MS:
+    {
+        uint32_t ms = strtoul(value, NULL, 10);
+        if (ms > 10000)
+        {
+            strcpy(result->error_message, "VAD hangover must be 0-10000 ms");
+            return false;
+        }
+        result->valid = true;
+        strcpy(result->error_message, "Valid VAD hangover");
+        break;
+    }
+
+    case CONFIG_FIELD_DSP_CAPTURE_RATE:
+    {
+        uint32_t rate = strtoul(value, NULL, 10);
+        if (rate != 0 && (rate < AUDIO_SAMPLE_RATE_MIN || rate > AUDIO_SAMPLE_RATE_MAX))
+        {
+            snprintf(result->error_message, sizeof(result->error_message),
+                     "Capture rate must be 0 or %d-%d Hz", AUDIO_SAMPLE_RATE_MIN, AUDIO_SAMPLE_RATE_MAX);
+            return false;
+        }
+        result->valid = true;
+        strcpy(result->error_message, "Valid capture rate");
+        break;
+    }
+
+    case CONFIG_FIELD_DSP_HIGHPASS_HZ:
+    {
+        uint32_t hz = strtoul(value, NULL, 10);
+        if (hz < 10 || hz > 1000)
+        {
+            strcpy(result->error_message, "High-pass cutoff must be 10-1000 Hz");
+            return false;
+        }
+        result->valid = true;
+        strcpy(result->error_message, "Valid high-pass cutoff");
+        break;
+    }
+
+    case CONFIG_FIELD_DSP_AGC_TARGET_DB:
+    {
+        long db = strtol(value, NULL, 10);
+        if (db < -40 || db > -3)
+        {
+            strcpy(result->error_message, "AGC target must be -40 to -3 dBFS");
+            return false;
+        }
+        result->valid = true;
+        strcpy(result->error_message, "Valid AGC target");
+        break;
+    }
+
+    case CONFIG_FIELD_DSP_AGC_MAX_GAIN_DB:
+    {
+        uint32_t db = strtoul(value, NULL, 10);
+        if (db > 40)
+        {
+            strcpy(result->error_message, "AGC max gain must be 0-40 dB");
+            return false;
+        }
+        result->valid = true;
+        strcpy(result->error_message, "Valid AGC max gain");
+        break;
+    }
+
+    case CONFIG_FIELD_DSP_LIMITER_DB:
+    {
+        long db = strtol(value, NULL, 10);
+        if (db < -20 || db > 0)
+        {
+            strcpy(result->error_message, "Limiter ceiling must be -20 to 0 dBFS");
+            return false;
+        }
+        result->valid = true;
+        strcpy(result->error_message, "Valid limiter ceiling");
+        break;
+    }
+
+    case CONFIG_FIELD_VAD_PREROLL_MS:
+    {
+        uint32_t ms = strtoul(value, NULL, 10);
+        if (ms > VAD_PREROLL_MAX_MS)
+        {
+            snprintf(result->error_message, sizeof(result->error_message),
+                     "VAD pre-roll must be 0-%d ms", VAD_PREROLL_MAX_MS);
+            return false;
+        }
+        result->valid = true;
+        strcpy(result->error_message, "Valid VAD pre-roll");
+        break;
+    }
+
+    case CONFIG_FIELD_LATENCY_PROFILE:
+    {
+        uint32_t profile = strtoul(value, NULL, 10);
+        if (profile > LATENCY_PROFILE_CUSTOM)
+        {
+            strcpy(result->error_message, "Profile must be 0 (low), 1 (balanced), 2 (archival) or 3 (custom)");
+            return false;
+        }
+        result->valid = true;
+        strcpy(result->error_message, "Valid latency profile");
+        break;
+    }
+
+    case CONFIG_FIELD_BUFFER_OVERFLOW_POLICY:
+    {
+        uint32_t policy = strtoul(value, NULL, 10);
+        if (policy > OVERFLOW_POLICY_DEGRADE)
+        {
+            strcpy(result->error_message, "Policy must be 0 (drop oldest), 1 (drop newest) or 2 (degrade)");
+            return false;
+        }
+        result->valid = true;
+        strcpy(result->error_message, "Valid overflow policy");
+        break;
+    }
+
     case CONFIG_FIELD_STREAMING_PROTOCOL:
     {
         uint8_t protocol = (uint8_t)strtoul(value, NULL, 10);
@@ -311,6 +506,20 @@ bool config_schema_validate_field(config_field_id_t field_id,
         break;
     }
 
+    case CONFIG_FIELD_UDP_FEC_GROUP_SIZE:
+    {
+        uint32_t group = strtoul(value, NULL, 10);
+        if (group < UDP_FEC_GROUP_SIZE_MIN || group > UDP_FEC_GROUP_SIZE_MAX)
+        {
+            snprintf(result->error_message, sizeof(result->error_message),
+                     "FEC group size must be %d-%d packets", UDP_FEC_GROUP_SIZE_MIN, UDP_FEC_GROUP_SIZE_MAX);
+            return false;
+        }
+        result->valid = true;
+        strcpy(result->error_message, "Valid FEC group size");
+        break;
+    }
+
     default:
         // For other fields, just check basic format
         result->valid = true;
@@ -482,6 +691,21 @@ bool config_schema_get_field_default(config_field_id_t field_id,
     case CONFIG_FIELD_AUDIO_DATA_IN_PIN:
         snprintf(buffer, buffer_size, "%d", I2S_SD_GPIO);
         break;
+    case CONFIG_FIELD_AUDIO_CODEC:
+        snprintf(buffer, buffer_size, "%d", AUDIO_CODEC_DEFAULT);
+        break;
+    case CONFIG_FIELD_VAD_ENABLED:
+        strncpy(buffer, VAD_ENABLED ? "1" : "0", buffer_size - 1);
+        break;
+    case CONFIG_FIELD_VAD_THRESHOLD_DB:
+        snprintf(buffer, buffer_size, "%d", VAD_THRESHOLD_DBFS);
+        break;
+    case CONFIG_FIELD_VAD_HANGOVER_MS:
+        snprintf(buffer, buffer_size, "%d", VAD_HANGOVER_MS);
+        break;
+    case CONFIG_FIELD_VAD_PREROLL_MS:
+        snprintf(buffer, buffer_size, "%d", VAD_PREROLL_MS);
+        break;
 
     // Buffer defaults
     case CONFIG_FIELD_BUFFER_RING_SIZE:
@@ -493,6 +717,12 @@ bool config_schema_get_field_default(config_field_id_t field_id,
     case CONFIG_FIELD_BUFFER_DMA_LENGTH:
         snprintf(buffer, buffer_size, "%d", I2S_DMA_BUF_LEN);
         break;
+    case CONFIG_FIELD_LATENCY_PROFILE:
+        snprintf(buffer, buffer_size, "%d", LATENCY_PROFILE_DEFAULT);
+        break;
+    case CONFIG_FIELD_BUFFER_OVERFLOW_POLICY:
+        snprintf(buffer, buffer_size, "%d", OVERFLOW_POLICY_DEFAULT);
+        break;
     case CONFIG_FIELD_BUFFER_ADAPTIVE_ENABLED:
         strncpy(buffer, "1", buffer_size - 1); // Enabled by default
         break;
@@ -608,10 +838,25 @@ bool config_schema_get_field_default(config_field_id_t field_id,
         snprintf(buffer, buffer_size, "%d", UDP_BUFFER_COUNT);
         break;
     case CONFIG_FIELD_UDP_MULTICAST_GROUP:
-        strncpy(buffer, "239.255.1.1", buffer_size - 1);
+        strncpy(buffer, UDP_MULTICAST_GROUP, buffer_size - 1);
         break;
     case CONFIG_FIELD_UDP_MULTICAST_PORT:
-        strncpy(buffer, "9002", buffer_size - 1);
+        snprintf(buffer, buffer_size, "%d", UDP_MULTICAST_PORT);
+        break;
+    case CONFIG_FIELD_MEDIA_CLOCK_PORT:
+        snprintf(buffer, buffer_size, "%d", MEDIA_CLOCK_SERVER_PORT);
+        break;
+    case CONFIG_FIELD_UDP_MULTICAST_ENABLED:
+        strncpy(buffer, UDP_MULTICAST_ENABLED ? "1" : "0", buffer_size - 1);
+        break;
+    case CONFIG_FIELD_UDP_MULTICAST_TTL:
+        snprintf(buffer, buffer_size, "%d", UDP_MULTICAST_TTL);
+        break;
+    case CONFIG_FIELD_UDP_FEC_ENABLED:
+        strncpy(buffer, UDP_FEC_ENABLED ? "1" : "0", buffer_size - 1);
+        break;
+    case CONFIG_FIELD_UDP_FEC_GROUP_SIZE:
+        snprintf(buffer, buffer_size, "%d", UDP_FEC_GROUP_SIZE);
         break;
 
     // TCP optimization defaults
@@ -636,6 +881,9 @@ bool config_schema_get_field_default(config_field_id_t field_id,
     case CONFIG_FIELD_TCP_RX_BUFFER_SIZE:
         snprintf(buffer, buffer_size, "%d", TCP_RX_BUFFER_SIZE);
         break;
+    case CONFIG_FIELD_TCP_FRAMING_ENABLED:
+        strncpy(buffer, TCP_FRAMING_ENABLED ? "1" : "0", buffer_size - 1);
+        break;
 
     // Performance monitoring defaults
     case CONFIG_FIELD_PERF_INTERVAL_MS:
@@ -645,6 +893,29 @@ bool config_schema_get_field_default(config_field_id_t field_id,
         snprintf(buffer, buffer_size, "%d", MAX_HISTORY_ENTRIES);
         break;
 
+    // DSP chain defaults
+    case CONFIG_FIELD_DSP_CAPTURE_RATE:
+        snprintf(buffer, buffer_size, "%d", DSP_CAPTURE_RATE);
+        break;
+    case CONFIG_FIELD_DSP_HIGHPASS_ENABLED:
+        strncpy(buffer, DSP_HIGHPASS_ENABLED ? "1" : "0", buffer_size - 1);
+        break;
+    case CONFIG_FIELD_DSP_HIGHPASS_HZ:
+        snprintf(buffer, buffer_size, "%d", DSP_HIGHPASS_HZ);
+        break;
+    case CONFIG_FIELD_DSP_AGC_ENABLED:
+        strncpy(buffer, DSP_AGC_ENABLED ? "1" : "0", buffer_size - 1);
+        break;
+    case CONFIG_FIELD_DSP_AGC_TARGET_DB:
+        snprintf(buffer, buffer_size, "%d", DSP_AGC_TARGET_DBFS);
+        break;
+    case CONFIG_FIELD_DSP_AGC_MAX_GAIN_DB:
+        snprintf(buffer, buffer_size, "%d", DSP_AGC_MAX_GAIN_DB);
+        break;
+    case CONFIG_FIELD_DSP_LIMITER_DB:
+        snprintf(buffer, buffer_size, "%d", DSP_LIMITER_DBFS);
+        break;
+
     default:
         return false;
     }
@@ -757,6 +1028,9 @@ bool config_schema_set_field_value(unified_config_t *config,
     case CONFIG_FIELD_UDP_MULTICAST_PORT:
         config->udp_multicast_port = (uint16_t)strtoul(value, NULL, 10);
         break;
+    case CONFIG_FIELD_MEDIA_CLOCK_PORT:
+        config->media_clock_port = (uint16_t)strtoul(value, NULL, 10);
+        break;
     case CONFIG_FIELD_STREAMING_PROTOCOL:
         config->streaming_protocol = (uint8_t)strtoul(value, NULL, 10);
         break;
@@ -778,6 +1052,21 @@ bool config_schema_set_field_value(unified_config_t *config,
     case CONFIG_FIELD_AUDIO_DATA_IN_PIN:
         config->audio_data_in_pin = (uint8_t)strtoul(value, NULL, 10);
         break;
+    case CONFIG_FIELD_AUDIO_CODEC:
+        config->audio_codec = (uint8_t)strtoul(value, NULL, 10);
+        break;
+    case CONFIG_FIELD_VAD_ENABLED:
+        config->vad_enabled = (strcmp(value, "1") == 0 || strcmp(value, "true") == 0);
+        break;
+    case CONFIG_FIELD_VAD_THRESHOLD_DB:
+        config->vad_threshold_db = (int8_t)strtol(value, NULL, 10);
+        break;
+    case CONFIG_FIELD_VAD_HANGOVER_MS:
+        config->vad_hangover_ms = (uint16_t)strtoul(value, NULL, 10);
+        break;
+    case CONFIG_FIELD_VAD_PREROLL_MS:
+        config->vad_preroll_ms = (uint16_t)strtoul(value, NULL, 10);
+        break;
 
     // Buffer fields
     case CONFIG_FIELD_BUFFER_RING_SIZE:
@@ -789,6 +1078,12 @@ bool config_schema_set_field_value(unified_config_t *config,
     case CONFIG_FIELD_BUFFER_DMA_LENGTH:
         config->buffer_dma_length = (uint16_t)strtoul(value, NULL, 10);
         break;
+    case CONFIG_FIELD_LATENCY_PROFILE:
+        config->latency_profile = (uint8_t)strtoul(value, NULL, 10);
+        break;
+    case CONFIG_FIELD_BUFFER_OVERFLOW_POLICY:
+        config->buffer_overflow_policy = (uint8_t)strtoul(value, NULL, 10);
+        break;
     case CONFIG_FIELD_BUFFER_ADAPTIVE_ENABLED:
         config->buffer_adaptive_enabled = (strcmp(value, "1") == 0 || strcmp(value, "true") == 0);
         break;
@@ -887,6 +1182,18 @@ bool config_schema_set_field_value(unified_config_t *config,
     case CONFIG_FIELD_UDP_BUFFER_COUNT:
         config->udp_buffer_count = (uint8_t)strtoul(value, NULL, 10);
         break;
+    case CONFIG_FIELD_UDP_MULTICAST_ENABLED:
+        config->udp_multicast_enabled = (strcmp(value, "1") == 0 || strcmp(value, "true") == 0);
+        break;
+    case CONFIG_FIELD_UDP_MULTICAST_TTL:
+        config->udp_multicast_ttl = (uint8_t)strtoul(value, NULL, 10);
+        break;
+    case CONFIG_FIELD_UDP_FEC_ENABLED:
+        config->udp_fec_enabled = (strcmp(value, "1") == 0 || strcmp(value, "true") == 0);
+        break;
+    case CONFIG_FIELD_UDP_FEC_GROUP_SIZE:
+        config->udp_fec_group_size = (uint8_t)strtoul(value, NULL, 10);
+        break;
 
     // TCP optimization fields
     case CONFIG_FIELD_TCP_KEEPALIVE_ENABLED:
@@ -910,6 +1217,9 @@ bool config_schema_set_field_value(unified_config_t *config,
     case CONFIG_FIELD_TCP_RX_BUFFER_SIZE:
         config->tcp_rx_buffer_size = strtoul(value, NULL, 10);
         break;
+    case CONFIG_FIELD_TCP_FRAMING_ENABLED:
+        config->tcp_framing_enabled = (strcmp(value, "1") == 0 || strcmp(value, "true") == 0);
+        break;
 
     // Performance monitoring fields
     case CONFIG_FIELD_PERF_INTERVAL_MS:
@@ -919,6 +1229,29 @@ bool config_schema_set_field_value(unified_config_t *config,
         config->perf_max_entries = strtoul(value, NULL, 10);
         break;
 
+    // DSP chain fields
+    case CONFIG_FIELD_DSP_CAPTURE_RATE:
+        config->dsp_capture_rate = strtoul(value, NULL, 10);
+        break;
+    case CONFIG_FIELD_DSP_HIGHPASS_ENABLED:
+        config->dsp_highpass_enabled = (strcmp(value, "1") == 0 || strcmp(value, "true") == 0);
+        break;
+    case CONFIG_FIELD_DSP_HIGHPASS_HZ:
+        config->dsp_highpass_hz = (uint16_t)strtoul(value, NULL, 10);
+        break;
+    case CONFIG_FIELD_DSP_AGC_ENABLED:
+        config->dsp_agc_enabled = (strcmp(value, "1") == 0 || strcmp(value, "true") == 0);
+        break;
+    case CONFIG_FIELD_DSP_AGC_TARGET_DB:
+        config->dsp_agc_target_db = (int8_t)strtol(value, NULL, 10);
+        break;
+    case CONFIG_FIELD_DSP_AGC_MAX_GAIN_DB:
+        config->dsp_agc_max_gain_db = (uint8_t)strtoul(value, NULL, 10);
+        break;
+    case CONFIG_FIELD_DSP_LIMITER_DB:
+        config->dsp_limiter_db = (int8_t)strtol(value, NULL, 10);
+        break;
+
     default:
         return false;
     }
@@ -995,6 +1328,9 @@ bool config_schema_get_field_value(const unified_config_t *config,
     case CONFIG_FIELD_UDP_MULTICAST_PORT:
         snprintf(buffer, buffer_size, "%d", config->udp_multicast_port);
         break;
+    case CONFIG_FIELD_MEDIA_CLOCK_PORT:
+        snprintf(buffer, buffer_size, "%d", config->media_clock_port);
+        break;
     case CONFIG_FIELD_STREAMING_PROTOCOL:
         snprintf(buffer, buffer_size, "%d", config->streaming_protocol);
         break;
@@ -1016,6 +1352,21 @@ bool config_schema_get_field_value(const unified_config_t *config,
     case CONFIG_FIELD_AUDIO_DATA_IN_PIN:
         snprintf(buffer, buffer_size, "%d", config->audio_data_in_pin);
         break;
+    case CONFIG_FIELD_AUDIO_CODEC:
+        snprintf(buffer, buffer_size, "%d", config->audio_codec);
+        break;
+    case CONFIG_FIELD_VAD_ENABLED:
+        snprintf(buffer, buffer_size, "%d", config->vad_enabled ? 1 : 0);
+        break;
+    case CONFIG_FIELD_VAD_THRESHOLD_DB:
+        snprintf(buffer, buffer_size, "%d", config->vad_threshold_db);
+        break;
+    case CONFIG_FIELD_VAD_HANGOVER_MS:
+        snprintf(buffer, buffer_size, "%d", config->vad_hangover_ms);
+        break;
+    case CONFIG_FIELD_VAD_PREROLL_MS:
+        snprintf(buffer, buffer_size, "%d", config->vad_preroll_ms);
+        break;
 
     // Buffer fields
     case CONFIG_FIELD_BUFFER_RING_SIZE:
@@ -1027,6 +1378,12 @@ bool config_schema_get_field_value(const unified_config_t *config,
     case CONFIG_FIELD_BUFFER_DMA_LENGTH:
         snprintf(buffer, buffer_size, "%d", config->buffer_dma_length);
         break;
+    case CONFIG_FIELD_LATENCY_PROFILE:
+        snprintf(buffer, buffer_size, "%d", config->latency_profile);
+        break;
+    case CONFIG_FIELD_BUFFER_OVERFLOW_POLICY:
+        snprintf(buffer, buffer_size, "%d", config->buffer_overflow_policy);
+        break;
     case CONFIG_FIELD_BUFFER_ADAPTIVE_ENABLED:
         snprintf(buffer, buffer_size, "%d", config->buffer_adaptive_enabled ? 1 : 0);
         break;
@@ -1125,6 +1482,18 @@ bool config_schema_get_field_value(const unified_config_t *config,
     case CONFIG_FIELD_UDP_BUFFER_COUNT:
         snprintf(buffer, buffer_size, "%d", config->udp_buffer_count);
         break;
+    case CONFIG_FIELD_UDP_MULTICAST_ENABLED:
+        snprintf(buffer, buffer_size, "%d", config->udp_multicast_enabled ? 1 : 0);
+        break;
+    case CONFIG_FIELD_UDP_MULTICAST_TTL:
+        snprintf(buffer, buffer_size, "%d", config->udp_multicast_ttl);
+        break;
+    case CONFIG_FIELD_UDP_FEC_ENABLED:
+        snprintf(buffer, buffer_size, "%d", config->udp_fec_enabled ? 1 : 0);
+        break;
+    case CONFIG_FIELD_UDP_FEC_GROUP_SIZE:
+        snprintf(buffer, buffer_size, "%d", config->udp_fec_group_size);
+        break;
 
     // TCP optimization fields
     case CONFIG_FIELD_TCP_KEEPALIVE_ENABLED:
@@ -1148,6 +1517,9 @@ bool config_schema_get_field_value(const unified_config_t *config,
     case CONFIG_FIELD_TCP_RX_BUFFER_SIZE:
         snprintf(buffer, buffer_size, "%lu", (unsigned long)config->tcp_rx_buffer_size);
         break;
+    case CONFIG_FIELD_TCP_FRAMING_ENABLED:
+        snprintf(buffer, buffer_size, "%d", config->tcp_framing_enabled ? 1 : 0);
+        break;
 
     // Performance monitoring fields
     case CONFIG_FIELD_PERF_INTERVAL_MS:
@@ -1157,6 +1529,29 @@ bool config_schema_get_field_value(const unified_config_t *config,
         snprintf(buffer, buffer_size, "%zu", config->perf_max_entries);
         break;
 
+    // DSP chain fields
+    case CONFIG_FIELD_DSP_CAPTURE_RATE:
+        snprintf(buffer, buffer_size, "%lu", (unsigned long)config->dsp_capture_rate);
+        break;
+    case CONFIG_FIELD_DSP_HIGHPASS_ENABLED:
+        snprintf(buffer, buffer_size, "%d", config->dsp_highpass_enabled ? 1 : 0);
+        break;
+    case CONFIG_FIELD_DSP_HIGHPASS_HZ:
+        snprintf(buffer, buffer_size, "%d", config->dsp_highpass_hz);
+        break;
+    case CONFIG_FIELD_DSP_AGC_ENABLED:
+        snprintf(buffer, buffer_size, "%d", config->dsp_agc_enabled ? 1 : 0);
+        break;
+    case CONFIG_FIELD_DSP_AGC_TARGET_DB:
+        snprintf(buffer, buffer_size, "%d", config->dsp_agc_target_db);
+        break;
+    case CONFIG_FIELD_DSP_AGC_MAX_GAIN_DB:
+        snprintf(buffer, buffer_size, "%d", config->dsp_agc_max_gain_db);
+        break;
+    case CONFIG_FIELD_DSP_LIMITER_DB:
+        snprintf(buffer, buffer_size, "%d", config->dsp_limiter_db);
+        break;
+
     default:
         return false;
     }
@@ -34,11 +34,18 @@ typedef enum {
     CONFIG_FIELD_AUDIO_BCK_PIN,
     CONFIG_FIELD_AUDIO_WS_PIN,
     CONFIG_FIELD_AUDIO_DATA_IN_PIN,
+    CONFIG_FIELD_AUDIO_CODEC,
+    CONFIG_FIELD_VAD_ENABLED,
+    CONFIG_FIELD_VAD_THRESHOLD_DB,
+    CONFIG_FIELD_VAD_HANGOVER_MS,
+    CONFIG_FIELD_VAD_PREROLL_MS,
 
     // Buffer fields
     CONFIG_FIELD_BUFFER_RING_SIZE,
     CONFIG_FIELD_BUFFER_DMA_COUNT,
     CONFIG_FIELD_BUFFER_DMA_LENGTH,
+    CONFIG_FIELD_LATENCY_PROFILE,
+    CONFIG_FIELD_BUFFER_OVERFLOW_POLICY,
     CONFIG_FIELD_BUFFER_ADAPTIVE_ENABLED,
     CONFIG_FIELD_BUFFER_ADAPTIVE_MIN_SIZE,
     CONFIG_FIELD_BUFFER_ADAPTIVE_MAX_SIZE,
@@ -80,6 +87,7 @@ typedef enum {
     // NTP fields
     CONFIG_FIELD_NTP_SERVER,
     CONFIG_FIELD_NTP_TIMEZONE,
+    CONFIG_FIELD_MEDIA_CLOCK_PORT,
 
     // UDP fields
     CONFIG_FIELD_UDP_PACKET_MAX_SIZE,
@@ -87,6 +95,10 @@ typedef enum {
     CONFIG_FIELD_UDP_BUFFER_COUNT,
     CONFIG_FIELD_UDP_MULTICAST_GROUP,
     CONFIG_FIELD_UDP_MULTICAST_PORT,
+    CONFIG_FIELD_UDP_MULTICAST_ENABLED,
+    CONFIG_FIELD_UDP_MULTICAST_TTL,
+    CONFIG_FIELD_UDP_FEC_ENABLED,
+    CONFIG_FIELD_UDP_FEC_GROUP_SIZE,
 
     // TCP optimization fields
     CONFIG_FIELD_TCP_KEEPALIVE_ENABLED,
@@ -96,11 +108,21 @@ typedef enum {
     CONFIG_FIELD_TCP_NODELAY_ENABLED,
     CONFIG_FIELD_TCP_TX_BUFFER_SIZE,
     CONFIG_FIELD_TCP_RX_BUFFER_SIZE,
+    CONFIG_FIELD_TCP_FRAMING_ENABLED,
 
     // Performance monitoring fields
     CONFIG_FIELD_PERF_INTERVAL_MS,
     CONFIG_FIELD_PERF_MAX_ENTRIES,
 
+    // DSP chain fields
+    CONFIG_FIELD_DSP_CAPTURE_RATE,
+    CONFIG_FIELD_DSP_HIGHPASS_ENABLED,
+    CONFIG_FIELD_DSP_HIGHPASS_HZ,
+    CONFIG_FIELD_DSP_AGC_ENABLED,
+    CONFIG_FIELD_DSP_AGC_TARGET_DB,
+    CONFIG_FIELD_DSP_AGC_MAX_GAIN_DB,
+    CONFIG_FIELD_DSP_LIMITER_DB,
+
     // Total number of configuration fields
     CONFIG_FIELD_COUNT
 } config_field_id_t;
@@ -143,17 +165,24 @@ typedef struct {
     uint8_t streaming_protocol; // 0=TCP, 1=UDP, 2=BOTH
 
     // Audio configuration (fixed values)
-    uint32_t audio_sample_rate;    // Fixed: 16000
-    uint8_t audio_bits_per_sample; // Fixed: 16
-    uint8_t audio_channels;        // Fixed: 1
+    uint32_t audio_sample_rate;    // 8000-48000 Hz (default 16000)
+    uint8_t audio_bits_per_sample; // 16, 24 (packed) or 32 (default 16)
+    uint8_t audio_channels;        // 1 or 2 (default 1)
     uint8_t audio_bck_pin;         // Configurable GPIO
     uint8_t audio_ws_pin;          // Configurable GPIO
     uint8_t audio_data_in_pin;     // Configurable GPIO
+    uint8_t audio_codec;           // audio_codec_t: 0=PCM, 1=IMA-ADPCM, 2=Opus
+    bool vad_enabled;              // Send silence frames while the level is below the threshold
+    int8_t vad_threshold_db;       // Gate open threshold in dBFS
+    uint16_t vad_hangover_ms;
+    uint16_t vad_preroll_ms;
 
     // Buffer configuration
     uint32_t buffer_ring_size;
     uint8_t buffer_dma_count;
     uint16_t buffer_dma_length;
+    uint8_t latency_profile;        // latency_profile_t
+    uint8_t buffer_overflow_policy; // overflow_policy_t
     bool buffer_adaptive_enabled;
     uint32_t buffer_adaptive_min_size;
     uint32_t buffer_adaptive_max_size;
@@ -195,6 +224,7 @@ typedef struct {
     // NTP configuration
     char ntp_server[64];
     char ntp_timezone[32];
+    uint16_t media_clock_port; // Stream server's time exchange (media_clock.h)
 
     // UDP configuration
     uint32_t udp_packet_max_size;
@@ -202,6 +232,10 @@ typedef struct {
     uint8_t udp_buffer_count;
     char udp_multicast_group[16];
     uint16_t udp_multicast_port;
+    bool udp_multicast_enabled; // Send to multicast group instead of udp_server_ip
+    uint8_t udp_multicast_ttl;  // 1-255 (1 = local subnet)
+    bool udp_fec_enabled;       // XOR parity packet per group
+    uint8_t udp_fec_group_size; // Data packets per parity packet (2-16)
 
     // TCP optimization configuration
     bool tcp_keepalive_enabled;
@@ -211,11 +245,21 @@ typedef struct {
     bool tcp_nodelay_enabled;
     uint32_t tcp_tx_buffer_size;
     uint32_t tcp_rx_buffer_size;
+    bool tcp_framing_enabled; // Header per block (sequence, timestamp, format)
 
     // Performance monitoring configuration
     uint32_t perf_interval_ms;
     size_t perf_max_entries;
 
+    // DSP chain
+    uint32_t dsp_capture_rate; // I2S rate, 0 = audio_sample_rate (no decimation)
+    bool dsp_highpass_enabled;
+    uint16_t dsp_highpass_hz;
+    bool dsp_agc_enabled;
+    int8_t dsp_agc_target_db;
+    uint8_t dsp_agc_max_gain_db;
+    int8_t dsp_limiter_db;
+
     // Metadata
     uint8_t version;
     uint32_t last_updated;
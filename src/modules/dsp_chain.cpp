@@ -0,0 +1,408 @@
+#include "dsp_chain.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include <string.h>
+#include <math.h>
+
+static const char *TAG = "DSP_CHAIN";
+
+#define DSP_MAX_TAPS (DSP_DECIMATOR_TAPS_PER_PHASE * DSP_DECIMATE_MAX)
+#define SAMPLE_MAX ((1 << 23) - 1) // 24-bit data
+#define SAMPLE_MIN (-(1 << 23))
+
+enum
+{
+    STAGE_RESAMPLE = 0,
+    STAGE_HIGHPASS = 1,
+    STAGE_AGC = 2
+};
+
+typedef struct
+{
+    uint64_t budget_centi;
+    uint32_t avg_centi;
+    uint32_t max_centi;
+    uint32_t over_budget;
+    uint32_t blocks;
+} stage_timing_t;
+
+static const char *stage_names[DSP_STAGE_COUNT] = {"resample", "highpass", "agc"};
+static const uint32_t stage_budgets[DSP_STAGE_COUNT] = {
+    DSP_RESAMPLE_BUDGET_CYCLES, DSP_HIGHPASS_BUDGET_CYCLES, DSP_AGC_BUDGET_CYCLES};
+static stage_timing_t timing[DSP_STAGE_COUNT];
+static bool stage_enabled[DSP_STAGE_COUNT] = {false, false, false};
+
+static size_t channels = 1;
+static uint32_t stream_rate = SAMPLE_RATE;
+
+// Decimator: Q15 windowed sinc, delay line stored twice so every window is contiguous
+static uint32_t decimation = 1;
+static size_t taps = 0;
+static int16_t coeffs[DSP_MAX_TAPS];
+static int32_t delay_line[AUDIO_CHANNELS_MAX][2 * DSP_MAX_TAPS];
+static size_t delay_pos = 0;
+static uint32_t phase = 0;
+
+// High-pass biquad (Q30), per channel state
+typedef struct
+{
+    int32_t x1, x2, y1, y2;
+    int64_t err; // Truncation residue fed back into the next sample
+} biquad_state_t;
+
+static int32_t hp_b0 = 0; // b2 = b0, b1 = -2 * b0 for a high-pass
+static int32_t hp_a1 = 0;
+static int32_t hp_a2 = 0;
+static biquad_state_t hp_state[AUDIO_CHANNELS_MAX];
+
+// AGC / limiter
+static float agc_target = 0.0f;   // RMS in 24-bit units
+static float agc_floor = 0.0f;    // Below this the gain is held
+static float agc_max_gain = 1.0f;
+static float agc_min_gain = 0.1f; // Loud input may be attenuated by up to 20 dB
+static float agc_gain = 1.0f;
+static int32_t agc_gain_q16 = 1 << 16; // Gain at the end of the previous block
+static int32_t limiter_level = SAMPLE_MAX;
+
+static inline int32_t saturate24(int64_t v)
+{
+    if (v > SAMPLE_MAX)
+        return SAMPLE_MAX;
+    if (v < SAMPLE_MIN)
+        return SAMPLE_MIN;
+    return (int32_t)v;
+}
+
+static float dbfs_to_level(float dbfs)
+{
+    return (float)SAMPLE_MAX * powf(10.0f, dbfs / 20.0f);
+}
+
+static void stage_record(int stage, uint32_t cycles, size_t out_samples)
+{
+    if (out_samples == 0)
+    {
+        return;
+    }
+
+    stage_timing_t *t = &timing[stage];
+    uint32_t centi = (uint32_t)(((uint64_t)cycles * 100) / out_samples);
+    // EMA with alpha = 1/16, seeded by the first block
+    t->avg_centi = (t->blocks == 0) ? centi : t->avg_centi + ((int32_t)(centi - t->avg_centi)) / 16;
+    t->blocks++;
+    if (centi > t->max_centi)
+    {
+        t->max_centi = centi;
+    }
+    if (centi > t->budget_centi)
+    {
+        t->over_budget++;
+    }
+}
+
+static void design_decimator(void)
+{
+    taps = DSP_DECIMATOR_TAPS_PER_PHASE * decimation;
+    const double cutoff = 0.45 / decimation; // Cycles per input sample, just below the new Nyquist
+    const double center = (taps - 1) / 2.0;
+    double h[DSP_MAX_TAPS];
+    double sum = 0.0;
+
+    for (size_t n = 0; n < taps; n++)
+    {
+        double t = n - center;
+        double sinc = (t == 0.0) ? 2.0 * cutoff : sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+        double w = 0.42 - 0.5 * cos(2.0 * M_PI * n / (taps - 1)) + 0.08 * cos(4.0 * M_PI * n / (taps - 1));
+        h[n] = sinc * w;
+        sum += h[n];
+    }
+
+    // Unity DC gain after quantization: the rounding error goes to the centre taps
+    int32_t qsum = 0;
+    for (size_t n = 0; n < taps; n++)
+    {
+        coeffs[n] = (int16_t)lround(h[n] / sum * 32768.0);
+        qsum += coeffs[n];
+    }
+    coeffs[taps / 2] += (int16_t)(32768 - qsum);
+
+    memset(delay_line, 0, sizeof(delay_line));
+    delay_pos = 0;
+    phase = 0;
+}
+
+static void design_highpass(uint32_t cutoff_hz)
+{
+    // RBJ cookbook high-pass, Q = 1/sqrt(2)
+    double w0 = 2.0 * M_PI * cutoff_hz / stream_rate;
+    double alpha = sin(w0) / (2.0 * M_SQRT1_2);
+    double a0 = 1.0 + alpha;
+    double b0 = (1.0 + cos(w0)) / 2.0 / a0;
+    double a1 = -2.0 * cos(w0) / a0;
+    double a2 = (1.0 - alpha) / a0;
+
+    hp_b0 = (int32_t)lround(b0 * (1 << 30));
+    hp_a1 = (int32_t)lround(a1 * (1 << 30));
+    hp_a2 = (int32_t)lround(a2 * (1 << 30));
+    memset(hp_state, 0, sizeof(hp_state));
+}
+
+bool dsp_chain_init(const dsp_chain_config_t *config, const i2s_audio_format_t *format)
+{
+    if (config == NULL || format == NULL || format->channels == 0 || format->channels > AUDIO_CHANNELS_MAX)
+    {
+        return false;
+    }
+
+    bool ok = true;
+    channels = format->channels;
+    stream_rate = format->sample_rate;
+    memset(timing, 0, sizeof(timing));
+    for (int i = 0; i < DSP_STAGE_COUNT; i++)
+    {
+        timing[i].budget_centi = (uint64_t)stage_budgets[i] * 100;
+    }
+
+    // Decimator
+    decimation = 1;
+    if (config->capture_rate != 0 && config->capture_rate != stream_rate)
+    {
+        uint32_t ratio = config->capture_rate / stream_rate;
+        if (config->capture_rate % stream_rate == 0 && ratio >= 2 && ratio <= DSP_DECIMATE_MAX)
+        {
+            decimation = ratio;
+            design_decimator();
+        }
+        else
+        {
+            ESP_LOGW(TAG, "Capture rate %lu Hz is not a x2-x%d multiple of %lu Hz, decimator off",
+                     config->capture_rate, DSP_DECIMATE_MAX, stream_rate);
+            ok = false;
+        }
+    }
+    stage_enabled[STAGE_RESAMPLE] = decimation > 1;
+
+    // High-pass
+    stage_enabled[STAGE_HIGHPASS] = false;
+    if (config->highpass_enabled)
+    {
+        if (config->highpass_hz > 0 && config->highpass_hz < stream_rate / 4)
+        {
+            design_highpass(config->highpass_hz);
+            stage_enabled[STAGE_HIGHPASS] = true;
+        }
+        else
+        {
+            ESP_LOGW(TAG, "High-pass cutoff %lu Hz out of range, high-pass off", config->highpass_hz);
+            ok = false;
+        }
+    }
+
+    // AGC / limiter
+    stage_enabled[STAGE_AGC] = config->agc_enabled;
+    agc_target = dbfs_to_level((float)config->agc_target_dbfs) / 1.41421356f; // Sine peak to RMS
+    agc_floor = dbfs_to_level((float)DSP_AGC_NOISE_FLOOR_DBFS);
+    agc_max_gain = powf(10.0f, config->agc_max_gain_db / 20.0f);
+    agc_gain = 1.0f;
+    agc_gain_q16 = 1 << 16;
+    limiter_level = (int32_t)dbfs_to_level((float)(config->limiter_dbfs < 0 ? config->limiter_dbfs : 0));
+
+    ESP_LOGI(TAG, "DSP chain: decimate x%lu (%zu taps), high-pass %s, AGC %s",
+             decimation, decimation > 1 ? taps : 0,
+             stage_enabled[STAGE_HIGHPASS] ? "on" : "off", stage_enabled[STAGE_AGC] ? "on" : "off");
+    return ok;
+}
+
+uint32_t dsp_chain_decimation(void)
+{
+    return decimation;
+}
+
+// Decimating FIR: only every decimation-th output is computed
+static size_t run_decimator(int32_t *samples, size_t count)
+{
+    size_t out = 0;
+    for (size_t i = 0; i + channels <= count; i += channels)
+    {
+        delay_pos = (delay_pos == 0) ? taps - 1 : delay_pos - 1;
+        for (size_t c = 0; c < channels; c++)
+        {
+            int32_t x = samples[i + c] >> 8;
+            delay_line[c][delay_pos] = x;
+            delay_line[c][delay_pos + taps] = x;
+        }
+
+        if (++phase < decimation)
+        {
+            continue;
+        }
+        phase = 0;
+
+        for (size_t c = 0; c < channels; c++)
+        {
+            const int32_t *d = &delay_line[c][delay_pos];
+            int64_t acc = 0;
+            for (size_t k = 0; k < taps; k++)
+            {
+                acc += (int64_t)d[k] * coeffs[k];
+            }
+            samples[out++] = saturate24((acc + (1 << 14)) >> 15) << 8;
+        }
+    }
+    return out;
+}
+
+static void run_highpass(int32_t *samples, size_t count)
+{
+    for (size_t c = 0; c < channels; c++)
+    {
+        biquad_state_t s = hp_state[c];
+        for (size_t i = c; i < count; i += channels)
+        {
+            int32_t x = samples[i] >> 8;
+            int64_t acc = (int64_t)hp_b0 * ((int64_t)x - 2 * (int64_t)s.x1 + s.x2) -
+                          (int64_t)hp_a1 * s.y1 - (int64_t)hp_a2 * s.y2 + s.err;
+            int64_t y = acc >> 30;
+            s.err = acc - (y << 30);
+            int32_t out = saturate24(y);
+            s.x2 = s.x1;
+            s.x1 = x;
+            s.y2 = s.y1;
+            s.y1 = out;
+            samples[i] = out << 8;
+        }
+        hp_state[c] = s;
+    }
+}
+
+static void run_agc(int32_t *samples, size_t count)
+{
+    // Block level
+    int32_t peak = 0;
+    float sum_sq = 0.0f;
+    for (size_t i = 0; i < count; i++)
+    {
+        int32_t x = samples[i] >> 8;
+        int32_t a = (x < 0) ? -x : x;
+        if (a > peak)
+            peak = a;
+        sum_sq += (float)x * (float)x;
+    }
+    float rms = sqrtf(sum_sq / count);
+
+    // Steer the gain; hold it through pauses so the noise floor is not pumped up
+    if (rms > agc_floor)
+    {
+        float desired = agc_target / rms;
+        if (desired > agc_max_gain)
+            desired = agc_max_gain;
+        if (desired < agc_min_gain)
+            desired = agc_min_gain;
+
+        float block_ms = (1000.0f * (count / channels)) / stream_rate;
+        float tau = (desired < agc_gain) ? DSP_AGC_ATTACK_MS : DSP_AGC_RELEASE_MS;
+        agc_gain += (desired - agc_gain) * (1.0f - expf(-block_ms / tau));
+    }
+
+    // Limiter: never let the block peak cross the ceiling
+    float gain = agc_gain;
+    if (peak > 0 && peak * gain > limiter_level)
+    {
+        gain = (float)limiter_level / peak;
+    }
+
+    // Ramp from the previous block's gain to avoid zipper noise
+    int32_t target_q16 = (int32_t)(gain * 65536.0f);
+    size_t frames = count / channels;
+    int32_t step = (target_q16 - agc_gain_q16) / (int32_t)(frames > 0 ? frames : 1);
+    int32_t g = agc_gain_q16;
+    for (size_t i = 0; i < count; i += channels)
+    {
+        g += step;
+        for (size_t c = 0; c < channels; c++)
+        {
+            int64_t y = ((int64_t)(samples[i + c] >> 8) * g) >> 16;
+            if (y > limiter_level)
+                y = limiter_level;
+            if (y < -limiter_level)
+                y = -limiter_level;
+            samples[i + c] = (int32_t)y << 8;
+        }
+    }
+    agc_gain_q16 = target_q16;
+}
+
+size_t dsp_chain_process(int32_t *samples, size_t count)
+{
+    if (samples == NULL || count == 0)
+    {
+        return 0;
+    }
+
+    uint32_t start;
+    if (stage_enabled[STAGE_RESAMPLE])
+    {
+        start = esp_cpu_get_cycle_count();
+        count = run_decimator(samples, count);
+        stage_record(STAGE_RESAMPLE, esp_cpu_get_cycle_count() - start, count);
+        if (count == 0)
+        {
+            return 0;
+        }
+    }
+
+    if (stage_enabled[STAGE_HIGHPASS])
+    {
+        start = esp_cpu_get_cycle_count();
+        run_highpass(samples, count);
+        stage_record(STAGE_HIGHPASS, esp_cpu_get_cycle_count() - start, count);
+    }
+
+    if (stage_enabled[STAGE_AGC])
+    {
+        start = esp_cpu_get_cycle_count();
+        run_agc(samples, count);
+        stage_record(STAGE_AGC, esp_cpu_get_cycle_count() - start, count);
+    }
+
+    return count;
+}
+
+int64_t dsp_chain_delay_us(void)
+{
+    if (decimation <= 1)
+    {
+        return 0;
+    }
+    // Linear-phase FIR: (taps - 1) / 2 input samples
+    return (int64_t)((taps - 1) * 1000000ULL) / (2ULL * stream_rate * decimation);
+}
+
+int32_t dsp_chain_agc_gain_db10(void)
+{
+    if (!stage_enabled[STAGE_AGC] || agc_gain_q16 <= 0)
+    {
+        return 0;
+    }
+    return (int32_t)lroundf(200.0f * log10f(agc_gain_q16 / 65536.0f));
+}
+
+size_t dsp_chain_get_stats(dsp_stage_stats_t *stats, size_t max_stages)
+{
+    if (stats == NULL)
+    {
+        return 0;
+    }
+
+    size_t n = (max_stages < DSP_STAGE_COUNT) ? max_stages : DSP_STAGE_COUNT;
+    for (size_t i = 0; i < n; i++)
+    {
+        stats[i].name = stage_names[i];
+        stats[i].enabled = stage_enabled[i];
+        stats[i].budget_cycles = stage_budgets[i];
+        stats[i].avg_centicycles = timing[i].avg_centi;
+        stats[i].max_centicycles = timing[i].max_centi;
+        stats[i].over_budget = timing[i].over_budget;
+    }
+    return n;
+}
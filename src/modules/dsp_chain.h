@@ -0,0 +1,101 @@
+#ifndef DSP_CHAIN_H
+#define DSP_CHAIN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../config.h"
+#include "i2s_handler.h"
+
+/**
+ * Block-based DSP on the audio core
+ *
+ * Runs in the I2S reader on raw slots, in place, before conversion into the
+ * ring. Stages, in order:
+ * - Decimator: I2S runs at capture_rate, an integer multiple of the stream
+ *   rate; a windowed-sinc FIR computes only the kept outputs
+ * - High-pass: 2nd-order Butterworth biquad (DC blocking), Q30 coefficients
+ *   with error feedback so low cutoffs do not leave a residual offset
+ * - AGC/limiter: block RMS steers a smoothed gain towards the target level,
+ *   ramped across the block; peaks are held under the limiter ceiling
+ *
+ * All sample arithmetic is fixed point on the 24-bit data. Every stage is
+ * timed with the CPU cycle counter against its budget (cycles per output
+ * sample, see DSP_*_BUDGET_CYCLES).
+ */
+
+/**
+ * DSP chain settings
+ */
+typedef struct
+{
+    uint32_t capture_rate; // I2S rate; 0 or the stream rate disables the decimator
+    bool highpass_enabled;
+    uint32_t highpass_hz;
+    bool agc_enabled;
+    int agc_target_dbfs;
+    uint32_t agc_max_gain_db;
+    int limiter_dbfs;
+} dsp_chain_config_t;
+
+/**
+ * Per-stage timing
+ */
+typedef struct
+{
+    const char *name;
+    bool enabled;
+    uint32_t budget_cycles;    // Per output sample
+    uint32_t avg_centicycles;  // Per output sample x 100 (EMA)
+    uint32_t max_centicycles;  // Worst block since boot
+    uint32_t over_budget;      // Blocks above budget
+} dsp_stage_stats_t;
+
+#define DSP_STAGE_COUNT 3
+
+/**
+ * Configure the chain for a stream format
+ *
+ * Call before the I2S reader starts. If capture_rate is not a supported
+ * integer multiple of the stream rate, the decimator is disabled.
+ *
+ * @param config Chain settings
+ * @param format Stream format (what the ring and the wire carry)
+ * @return true if every requested stage is active
+ */
+bool dsp_chain_init(const dsp_chain_config_t *config, const i2s_audio_format_t *format);
+
+/**
+ * Get the capture/stream rate ratio (1 without decimation)
+ */
+uint32_t dsp_chain_decimation(void);
+
+/**
+ * Process one chunk of raw slots in place (I2S reader only)
+ *
+ * @param samples Raw 32-bit slots, interleaved; overwritten with the output
+ * @param count Interleaved samples in (whole frames)
+ * @return Interleaved samples out (count / decimation)
+ */
+size_t dsp_chain_process(int32_t *samples, size_t count);
+
+/**
+ * Get the group delay added by the chain, for back-dating capture times
+ */
+int64_t dsp_chain_delay_us(void);
+
+/**
+ * Get the current AGC gain in dB x 10 (0 when the AGC is off)
+ */
+int32_t dsp_chain_agc_gain_db10(void);
+
+/**
+ * Get per-stage timing
+ *
+ * @param stats Output array, DSP_STAGE_COUNT entries
+ * @param max_stages Size of stats
+ * @return Number of entries filled
+ */
+size_t dsp_chain_get_stats(dsp_stage_stats_t *stats, size_t max_stages);
+
+#endif // DSP_CHAIN_H
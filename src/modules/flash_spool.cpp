@@ -0,0 +1,581 @@
+#include "flash_spool.h"
+#include "audio_encoder.h"
+#include "i2s_handler.h"
+#include "media_clock.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include <stddef.h>
+#include <atomic>
+
+static const char *TAG = "FLASH_SPOOL";
+
+#define SPOOL_SLOT_SIZE 4096 // One flash sector per record
+#define SPOOL_MAGIC 0x4C505341   // "ASPL" in flash
+#define SPOOL_PENDING 0xFFFFFFFF // replayed word as written; cleared to 0 once sent
+
+// Record header at the start of its sector; the payload follows it.
+// Written after the payload, so a record torn by a power cut has no header
+// (or fails its CRC). crc covers the header up to crc, with replayed as
+// SPOOL_PENDING, and the payload.
+typedef struct
+{
+    uint32_t magic;
+    uint32_t sequence;       // Record counter, orders the log across wraps and reboots
+    uint32_t replayed;       // SPOOL_PENDING until sent
+    uint16_t session;        // Boot the audio was captured in
+    uint16_t payload_bytes;
+    uint64_t sample_index;
+    int64_t capture_us;
+    int64_t utc_us;          // 0 = clock not synced at capture
+    uint32_t sample_rate;
+    uint16_t samples;        // Interleaved samples captured (the last frame is padded)
+    uint8_t channels;
+    uint8_t reserved;
+    uint32_t crc;
+} __attribute__((packed)) spool_header_t;
+
+// Payload: IMA-ADPCM frames (4 header bytes + 252 code bytes per mono frame)
+#define SPOOL_PAYLOAD_MAX (SPOOL_SLOT_SIZE - sizeof(spool_header_t))
+static_assert(SPOOL_PAYLOAD_MAX / (4 + AUDIO_ADPCM_FRAME_SAMPLES / 2) <= FLASH_SPOOL_RECORD_FRAMES_MAX,
+              "FLASH_SPOOL_RECORD_FRAMES_MAX must cover a full mono record");
+
+static const esp_partition_t *partition = NULL;
+static uint32_t slot_count = 0;
+static bool ready = false;
+static std::atomic<bool> enabled(true);
+static TaskHandle_t spool_task_handle = NULL;
+
+// Log position, under log_lock (never held across an erase or a record write)
+// [tail, head) holds backlog records waiting for replay, oldest first
+static SemaphoreHandle_t log_lock = NULL;
+static uint32_t head = 0;
+static uint32_t tail = 0;
+static uint32_t backlog = 0;
+static uint32_t next_sequence = 0;
+static uint16_t session = 0;
+
+// Spill staging, filled by the sender (spill) or the spool task (lent ring)
+static spool_header_t stage_header;
+static uint8_t *stage_payload = NULL;
+static int16_t *stage_pcm = NULL; // One frame of ring samples cut to 16 bits
+static audio_adpcm_state_t stage_adpcm[AUDIO_CHANNELS_MAX];
+static std::atomic<bool> staged(false);
+
+// Ring hand-over: the spool task only reads the ring while it holds reader_lock and the ring is lent
+static SemaphoreHandle_t reader_lock = NULL;
+static std::atomic<bool> ring_lent(false);
+static std::atomic<bool> spilling(false);
+
+// Replay buffer: sender task only; the peeked slot is under log_lock
+static uint8_t *replay_payload = NULL;
+static bool peeked = false;
+static uint32_t peeked_slot = 0;
+
+static std::atomic<uint32_t> spilled_count(0);
+static std::atomic<uint32_t> replayed_count(0);
+static std::atomic<uint32_t> overwritten_count(0);
+static std::atomic<uint32_t> error_count(0);
+
+// Prefer PSRAM and leave internal RAM to WiFi; boards without PSRAM use internal RAM
+static void *alloc_prefer_psram(size_t size)
+{
+    void *ptr = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (ptr == NULL)
+    {
+        ptr = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    }
+    return ptr;
+}
+
+static inline uint32_t slot_next(uint32_t slot)
+{
+    return (slot + 1) % slot_count;
+}
+
+static uint32_t header_crc(const spool_header_t *header, const uint8_t *payload)
+{
+    spool_header_t copy = *header;
+    copy.replayed = SPOOL_PENDING;
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)&copy, offsetof(spool_header_t, crc));
+    return esp_rom_crc32_le(crc, payload, header->payload_bytes);
+}
+
+static bool header_plausible(const spool_header_t *header)
+{
+    if (header->magic != SPOOL_MAGIC || header->channels < 1 || header->channels > AUDIO_CHANNELS_MAX ||
+        header->payload_bytes == 0 || header->payload_bytes > SPOOL_PAYLOAD_MAX)
+    {
+        return false;
+    }
+    size_t frame_bytes = audio_encoder_adpcm_frame_bytes(header->channels);
+    size_t frames = header->payload_bytes / frame_bytes;
+    return header->payload_bytes % frame_bytes == 0 && header->samples > 0 &&
+           header->samples <= frames * AUDIO_ADPCM_FRAME_SAMPLES * header->channels;
+}
+
+// Interleaved samples one record holds
+static size_t record_samples(uint8_t channels)
+{
+    return (SPOOL_PAYLOAD_MAX / audio_encoder_adpcm_frame_bytes(channels)) * AUDIO_ADPCM_FRAME_SAMPLES * channels;
+}
+
+/**
+ * Find the newest record and the oldest one not replayed yet
+ *
+ * Headers only: payload CRCs are checked when a record is replayed.
+ */
+static void recover_log(void)
+{
+    bool any = false;
+    bool any_pending = false;
+    uint32_t newest_sequence = 0;
+    uint32_t oldest_pending = 0;
+    uint16_t newest_session = 0;
+
+    for (uint32_t slot = 0; slot < slot_count; slot++)
+    {
+        spool_header_t header;
+        if (esp_partition_read(partition, (size_t)slot * SPOOL_SLOT_SIZE, &header, sizeof(header)) != ESP_OK ||
+            !header_plausible(&header))
+        {
+            continue;
+        }
+        if (!any || (int32_t)(header.sequence - newest_sequence) > 0)
+        {
+            newest_sequence = header.sequence;
+            newest_session = header.session;
+            head = slot_next(slot);
+            any = true;
+        }
+        if (header.replayed == SPOOL_PENDING &&
+            (!any_pending || (int32_t)(header.sequence - oldest_pending) < 0))
+        {
+            oldest_pending = header.sequence;
+            tail = slot;
+            any_pending = true;
+        }
+    }
+
+    next_sequence = any ? newest_sequence + 1 : 0;
+    session = (uint16_t)(newest_session + 1);
+    if (!any_pending)
+    {
+        tail = head;
+        backlog = 0;
+    }
+    else
+    {
+        backlog = (head + slot_count - tail) % slot_count;
+        if (backlog == 0)
+        {
+            backlog = slot_count; // Full log
+        }
+    }
+}
+
+/**
+ * Write the staged record at head (spool task)
+ */
+static void write_staged(void)
+{
+    xSemaphoreTake(log_lock, portMAX_DELAY);
+    uint32_t slot = head;
+    if (backlog == slot_count)
+    {
+        // Full: the oldest unreplayed record makes room (drop-oldest, as the ring does)
+        if (peeked && peeked_slot == tail)
+        {
+            peeked = false; // Its release must not touch the new record
+        }
+        tail = slot_next(tail);
+        backlog--;
+        overwritten_count++;
+    }
+    stage_header.magic = SPOOL_MAGIC;
+    stage_header.sequence = next_sequence++;
+    stage_header.replayed = SPOOL_PENDING;
+    stage_header.session = session;
+    xSemaphoreGive(log_lock);
+
+    stage_header.crc = header_crc(&stage_header, stage_payload);
+    size_t offset = (size_t)slot * SPOOL_SLOT_SIZE;
+
+    // Payload first, header last: a torn record never looks valid
+    bool ok = esp_partition_erase_range(partition, offset, SPOOL_SLOT_SIZE) == ESP_OK &&
+              esp_partition_write(partition, offset + sizeof(spool_header_t), stage_payload,
+                                  stage_header.payload_bytes) == ESP_OK &&
+              esp_partition_write(partition, offset, &stage_header, sizeof(stage_header)) == ESP_OK;
+
+    xSemaphoreTake(log_lock, portMAX_DELAY);
+    if (ok)
+    {
+        head = slot_next(slot);
+        backlog++;
+        spilled_count++;
+    }
+    else
+    {
+        error_count++; // The slot is retried by the next record
+    }
+    xSemaphoreGive(log_lock);
+
+    if (!ok)
+    {
+        ESP_LOGE(TAG, "Flash write failed at slot %lu", slot);
+    }
+    staged.store(false);
+}
+
+// Read ring samples as 16-bit: the top two bytes of a little-endian sample of any width
+static void span_to_16(const buffer_span_t *span, size_t offset, size_t samples, int16_t *out)
+{
+    const size_t width = span->sample_bytes;
+    for (size_t i = 0; i < samples; i++)
+    {
+        size_t pos = offset + i;
+        const uint8_t *p = pos < span->samples[0] ? span->data[0] + pos * width
+                                                  : span->data[1] + (pos - span->samples[0]) * width;
+        out[i] = (int16_t)(p[width - 2] | (p[width - 1] << 8));
+    }
+}
+
+// Encode the oldest block of ring spans into the staging record
+static size_t stage_span(const buffer_span_t *span, size_t samples)
+{
+    i2s_audio_format_t format;
+    i2s_handler_get_format(&format);
+    const uint8_t channels = format.channels > 0 ? format.channels : 1;
+    if (span->sample_bytes < 2 || channels > AUDIO_CHANNELS_MAX)
+    {
+        return 0;
+    }
+    size_t capacity = record_samples(channels);
+    if (samples > capacity)
+    {
+        samples = capacity;
+    }
+    samples -= samples % channels;
+    if (samples == 0)
+    {
+        return 0;
+    }
+
+    // Whole frames; a short last one holds its final sample to the end of the frame
+    const size_t frame_samples = AUDIO_ADPCM_FRAME_SAMPLES * channels;
+    const size_t frame_bytes = audio_encoder_adpcm_frame_bytes(channels);
+    size_t frames = (samples + frame_samples - 1) / frame_samples;
+    for (size_t f = 0; f < frames; f++)
+    {
+        size_t start = f * frame_samples;
+        size_t count = samples - start < frame_samples ? samples - start : frame_samples;
+        span_to_16(span, start, count, stage_pcm);
+        for (size_t i = count; i < frame_samples; i++)
+        {
+            stage_pcm[i] = stage_pcm[i - channels];
+        }
+        audio_encoder_adpcm_encode_frame(stage_adpcm, channels, stage_pcm, stage_payload + f * frame_bytes,
+                                         frame_bytes);
+    }
+
+    memset(&stage_header, 0, sizeof(stage_header));
+    stage_header.payload_bytes = (uint16_t)(frames * frame_bytes);
+    stage_header.samples = (uint16_t)samples;
+    stage_header.sample_index = span->sample_index;
+    stage_header.capture_us = span->capture_us;
+    int64_t utc_us = 0;
+    if (span->capture_us != 0 && media_clock_to_utc(span->capture_us, &utc_us))
+    {
+        stage_header.utc_us = utc_us;
+    }
+    stage_header.sample_rate = format.sample_rate;
+    stage_header.channels = channels;
+    return samples;
+}
+
+/**
+ * Move one record's worth of the oldest ring audio into staging (spool task, ring lent)
+ */
+static bool stage_from_ring(void)
+{
+    bool got = false;
+    xSemaphoreTake(reader_lock, portMAX_DELAY);
+    if (ring_lent.load())
+    {
+        i2s_audio_format_t format;
+        i2s_handler_get_format(&format);
+        buffer_span_t span;
+        size_t samples = buffer_manager_peek_read(record_samples(format.channels > 0 ? format.channels : 1), &span);
+        if (samples > 0)
+        {
+            // Encoded out, so a resize/reset is never held up by the flash write
+            samples = stage_span(&span, samples);
+            got = samples > 0;
+        }
+        buffer_manager_consume_read(samples);
+    }
+    xSemaphoreGive(reader_lock);
+    return got;
+}
+
+static void spool_task(void *arg)
+{
+    (void)arg;
+    bool draining = false; // Between the high and the low watermark
+    while (true)
+    {
+        // Blocks handed over by a backed-up sender first
+        if (staged.load())
+        {
+            write_staged();
+            continue;
+        }
+
+        if (!ring_lent.load() || !enabled.load())
+        {
+            if (spilling.exchange(false))
+            {
+                ESP_LOGI(TAG, "Stream back, %lu records to replay", flash_spool_pending());
+            }
+            draining = false;
+        }
+        else
+        {
+            uint8_t usage = buffer_manager_usage_percent();
+            draining = usage >= (draining ? FLASH_SPOOL_LOW_PERCENT : FLASH_SPOOL_HIGH_PERCENT);
+            if (draining)
+            {
+                if (!spilling.exchange(true))
+                {
+                    ESP_LOGW(TAG, "Stream down, spilling ring to flash (%d%% full)", usage);
+                }
+                if (stage_from_ring())
+                {
+                    staged.store(true);
+                    continue;
+                }
+            }
+        }
+
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(FLASH_SPOOL_POLL_MS));
+    }
+}
+
+bool flash_spool_init(void)
+{
+    if (!FLASH_SPOOL_ENABLED)
+    {
+        return false;
+    }
+
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                         FLASH_SPOOL_PARTITION_LABEL);
+    if (partition == NULL)
+    {
+        ESP_LOGW(TAG, "No '%s' partition, outage spool disabled", FLASH_SPOOL_PARTITION_LABEL);
+        return false;
+    }
+    slot_count = partition->size / SPOOL_SLOT_SIZE;
+    if (slot_count < 2)
+    {
+        ESP_LOGE(TAG, "Spool partition too small (%lu bytes)", (unsigned long)partition->size);
+        return false;
+    }
+
+    stage_payload = (uint8_t *)alloc_prefer_psram(SPOOL_PAYLOAD_MAX);
+    stage_pcm = (int16_t *)alloc_prefer_psram(AUDIO_ADPCM_FRAME_SAMPLES * AUDIO_CHANNELS_MAX * sizeof(int16_t));
+    replay_payload = (uint8_t *)alloc_prefer_psram(SPOOL_PAYLOAD_MAX);
+    log_lock = xSemaphoreCreateMutex();
+    reader_lock = xSemaphoreCreateMutex();
+    if (stage_payload == NULL || stage_pcm == NULL || replay_payload == NULL || log_lock == NULL ||
+        reader_lock == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to allocate spool buffers");
+        return false;
+    }
+
+    recover_log();
+
+    if (xTaskCreatePinnedToCore(spool_task, "flash_spool", FLASH_SPOOL_TASK_STACK_SIZE, NULL,
+                                FLASH_SPOOL_TASK_PRIORITY, &spool_task_handle, FLASH_SPOOL_TASK_CORE) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to start spool task");
+        return false;
+    }
+
+    ready = true;
+    flash_spool_status_t status;
+    flash_spool_get_status(&status);
+    ESP_LOGI(TAG, "Outage spool ready: %lu slots (%lu s of audio), %lu records to replay", slot_count,
+             status.capacity_ms / 1000, backlog);
+    return true;
+}
+
+void flash_spool_set_enabled(bool on)
+{
+    if (enabled.exchange(on) != on)
+    {
+        ESP_LOGI(TAG, "Outage spool %s", on ? "enabled" : "disabled");
+    }
+}
+
+bool flash_spool_active(void)
+{
+    return ready && enabled.load();
+}
+
+void flash_spool_lend_ring(void)
+{
+    if (ready && !ring_lent.exchange(true))
+    {
+        xTaskNotifyGive(spool_task_handle);
+    }
+}
+
+void flash_spool_reclaim_ring(void)
+{
+    if (!ready || !ring_lent.exchange(false))
+    {
+        return;
+    }
+    // A spill that already checked ring_lent finishes its copy first
+    xSemaphoreTake(reader_lock, portMAX_DELAY);
+    xSemaphoreGive(reader_lock);
+}
+
+size_t flash_spool_spill(const buffer_span_t *span)
+{
+    if (!flash_spool_active() || span == NULL || staged.load())
+    {
+        return 0;
+    }
+    size_t samples = stage_span(span, span->samples[0] + span->samples[1]);
+    if (samples > 0)
+    {
+        staged.store(true);
+        xTaskNotifyGive(spool_task_handle);
+    }
+    return samples;
+}
+
+uint32_t flash_spool_pending(void)
+{
+    if (!ready)
+    {
+        return 0;
+    }
+    xSemaphoreTake(log_lock, portMAX_DELAY);
+    uint32_t pending = backlog;
+    xSemaphoreGive(log_lock);
+    return pending;
+}
+
+bool flash_spool_peek(flash_spool_block_t *block)
+{
+    if (!flash_spool_active() || block == NULL)
+    {
+        return false;
+    }
+
+    xSemaphoreTake(log_lock, portMAX_DELAY);
+    peeked = false;
+    while (backlog > 0)
+    {
+        size_t offset = (size_t)tail * SPOOL_SLOT_SIZE;
+        spool_header_t header;
+        bool valid = esp_partition_read(partition, offset, &header, sizeof(header)) == ESP_OK &&
+                     header_plausible(&header) &&
+                     esp_partition_read(partition, offset + sizeof(header), replay_payload,
+                                        header.payload_bytes) == ESP_OK &&
+                     header.crc == header_crc(&header, replay_payload);
+        if (valid && header.replayed == SPOOL_PENDING)
+        {
+            block->data = replay_payload;
+            block->bytes = header.payload_bytes;
+            block->frame_bytes = audio_encoder_adpcm_frame_bytes(header.channels);
+            block->frames = header.payload_bytes / block->frame_bytes;
+            block->frame_samples = AUDIO_ADPCM_FRAME_SAMPLES * header.channels;
+            block->samples = header.samples;
+            block->channels = header.channels;
+            block->sample_rate = header.sample_rate;
+            block->sample_index = header.sample_index;
+            block->capture_us = header.capture_us;
+            block->utc_us = header.utc_us;
+            block->previous_boot = header.session != session;
+            peeked = true;
+            peeked_slot = tail;
+            break;
+        }
+
+        // Torn by a power cut (or already sent): skip it
+        if (!valid)
+        {
+            error_count++;
+            ESP_LOGW(TAG, "Skipping corrupt record at slot %lu", tail);
+        }
+        tail = slot_next(tail);
+        backlog--;
+    }
+    xSemaphoreGive(log_lock);
+    return peeked;
+}
+
+void flash_spool_release(void)
+{
+    if (!ready)
+    {
+        return;
+    }
+
+    xSemaphoreTake(log_lock, portMAX_DELAY);
+    if (peeked && peeked_slot == tail && backlog > 0)
+    {
+        // Clear the replayed word in place: programming 1 -> 0 bits needs no erase
+        uint32_t replayed = 0;
+        esp_partition_write(partition, (size_t)tail * SPOOL_SLOT_SIZE + offsetof(spool_header_t, replayed),
+                            &replayed, sizeof(replayed));
+        tail = slot_next(tail);
+        backlog--;
+        replayed_count++;
+        if (backlog == 0)
+        {
+            ESP_LOGI(TAG, "Backfill complete (%lu records replayed since boot)", replayed_count.load());
+        }
+    }
+    peeked = false;
+    xSemaphoreGive(log_lock);
+}
+
+void flash_spool_get_status(flash_spool_status_t *status)
+{
+    if (status == NULL)
+    {
+        return;
+    }
+    memset(status, 0, sizeof(*status));
+    status->ready = ready;
+    status->enabled = enabled.load();
+    status->spilling = spilling.load();
+    status->slots = slot_count;
+    status->pending = flash_spool_pending();
+
+    // Durations at the current format, from the samples one record holds
+    i2s_audio_format_t format;
+    i2s_handler_get_format(&format);
+    uint32_t sps = format.sample_rate * format.channels;
+    if (sps > 0 && format.channels <= AUDIO_CHANNELS_MAX)
+    {
+        uint64_t per_record = record_samples(format.channels);
+        status->pending_ms = (uint32_t)(status->pending * per_record * 1000 / sps);
+        status->capacity_ms = (uint32_t)(slot_count * per_record * 1000 / sps);
+    }
+    status->spilled = spilled_count.load();
+    status->replayed = replayed_count.load();
+    status->overwritten = overwritten_count.load();
+    status->errors = error_count.load();
+}
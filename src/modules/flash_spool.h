@@ -0,0 +1,146 @@
+#ifndef FLASH_SPOOL_H
+#define FLASH_SPOOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../config.h"
+#include "buffer_manager.h"
+
+/**
+ * Outage spool: ring audio kept in flash while the stream is down
+ *
+ * A circular log in the FLASH_SPOOL_PARTITION_LABEL data partition, one
+ * record per 4 KB sector: a CRC-protected header (stream index, capture
+ * time, UTC stamp, format) and the audio as IMA-ADPCM frames in the
+ * audio_encoder.h layout, whatever the live codec. Wider ring samples are
+ * cut to their top 16 bits first. At 4 bits per sample a mono record holds
+ * 15 frames (about 0.47 s at 16 kHz), so the 1536 KB partition covers
+ * about 3 minutes of a 16 kHz mono stream.
+ *
+ * Records are written in sector order and the log carries on after the
+ * newest record across reboots, so every sector is erased equally often. A
+ * record is marked replayed in place (bits cleared, no erase), so audio
+ * spooled before a restart is still sent after it.
+ *
+ * Spill: while the sender waits for WiFi or a reconnect it lends the ring
+ * to the spool task, which moves the oldest audio to flash once the ring
+ * passes FLASH_SPOOL_HIGH_PERCENT, down to FLASH_SPOOL_LOW_PERCENT. A TCP
+ * stream that stays backed up hands the blocks it would drop to
+ * flash_spool_spill() instead. When the spool is full the oldest records
+ * are overwritten.
+ *
+ * Replay: once the stream is back the sender sends spooled records between
+ * live blocks, faster than real time, as IMA-ADPCM frames flagged as
+ * backfill in the framing (TCP_FRAME_FLAG_BACKFILL, UDP header flag bit 15).
+ *
+ * Each record costs a sector erase (tens of ms with the flash cache off on
+ * both cores), so the I2S DMA depth must cover one. Not used with
+ * STREAMING_PROTOCOL_BOTH (the fan-out sinks keep their own backlog).
+ */
+
+#define FLASH_SPOOL_RECORD_FRAMES_MAX 16 // IMA-ADPCM frames in the largest record (mono)
+
+/**
+ * One spooled record, as handed to the streamers for replay
+ */
+typedef struct
+{
+    const uint8_t *data;   // IMA-ADPCM frames, frame_bytes each
+    size_t bytes;
+    size_t frames;         // At most FLASH_SPOOL_RECORD_FRAMES_MAX
+    size_t frame_bytes;    // audio_encoder_adpcm_frame_bytes(channels)
+    size_t frame_samples;  // Interleaved samples each frame encodes
+    size_t samples;        // Interleaved samples captured; the last frame is padded up to frame_samples
+    uint8_t channels;
+    uint32_t sample_rate;  // Hz
+    uint64_t sample_index; // Capture stream index of the first sample
+    int64_t capture_us;    // esp_timer capture time of the first sample
+    int64_t utc_us;        // ... in UTC (0 if the clock was not synced at capture)
+    bool previous_boot;    // Captured before the last restart: sample_index and capture_us are of that boot
+} flash_spool_block_t;
+
+/**
+ * Spool status
+ */
+typedef struct
+{
+    bool ready;           // Partition found and buffers allocated
+    bool enabled;         // Spill and replay allowed (see flash_spool_set_enabled)
+    bool spilling;        // The stream is down and the ring has been moved to flash
+    uint32_t slots;       // Records the partition holds
+    uint32_t pending;     // Records waiting for replay
+    uint32_t pending_ms;  // ... as audio at the current format
+    uint32_t capacity_ms; // Audio the partition holds at the current format
+    uint32_t spilled;     // Records written since boot
+    uint32_t replayed;    // Records sent as backfill since boot
+    uint32_t overwritten; // Unreplayed records lost to a full spool
+    uint32_t errors;      // Failed flash writes and records that failed their CRC
+} flash_spool_status_t;
+
+/**
+ * Find the partition, recover the log and start the spool task
+ * @return false if spooling is compiled out, the partition is missing or allocation failed
+ */
+bool flash_spool_init(void);
+
+/**
+ * Allow or stop spill and replay (records already spooled are kept)
+ * TCP streams turn the spool off without framing: backfill could not be told apart.
+ */
+void flash_spool_set_enabled(bool enabled);
+
+/**
+ * Check whether the spool is ready and enabled
+ */
+bool flash_spool_active(void);
+
+/**
+ * Let the spool task drain the ring (network sender, while it is not reading the ring)
+ */
+void flash_spool_lend_ring(void);
+
+/**
+ * Take the ring back before reading it again (network sender)
+ * Waits for a spill in progress to release the ring, never for the flash write.
+ */
+void flash_spool_reclaim_ring(void);
+
+/**
+ * Hand over the oldest part of a peeked block instead of dropping it (network sender)
+ *
+ * Copies up to one record; the flash write happens in the spool task.
+ *
+ * @param span Spans from buffer_manager_peek_read()
+ * @return Samples taken (consume them), 0 if the spool is inactive or busy
+ */
+size_t flash_spool_spill(const buffer_span_t *span);
+
+/**
+ * Get the number of records waiting for replay (0 without a spool partition)
+ */
+uint32_t flash_spool_pending(void);
+
+/**
+ * Read the oldest record waiting for replay (network sender)
+ *
+ * Records that fail their CRC are skipped. block->data stays valid until
+ * the next peek or release.
+ *
+ * @param block Output
+ * @return false if nothing is waiting
+ */
+bool flash_spool_peek(flash_spool_block_t *block);
+
+/**
+ * Mark the peeked record replayed (after the streamer accepted it)
+ */
+void flash_spool_release(void);
+
+/**
+ * Get spool status
+ * @param status Output
+ */
+void flash_spool_get_status(flash_spool_status_t *status);
+
+#endif // FLASH_SPOOL_H
@@ -1,22 +1,149 @@
 #include "i2s_handler.h"
+#include "audio_convert.h"
 #include "../config.h"
 #include "driver/i2s_std.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include <string.h>
 
 static const char *TAG = "I2S_HANDLER";
 static uint32_t overflow_count = 0;
 static uint32_t underflow_count = 0;
 static i2s_chan_handle_t rx_chan = NULL;
 
+typedef void (*convert_kernel_t)(const int32_t *in, uint8_t *out, size_t samples);
+
+static void convert_kernel_16(const int32_t *in, uint8_t *out, size_t samples)
+{
+    audio_convert_to_16(in, (int16_t *)out, samples);
+}
+
+// Active capture format and the kernel that produces it
+static i2s_audio_format_t current_format = {
+    .sample_rate = SAMPLE_RATE,
+    .bits_per_sample = BITS_PER_SAMPLE,
+    .channels = CHANNELS};
+static size_t current_bytes_per_sample = BYTES_PER_SAMPLE;
+static convert_kernel_t current_kernel = convert_kernel_16;
+
+// DMA layout used by the next i2s_handler_init()
+static uint32_t dma_desc_num = I2S_DMA_BUF_COUNT;
+static uint32_t dma_frame_num = I2S_DMA_BUF_LEN;
+
+// I2S clock rate when the DSP chain decimates (0 = stream rate)
+static uint32_t capture_rate = 0;
+
+// Largest DMA descriptor the I2S driver accepts
+#define DMA_DESC_MAX_BYTES 4092
+
+static bool is_supported_sample_rate(uint32_t rate)
+{
+    switch (rate)
+    {
+    case AUDIO_SAMPLE_RATE_8K:
+    case AUDIO_SAMPLE_RATE_16K:
+    case AUDIO_SAMPLE_RATE_22K:
+    case AUDIO_SAMPLE_RATE_32K:
+    case AUDIO_SAMPLE_RATE_44K:
+    case AUDIO_SAMPLE_RATE_48K:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool i2s_handler_set_format(const i2s_audio_format_t *format)
+{
+    if (format == NULL)
+    {
+        return false;
+    }
+
+    if (!is_supported_sample_rate(format->sample_rate))
+    {
+        ESP_LOGE(TAG, "Unsupported sample rate: %lu Hz", format->sample_rate);
+        return false;
+    }
+
+    if (format->channels < AUDIO_CHANNELS_MIN || format->channels > AUDIO_CHANNELS_MAX)
+    {
+        ESP_LOGE(TAG, "Unsupported channel count: %d", format->channels);
+        return false;
+    }
+
+    switch (format->bits_per_sample)
+    {
+    case 16:
+        current_kernel = convert_kernel_16;
+        current_bytes_per_sample = 2;
+        break;
+    case 24:
+        current_kernel = audio_convert_to_24;
+        current_bytes_per_sample = 3;
+        break;
+    case 32:
+        current_kernel = audio_convert_to_32;
+        current_bytes_per_sample = 4;
+        break;
+    default:
+        ESP_LOGE(TAG, "Unsupported bits per sample: %d", format->bits_per_sample);
+        return false;
+    }
+
+    current_format = *format;
+    ESP_LOGI(TAG, "Capture format: %lu Hz, %d-bit (%zu bytes/sample), %s",
+             current_format.sample_rate, current_format.bits_per_sample,
+             current_bytes_per_sample, current_format.channels == 2 ? "stereo" : "mono");
+    return true;
+}
+
+void i2s_handler_get_format(i2s_audio_format_t *format)
+{
+    if (format)
+    {
+        *format = current_format;
+    }
+}
+
+size_t i2s_handler_bytes_per_sample(void)
+{
+    return current_bytes_per_sample;
+}
+
+void i2s_handler_set_dma(uint32_t desc_num, uint32_t frame_num)
+{
+    const uint32_t max_frames = DMA_DESC_MAX_BYTES / ((I2S_SLOT_BIT_WIDTH / 8) * current_format.channels);
+    dma_desc_num = desc_num;
+    dma_frame_num = (frame_num > max_frames) ? max_frames : frame_num;
+}
+
+bool i2s_handler_set_capture_rate(uint32_t rate)
+{
+    if (rate != 0 && (!is_supported_sample_rate(rate) || rate % current_format.sample_rate != 0))
+    {
+        ESP_LOGE(TAG, "Capture rate %lu Hz is not a supported multiple of %lu Hz",
+                 rate, current_format.sample_rate);
+        return false;
+    }
+    capture_rate = (rate == current_format.sample_rate) ? 0 : rate;
+    return true;
+}
+
+uint32_t i2s_handler_get_capture_rate(void)
+{
+    return capture_rate != 0 ? capture_rate : current_format.sample_rate;
+}
+
 bool i2s_handler_init(void)
 {
     esp_err_t ret;
 
     // I2S channel configuration (master, RX only)
     i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_0, I2S_ROLE_MASTER);
+    chan_cfg.dma_desc_num = dma_desc_num;
+    chan_cfg.dma_frame_num = dma_frame_num;
     ret = i2s_new_channel(&chan_cfg, NULL, &rx_chan);
     if (ret != ESP_OK)
     {
@@ -24,24 +151,25 @@ bool i2s_handler_init(void)
         return false;
     }
 
-    // Clock configuration: 16 kHz (fixed), no MCLK
-    // Note: bits_per_sample is the post-conversion output format (16-bit)
-    // while I2S hardware captures 24-bit data in 32-bit slots (Philips standard)
-    // Conversion from 24-bit to 16-bit happens in i2s_read_16() function
+    // Clock configuration: capture rate (stream rate unless the DSP chain decimates), no MCLK
+    // Note: bits_per_sample is the post-conversion output format (16/24/32-bit)
+    // while I2S hardware always captures 24-bit data in 32-bit slots (Philips standard)
+    // Conversion happens in the kernel selected by i2s_handler_set_format()
     i2s_std_clk_config_t clk_cfg = {
-        .sample_rate_hz = SAMPLE_RATE,
+        .sample_rate_hz = i2s_handler_get_capture_rate(),
         .clk_src = I2S_CLK_SRC_DEFAULT,
         .ext_clk_freq_hz = 0,
         .mclk_multiple = (i2s_mclk_multiple_t)0, // Disable MCLK
         .bclk_div = 8                            // BCLK divider (default for most cases)
     };
 
-    // Slot: Philips standard, mono-left, 32-bit slot, 24-bit data
+    // Slot: Philips standard, mono-left or stereo (interleaved L/R), 32-bit slot, 24-bit data
+    bool stereo = (current_format.channels == AUDIO_CHANNELS_STEREO);
     i2s_std_slot_config_t slot_cfg = {
         .data_bit_width = I2S_DATA_BIT_WIDTH_24BIT,
         .slot_bit_width = (i2s_slot_bit_width_t)I2S_SLOT_BIT_WIDTH,
-        .slot_mode = I2S_SLOT_MODE_MONO,
-        .slot_mask = I2S_STD_SLOT_LEFT,
+        .slot_mode = stereo ? I2S_SLOT_MODE_STEREO : I2S_SLOT_MODE_MONO,
+        .slot_mask = stereo ? I2S_STD_SLOT_BOTH : I2S_STD_SLOT_LEFT,
         .ws_width = I2S_DATA_BIT_WIDTH_32BIT,
         .ws_pol = false,
         .bit_shift = true,
@@ -89,9 +217,11 @@ bool i2s_handler_init(void)
         return false;
     }
 
-    ESP_LOGI(TAG, "I2S initialized successfully (Philips standard, 32-bit slot, 24-bit data, mono-left)");
-    ESP_LOGI(TAG, "Sample rate: %d Hz, BCLK: GPIO%d, WS: GPIO%d, SD: GPIO%d",
-             SAMPLE_RATE, I2S_BCLK_GPIO, I2S_WS_GPIO, I2S_SD_GPIO);
+    ESP_LOGI(TAG, "I2S initialized successfully (Philips standard, 32-bit slot, 24-bit data, %s)",
+             stereo ? "stereo" : "mono-left");
+    ESP_LOGI(TAG, "Sample rate: %lu Hz (capture %lu Hz), output: %d-bit, BCLK: GPIO%d, WS: GPIO%d, SD: GPIO%d",
+             current_format.sample_rate, i2s_handler_get_capture_rate(), current_format.bits_per_sample,
+             I2S_BCLK_GPIO, I2S_WS_GPIO, I2S_SD_GPIO);
 
     return true;
 }
@@ -175,10 +305,7 @@ size_t i2s_read_16(int16_t *out, int32_t *tmp_buffer, size_t samples)
             break;
         }
         size_t n = bytes_read / sizeof(int32_t);
-        for (size_t i = 0; i < n; ++i)
-        {
-            out_ptr[i] = (int16_t)(tmp_buffer[i] >> 16);
-        }
+        audio_convert_to_16(tmp_buffer, out_ptr, n);
         out_ptr += n;
         total_samples_read += n;
         if (n < chunk_samples)
@@ -192,6 +319,44 @@ size_t i2s_read_16(int16_t *out, int32_t *tmp_buffer, size_t samples)
     return total_samples_read;
 }
 
+size_t i2s_read_raw(int32_t *tmp_buffer, size_t samples)
+{
+    if (tmp_buffer == NULL)
+    {
+        ESP_LOGE(TAG, "Invalid temporary buffer");
+        return 0;
+    }
+
+    if (rx_chan == NULL)
+    {
+        ESP_LOGE(TAG, "I2S channel not initialized");
+        return 0;
+    }
+
+    size_t chunk_samples = samples > I2S_READ_SAMPLES_MAX ? I2S_READ_SAMPLES_MAX : samples;
+    size_t bytes_read = 0;
+    esp_err_t ret = i2s_channel_read(rx_chan, tmp_buffer, chunk_samples * sizeof(int32_t),
+                                     &bytes_read, portMAX_DELAY);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "I2S read failed: %s", esp_err_to_name(ret));
+        return 0;
+    }
+
+    size_t n = bytes_read / sizeof(int32_t);
+    if (n < chunk_samples)
+    {
+        underflow_count++;
+    }
+
+    return n;
+}
+
+void i2s_convert(const int32_t *in, uint8_t *out, size_t samples)
+{
+    current_kernel(in, out, samples);
+}
+
 void i2s_handler_deinit(void)
 {
     if (rx_chan != NULL)
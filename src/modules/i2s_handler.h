@@ -5,13 +5,79 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+/**
+ * Capture/transport format
+ *
+ * The INMP441 always delivers 24-bit data in a 32-bit slot; bits_per_sample
+ * selects what is stored in the ring buffer and sent on the wire:
+ * - 16: top 16 bits, 2 bytes per sample
+ * - 24: full 24 bits packed little-endian, 3 bytes per sample
+ * - 32: raw slot passthrough, 4 bytes per sample
+ * Stereo samples are interleaved L, R.
+ */
+typedef struct
+{
+    uint32_t sample_rate;    // Hz
+    uint8_t bits_per_sample; // 16, 24 or 32
+    uint8_t channels;        // 1 = mono (left slot), 2 = stereo
+} i2s_audio_format_t;
+
+/**
+ * Set capture format used by the next i2s_handler_init()
+ *
+ * Also selects the conversion kernel used by i2s_convert().
+ *
+ * @param format Requested format
+ * @return true if the format is supported, false otherwise (format unchanged)
+ */
+bool i2s_handler_set_format(const i2s_audio_format_t *format);
+
+/**
+ * Get current capture format
+ *
+ * @param format Output format
+ */
+void i2s_handler_get_format(i2s_audio_format_t *format);
+
+/**
+ * Get bytes stored per sample for the current format (2, 3 or 4)
+ */
+size_t i2s_handler_bytes_per_sample(void);
+
+/**
+ * Set DMA layout used by the next i2s_handler_init()
+ *
+ * Deeper DMA absorbs scheduling jitter, shorter descriptors hand data to
+ * the reader sooner (see latency_profile.h).
+ *
+ * @param desc_num Number of DMA descriptors
+ * @param frame_num Frames per descriptor (clamped to 4092 bytes of slots)
+ */
+void i2s_handler_set_dma(uint32_t desc_num, uint32_t frame_num);
+
+/**
+ * Set the I2S clock rate used by the next i2s_handler_init()
+ *
+ * The capture format keeps the stream rate; the DSP chain decimates the
+ * capture rate down to it (see dsp_chain.h). Call after i2s_handler_set_format().
+ *
+ * @param rate Supported rate, an integer multiple of the stream rate (0 = stream rate)
+ * @return true if accepted
+ */
+bool i2s_handler_set_capture_rate(uint32_t rate);
+
+/**
+ * Get the I2S clock rate (the stream rate unless decimating)
+ */
+uint32_t i2s_handler_get_capture_rate(void);
+
 /**
  * Initialize I2S driver for INMP441 MEMS microphone
  *
  * Configures:
- * - 16 kHz sample rate
+ * - Sample rate and channel layout from i2s_handler_set_format()
+ *   (default 16 kHz mono-left)
  * - 24-bit data in 32-bit slot (Philips standard)
- * - Mono (left channel only, L/R pin to GND)
  * - I2S standard mode (master-RX)
  * - Proper BCLK, WS, SD GPIO pins
  *
@@ -46,6 +112,30 @@ bool i2s_handler_read(int32_t *buffer, size_t samples_to_read, size_t *bytes_rea
  */
 size_t i2s_read_16(int16_t *out, int32_t *tmp_buffer, size_t samples);
 
+/**
+ * Read one chunk of raw 32-bit slots from the I2S DMA buffer
+ *
+ * Used by the zero-copy capture path: the caller converts the raw slots
+ * straight into ring buffer space with i2s_convert().
+ *
+ * @param tmp_buffer Buffer for 32-bit samples (at least I2S_READ_SAMPLES)
+ * @param samples Number of samples to read (clamped to I2S_READ_SAMPLES_MAX)
+ * @return Number of samples actually read, 0 on failure
+ */
+size_t i2s_read_raw(int32_t *tmp_buffer, size_t samples);
+
+/**
+ * Convert raw slots with the kernel selected for the current format
+ *
+ * Kernels live in audio_convert (SIMD where available, DC offset and gain
+ * applied per audio_convert_set_params()).
+ *
+ * @param in Raw samples from i2s_read_raw()
+ * @param out Destination, i2s_handler_bytes_per_sample() bytes per sample
+ * @param samples Number of samples to convert
+ */
+void i2s_convert(const int32_t *in, uint8_t *out, size_t samples);
+
 /**
  * Deinitialize I2S driver
  */
@@ -0,0 +1,229 @@
+#include "json_stream.h"
+#include "web_server_v2.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <inttypes.h>
+
+static const char *TAG = "JSON_STREAM";
+
+static void flush(json_stream_t *js)
+{
+    if (js->failed || js->len == 0)
+    {
+        return;
+    }
+    if (httpd_resp_send_chunk(js->req, js->buf, js->len) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Client went away mid-response");
+        js->failed = true;
+    }
+    js->len = 0;
+}
+
+static void put(json_stream_t *js, const char *data, size_t len)
+{
+    while (len > 0 && !js->failed)
+    {
+        size_t room = sizeof(js->buf) - js->len;
+        if (room == 0)
+        {
+            flush(js);
+            continue;
+        }
+        size_t n = len < room ? len : room;
+        memcpy(js->buf + js->len, data, n);
+        js->len += n;
+        data += n;
+        len -= n;
+    }
+}
+
+static inline void put_char(json_stream_t *js, char c)
+{
+    put(js, &c, 1);
+}
+
+static void put_escaped(json_stream_t *js, const char *s)
+{
+    put_char(js, '"');
+    const char *run = s;
+    for (; *s != '\0'; s++)
+    {
+        unsigned char c = (unsigned char)*s;
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue;
+        }
+        put(js, run, s - run);
+        run = s + 1;
+
+        char esc[8];
+        switch (c)
+        {
+        case '"':
+            put(js, "\\\"", 2);
+            break;
+        case '\\':
+            put(js, "\\\\", 2);
+            break;
+        case '\n':
+            put(js, "\\n", 2);
+            break;
+        case '\r':
+            put(js, "\\r", 2);
+            break;
+        case '\t':
+            put(js, "\\t", 2);
+            break;
+        default:
+            snprintf(esc, sizeof(esc), "\\u%04x", c);
+            put(js, esc, 6);
+            break;
+        }
+    }
+    put(js, run, s - run);
+    put_char(js, '"');
+}
+
+// Comma and key for the next value at the current level
+static void begin_value(json_stream_t *js, const char *key)
+{
+    uint32_t bit = 1u << js->depth;
+    if (js->has_items & bit)
+    {
+        put_char(js, ',');
+    }
+    js->has_items |= bit;
+
+    if (key != NULL)
+    {
+        put_escaped(js, key);
+        put_char(js, ':');
+    }
+}
+
+static void open_level(json_stream_t *js, const char *key, char bracket)
+{
+    begin_value(js, key);
+    put_char(js, bracket);
+    if (js->depth + 1 >= JSON_STREAM_MAX_DEPTH)
+    {
+        ESP_LOGE(TAG, "Nesting deeper than %d", JSON_STREAM_MAX_DEPTH);
+        js->failed = true;
+        return;
+    }
+    js->depth++;
+    js->has_items &= ~(1u << js->depth);
+}
+
+static void close_level(json_stream_t *js, char bracket)
+{
+    if (js->depth > 0)
+    {
+        js->depth--;
+    }
+    put_char(js, bracket);
+}
+
+void json_stream_begin(json_stream_t *js, httpd_req_t *req)
+{
+    js->req = req;
+    js->len = 0;
+    js->has_items = 0;
+    js->depth = 0;
+    js->failed = false;
+
+    web_server_v2_add_cors_headers(req);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_status(req, HTTPD_200);
+}
+
+void json_stream_object_start(json_stream_t *js, const char *key)
+{
+    open_level(js, key, '{');
+}
+
+void json_stream_object_end(json_stream_t *js)
+{
+    close_level(js, '}');
+}
+
+void json_stream_array_start(json_stream_t *js, const char *key)
+{
+    open_level(js, key, '[');
+}
+
+void json_stream_array_end(json_stream_t *js)
+{
+    close_level(js, ']');
+}
+
+void json_stream_add_string(json_stream_t *js, const char *key, const char *value)
+{
+    begin_value(js, key);
+    if (value == NULL)
+    {
+        put(js, "null", 4);
+        return;
+    }
+    put_escaped(js, value);
+}
+
+void json_stream_add_int(json_stream_t *js, const char *key, int64_t value)
+{
+    char num[24];
+    int n = snprintf(num, sizeof(num), "%" PRId64, value);
+    begin_value(js, key);
+    put(js, num, n);
+}
+
+void json_stream_add_uint(json_stream_t *js, const char *key, uint64_t value)
+{
+    char num[24];
+    int n = snprintf(num, sizeof(num), "%" PRIu64, value);
+    begin_value(js, key);
+    put(js, num, n);
+}
+
+void json_stream_add_number(json_stream_t *js, const char *key, double value)
+{
+    begin_value(js, key);
+    if (!isfinite(value))
+    {
+        put(js, "null", 4); // JSON has no NaN/Inf
+        return;
+    }
+    char num[32];
+    int n = snprintf(num, sizeof(num), "%.10g", value);
+    put(js, num, n);
+}
+
+void json_stream_add_bool(json_stream_t *js, const char *key, bool value)
+{
+    begin_value(js, key);
+    if (value)
+    {
+        put(js, "true", 4);
+    }
+    else
+    {
+        put(js, "false", 5);
+    }
+}
+
+esp_err_t json_stream_finish(json_stream_t *js)
+{
+    flush(js);
+    if (js->failed)
+    {
+        return ESP_FAIL;
+    }
+    // Zero-length chunk ends the chunked response
+    if (httpd_resp_send_chunk(js->req, NULL, 0) != ESP_OK)
+    {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,66 @@
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_http_server.h"
+#include "../config.h"
+
+/**
+ * Streaming JSON writer for HTTP responses
+ *
+ * Values are formatted into a fixed scratch buffer inside the writer and
+ * flushed with httpd_resp_send_chunk() whenever it fills, so a response of
+ * any size costs JSON_STREAM_CHUNK_SIZE bytes of stack and no heap. Commas
+ * and nesting are tracked by the writer; pass a key inside objects and NULL
+ * inside arrays. After a failed send every further call is a no-op and
+ * json_stream_finish() reports the failure.
+ */
+
+#define JSON_STREAM_MAX_DEPTH 16
+
+typedef struct
+{
+    httpd_req_t *req;
+    char buf[JSON_STREAM_CHUNK_SIZE];
+    size_t len;
+    uint32_t has_items; // Bit per nesting level: a value was written there
+    uint8_t depth;
+    bool failed;
+} json_stream_t;
+
+/**
+ * Start a 200 application/json response (CORS headers included)
+ */
+void json_stream_begin(json_stream_t *js, httpd_req_t *req);
+
+/**
+ * Open and close an object (key NULL at the top level and inside arrays)
+ */
+void json_stream_object_start(json_stream_t *js, const char *key);
+void json_stream_object_end(json_stream_t *js);
+
+/**
+ * Open and close an array
+ */
+void json_stream_array_start(json_stream_t *js, const char *key);
+void json_stream_array_end(json_stream_t *js);
+
+/**
+ * Add a member (or an array element with key NULL)
+ */
+void json_stream_add_string(json_stream_t *js, const char *key, const char *value);
+void json_stream_add_int(json_stream_t *js, const char *key, int64_t value);
+void json_stream_add_uint(json_stream_t *js, const char *key, uint64_t value);
+void json_stream_add_number(json_stream_t *js, const char *key, double value);
+void json_stream_add_bool(json_stream_t *js, const char *key, bool value);
+
+/**
+ * Flush the remaining bytes and end the chunked response
+ *
+ * @return ESP_OK, or ESP_FAIL if any chunk could not be sent
+ */
+esp_err_t json_stream_finish(json_stream_t *js);
+
+#endif // JSON_STREAM_H
@@ -0,0 +1,198 @@
+#include "latency_profile.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "LATENCY";
+
+// Profile definitions in milliseconds; converted to samples for the capture format
+typedef struct
+{
+    latency_profile_t id;
+    const char *name;
+    uint32_t budget_ms;
+    uint16_t chunk_ms;
+    uint8_t dma_desc_num;
+    uint16_t wake_ms;
+    uint16_t block_ms;
+} profile_def_t;
+
+static const profile_def_t profiles[] = {
+    {LATENCY_PROFILE_LOW, "low", 10, 2, 4, 4, 4},
+    {LATENCY_PROFILE_BALANCED, "balanced", 40, 8, 4, 16, 24},
+    {LATENCY_PROFILE_ARCHIVAL, "archival", 250, 16, 8, 128, 256},
+};
+
+// Largest DMA descriptor the I2S driver accepts
+#define DMA_DESC_MAX_BYTES 4092
+#define MIN_CHUNK_FRAMES 8
+
+static latency_params_t active = {
+    .profile = LATENCY_PROFILE_CUSTOM,
+    .budget_ms = 0,
+    .i2s_read_samples = I2S_READ_SAMPLES,
+    .dma_desc_num = I2S_DMA_BUF_COUNT,
+    .dma_frame_num = I2S_DMA_BUF_LEN,
+    .send_samples = TCP_SEND_SAMPLES,
+    .wake_samples = NETWORK_SENDER_WATERMARK_SAMPLES};
+
+// Latency statistics (written by the network sender only)
+static uint32_t stat_last_us = 0;
+static uint32_t stat_avg_us = 0;
+static uint32_t stat_window_max_us = 0;
+static uint32_t stat_prev_window_max_us = 0;
+static uint32_t stat_window_count = 0;
+static uint32_t stat_over_budget = 0;
+static uint32_t stat_samples = 0;
+
+// Samples (interleaved, whole frames) covering ms of audio
+static size_t ms_to_samples(const i2s_audio_format_t *format, uint32_t ms)
+{
+    size_t frames = (size_t)(((uint64_t)format->sample_rate * ms) / 1000);
+    if (frames < MIN_CHUNK_FRAMES)
+    {
+        frames = MIN_CHUNK_FRAMES;
+    }
+    return frames * format->channels;
+}
+
+// Round down to whole frames, at least one
+static size_t clamp_samples(size_t samples, size_t max_samples, uint8_t channels)
+{
+    if (samples > max_samples)
+    {
+        samples = max_samples;
+    }
+    samples -= samples % channels;
+    return samples > 0 ? samples : channels;
+}
+
+bool latency_profile_apply(latency_profile_t profile, const i2s_audio_format_t *format,
+                           uint32_t custom_dma_count, uint32_t custom_dma_len)
+{
+    if (format == NULL || format->channels == 0)
+    {
+        return false;
+    }
+
+    const profile_def_t *def = NULL;
+    for (size_t i = 0; i < sizeof(profiles) / sizeof(profiles[0]); i++)
+    {
+        if (profiles[i].id == profile)
+        {
+            def = &profiles[i];
+            break;
+        }
+    }
+
+    const uint8_t channels = format->channels;
+    const uint32_t max_dma_frames = DMA_DESC_MAX_BYTES / ((I2S_SLOT_BIT_WIDTH / 8) * channels);
+    latency_params_t params;
+    memset(&params, 0, sizeof(params));
+
+    if (def != NULL)
+    {
+        params.profile = def->id;
+        params.budget_ms = def->budget_ms;
+        params.i2s_read_samples = clamp_samples(ms_to_samples(format, def->chunk_ms), I2S_READ_SAMPLES_MAX, channels);
+        params.dma_desc_num = def->dma_desc_num;
+        params.dma_frame_num = params.i2s_read_samples / channels;
+        params.send_samples = clamp_samples(ms_to_samples(format, def->block_ms), LATENCY_SEND_SAMPLES_MAX, channels);
+        params.wake_samples = clamp_samples(ms_to_samples(format, def->wake_ms), params.send_samples, channels);
+    }
+    else
+    {
+        if (profile != LATENCY_PROFILE_CUSTOM)
+        {
+            ESP_LOGW(TAG, "Unknown latency profile %d, using custom sizes", profile);
+        }
+        params.profile = LATENCY_PROFILE_CUSTOM;
+        params.budget_ms = 0;
+        params.i2s_read_samples = clamp_samples(I2S_READ_SAMPLES, I2S_READ_SAMPLES_MAX, channels);
+        params.dma_desc_num = custom_dma_count;
+        params.dma_frame_num = custom_dma_len;
+        params.send_samples = clamp_samples(TCP_SEND_SAMPLES, LATENCY_SEND_SAMPLES_MAX, channels);
+        params.wake_samples = NETWORK_SENDER_WATERMARK_SAMPLES;
+    }
+
+    // Keep the DMA inside what the driver accepts
+    if (params.dma_desc_num < 2)
+    {
+        params.dma_desc_num = 2;
+    }
+    if (params.dma_frame_num < MIN_CHUNK_FRAMES)
+    {
+        params.dma_frame_num = MIN_CHUNK_FRAMES;
+    }
+    if (params.dma_frame_num > max_dma_frames)
+    {
+        params.dma_frame_num = max_dma_frames;
+    }
+
+    active = params;
+
+    ESP_LOGI(TAG, "Latency profile %s: chunk %zu, DMA %lu x %lu, block %zu, wake %zu samples",
+             latency_profile_name(active.profile), active.i2s_read_samples,
+             active.dma_desc_num, active.dma_frame_num, active.send_samples, active.wake_samples);
+    return def != NULL || profile == LATENCY_PROFILE_CUSTOM;
+}
+
+const latency_params_t *latency_profile_get(void)
+{
+    return &active;
+}
+
+const char *latency_profile_name(latency_profile_t profile)
+{
+    for (size_t i = 0; i < sizeof(profiles) / sizeof(profiles[0]); i++)
+    {
+        if (profiles[i].id == profile)
+        {
+            return profiles[i].name;
+        }
+    }
+    return profile == LATENCY_PROFILE_CUSTOM ? "custom" : "unknown";
+}
+
+void latency_profile_record(int64_t latency_us)
+{
+    if (latency_us < 0)
+    {
+        latency_us = 0;
+    }
+    uint32_t us = latency_us > UINT32_MAX ? UINT32_MAX : (uint32_t)latency_us;
+
+    stat_last_us = us;
+    // EMA with alpha = 1/16, seeded by the first measurement
+    stat_avg_us = (stat_samples == 0) ? us : stat_avg_us + (int32_t)(us - stat_avg_us) / 16;
+    stat_samples++;
+
+    if (active.budget_ms > 0 && us > active.budget_ms * 1000)
+    {
+        stat_over_budget++;
+    }
+
+    if (us > stat_window_max_us)
+    {
+        stat_window_max_us = us;
+    }
+    if (++stat_window_count >= LATENCY_STATS_WINDOW)
+    {
+        stat_prev_window_max_us = stat_window_max_us;
+        stat_window_max_us = 0;
+        stat_window_count = 0;
+    }
+}
+
+void latency_profile_get_stats(latency_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    stats->last_us = stat_last_us;
+    stats->avg_us = stat_avg_us;
+    stats->max_us = (stat_window_max_us > stat_prev_window_max_us) ? stat_window_max_us : stat_prev_window_max_us;
+    stats->over_budget = stat_over_budget;
+    stats->samples = stat_samples;
+}
@@ -0,0 +1,93 @@
+#ifndef LATENCY_PROFILE_H
+#define LATENCY_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../config.h"
+#include "i2s_handler.h"
+
+/**
+ * Latency profiles
+ *
+ * A profile picks the I2S read chunk, the DMA descriptor count/length, the
+ * network sender block and its wake watermark together, scaled to the
+ * capture format. Capture-to-send latency is roughly one watermark plus one
+ * capture chunk; DMA depth only absorbs scheduling jitter.
+ *
+ *   profile   budget  chunk  DMA       watermark  block
+ *   low       10 ms   2 ms   4 desc    4 ms       4 ms
+ *   balanced  40 ms   8 ms   4 desc    16 ms      24 ms
+ *   archival  250 ms  16 ms  8 desc    128 ms     256 ms
+ *   custom    -       I2S_READ_SAMPLES, buffer_dma_count/length,
+ *                     NETWORK_SENDER_WATERMARK_SAMPLES, TCP_SEND_SAMPLES
+ *
+ * Blocks are capped at LATENCY_SEND_SAMPLES_MAX and chunks at
+ * I2S_READ_SAMPLES_MAX, so very high rates get shorter blocks than listed.
+ */
+
+/**
+ * Resolved sizes for the active profile (sample counts are interleaved)
+ */
+typedef struct
+{
+    latency_profile_t profile;
+    uint32_t budget_ms;      // Target capture-to-send latency (0 = none)
+    size_t i2s_read_samples; // Samples per i2s_read_raw() call
+    uint32_t dma_desc_num;   // DMA descriptors
+    uint32_t dma_frame_num;  // Frames (L/R pairs in stereo) per descriptor
+    size_t send_samples;     // Largest block the sender peeks at once
+    size_t wake_samples;     // Sender wake watermark (0 = one packet's worth)
+} latency_params_t;
+
+/**
+ * Measured capture-to-send latency
+ */
+typedef struct
+{
+    uint32_t last_us;
+    uint32_t avg_us;       // Exponential moving average
+    uint32_t max_us;       // Worst case over the last two stats windows
+    uint32_t over_budget;  // Sends later than budget_ms since boot
+    uint32_t samples;      // Sends measured since boot
+} latency_stats_t;
+
+/**
+ * Resolve a profile for a capture format and make it active
+ *
+ * Call before i2s_handler_init() and before the I2S/sender tasks start.
+ *
+ * @param profile Requested profile
+ * @param format Capture format
+ * @param custom_dma_count DMA descriptors for LATENCY_PROFILE_CUSTOM
+ * @param custom_dma_len DMA frames per descriptor for LATENCY_PROFILE_CUSTOM
+ * @return true on success, false on invalid profile (custom is used)
+ */
+bool latency_profile_apply(latency_profile_t profile, const i2s_audio_format_t *format,
+                           uint32_t custom_dma_count, uint32_t custom_dma_len);
+
+/**
+ * Get resolved sizes for the active profile
+ */
+const latency_params_t *latency_profile_get(void);
+
+/**
+ * Get printable profile name
+ */
+const char *latency_profile_name(latency_profile_t profile);
+
+/**
+ * Record the capture-to-send latency of one block (network sender only)
+ *
+ * @param latency_us Send time minus capture time of the block's first sample
+ */
+void latency_profile_record(int64_t latency_us);
+
+/**
+ * Get measured latency statistics
+ *
+ * @param stats Output statistics
+ */
+void latency_profile_get_stats(latency_stats_t *stats);
+
+#endif // LATENCY_PROFILE_H
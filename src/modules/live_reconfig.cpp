@@ -0,0 +1,341 @@
+#include "live_reconfig.h"
+#include "config_manager_v2.h"
+#include "buffer_manager.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+
+static const char *TAG = "LIVE_RECONFIG";
+
+#define TASK_BIT(task) (1u << (task))
+#define DRAIN_POLL_MS 20
+#define DRAIN_STALL_POLLS 3 // Polls without the ring shrinking before the drain stops
+
+static reconfig_apply_fn_t apply_fn = NULL;
+static TaskHandle_t reconfig_task_handle = NULL;
+
+// Parts changed by config callbacks, and parts asked for with live_reconfig_request()
+static std::atomic<uint32_t> pending_parts(0);
+static std::atomic<uint32_t> requested_parts(0);
+static std::atomic<TickType_t> last_change_tick(0);
+
+// Per-task bits: asked to park, and parked at the checkpoint
+static std::atomic<uint32_t> pause_mask(0);
+static std::atomic<uint32_t> parked_mask(0);
+static std::atomic<TaskHandle_t> task_handles[RECONFIG_TASK_COUNT];
+static std::atomic<int64_t> first_park_us(0);
+
+static reconfig_status_t status;
+static portMUX_TYPE status_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Config categories and the parts they affect
+typedef struct
+{
+    const char *category;
+    uint32_t parts;
+} category_parts_t;
+
+static const category_parts_t category_parts[] = {
+    {"audio", RECONFIG_PART_AUDIO},
+    {"dsp", RECONFIG_PART_AUDIO},
+    {"buffer", RECONFIG_PART_AUDIO},
+    {"server", RECONFIG_PART_STREAM},
+    {"udp", RECONFIG_PART_STREAM},
+    {"tcp", RECONFIG_PART_STREAM | RECONFIG_PART_AUDIO}, // Framing decides whether the silence gate may run
+};
+
+static void on_config_change(const unified_config_t *previous, const unified_config_t *current, void *ctx)
+{
+    (void)previous;
+    (void)current;
+    pending_parts.fetch_or((uint32_t)(uintptr_t)ctx, std::memory_order_relaxed);
+    last_change_tick.store(xTaskGetTickCount(), std::memory_order_relaxed);
+#if LIVE_RECONFIG_AUTO_APPLY
+    xTaskNotifyGive(reconfig_task_handle);
+#endif
+}
+
+static void wake_task(reconfig_task_t task)
+{
+    TaskHandle_t handle = task_handles[task].load(std::memory_order_acquire);
+    if (handle != NULL)
+    {
+        xTaskNotifyGive(handle);
+    }
+}
+
+// Wait until every task in mask is parked (parked = true) or none is (parked = false)
+static bool wait_parked(uint32_t mask, bool parked, uint32_t timeout_ms)
+{
+    TickType_t start = xTaskGetTickCount();
+    while (true)
+    {
+        uint32_t current = parked_mask.load(std::memory_order_acquire) & mask;
+        if (parked ? current == mask : current == 0)
+        {
+            return true;
+        }
+        if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(timeout_ms))
+        {
+            return false;
+        }
+        vTaskDelay(1);
+    }
+}
+
+// Capture is parked: let the sender send what is buffered instead of losing it to the reset
+static void drain_ring(void)
+{
+    TickType_t start = xTaskGetTickCount();
+    size_t available = buffer_manager_available();
+    int stalled = 0;
+
+    while (available > 0 && stalled < DRAIN_STALL_POLLS &&
+           xTaskGetTickCount() - start < pdMS_TO_TICKS(LIVE_RECONFIG_DRAIN_TIMEOUT_MS))
+    {
+        wake_task(RECONFIG_TASK_SENDER); // Send below its wake watermark
+        vTaskDelay(pdMS_TO_TICKS(DRAIN_POLL_MS));
+
+        size_t now = buffer_manager_available();
+        stalled = (now < available) ? 0 : stalled + 1; // A partial codec frame never drains
+        available = now;
+    }
+}
+
+static void run_reconfig(uint32_t parts)
+{
+    const bool audio = (parts & RECONFIG_PART_AUDIO) != 0;
+    const uint32_t tasks = audio ? TASK_BIT(RECONFIG_TASK_READER) | TASK_BIT(RECONFIG_TASK_SENDER)
+                                 : TASK_BIT(RECONFIG_TASK_SENDER);
+
+    for (int i = 0; i < RECONFIG_TASK_COUNT; i++)
+    {
+        if ((tasks & TASK_BIT(i)) && task_handles[i].load(std::memory_order_acquire) == NULL)
+        {
+            ESP_LOGW(TAG, "Pipeline not running, changes kept for later");
+            pending_parts.fetch_or(parts, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    first_park_us.store(0, std::memory_order_relaxed);
+    portENTER_CRITICAL(&status_lock);
+    status.in_progress = true;
+    portEXIT_CRITICAL(&status_lock);
+
+    // Stop capture first so the sender can drain the ring behind it
+    bool parked = true;
+    if (audio)
+    {
+        pause_mask.fetch_or(TASK_BIT(RECONFIG_TASK_READER), std::memory_order_release);
+        parked = wait_parked(TASK_BIT(RECONFIG_TASK_READER), true, LIVE_RECONFIG_PAUSE_TIMEOUT_MS);
+        if (parked)
+        {
+            drain_ring();
+        }
+    }
+    if (parked)
+    {
+        pause_mask.fetch_or(TASK_BIT(RECONFIG_TASK_SENDER), std::memory_order_release);
+        wake_task(RECONFIG_TASK_SENDER); // Cut a ring wait short
+        parked = wait_parked(tasks, true, LIVE_RECONFIG_PAUSE_TIMEOUT_MS);
+    }
+
+    bool success = false;
+    if (parked)
+    {
+        success = apply_fn(parts);
+    }
+    else
+    {
+        ESP_LOGE(TAG, "Pipeline did not pause within %d ms, reconfiguration cancelled",
+                 LIVE_RECONFIG_PAUSE_TIMEOUT_MS);
+        pending_parts.fetch_or(parts, std::memory_order_relaxed);
+    }
+
+    pause_mask.store(0, std::memory_order_release);
+    for (int i = 0; i < RECONFIG_TASK_COUNT; i++)
+    {
+        wake_task((reconfig_task_t)i);
+    }
+    int64_t resume_us = esp_timer_get_time();
+
+    // The next run must not mistake a task that has not left yet for a parked one
+    wait_parked(tasks, false, LIVE_RECONFIG_PAUSE_TIMEOUT_MS);
+
+    int64_t park_us = first_park_us.load(std::memory_order_relaxed);
+    uint32_t gap_ms = park_us != 0 ? (uint32_t)((resume_us - park_us) / 1000) : 0;
+    uint32_t total_ms = (uint32_t)((resume_us - start_us) / 1000);
+
+    portENTER_CRITICAL(&status_lock);
+    status.in_progress = false;
+    status.last_parts = parts;
+    status.last_success = success;
+    status.last_gap_ms = gap_ms;
+    status.last_total_ms = total_ms;
+    status.count++;
+    if (!success)
+    {
+        status.failures++;
+    }
+    portEXIT_CRITICAL(&status_lock);
+
+    char what[24];
+    snprintf(what, sizeof(what), "%s%s%s%s%s", audio ? "audio" : "",
+             (audio && (parts & ~RECONFIG_PART_AUDIO)) ? "+" : "", (parts & RECONFIG_PART_STREAM) ? "stream" : "",
+             ((parts & RECONFIG_PART_STREAM) && (parts & RECONFIG_PART_CODEC)) ? "+" : "",
+             (parts & RECONFIG_PART_CODEC) ? "codec" : "");
+    if (success)
+    {
+        ESP_LOGI(TAG, "Reconfigured %s: %s gap %lu ms (total %lu ms)",
+                 what, audio ? "capture" : "send", gap_ms, total_ms);
+    }
+    else if (parked)
+    {
+        ESP_LOGE(TAG, "Reconfiguring %s failed (gap %lu ms)", what, gap_ms);
+    }
+}
+
+static void reconfig_task(void *arg)
+{
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // One form post sets many fields: apply once they stop changing
+        if (pending_parts.load(std::memory_order_relaxed) != 0)
+        {
+            TickType_t settle = pdMS_TO_TICKS(LIVE_RECONFIG_SETTLE_MS);
+            TickType_t since = xTaskGetTickCount() - last_change_tick.load(std::memory_order_relaxed);
+            while (since < settle)
+            {
+                vTaskDelay(settle - since);
+                since = xTaskGetTickCount() - last_change_tick.load(std::memory_order_relaxed);
+            }
+        }
+
+        uint32_t parts = requested_parts.exchange(0, std::memory_order_relaxed);
+#if LIVE_RECONFIG_AUTO_APPLY
+        parts |= pending_parts.load(std::memory_order_relaxed);
+#endif
+        pending_parts.fetch_and(~parts, std::memory_order_relaxed);
+
+        if (parts != 0)
+        {
+            run_reconfig(parts);
+        }
+    }
+}
+
+bool live_reconfig_init(reconfig_apply_fn_t apply)
+{
+    if (apply == NULL)
+    {
+        return false;
+    }
+    if (reconfig_task_handle != NULL)
+    {
+        ESP_LOGW(TAG, "Already initialized");
+        return true;
+    }
+
+    apply_fn = apply;
+    memset(&status, 0, sizeof(status));
+
+    if (xTaskCreate(reconfig_task, "live_reconfig", LIVE_RECONFIG_TASK_STACK_SIZE, NULL,
+                    LIVE_RECONFIG_TASK_PRIORITY, &reconfig_task_handle) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create reconfiguration task");
+        reconfig_task_handle = NULL;
+        return false;
+    }
+
+    for (size_t i = 0; i < sizeof(category_parts) / sizeof(category_parts[0]); i++)
+    {
+        if (!config_manager_v2_subscribe(category_parts[i].category, on_config_change,
+                                         (void *)(uintptr_t)category_parts[i].parts))
+        {
+            ESP_LOGW(TAG, "Changes to '%s' will need a restart", category_parts[i].category);
+        }
+    }
+
+    ESP_LOGI(TAG, "Live reconfiguration ready (%s)", LIVE_RECONFIG_AUTO_APPLY ? "auto-apply" : "on request");
+    return true;
+}
+
+bool live_reconfig_request(uint32_t parts)
+{
+    if (reconfig_task_handle == NULL)
+    {
+        return false;
+    }
+
+    if (parts == 0)
+    {
+        parts = pending_parts.load(std::memory_order_relaxed);
+        if (parts == 0)
+        {
+            return false;
+        }
+    }
+
+    requested_parts.fetch_or(parts, std::memory_order_relaxed);
+    xTaskNotifyGive(reconfig_task_handle);
+    return true;
+}
+
+bool live_reconfig_checkpoint(reconfig_task_t task)
+{
+    if (task >= RECONFIG_TASK_COUNT)
+    {
+        return false;
+    }
+
+    if (task_handles[task].load(std::memory_order_relaxed) == NULL)
+    {
+        task_handles[task].store(xTaskGetCurrentTaskHandle(), std::memory_order_release);
+    }
+
+    const uint32_t bit = TASK_BIT(task);
+    if ((pause_mask.load(std::memory_order_acquire) & bit) == 0)
+    {
+        return false;
+    }
+
+    int64_t expected = 0;
+    first_park_us.compare_exchange_strong(expected, esp_timer_get_time(), std::memory_order_relaxed);
+    parked_mask.fetch_or(bit, std::memory_order_release);
+
+    // Woken by the resume; the slice only bounds a missed notification
+    while (pause_mask.load(std::memory_order_acquire) & bit)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+    }
+
+    parked_mask.fetch_and(~bit, std::memory_order_release);
+    return true;
+}
+
+bool live_reconfig_pause_requested(reconfig_task_t task)
+{
+    return task < RECONFIG_TASK_COUNT && (pause_mask.load(std::memory_order_relaxed) & TASK_BIT(task)) != 0;
+}
+
+void live_reconfig_get_status(reconfig_status_t *out)
+{
+    if (out == NULL)
+    {
+        return;
+    }
+
+    portENTER_CRITICAL(&status_lock);
+    *out = status;
+    portEXIT_CRITICAL(&status_lock);
+    out->active = reconfig_task_handle != NULL;
+    out->pending_parts = pending_parts.load(std::memory_order_relaxed);
+}
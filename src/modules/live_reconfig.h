@@ -0,0 +1,108 @@
+#ifndef LIVE_RECONFIG_H
+#define LIVE_RECONFIG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config.h"
+
+/**
+ * Live reconfiguration of the audio pipeline, without a reboot
+ *
+ * Config changes are collected per part (config_manager_v2_subscribe) and
+ * applied by a low-priority task, LIVE_RECONFIG_SETTLE_MS after the last
+ * change or on request:
+ *   1. the I2S reader parks at its checkpoint (audio parts only), and the
+ *      sender drains the ring for up to LIVE_RECONFIG_DRAIN_TIMEOUT_MS
+ *   2. the network sender parks at its checkpoint
+ *   3. the apply callback restarts I2S / reopens the sockets
+ *   4. both resume and re-derive their block sizes and buffers
+ *
+ * A stream or codec change parks only the sender, so capture keeps filling
+ * the ring and no audio is lost if the gap fits in it. The gap (first park to
+ * resume) is logged and kept in the status.
+ */
+
+/**
+ * Pipeline parts to reconfigure
+ */
+typedef enum
+{
+    RECONFIG_PART_AUDIO = 1 << 0,  // Format, codec, DSP, latency, VAD: I2S restart and ring reset
+    RECONFIG_PART_STREAM = 1 << 1, // Server address, TCP/UDP options: sockets reopened
+    RECONFIG_PART_CODEC = 1 << 2,  // Codec and FEC level at the same capture format (adaptive quality)
+} reconfig_part_t;
+
+/**
+ * Pipeline tasks that park during a reconfiguration
+ */
+typedef enum
+{
+    RECONFIG_TASK_READER = 0, // I2S reader
+    RECONFIG_TASK_SENDER = 1, // Network sender
+    RECONFIG_TASK_COUNT
+} reconfig_task_t;
+
+/**
+ * Apply the new settings while the affected tasks are parked
+ * @param parts Mask of reconfig_part_t
+ * @return true if every part was applied
+ */
+typedef bool (*reconfig_apply_fn_t)(uint32_t parts);
+
+/**
+ * Reconfiguration status
+ */
+typedef struct
+{
+    bool active;            // Initialized: changes apply without a restart
+    bool in_progress;
+    uint32_t pending_parts; // Changed since the last reconfiguration
+    uint32_t last_parts;
+    bool last_success;
+    uint32_t last_gap_ms;   // First task parked to tasks resumed
+    uint32_t last_total_ms; // Request to tasks resumed
+    uint32_t count;         // Reconfigurations run
+    uint32_t failures;
+} reconfig_status_t;
+
+/**
+ * Subscribe to config changes and start the reconfiguration task
+ *
+ * Call once the pipeline is configured, before its tasks start.
+ *
+ * @param apply Callback that applies the settings
+ * @return true on success
+ */
+bool live_reconfig_init(reconfig_apply_fn_t apply);
+
+/**
+ * Queue a reconfiguration (runs asynchronously)
+ * @param parts Mask of reconfig_part_t, 0 for the parts changed since the last one
+ * @return false if not initialized or there is nothing to apply
+ */
+bool live_reconfig_request(uint32_t parts);
+
+/**
+ * Park here while a reconfiguration needs this task
+ *
+ * Call at the top of the task loop, outside any ring reservation or send.
+ *
+ * @param task Calling task
+ * @return true if the task was parked: settings may have changed, re-derive them
+ */
+bool live_reconfig_checkpoint(reconfig_task_t task);
+
+/**
+ * Check whether a task is asked to park (to cut a long wait short)
+ * @param task Task to check
+ * @return true if the task should return to its checkpoint
+ */
+bool live_reconfig_pause_requested(reconfig_task_t task);
+
+/**
+ * Get reconfiguration status
+ * @param status Output
+ */
+void live_reconfig_get_status(reconfig_status_t *status);
+
+#endif // LIVE_RECONFIG_H
@@ -1,7 +1,15 @@
 #include "log_manager.h"
+#include "rate_limiter.h"
 #include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_memory_utils.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdarg.h>
+#include <atomic>
 
 static const char* TAG = "LOG_MANAGER";
 
@@ -10,6 +18,7 @@ static log_entry_t log_buffer[MAX_LOG_ENTRIES];
 static size_t log_write_index = 0;
 static size_t log_count = 0;
 static bool log_buffer_full = false;
+static uint32_t log_seq = 0; // Seq of the newest entry
 
 // Mutex for thread-safe access
 static SemaphoreHandle_t log_mutex = NULL;
@@ -17,17 +26,13 @@ static SemaphoreHandle_t log_mutex = NULL;
 // Original vprintf function pointer
 static vprintf_like_t original_vprintf = NULL;
 
-// Custom vprintf hook to capture logs
-static int log_vprintf_hook(const char* format, va_list args) {
-    // Call original vprintf to maintain normal console output
-    int ret = original_vprintf(format, args);
-
-    // Parse the log message (ESP-IDF format: "LEVEL (timestamp) TAG: message")
-    char buffer[256];
-    vsnprintf(buffer, sizeof(buffer), format, args);
+// Per-call-site limiter, keyed by format string address
+static rate_limiter_t log_limiter;
+static uint32_t last_summary_ms = 0;
 
+// Parse an ESP-IDF line ("E (12345) TAG: message\n") into the circular buffer
+static void store_line(const char* buffer, uint32_t timestamp_ms) {
     // Try to extract log level, tag, and message from ESP-IDF format
-    // Format: "E (12345) TAG: message\n"
     char level_char = buffer[0];
     esp_log_level_t level = ESP_LOG_INFO;
 
@@ -43,12 +48,12 @@ static int log_vprintf_hook(const char* format, va_list args) {
     char tag[MAX_LOG_TAG_LEN] = "SYSTEM";
     char message[MAX_LOG_MESSAGE_LEN] = "";
 
-    char* tag_start = strchr(buffer, ')');
+    const char* tag_start = strchr(buffer, ')');
     if (tag_start) {
         tag_start++; // Skip ')'
         while (*tag_start == ' ') tag_start++; // Skip spaces
 
-        char* tag_end = strchr(tag_start, ':');
+        const char* tag_end = strchr(tag_start, ':');
         if (tag_end) {
             size_t tag_len = tag_end - tag_start;
             if (tag_len > 0 && tag_len < MAX_LOG_TAG_LEN) {
@@ -57,7 +62,7 @@ static int log_vprintf_hook(const char* format, va_list args) {
             }
 
             // Extract message
-            char* msg_start = tag_end + 1;
+            const char* msg_start = tag_end + 1;
             while (*msg_start == ' ') msg_start++; // Skip spaces
 
             strncpy(message, msg_start, MAX_LOG_MESSAGE_LEN - 1);
@@ -75,7 +80,8 @@ static int log_vprintf_hook(const char* format, va_list args) {
     if (log_mutex && xSemaphoreTake(log_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
         log_entry_t* entry = &log_buffer[log_write_index];
 
-        entry->timestamp = (uint32_t)(esp_timer_get_time() / 1000); // Convert to milliseconds
+        entry->seq = ++log_seq;
+        entry->timestamp = timestamp_ms;
         entry->level = level;
         strncpy(entry->tag, tag, MAX_LOG_TAG_LEN - 1);
         entry->tag[MAX_LOG_TAG_LEN - 1] = '\0';
@@ -92,10 +98,555 @@ static int log_vprintf_hook(const char* format, va_list args) {
 
         xSemaphoreGive(log_mutex);
     }
+}
+
+// vprintf_like_t wants a va_list, so go through a variadic shim for "%s"
+static void console_write(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    original_vprintf(fmt, args);
+    va_end(args);
+}
+
+// Print and store a line produced by the log manager itself
+static void emit_line(const char* line, uint32_t timestamp_ms) {
+    console_write("%s", line);
+    store_line(line, timestamp_ms);
+}
+
+// Summarize call sites that were rate limited and have since gone quiet
+static void report_repeats(uint32_t now_ms) {
+    if (now_ms - last_summary_ms < LOG_RATE_LIMIT_REFILL_MS) {
+        return;
+    }
+    last_summary_ms = now_ms;
+
+    rate_limit_summary_t summaries[4];
+    size_t count = rate_limiter_collect(&log_limiter, now_ms, LOG_RATE_LIMIT_SUMMARY_MS,
+                                        summaries, sizeof(summaries) / sizeof(summaries[0]));
+    for (size_t i = 0; i < count; i++) {
+        // Label is the format string: show its text after "TAG: "
+        const char* text = (const char*)summaries[i].label;
+        const char* after_tag = strstr(text, "%s: ");
+        if (after_tag) {
+            text = after_tag + 4;
+        }
+        char line[192];
+        snprintf(line, sizeof(line), "W (%lu) %s: last message repeated %lu times: %.*s\n",
+                 (unsigned long)now_ms, TAG, (unsigned long)summaries[i].repeated,
+                 (int)strcspn(text, "\n\033"), text);
+        emit_line(line, now_ms);
+    }
+}
+
+#if LOG_DEFERRED_ENABLED
+
+// Deferred record. format == NULL means args holds the already formatted text
+// (the format string was not in flash, so it may be gone by the time we print).
+typedef struct {
+    std::atomic<uint32_t> seq;  // Slot sequence (bounded MPSC queue)
+    const char* format;
+    uint32_t timestamp_ms;
+    uint32_t repeated;          // Lines suppressed by the rate limiter before this one
+    uint16_t arg_len;
+    uint8_t truncated;          // Arguments did not fit, line ends in "..."
+    uint8_t args[LOG_DEFERRED_ARG_BYTES];
+} log_record_t;
+
+#define LOG_DEFERRED_MASK (LOG_DEFERRED_SLOTS - 1)
+static_assert((LOG_DEFERRED_SLOTS & LOG_DEFERRED_MASK) == 0, "LOG_DEFERRED_SLOTS must be a power of two");
+
+static log_record_t records[LOG_DEFERRED_SLOTS];
+static std::atomic<uint32_t> enqueue_pos(0);
+static uint32_t dequeue_pos = 0; // Under drain_mutex
+static std::atomic<uint32_t> dropped_records(0);
+static TaskHandle_t log_task_handle = NULL;
+static SemaphoreHandle_t drain_mutex = NULL; // One consumer at a time: log_task or the shutdown hook
+
+// Argument classes, as they sit in the record
+typedef enum {
+    ARG_INT32,
+    ARG_INT64,
+    ARG_POINTER,
+    ARG_DOUBLE,
+    ARG_STRING,
+    ARG_NONE,     // %% or %n: nothing stored
+    ARG_INVALID   // Unknown conversion: stop here
+} arg_class_t;
+
+// One parsed conversion
+typedef struct {
+    const char* start;   // At '%'
+    const char* end;     // Past the conversion character
+    bool star_width;
+    bool star_precision;
+    char length;         // 0, 'H' (hh), 'h', 'l', 'L' (ll / L), 'z', 'j', 't'
+    char conversion;
+    arg_class_t arg;
+} log_spec_t;
+
+static const char* parse_spec(const char* p, log_spec_t* spec) {
+    memset(spec, 0, sizeof(*spec));
+    spec->start = p++;
+
+    while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') p++;
+    if (*p == '*') {
+        spec->star_width = true;
+        p++;
+    } else {
+        while (*p >= '0' && *p <= '9') p++;
+    }
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            spec->star_precision = true;
+            p++;
+        } else {
+            while (*p >= '0' && *p <= '9') p++;
+        }
+    }
+
+    switch (*p) {
+        case 'h': p++; spec->length = (*p == 'h') ? (p++, 'H') : 'h'; break;
+        case 'l': p++; spec->length = (*p == 'l') ? (p++, 'L') : 'l'; break;
+        case 'L': p++; spec->length = 'L'; break;
+        case 'z': case 'j': case 't': spec->length = *p++; break;
+    }
+
+    spec->conversion = *p;
+    switch (*p) {
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+            spec->arg = (spec->length == 'L' || (spec->length == 'j' && sizeof(intmax_t) == 8))
+                            ? ARG_INT64 : ARG_INT32;
+            break;
+        case 'p': spec->arg = ARG_POINTER; break;
+        case 's': spec->arg = ARG_STRING; break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            spec->arg = ARG_DOUBLE;
+            break;
+        case '%': case 'n': spec->arg = ARG_NONE; break;
+        default:  spec->arg = ARG_INVALID; return p;
+    }
+
+    spec->end = p + 1;
+    return spec->end;
+}
+
+// Strings in flash or ROM outlive the record, so only their pointer is kept
+static inline bool string_is_persistent(const char* s) {
+    return s == NULL || esp_ptr_in_drom(s) || esp_ptr_in_rom(s);
+}
+
+/**
+ * Copy the raw arguments of a format into a record: no formatting, no locks
+ * @return false if they did not all fit (record marked truncated)
+ */
+static bool capture_args(log_record_t* rec, const char* format, va_list args) {
+    uint8_t* out = rec->args;
+    size_t used = 0;
+
+#define PUT(value) \
+    do { \
+        if (used + sizeof(value) > sizeof(rec->args)) goto full; \
+        memcpy(out + used, &(value), sizeof(value)); \
+        used += sizeof(value); \
+    } while (0)
+
+    for (const char* p = format; *p; ) {
+        if (*p != '%') {
+            p++;
+            continue;
+        }
+
+        log_spec_t spec;
+        p = parse_spec(p, &spec);
+        if (spec.arg == ARG_INVALID) {
+            break; // Formatter stops at the same place
+        }
+        if (spec.star_width) {
+            int width = va_arg(args, int);
+            PUT(width);
+        }
+        if (spec.star_precision) {
+            int precision = va_arg(args, int);
+            PUT(precision);
+        }
+
+        switch (spec.arg) {
+            case ARG_INT32: {
+                // long and size_t are 32-bit on the ESP32-S3; chars and shorts are promoted
+                uint32_t v = va_arg(args, uint32_t);
+                PUT(v);
+                break;
+            }
+            case ARG_INT64: {
+                uint64_t v = va_arg(args, uint64_t);
+                PUT(v);
+                break;
+            }
+            case ARG_POINTER: {
+                void* v = va_arg(args, void*);
+                PUT(v);
+                break;
+            }
+            case ARG_DOUBLE: {
+                double v = (spec.length == 'L') ? (double)va_arg(args, long double) : va_arg(args, double);
+                PUT(v);
+                break;
+            }
+            case ARG_STRING: {
+                const char* s = va_arg(args, const char*);
+                uint8_t inline_copy = string_is_persistent(s) ? 0 : 1;
+                PUT(inline_copy);
+                if (!inline_copy) {
+                    PUT(s);
+                    break;
+                }
+                // Copy as much as fits, always NUL-terminated
+                size_t room = sizeof(rec->args) - used;
+                if (room < 1) goto full;
+                size_t len = strnlen(s, room - 1);
+                memcpy(out + used, s, len);
+                out[used + len] = '\0';
+                used += len + 1;
+                if (s[len] != '\0') goto full;
+                break;
+            }
+            case ARG_NONE:
+            case ARG_INVALID:
+                if (spec.conversion == 'n') {
+                    (void)va_arg(args, void*);
+                }
+                break;
+        }
+    }
+#undef PUT
+
+    rec->arg_len = (uint16_t)used;
+    rec->truncated = 0;
+    return true;
+
+full:
+    rec->arg_len = (uint16_t)used;
+    rec->truncated = 1;
+    return false;
+}
+
+// Append text at n, leaving room for "\n\0"
+static size_t append_text(char* out, size_t n, size_t size, const char* text) {
+    size_t len = strlen(text);
+    if (n + len > size - 2) len = (n < size - 2) ? size - 2 - n : 0;
+    memcpy(out + n, text, len);
+    return n + len;
+}
+
+/**
+ * Format a record the way vsnprintf would have at log time
+ * @return Length written (excluding NUL)
+ */
+static size_t format_record(const log_record_t* rec, char* out, size_t size) {
+    const uint8_t* in = rec->args;
+    size_t pos = 0;
+    size_t n = 0;
+    bool complete = true;
+
+    if (rec->format == NULL) {
+        n = strnlen((const char*)in, rec->arg_len);
+        if (n >= size) n = size - 1;
+        memcpy(out, in, n);
+        goto done;
+    }
+
+#define GET(var) \
+    do { \
+        if (pos + sizeof(var) > rec->arg_len) { complete = false; goto done; } \
+        memcpy(&(var), in + pos, sizeof(var)); \
+        pos += sizeof(var); \
+    } while (0)
+
+#define EMIT(...) \
+    do { \
+        int w = snprintf(out + n, size - n, __VA_ARGS__); \
+        if (w > 0) n += ((size_t)w < size - n) ? (size_t)w : size - n - 1; \
+    } while (0)
+
+    for (const char* p = rec->format; *p && n < size - 1; ) {
+        if (*p != '%') {
+            out[n++] = *p++;
+            continue;
+        }
+
+        log_spec_t spec;
+        const char* next = parse_spec(p, &spec);
+        if (spec.arg == ARG_INVALID) {
+            complete = false;
+            break;
+        }
+        if (spec.conversion == '%') {
+            out[n++] = '%';
+            p = next;
+            continue;
+        }
+        if (spec.conversion == 'n') {
+            p = next;
+            continue;
+        }
+
+        // Rebuild the spec with '*' resolved and our own length modifier
+        char fmt[32];
+        size_t f = 0;
+        for (const char* c = spec.start; c < next && f < sizeof(fmt) - 12; c++) {
+            if (*c == '*') {
+                int value;
+                GET(value);
+                f += snprintf(fmt + f, sizeof(fmt) - f, "%d", value);
+            } else if (*c == 'h' || *c == 'l' || *c == 'L' || *c == 'z' || *c == 'j' || *c == 't') {
+                continue;
+            } else if (c == next - 1) {
+                break; // Conversion char added below
+            } else {
+                fmt[f++] = *c;
+            }
+        }
+
+        switch (spec.arg) {
+            case ARG_INT32:
+            case ARG_INT64: {
+                uint64_t raw = 0;
+                if (spec.arg == ARG_INT64) {
+                    GET(raw);
+                } else {
+                    uint32_t v;
+                    GET(v);
+                    raw = v;
+                }
+                bool is_signed = (spec.conversion == 'd' || spec.conversion == 'i');
+                long long value;
+                if (spec.arg == ARG_INT64) value = (long long)raw;
+                else if (spec.length == 'H') value = is_signed ? (long long)(int8_t)raw : (long long)(uint8_t)raw;
+                else if (spec.length == 'h') value = is_signed ? (long long)(int16_t)raw : (long long)(uint16_t)raw;
+                else value = is_signed ? (long long)(int32_t)raw : (long long)(uint32_t)raw;
+
+                if (spec.conversion == 'c') {
+                    fmt[f++] = 'c';
+                    fmt[f] = '\0';
+                    EMIT(fmt, (int)value);
+                } else {
+                    fmt[f++] = 'l';
+                    fmt[f++] = 'l';
+                    fmt[f++] = spec.conversion;
+                    fmt[f] = '\0';
+                    EMIT(fmt, value);
+                }
+                break;
+            }
+            case ARG_POINTER: {
+                void* value;
+                GET(value);
+                fmt[f++] = 'p';
+                fmt[f] = '\0';
+                EMIT(fmt, value);
+                break;
+            }
+            case ARG_DOUBLE: {
+                double value;
+                GET(value);
+                fmt[f++] = spec.conversion;
+                fmt[f] = '\0';
+                EMIT(fmt, value);
+                break;
+            }
+            case ARG_STRING: {
+                uint8_t inline_copy;
+                GET(inline_copy);
+                const char* s;
+                if (inline_copy) {
+                    if (pos >= rec->arg_len) { complete = false; goto done; }
+                    s = (const char*)(in + pos);
+                    size_t len = strnlen(s, rec->arg_len - pos);
+                    pos += len + 1;
+                    if (pos > rec->arg_len) { complete = false; goto done; }
+                } else {
+                    GET(s);
+                }
+                fmt[f++] = 's';
+                fmt[f] = '\0';
+                EMIT(fmt, s ? s : "(null)");
+                // A string cut short at capture ends the line
+                if (inline_copy && pos == rec->arg_len && rec->truncated) {
+                    complete = false;
+                    goto done;
+                }
+                break;
+            }
+            case ARG_NONE:
+            case ARG_INVALID:
+                break;
+        }
+        p = next;
+    }
+#undef GET
+#undef EMIT
+
+done:
+    // Notes go before the line ending so UART output stays line-oriented
+    bool newline = (n > 0 && out[n - 1] == '\n');
+    if (newline) n--;
+    if (!complete || rec->truncated) {
+        n = append_text(out, n, size, "...");
+        newline = true;
+    }
+    if (rec->repeated > 0) {
+        char note[32];
+        snprintf(note, sizeof(note), " (repeated %lu times)", (unsigned long)rec->repeated);
+        n = append_text(out, n, size, note);
+    }
+    if (newline) out[n++] = '\n';
+    out[n] = '\0';
+    return n;
+}
+
+// Hot path: claim a slot, copy the raw arguments, publish. Never blocks.
+static int log_vprintf_hook(const char* format, va_list args) {
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    bool persistent = esp_ptr_in_drom(format);
+    uint32_t repeated = 0;
+    if (persistent && !rate_limiter_allow(&log_limiter, (uint32_t)(uintptr_t)format, format, now_ms, &repeated)) {
+        return 0;
+    }
+
+    uint32_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    log_record_t* rec;
+    for (;;) {
+        rec = &records[pos & LOG_DEFERRED_MASK];
+        uint32_t seq = rec->seq.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            dropped_records.fetch_add(1, std::memory_order_relaxed); // Full: drop, the caller must not wait
+            return 0;
+        } else {
+            pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    rec->timestamp_ms = now_ms;
+    rec->repeated = repeated;
+    if (persistent) {
+        rec->format = format;
+        va_list copy;
+        va_copy(copy, args);
+        capture_args(rec, format, copy);
+        va_end(copy);
+    } else {
+        // Format string could be on a stack or heap: format now, into the slot
+        rec->format = NULL;
+        int len = vsnprintf((char*)rec->args, sizeof(rec->args), format, args);
+        rec->truncated = (len >= (int)sizeof(rec->args)) ? 1 : 0;
+        rec->arg_len = (uint16_t)((len < 0) ? 0 : (rec->truncated ? sizeof(rec->args) - 1 : len));
+    }
+
+    rec->seq.store(pos + 1, std::memory_order_release);
+    return 0;
+}
+
+// Format published records for UART and the web buffer; caller holds drain_mutex
+// @return false if the ring was empty
+static bool drain_records(char* line, size_t size) {
+    bool any = false;
+    for (;;) {
+        log_record_t* rec = &records[dequeue_pos & LOG_DEFERRED_MASK];
+        if ((int32_t)(rec->seq.load(std::memory_order_acquire) - (dequeue_pos + 1)) < 0) {
+            break; // Empty
+        }
+
+        format_record(rec, line, size);
+        uint32_t timestamp_ms = rec->timestamp_ms;
+        rec->seq.store(dequeue_pos + LOG_DEFERRED_SLOTS, std::memory_order_release);
+        dequeue_pos++;
+        any = true;
+
+        emit_line(line, timestamp_ms);
+    }
+    return any;
+}
+
+// Low-priority task: format queued records for UART and the web buffer
+static void log_task(void* arg) {
+    (void)arg;
+    static char line[256];
+    uint32_t reported_drops = 0;
+
+    while (true) {
+        xSemaphoreTake(drain_mutex, portMAX_DELAY);
+        bool idle = !drain_records(line, sizeof(line));
+        xSemaphoreGive(drain_mutex);
+
+        uint32_t drops = dropped_records.load(std::memory_order_relaxed);
+        if (drops != reported_drops) {
+            snprintf(line, sizeof(line), "W (%lu) %s: %lu log lines dropped (queue full)\n",
+                     (unsigned long)(esp_timer_get_time() / 1000), TAG,
+                     (unsigned long)(drops - reported_drops));
+            reported_drops = drops;
+            emit_line(line, (uint32_t)(esp_timer_get_time() / 1000));
+        }
+        report_repeats((uint32_t)(esp_timer_get_time() / 1000));
+
+        if (idle) {
+            vTaskDelay(pdMS_TO_TICKS(LOG_DEFERRED_FLUSH_MS));
+        }
+    }
+}
+
+// esp_restart() hook: print what is still queued, so the error that led to a reboot is not lost
+// (a log_task caught mid-drain inherits our priority and finishes first)
+static void flush_on_shutdown(void) {
+    static char line[256];
+    if (xSemaphoreTake(drain_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        drain_records(line, sizeof(line));
+        xSemaphoreGive(drain_mutex);
+    }
+}
+
+#else
+
+// Custom vprintf hook to capture logs
+static int log_vprintf_hook(const char* format, va_list args) {
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    report_repeats(now_ms);
+
+    uint32_t repeated = 0;
+    if (esp_ptr_in_drom(format) &&
+        !rate_limiter_allow(&log_limiter, (uint32_t)(uintptr_t)format, format, now_ms, &repeated)) {
+        return 0;
+    }
+    if (repeated > 0) {
+        char note[64];
+        snprintf(note, sizeof(note), "W (%lu) %s: previous message repeated %lu times\n",
+                 (unsigned long)now_ms, TAG, (unsigned long)repeated);
+        emit_line(note, now_ms);
+    }
+
+    // Call original vprintf to maintain normal console output
+    // (a va_list can only be walked once)
+    va_list copy;
+    va_copy(copy, args);
+    int ret = original_vprintf(format, args);
+
+    char buffer[256];
+    vsnprintf(buffer, sizeof(buffer), format, copy);
+    va_end(copy);
+
+    store_line(buffer, now_ms);
 
     return ret;
 }
 
+#endif // LOG_DEFERRED_ENABLED
+
 bool log_manager_init(void) {
     // Create mutex
     log_mutex = xSemaphoreCreateMutex();
@@ -104,6 +655,27 @@ bool log_manager_init(void) {
         return false;
     }
 
+    rate_limiter_init(&log_limiter, LOG_RATE_LIMIT_BURST, LOG_RATE_LIMIT_REFILL_MS);
+
+#if LOG_DEFERRED_ENABLED
+    for (uint32_t i = 0; i < LOG_DEFERRED_SLOTS; i++) {
+        records[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    drain_mutex = xSemaphoreCreateMutex();
+    if (drain_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create log drain mutex");
+        return false;
+    }
+
+    if (xTaskCreatePinnedToCore(log_task, "log_task", LOG_TASK_STACK_SIZE, NULL,
+                                LOG_TASK_PRIORITY, &log_task_handle, LOG_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create log task");
+        return false;
+    }
+    esp_register_shutdown_handler(flush_on_shutdown);
+#endif
+
     // Hook into ESP-IDF logging system
     original_vprintf = esp_log_set_vprintf(log_vprintf_hook);
 
@@ -111,7 +683,6 @@ bool log_manager_init(void) {
 
     return true;
 }
-
 size_t log_manager_get_logs(log_entry_t* logs, size_t max_count) {
     if (logs == NULL || max_count == 0) {
         return 0;
@@ -136,6 +707,33 @@ size_t log_manager_get_logs(log_entry_t* logs, size_t max_count) {
     return count;
 }
 
+size_t log_manager_get_since(uint32_t after_seq, log_entry_t* logs, size_t max_count) {
+    if (logs == NULL || max_count == 0 || log_mutex == NULL) {
+        return 0;
+    }
+
+    size_t count = 0;
+
+    if (xSemaphoreTake(log_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        // Entries newer than after_seq are the last (log_seq - after_seq) stored
+        uint32_t pending = log_seq - after_seq;
+        if (pending > log_count) {
+            pending = log_count; // Reader fell behind, older ones are gone
+        }
+        size_t start_index = (log_write_index + MAX_LOG_ENTRIES - pending) % MAX_LOG_ENTRIES;
+        size_t entries_to_copy = (pending < max_count) ? pending : max_count;
+
+        for (size_t i = 0; i < entries_to_copy; i++) {
+            memcpy(&logs[count], &log_buffer[(start_index + i) % MAX_LOG_ENTRIES], sizeof(log_entry_t));
+            count++;
+        }
+
+        xSemaphoreGive(log_mutex);
+    }
+
+    return count;
+}
+
 size_t log_manager_get_count(void) {
     return log_count;
 }
@@ -145,7 +743,7 @@ void log_manager_clear(void) {
         log_write_index = 0;
         log_count = 0;
         log_buffer_full = false;
-        memset(log_buffer, 0, sizeof(log_buffer));
+        memset(log_buffer, 0, sizeof(log_buffer)); // log_seq keeps counting for incremental readers
         xSemaphoreGive(log_mutex);
 
         ESP_LOGI(TAG, "Logs cleared");
@@ -162,3 +760,11 @@ const char* log_manager_level_to_string(esp_log_level_t level) {
         default:              return "UNKNOWN";
     }
 }
+
+uint32_t log_manager_get_dropped(void) {
+#if LOG_DEFERRED_ENABLED
+    return dropped_records.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
@@ -3,13 +3,27 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "esp_log.h"
 
 #define MAX_LOG_ENTRIES 200
 #define MAX_LOG_MESSAGE_LEN 128
 #define MAX_LOG_TAG_LEN 16
 
+// Deferred logging: the caller only copies the format pointer and raw
+// arguments into a lock-free ring; log_task formats them for UART and the
+// buffer above. A full ring drops the record instead of blocking, and
+// esp_restart() prints what is still queued before the reboot.
+#define LOG_DEFERRED_ENABLED 1
+#define LOG_DEFERRED_SLOTS 64          // Power of two
+#define LOG_DEFERRED_ARG_BYTES 44      // Raw arguments per record (64-byte slot)
+#define LOG_DEFERRED_FLUSH_MS 10       // Log task poll period when idle
+#define LOG_TASK_STACK_SIZE 4096
+#define LOG_TASK_PRIORITY 1
+#define LOG_TASK_CORE 0
+
 typedef struct {
+    uint32_t seq;           // Increments per stored entry, never reused
     uint32_t timestamp;     // Milliseconds since boot
     esp_log_level_t level;
     char tag[MAX_LOG_TAG_LEN];
@@ -30,6 +44,20 @@ bool log_manager_init(void);
  */
 size_t log_manager_get_logs(log_entry_t* logs, size_t max_count);
 
+/**
+ * Get log entries stored after a sequence number, oldest first
+ *
+ * For incremental readers: pass the seq of the last entry already seen
+ * (0 for everything still buffered). A gap in seq means entries were
+ * overwritten before they were read.
+ *
+ * @param after_seq Sequence number of the last entry already seen
+ * @param logs Array to store log entries
+ * @param max_count Maximum number of logs to retrieve
+ * @return Number of logs retrieved
+ */
+size_t log_manager_get_since(uint32_t after_seq, log_entry_t* logs, size_t max_count);
+
 /**
  * Get number of stored logs
  * @return Log count
@@ -41,6 +69,20 @@ size_t log_manager_get_count(void);
  */
 void log_manager_clear(void);
 
+/**
+ * Rate limiting: each log call site (format string in flash) may print
+ * LOG_RATE_LIMIT_BURST lines back to back, then one per
+ * LOG_RATE_LIMIT_REFILL_MS. The next line that gets through carries
+ * "(repeated N times)", and a site that goes quiet is summarized after
+ * LOG_RATE_LIMIT_SUMMARY_MS.
+ */
+
+/**
+ * Get number of log records dropped because the deferred ring was full
+ * @return Dropped count since boot (0 when deferred logging is disabled)
+ */
+uint32_t log_manager_get_dropped(void);
+
 /**
  * Get log level as string
  * @param level ESP log level
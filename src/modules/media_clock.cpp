@@ -0,0 +1,431 @@
+#include "media_clock.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include <string.h>
+#include <atomic>
+
+static const char *TAG = "MEDIA_CLOCK";
+
+#define PPB 1000000000LL
+
+// Wall clock: written by the SNTP callback and the exchange task, read by the senders
+static portMUX_TYPE clock_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool wall_synced = false;
+static int64_t ref_timer_us = 0; // Anchor of the esp_timer -> UTC mapping
+static int64_t ref_utc_us = 0;
+static int64_t freq_timer_us = 0; // Start of the current frequency baseline
+static int64_t freq_utc_us = 0;
+static bool freq_measured = false;
+static int32_t timer_ppb = 0;
+static int64_t last_ref_us = 0;        // esp_timer time of the last accepted reference
+static int64_t last_server_ref_us = 0; // ... of the last server reference
+static media_clock_status_t wall_status;
+static char server_ip[16] = UDP_SERVER_IP;
+static uint16_t server_port = MEDIA_CLOCK_SERVER_PORT;
+
+// Sample clock: only touched by the reader task, results published atomically
+static uint32_t nominal_sps = 0;
+static bool capture_anchored = false;
+static uint64_t anchor_index = 0;
+static int64_t anchor_us = 0;
+static int32_t sample_ppb = 0; // Against esp_timer
+static int64_t window_start_us = 0;
+static int64_t window_min_err = INT64_MAX;
+static int64_t window_max_err = INT64_MIN;
+static uint64_t window_min_index = 0;
+static int64_t window_min_us = 0;
+static bool have_point = false; // Lower envelope point of the previous window
+static uint64_t point_index = 0;
+static int64_t point_us = 0;
+
+static std::atomic<int32_t> published_sample_ppb(0);
+static std::atomic<bool> sample_drift_valid(false);
+static std::atomic<uint32_t> capture_resyncs(0);
+static std::atomic<uint32_t> capture_jitter_us(0);
+
+static int32_t clamp_ppb(int64_t ppb)
+{
+    if (ppb > MEDIA_CLOCK_MAX_DRIFT_PPB)
+    {
+        return MEDIA_CLOCK_MAX_DRIFT_PPB;
+    }
+    if (ppb < -MEDIA_CLOCK_MAX_DRIFT_PPB)
+    {
+        return -MEDIA_CLOCK_MAX_DRIFT_PPB;
+    }
+    return (int32_t)ppb;
+}
+
+// esp_timer microseconds taken by this many samples on the sample clock
+static int64_t sample_span_us(int64_t samples)
+{
+    int64_t nominal_us = samples * 1000000 / nominal_sps;
+    return nominal_us - nominal_us * sample_ppb / PPB;
+}
+
+static void capture_anchor(uint64_t sample_index, int64_t read_us)
+{
+    capture_anchored = true;
+    anchor_index = sample_index;
+    anchor_us = read_us;
+    window_start_us = read_us;
+    window_min_err = INT64_MAX;
+    window_max_err = INT64_MIN;
+    have_point = false;
+}
+
+// Measure drift between lower envelope points at least half a window apart, then re-anchor on the newer one
+static void capture_close_window(int64_t read_us)
+{
+    bool keep_point = false;
+    if (have_point)
+    {
+        int64_t samples = (int64_t)(window_min_index - point_index);
+        int64_t elapsed_us = window_min_us - point_us;
+        keep_point = elapsed_us < (int64_t)MEDIA_CLOCK_DRIFT_WINDOW_MS * 500;
+        if (samples > 0 && !keep_point)
+        {
+            int64_t nominal_ns = samples * 1000000000LL / nominal_sps;
+            int64_t measured = (nominal_ns - elapsed_us * 1000) * 1000000 / elapsed_us;
+            if (!sample_drift_valid.load())
+            {
+                sample_ppb = clamp_ppb(measured);
+            }
+            else
+            {
+                sample_ppb = clamp_ppb(sample_ppb + (measured - sample_ppb) / MEDIA_CLOCK_DRIFT_SMOOTHING);
+            }
+            published_sample_ppb.store(sample_ppb);
+            sample_drift_valid.store(true);
+        }
+    }
+
+    capture_jitter_us.store((uint32_t)(window_max_err - window_min_err));
+    if (!keep_point)
+    {
+        point_index = window_min_index;
+        point_us = window_min_us;
+        have_point = true;
+    }
+
+    anchor_index = window_min_index;
+    anchor_us = window_min_us;
+    window_start_us = read_us;
+    window_min_err = INT64_MAX;
+    window_max_err = INT64_MIN;
+}
+
+// Caller holds clock_lock
+static int64_t timer_to_utc(int64_t timer_us)
+{
+    int64_t elapsed = timer_us - ref_timer_us;
+    return ref_utc_us + elapsed - elapsed * timer_ppb / PPB;
+}
+
+#if MEDIA_CLOCK_SERVER_SYNC_ENABLED
+// One burst of requests; the reply with the shortest round trip becomes a reference
+static bool exchange_burst(int sock, uint16_t *sequence)
+{
+    int64_t best_rtt = INT64_MAX;
+    int64_t best_timer_us = 0;
+    int64_t best_utc_us = 0;
+
+    for (int i = 0; i < MEDIA_CLOCK_SERVER_BURST; i++)
+    {
+        media_clock_sync_packet_t request;
+        memset(&request, 0, sizeof(request));
+        request.magic = MEDIA_CLOCK_SYNC_MAGIC;
+        request.version = MEDIA_CLOCK_SYNC_VERSION;
+        request.type = MEDIA_CLOCK_SYNC_REQUEST;
+        request.sequence = ++(*sequence);
+        request.t1_us = esp_timer_get_time();
+        if (send(sock, &request, sizeof(request), 0) != (ssize_t)sizeof(request))
+        {
+            return false;
+        }
+
+        // Late replies to earlier requests of the burst are skipped
+        media_clock_sync_packet_t reply;
+        ssize_t got;
+        while ((got = recv(sock, &reply, sizeof(reply), 0)) >= 0)
+        {
+            int64_t t4_us = esp_timer_get_time();
+            if (got != (ssize_t)sizeof(reply) || reply.magic != MEDIA_CLOCK_SYNC_MAGIC ||
+                reply.type != MEDIA_CLOCK_SYNC_REPLY || reply.sequence != request.sequence ||
+                reply.t1_us != request.t1_us)
+            {
+                continue;
+            }
+
+            int64_t rtt = (t4_us - request.t1_us) - (reply.t3_us - reply.t2_us);
+            if (rtt >= 0 && rtt < best_rtt)
+            {
+                best_rtt = rtt;
+                best_timer_us = request.t1_us + (t4_us - request.t1_us) / 2;
+                best_utc_us = reply.t2_us + (reply.t3_us - reply.t2_us) / 2;
+            }
+            break;
+        }
+    }
+
+    if (best_rtt > MEDIA_CLOCK_SERVER_MAX_RTT_US)
+    {
+        return false;
+    }
+    media_clock_reference(MEDIA_CLOCK_SOURCE_SERVER, best_timer_us, best_utc_us, (uint32_t)(best_rtt / 2));
+    return true;
+}
+
+static void exchange_task(void *arg)
+{
+    (void)arg;
+    uint16_t sequence = 0;
+    bool answering = false;
+
+    while (true)
+    {
+        vTaskDelay(pdMS_TO_TICKS(MEDIA_CLOCK_SERVER_INTERVAL_MS));
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        portENTER_CRITICAL(&clock_lock);
+        addr.sin_port = htons(server_port);
+        int parsed = inet_pton(AF_INET, server_ip, &addr.sin_addr);
+        portEXIT_CRITICAL(&clock_lock);
+        if (parsed != 1)
+        {
+            continue;
+        }
+
+        int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (sock < 0)
+        {
+            continue;
+        }
+        struct timeval tv = {0, MEDIA_CLOCK_SERVER_TIMEOUT_MS * 1000};
+        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+        bool ok = connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == 0 && exchange_burst(sock, &sequence);
+        close(sock);
+
+        if (ok != answering)
+        {
+            answering = ok;
+            if (ok)
+            {
+                ESP_LOGI(TAG, "Time server answering on port %d", ntohs(addr.sin_port));
+            }
+            else
+            {
+                ESP_LOGW(TAG, "Time server not answering, falling back to SNTP");
+            }
+        }
+    }
+}
+#endif
+
+bool media_clock_init(void)
+{
+    memset(&wall_status, 0, sizeof(wall_status));
+
+#if MEDIA_CLOCK_SERVER_SYNC_ENABLED
+    if (xTaskCreatePinnedToCore(exchange_task, "media_clock", MEDIA_CLOCK_TASK_STACK_SIZE, NULL,
+                                MEDIA_CLOCK_TASK_PRIORITY, NULL, MEDIA_CLOCK_TASK_CORE) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to start time exchange task");
+        return false;
+    }
+    ESP_LOGI(TAG, "Media clock ready (SNTP, time server port %d)", server_port);
+#else
+    ESP_LOGI(TAG, "Media clock ready (SNTP)");
+#endif
+    return true;
+}
+
+void media_clock_set_server(const char *ip, uint16_t port)
+{
+    if (ip == NULL)
+    {
+        return;
+    }
+    portENTER_CRITICAL(&clock_lock);
+    strncpy(server_ip, ip, sizeof(server_ip) - 1);
+    server_ip[sizeof(server_ip) - 1] = '\0';
+    if (port != 0)
+    {
+        server_port = port;
+    }
+    portEXIT_CRITICAL(&clock_lock);
+}
+
+void media_clock_set_sample_rate(uint32_t samples_per_sec)
+{
+    // The drift belongs to the crystal, not the rate: keep it as the starting estimate
+    nominal_sps = samples_per_sec;
+    capture_anchored = false;
+}
+
+int64_t media_clock_capture(uint64_t sample_index, int64_t read_us)
+{
+    if (nominal_sps == 0)
+    {
+        return read_us;
+    }
+    if (!capture_anchored)
+    {
+        capture_anchor(sample_index, read_us);
+        return read_us;
+    }
+
+    int64_t predicted = anchor_us + sample_span_us((int64_t)(sample_index - anchor_index));
+    int64_t err = read_us - predicted;
+    if (err > MEDIA_CLOCK_CAPTURE_RESYNC_US || err < -MEDIA_CLOCK_CAPTURE_RESYNC_US)
+    {
+        // Lost samples or a stalled reader: the timeline is broken, start over
+        capture_resyncs.fetch_add(1);
+        capture_anchor(sample_index, read_us);
+        return read_us;
+    }
+
+    if (err < window_min_err)
+    {
+        window_min_err = err;
+        window_min_index = sample_index;
+        window_min_us = read_us;
+    }
+    if (err > window_max_err)
+    {
+        window_max_err = err;
+    }
+    if (read_us - window_start_us >= (int64_t)MEDIA_CLOCK_DRIFT_WINDOW_MS * 1000)
+    {
+        capture_close_window(read_us);
+    }
+    return predicted;
+}
+
+void media_clock_reference(media_clock_source_t source, int64_t timer_us, int64_t utc_us, uint32_t uncertainty_us)
+{
+    int64_t now_us = esp_timer_get_time();
+    bool first = false;
+    bool stepped = false;
+    int64_t offset = 0;
+
+    portENTER_CRITICAL(&clock_lock);
+    // The server exchange is the better reference while it answers
+    if (source == MEDIA_CLOCK_SOURCE_NTP && last_server_ref_us != 0 &&
+        now_us - last_server_ref_us < (int64_t)MEDIA_CLOCK_SERVER_HOLDOFF_MS * 1000)
+    {
+        portEXIT_CRITICAL(&clock_lock);
+        return;
+    }
+    if (source == MEDIA_CLOCK_SOURCE_SERVER)
+    {
+        last_server_ref_us = now_us;
+    }
+
+    if (!wall_synced)
+    {
+        first = true;
+        wall_synced = true;
+        ref_timer_us = freq_timer_us = timer_us;
+        ref_utc_us = freq_utc_us = utc_us;
+    }
+    else
+    {
+        int64_t predicted = timer_to_utc(timer_us);
+        offset = utc_us - predicted;
+        if (offset > MEDIA_CLOCK_STEP_US || offset < -MEDIA_CLOCK_STEP_US)
+        {
+            stepped = true;
+            wall_status.steps++;
+            ref_timer_us = freq_timer_us = timer_us;
+            ref_utc_us = freq_utc_us = utc_us;
+        }
+        else
+        {
+            // Frequency over a baseline long enough that reference noise stays small
+            int64_t baseline_us = timer_us - freq_timer_us;
+            int64_t utc_elapsed_us = utc_us - freq_utc_us;
+            if (baseline_us >= (int64_t)MEDIA_CLOCK_FREQ_MIN_INTERVAL_MS * 1000 && utc_elapsed_us > 0)
+            {
+                int64_t measured = (baseline_us - utc_elapsed_us) * PPB / utc_elapsed_us;
+                timer_ppb = freq_measured ? clamp_ppb(timer_ppb + (measured - timer_ppb) / MEDIA_CLOCK_DRIFT_SMOOTHING)
+                                          : clamp_ppb(measured);
+                freq_measured = true;
+                freq_timer_us = timer_us;
+                freq_utc_us = utc_us;
+            }
+
+            // Phase: halfway to the reference, so one noisy reference cannot move every stamp
+            ref_timer_us = timer_us;
+            ref_utc_us = predicted + offset / 2;
+        }
+    }
+
+    wall_status.source = source;
+    wall_status.syncs++;
+    wall_status.uncertainty_us = uncertainty_us;
+    wall_status.last_offset_us = (int32_t)(offset > INT32_MAX ? INT32_MAX : (offset < INT32_MIN ? INT32_MIN : offset));
+    last_ref_us = now_us;
+    portEXIT_CRITICAL(&clock_lock);
+
+    if (first)
+    {
+        ESP_LOGI(TAG, "Wall clock synced (%s)", source == MEDIA_CLOCK_SOURCE_SERVER ? "time server" : "SNTP");
+    }
+    else if (stepped)
+    {
+        ESP_LOGW(TAG, "Wall clock stepped by %lld us (%s)", (long long)offset,
+                 source == MEDIA_CLOCK_SOURCE_SERVER ? "time server" : "SNTP");
+    }
+}
+
+bool media_clock_to_utc(int64_t timer_us, int64_t *utc_us)
+{
+    portENTER_CRITICAL(&clock_lock);
+    bool synced = wall_synced;
+    int64_t utc = synced ? timer_to_utc(timer_us) : timer_us;
+    portEXIT_CRITICAL(&clock_lock);
+
+    if (utc_us)
+    {
+        *utc_us = utc;
+    }
+    return synced;
+}
+
+int32_t media_clock_sample_drift_ppb(void)
+{
+    portENTER_CRITICAL(&clock_lock);
+    int32_t timer = wall_synced ? timer_ppb : 0;
+    portEXIT_CRITICAL(&clock_lock);
+
+    // Samples per UTC second = samples per esp_timer second x esp_timer seconds per UTC second
+    return clamp_ppb((int64_t)published_sample_ppb.load() + timer);
+}
+
+void media_clock_get_status(media_clock_status_t *status)
+{
+    if (status == NULL)
+    {
+        return;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    portENTER_CRITICAL(&clock_lock);
+    *status = wall_status;
+    status->synced = wall_synced;
+    status->timer_drift_ppb = timer_ppb;
+    status->since_sync_ms = wall_synced ? (uint32_t)((now_us - last_ref_us) / 1000) : 0;
+    portEXIT_CRITICAL(&clock_lock);
+
+    status->sample_drift_ppb = media_clock_sample_drift_ppb();
+    status->sample_drift_valid = sample_drift_valid.load();
+    status->capture_resyncs = capture_resyncs.load();
+    status->capture_jitter_us = capture_jitter_us.load();
+}
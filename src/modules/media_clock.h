@@ -0,0 +1,136 @@
+#ifndef MEDIA_CLOCK_H
+#define MEDIA_CLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config.h"
+
+/**
+ * Capture timestamps on a shared wall clock
+ *
+ * Two estimators, so devices capturing side by side can be aligned to the
+ * sample:
+ * - Sample clock: every I2S block is stamped by the reader when its read
+ *   returns, which jitters with scheduling. The tracker fits the stream
+ *   sample index to those stamps (lower envelope per
+ *   MEDIA_CLOCK_DRIFT_WINDOW_MS, since a read can only return late) and
+ *   hands back a smooth esp_timer time for the block, plus the sample
+ *   clock's drift against esp_timer.
+ * - Wall clock: esp_timer is mapped to UTC microseconds from reference
+ *   points, disciplined in phase and frequency rather than stepped. Points
+ *   come from SNTP (network_manager) or, with MEDIA_CLOCK_SERVER_SYNC_ENABLED,
+ *   from a two-way exchange with the stream server, which preempts SNTP
+ *   while it answers.
+ *
+ * Server exchange (UDP, media_clock_port, default MEDIA_CLOCK_SERVER_PORT,
+ * little-endian):
+ *   request: media_clock_sync_packet_t, type 1, t1 = device send time
+ *   reply:   the same packet, type 2, t1 echoed, t2/t3 = server receive
+ *            and send time in UTC microseconds
+ * The device takes the reply with the shortest round trip of each burst.
+ */
+
+#define MEDIA_CLOCK_SYNC_MAGIC 0x43545341 // "ASTC" on the wire
+#define MEDIA_CLOCK_SYNC_VERSION 1
+#define MEDIA_CLOCK_SYNC_REQUEST 1
+#define MEDIA_CLOCK_SYNC_REPLY 2
+
+typedef struct
+{
+    uint32_t magic;
+    uint8_t version;
+    uint8_t type;   // MEDIA_CLOCK_SYNC_REQUEST or MEDIA_CLOCK_SYNC_REPLY
+    uint16_t sequence;
+    int64_t t1_us;  // Device esp_timer time at send (echoed)
+    int64_t t2_us;  // Server UTC at receive
+    int64_t t3_us;  // Server UTC at reply
+} __attribute__((packed)) media_clock_sync_packet_t;
+
+typedef enum
+{
+    MEDIA_CLOCK_SOURCE_NONE = 0,
+    MEDIA_CLOCK_SOURCE_NTP = 1,
+    MEDIA_CLOCK_SOURCE_SERVER = 2,
+} media_clock_source_t;
+
+/**
+ * Clock status
+ */
+typedef struct
+{
+    bool synced;                 // Wall clock valid
+    media_clock_source_t source; // Last accepted reference
+    uint32_t syncs;              // Accepted references since boot
+    uint32_t steps;              // References too far off to slew to
+    uint32_t since_sync_ms;
+    uint32_t uncertainty_us;     // Of the last reference (half the round trip, 0 for SNTP)
+    int32_t last_offset_us;      // Last reference minus the disciplined clock
+    int32_t timer_drift_ppb;     // esp_timer against UTC (+ = runs fast)
+    int32_t sample_drift_ppb;    // Sample clock against UTC (against esp_timer while not synced)
+    bool sample_drift_valid;     // At least one drift window measured
+    uint32_t capture_resyncs;    // Sample clock re-anchored (gap or reconfiguration)
+    uint32_t capture_jitter_us;  // Largest read delay over the sample clock in the last window
+} media_clock_status_t;
+
+/**
+ * Start the clock (and the server exchange task if enabled)
+ * @return true on success
+ */
+bool media_clock_init(void);
+
+/**
+ * Set the stream server used by the exchange (call when the streamer server changes)
+ * @param ip IPv4 address
+ * @param port UDP port of its time service (0 keeps the current one)
+ */
+void media_clock_set_server(const char *ip, uint16_t port);
+
+/**
+ * Set the nominal ring rate and restart the sample clock
+ *
+ * Call from the reader whenever the capture format changes.
+ *
+ * @param samples_per_sec Interleaved samples per second into the ring
+ */
+void media_clock_set_sample_rate(uint32_t samples_per_sec);
+
+/**
+ * Stamp a captured block on the sample clock (reader task only)
+ *
+ * @param sample_index Stream index of the block's first sample
+ * @param read_us esp_timer time of the first sample as seen by the reader
+ * @return Smoothed esp_timer time of the first sample
+ */
+int64_t media_clock_capture(uint64_t sample_index, int64_t read_us);
+
+/**
+ * Feed a wall-clock reference
+ *
+ * @param source Where it came from
+ * @param timer_us esp_timer time the reference applies to
+ * @param utc_us UTC microseconds at that instant
+ * @param uncertainty_us Error bound (0 if unknown)
+ */
+void media_clock_reference(media_clock_source_t source, int64_t timer_us, int64_t utc_us, uint32_t uncertainty_us);
+
+/**
+ * Convert an esp_timer time to UTC microseconds
+ *
+ * @param timer_us esp_timer time
+ * @param utc_us Output (set to timer_us while not synced)
+ * @return true if the wall clock is synced
+ */
+bool media_clock_to_utc(int64_t timer_us, int64_t *utc_us);
+
+/**
+ * Get measured sample clock drift in ppb (against UTC once synced, 0 until measured)
+ */
+int32_t media_clock_sample_drift_ppb(void);
+
+/**
+ * Get clock status
+ * @param status Output
+ */
+void media_clock_get_status(media_clock_status_t *status);
+
+#endif // MEDIA_CLOCK_H
@@ -1,12 +1,22 @@
 #include "network_manager.h"
+#include "boot_profile.h"
+#include "media_clock.h"
 #include "../config.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_sntp.h"
+#include "esp_timer.h"
 #include "esp_task_wdt.h"
 // #include "mdns.h"  // TODO: Add mDNS support when available
 #include "nvs_flash.h"
+#include "nvs.h"
+#include "freertos/event_groups.h"
+#if WIFI_ROAMING_ASSIST_ENABLED && CONFIG_ESP_WIFI_11KV_SUPPORT
+#include "esp_wnm.h"
+#elif WIFI_ROAMING_ASSIST_ENABLED
+#warning "WIFI_ROAMING_ASSIST_ENABLED without CONFIG_ESP_WIFI_11KV_SUPPORT: no BSS transition queries (see sdkconfig.defaults)"
+#endif
 #include "lwip/err.h"
 #include "lwip/sys.h"
 #include <time.h>
@@ -22,6 +32,104 @@ static bool wifi_trials_paused = false;       // ✅ Flag to pause WiFi during c
 static const uint32_t MAX_DISCONNECT_BEFORE_REBOOT = 20;
 static const uint32_t MAX_INITIAL_FAILURES = 3; // ✅ 3 strikes before captive portal
 
+// Connected (has an IP): lets the sender block until the link is back instead of polling
+static EventGroupHandle_t wifi_events = NULL;
+#define WIFI_GOT_IP_BIT BIT0
+
+// ✅ FAST RECONNECT: the last AP joined, so a reconnect skips the all-channel scan
+#define FAST_RECONNECT_NAMESPACE "wifi_fast"
+#define FAST_RECONNECT_KEY "ap"
+
+typedef struct
+{
+    char ssid[33]; // Cache only applies to the SSID it was learned on
+    uint8_t bssid[6];
+    uint8_t channel;
+} wifi_ap_cache_t;
+
+static wifi_config_t sta_config = {};
+static wifi_ap_cache_t ap_cache = {};
+static bool ap_cache_valid = false;
+static bool ap_pinned = false;    // sta_config targets ap_cache (no scan)
+static int64_t disconnect_us = 0; // Link lost at, for the reconnect time log
+static uint32_t last_reconnect_ms = 0;
+
+static void ap_cache_load(void)
+{
+    nvs_handle_t handle;
+    if (nvs_open(FAST_RECONNECT_NAMESPACE, NVS_READONLY, &handle) != ESP_OK)
+    {
+        return; // Nothing joined yet
+    }
+
+    size_t size = sizeof(ap_cache);
+    ap_cache_valid = nvs_get_blob(handle, FAST_RECONNECT_KEY, &ap_cache, &size) == ESP_OK &&
+                     size == sizeof(ap_cache) && strncmp(ap_cache.ssid, WIFI_SSID, sizeof(ap_cache.ssid)) == 0 &&
+                     ap_cache.channel != 0;
+    nvs_close(handle);
+}
+
+static void ap_cache_store(const uint8_t *bssid, uint8_t channel)
+{
+    if (ap_cache_valid && channel == ap_cache.channel && memcmp(bssid, ap_cache.bssid, 6) == 0)
+    {
+        return; // Same AP as last time: no flash write
+    }
+
+    memset(&ap_cache, 0, sizeof(ap_cache));
+    strncpy(ap_cache.ssid, WIFI_SSID, sizeof(ap_cache.ssid) - 1);
+    memcpy(ap_cache.bssid, bssid, 6);
+    ap_cache.channel = channel;
+    ap_cache_valid = true;
+
+    nvs_handle_t handle;
+    if (nvs_open(FAST_RECONNECT_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK)
+    {
+        if (nvs_set_blob(handle, FAST_RECONNECT_KEY, &ap_cache, sizeof(ap_cache)) != ESP_OK ||
+            nvs_commit(handle) != ESP_OK)
+        {
+            ESP_LOGW(TAG, "Failed to cache AP for fast reconnect");
+        }
+        nvs_close(handle);
+    }
+}
+
+/**
+ * Point sta_config at the cached AP (pinned BSSID, single channel) or at a
+ * scan of every channel for the strongest AP of the SSID. Credentials stay
+ * the same, so the driver keeps its cached PMK and the handshake skips the
+ * passphrase hashing.
+ */
+static void set_sta_target(bool pin)
+{
+    pin = pin && ap_cache_valid;
+    if (pin)
+    {
+        sta_config.sta.bssid_set = true;
+        memcpy(sta_config.sta.bssid, ap_cache.bssid, 6);
+        sta_config.sta.channel = ap_cache.channel;
+        sta_config.sta.scan_method = WIFI_FAST_SCAN;
+    }
+    else
+    {
+        sta_config.sta.bssid_set = false;
+        sta_config.sta.channel = 0;
+        sta_config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+    }
+    sta_config.sta.sort_method = WIFI_CONNECT_AP_BY_SIGNAL;
+    ap_pinned = pin;
+}
+
+static void apply_sta_target(bool pin)
+{
+    set_sta_target(pin);
+    esp_err_t ret = esp_wifi_set_config(WIFI_IF_STA, &sta_config);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Failed to set WiFi target: %s", esp_err_to_name(ret));
+    }
+}
+
 static void wifi_event_handler(void *arg, esp_event_base_t event_base,
                                int32_t event_id, void *event_data)
 {
@@ -30,9 +138,54 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base,
         esp_wifi_connect();
         ESP_LOGI(TAG, "WiFi started, connecting...");
     }
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED)
+    {
+        wifi_event_sta_connected_t *event = (wifi_event_sta_connected_t *)event_data;
+        ESP_LOGI(TAG, "Associated with " MACSTR " (channel %d)", MAC2STR(event->bssid), event->channel);
+#if WIFI_FAST_RECONNECT_ENABLED
+        ap_cache_store(event->bssid, event->channel);
+#endif
+#if WIFI_ROAMING_ASSIST_ENABLED
+        esp_wifi_set_rssi_threshold(WIFI_ROAM_RSSI_THRESHOLD);
+#endif
+    }
+#if WIFI_ROAMING_ASSIST_ENABLED
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_BSS_RSSI_LOW)
+    {
+        wifi_event_bss_rssi_low_t *event = (wifi_event_bss_rssi_low_t *)event_data;
+        ESP_LOGW(TAG, "RSSI %ld dBm below roaming threshold", (long)event->rssi);
+#if CONFIG_ESP_WIFI_11KV_SUPPORT
+        // The AP answers with a BSS transition request; the supplicant then roams (FT if 802.11r)
+        esp_wnm_send_bss_transition_mgmt_query(REASON_FRAME_LOSS, NULL, 0);
+#endif
+        esp_wifi_set_rssi_threshold(WIFI_ROAM_RSSI_THRESHOLD); // One-shot: re-arm
+    }
+#endif
     else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED)
     {
+        wifi_event_sta_disconnected_t *event = (wifi_event_sta_disconnected_t *)event_data;
+        bool was_connected = wifi_connected;
         wifi_connected = false;
+        xEventGroupClearBits(wifi_events, WIFI_GOT_IP_BIT);
+
+#if WIFI_FAST_RECONNECT_ENABLED
+        // The cached AP did not take us: scan before counting a failure
+        if (ap_pinned && !was_connected)
+        {
+            ESP_LOGW(TAG, "Cached AP not reachable (reason %d), scanning all channels", event->reason);
+            apply_sta_target(false);
+            if (!wifi_trials_paused)
+            {
+                esp_wifi_connect();
+            }
+            return;
+        }
+#endif
+
+        if (was_connected)
+        {
+            disconnect_us = esp_timer_get_time();
+        }
         wifi_disconnect_count++; // ✅ Track disconnects
 
         // ✅ Count initial connection failures for 3-strike rule
@@ -43,8 +196,8 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base,
                      wifi_connection_failures, MAX_INITIAL_FAILURES);
         }
 
-        ESP_LOGW(TAG, "WiFi disconnected (count: %lu), attempting reconnect...",
-                 wifi_disconnect_count);
+        ESP_LOGW(TAG, "WiFi disconnected (reason %d, count: %lu), attempting reconnect...",
+                 event->reason, wifi_disconnect_count);
 
         // ✅ Add emergency reboot for persistent WiFi issues
         if (wifi_disconnect_count > MAX_DISCONNECT_BEFORE_REBOOT)
@@ -57,6 +210,13 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base,
         // ✅ Only attempt reconnect if trials are not paused
         if (!wifi_trials_paused)
         {
+#if WIFI_FAST_RECONNECT_ENABLED
+            // A dropped link usually comes back on the same AP: try it first
+            if (was_connected && !ap_pinned)
+            {
+                apply_sta_target(true);
+            }
+#endif
             esp_wifi_connect();
         }
         else
@@ -69,6 +229,14 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base,
         ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
         ESP_LOGI(TAG, "Got IP: " IPSTR, IP2STR(&event->ip_info.ip));
         wifi_connected = true;
+        xEventGroupSetBits(wifi_events, WIFI_GOT_IP_BIT);
+        boot_profile_mark(BOOT_PHASE_WIFI);
+        if (disconnect_us != 0)
+        {
+            last_reconnect_ms = (uint32_t)((esp_timer_get_time() - disconnect_us) / 1000);
+            disconnect_us = 0;
+            ESP_LOGI(TAG, "WiFi back after %lu ms (%s)", last_reconnect_ms, ap_pinned ? "cached AP" : "scan");
+        }
         wifi_disconnect_count = 0;    // ✅ Reset on successful connection
         wifi_connection_failures = 0; // ✅ Reset initial failure counter
     }
@@ -107,6 +275,16 @@ bool network_manager_init(void)
         return false;
     }
 
+    if (wifi_events == NULL)
+    {
+        wifi_events = xEventGroupCreate();
+        if (wifi_events == NULL)
+        {
+            ESP_LOGE(TAG, "CRITICAL: Failed to create WiFi event group");
+            return false;
+        }
+    }
+
     // Initialize TCP/IP stack
     ret = esp_netif_init();
     if (ret != ESP_OK)
@@ -209,18 +387,38 @@ bool network_manager_init(void)
     }
 
     // Configure WiFi
-    wifi_config_t wifi_config = {};
+    memset(&sta_config, 0, sizeof(sta_config));
 
     // Copy SSID with null-termination safeguard (SSID field is 32 bytes, max 31 chars + null)
-    strncpy((char *)wifi_config.sta.ssid, WIFI_SSID, sizeof(wifi_config.sta.ssid) - 1);
-    wifi_config.sta.ssid[sizeof(wifi_config.sta.ssid) - 1] = '\0';
+    strncpy((char *)sta_config.sta.ssid, WIFI_SSID, sizeof(sta_config.sta.ssid) - 1);
+    sta_config.sta.ssid[sizeof(sta_config.sta.ssid) - 1] = '\0';
 
     // Copy password with null-termination safeguard (password field is 64 bytes, max 63 chars + null)
-    strncpy((char *)wifi_config.sta.password, WIFI_PASSWORD, sizeof(wifi_config.sta.password) - 1);
-    wifi_config.sta.password[sizeof(wifi_config.sta.password) - 1] = '\0';
-    wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
-    wifi_config.sta.pmf_cfg.capable = true;
-    wifi_config.sta.pmf_cfg.required = false;
+    strncpy((char *)sta_config.sta.password, WIFI_PASSWORD, sizeof(sta_config.sta.password) - 1);
+    sta_config.sta.password[sizeof(sta_config.sta.password) - 1] = '\0';
+    sta_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
+    sta_config.sta.pmf_cfg.capable = true;
+    sta_config.sta.pmf_cfg.required = false;
+
+#if WIFI_ROAMING_ASSIST_ENABLED
+    // Used only when the AP advertises them (and the IDF options are on)
+    sta_config.sta.rm_enabled = 1;  // 802.11k neighbor reports
+    sta_config.sta.btm_enabled = 1; // 802.11v BSS transition
+    sta_config.sta.mbo_enabled = 1;
+    sta_config.sta.ft_enabled = 1;  // 802.11r fast transition: no full handshake on a roam
+#endif
+
+#if WIFI_FAST_RECONNECT_ENABLED
+    // First join goes straight to the last AP; a miss falls back to the scan
+    ap_cache_load();
+    if (ap_cache_valid)
+    {
+        ESP_LOGI(TAG, "Fast connect to cached AP " MACSTR " (channel %d)", MAC2STR(ap_cache.bssid), ap_cache.channel);
+    }
+    set_sta_target(ap_cache_valid);
+#else
+    set_sta_target(false);
+#endif
 
     ret = esp_wifi_set_mode(WIFI_MODE_STA);
     if (ret != ESP_OK)
@@ -229,7 +427,7 @@ bool network_manager_init(void)
         return false;
     }
 
-    ret = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+    ret = esp_wifi_set_config(WIFI_IF_STA, &sta_config);
     if (ret != ESP_OK)
     {
         ESP_LOGE(TAG, "Failed to set WiFi config: %s", esp_err_to_name(ret));
@@ -268,6 +466,22 @@ bool network_manager_is_connected(void)
     return wifi_connected;
 }
 
+bool network_manager_wait_connected(uint32_t timeout_ms)
+{
+    if (wifi_events == NULL)
+    {
+        vTaskDelay(pdMS_TO_TICKS(timeout_ms));
+        return false;
+    }
+    EventBits_t bits = xEventGroupWaitBits(wifi_events, WIFI_GOT_IP_BIT, pdFALSE, pdTRUE, pdMS_TO_TICKS(timeout_ms));
+    return (bits & WIFI_GOT_IP_BIT) != 0;
+}
+
+uint32_t network_manager_get_last_reconnect_ms(void)
+{
+    return last_reconnect_ms;
+}
+
 bool network_manager_reconnect(void)
 {
     if (wifi_connected)
@@ -299,6 +513,13 @@ static void ntp_sync_callback(struct timeval *tv)
 {
     ESP_LOGI(TAG, "NTP time synchronized");
     ntp_synced = true;
+
+    // tv was applied just now: a wall-clock reference for the capture timestamps
+    if (tv != NULL)
+    {
+        media_clock_reference(MEDIA_CLOCK_SOURCE_NTP, esp_timer_get_time(),
+                              (int64_t)tv->tv_sec * 1000000 + tv->tv_usec, 0);
+    }
 }
 
 bool network_manager_init_ntp(void)
@@ -307,6 +528,7 @@ bool network_manager_init_ntp(void)
 
     esp_sntp_setoperatingmode(SNTP_OPMODE_POLL);
     esp_sntp_setservername(0, NTP_SERVER);
+    sntp_set_sync_interval(NTP_SYNC_INTERVAL_MS);
     sntp_set_time_sync_notification_cb(ntp_sync_callback);
     esp_sntp_init();
 
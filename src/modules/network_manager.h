@@ -2,6 +2,7 @@
 #define NETWORK_MANAGER_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <ctime>
 
 /**
@@ -10,7 +11,8 @@
  * Configures WiFi with:
  * - Static IP or DHCP
  * - Power save mode disabled (for consistent streaming)
- * - Auto-reconnect enabled
+ * - Auto-reconnect enabled, to the cached AP (BSSID/channel in NVS) first
+ * - 802.11k/v/r roaming assistance when the AP supports it
  *
  * @return true on successful connection, false on failure
  */
@@ -23,6 +25,21 @@ bool network_manager_init(void);
  */
 bool network_manager_is_connected(void);
 
+/**
+ * Wait until WiFi has an IP (woken by IP_EVENT_STA_GOT_IP, no polling)
+ *
+ * @param timeout_ms Longest wait
+ * @return true if connected
+ */
+bool network_manager_wait_connected(uint32_t timeout_ms);
+
+/**
+ * Get how long the last reconnect took (link lost to IP back)
+ *
+ * @return Milliseconds, 0 if the link has not dropped since boot
+ */
+uint32_t network_manager_get_last_reconnect_ms(void);
+
 /**
  * Reconnect to WiFi if disconnected
  *
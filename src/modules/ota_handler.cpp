@@ -1,20 +1,471 @@
 #include "ota_handler.h"
+#include "../config.h"
 #include "web_server_v2.h"
 #include "esp_log.h"
 #include "esp_ota_ops.h"
 #include "esp_http_server.h"
+#include "esp_http_client.h"
+#include "esp_crt_bundle.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
 #include "esp_system.h"
 #include "esp_app_format.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "miniz.h"
 #include "cJSON.h"
+#include <stdio.h>
 #include <string.h>
+#include <atomic>
 
 static const char *TAG = "OTA_HANDLER";
 
+#define BLOCK_END 0xFF                  // Queued after the last block: the writer reports back
+#define INFLATE_DICT_SIZE TINFL_LZ_DICT_SIZE
+#define PROGRESS_LOG_BYTES (4 * OTA_BLOCK_SIZE) // Log every this many received bytes
+
 static esp_ota_handle_t ota_handle = 0;
 static const esp_partition_t *update_partition = NULL;
-static bool ota_in_progress = false;
-static size_t total_size = 0;
-static size_t written_size = 0;
+static std::atomic<bool> ota_in_progress(false);
+static std::atomic<size_t> total_size(0);    // Bytes to receive (0 = unknown)
+static std::atomic<size_t> received_size(0);
+static std::atomic<size_t> written_size(0);  // Bytes flashed (after inflating)
+static const char *session_source = "none";
+static bool session_compressed = false;
+static int64_t session_start_us = 0;
+
+static portMUX_TYPE error_lock = portMUX_INITIALIZER_UNLOCKED;
+static char last_error[64] = "";
+
+// Block pipeline: the receiver fills PSRAM blocks, the writer task flashes them
+// (fewer, smaller internal RAM blocks on boards without PSRAM)
+static uint8_t *blocks[OTA_BLOCK_COUNT];
+static size_t block_fill[OTA_BLOCK_COUNT];
+static size_t block_size = OTA_BLOCK_SIZE;
+static_assert(OTA_BLOCK_INTERNAL_COUNT <= OTA_BLOCK_COUNT, "OTA_BLOCK_INTERNAL_COUNT must fit the block queues");
+static uint8_t block_count = OTA_BLOCK_COUNT;
+static QueueHandle_t free_blocks = NULL;
+static QueueHandle_t full_blocks = NULL;
+static SemaphoreHandle_t writer_done = NULL;
+static TaskHandle_t writer_task_handle = NULL;
+static std::atomic<bool> writer_failed(false);
+static int current_block = -1; // Being filled by the receiver
+static uint32_t blocks_received = 0;
+
+// Writer-side image state
+static bool first_block = true;
+static tinfl_decompressor *inflator = NULL;
+static uint8_t *inflate_dict = NULL; // Inflate output window, flashed as it fills
+static size_t dict_offset = 0;
+static bool inflate_done = false;
+
+// Pull mode
+static char pull_url[OTA_PULL_URL_MAX];
+static TaskHandle_t pull_task_handle = NULL;
+
+static void set_error(const char *message)
+{
+    portENTER_CRITICAL(&error_lock);
+    strncpy(last_error, message, sizeof(last_error) - 1);
+    last_error[sizeof(last_error) - 1] = '\0';
+    portEXIT_CRITICAL(&error_lock);
+    ESP_LOGE(TAG, "%s", message);
+}
+
+static void get_error(char *out, size_t size)
+{
+    portENTER_CRITICAL(&error_lock);
+    strncpy(out, last_error, size - 1);
+    out[size - 1] = '\0';
+    portEXIT_CRITICAL(&error_lock);
+}
+
+// Length of a gzip member header, 0 if data does not start with a complete one
+static size_t gzip_header_size(const uint8_t *data, size_t len)
+{
+    if (len < 10 || data[0] != 0x1f || data[1] != 0x8b || data[2] != 8)
+    {
+        return 0;
+    }
+
+    uint8_t flags = data[3];
+    size_t pos = 10;
+    if (flags & 0x04) // FEXTRA
+    {
+        if (pos + 2 > len)
+        {
+            return 0;
+        }
+        pos += 2 + (data[pos] | (data[pos + 1] << 8));
+    }
+    for (uint8_t field = 0x08; field <= 0x10; field <<= 1) // FNAME, FCOMMENT
+    {
+        if (flags & field)
+        {
+            while (pos < len && data[pos] != '\0')
+            {
+                pos++;
+            }
+            pos++;
+        }
+    }
+    if (flags & 0x02) // FHCRC
+    {
+        pos += 2;
+    }
+    return pos <= len ? pos : 0;
+}
+
+static esp_err_t flash_write(const uint8_t *data, size_t len)
+{
+    esp_err_t ret = esp_ota_write(ota_handle, data, len);
+    if (ret == ESP_OK)
+    {
+        written_size.fetch_add(len, std::memory_order_relaxed);
+    }
+    return ret;
+}
+
+// Inflate one block of a gzip image into the window, flashing it as it fills
+static esp_err_t inflate_write(const uint8_t *data, size_t len)
+{
+    tinfl_status status;
+    do
+    {
+        size_t in_bytes = len;
+        size_t out_bytes = INFLATE_DICT_SIZE - dict_offset;
+        status = tinfl_decompress(inflator, data, &in_bytes, inflate_dict, inflate_dict + dict_offset, &out_bytes,
+                                  TINFL_FLAG_HAS_MORE_INPUT);
+        data += in_bytes;
+        len -= in_bytes;
+
+        if (out_bytes > 0)
+        {
+            esp_err_t ret = flash_write(inflate_dict + dict_offset, out_bytes);
+            if (ret != ESP_OK)
+            {
+                return ret;
+            }
+            dict_offset = (dict_offset + out_bytes) & (INFLATE_DICT_SIZE - 1);
+        }
+        if (status < TINFL_STATUS_DONE)
+        {
+            set_error("Corrupt compressed image");
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+    } while (status == TINFL_STATUS_HAS_MORE_OUTPUT || (status == TINFL_STATUS_NEEDS_MORE_INPUT && len > 0));
+
+    // The gzip trailer is left unchecked: the image SHA-256 in esp_ota_end() covers the content
+    inflate_done = status == TINFL_STATUS_DONE;
+    return ESP_OK;
+}
+
+static esp_err_t write_block(const uint8_t *data, size_t len)
+{
+    if (first_block)
+    {
+        first_block = false;
+        session_compressed = len >= 2 && data[0] == 0x1f && data[1] == 0x8b;
+        if (session_compressed)
+        {
+            size_t header = gzip_header_size(data, len);
+            if (header == 0)
+            {
+                set_error("Invalid gzip header");
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+            if (inflator == NULL)
+            {
+                set_error("Compressed images need PSRAM, upload the .bin");
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+            ESP_LOGI(TAG, "Compressed image, inflating while flashing");
+            tinfl_init(inflator);
+            data += header;
+            len -= header;
+        }
+    }
+
+    if (!session_compressed)
+    {
+        return flash_write(data, len);
+    }
+    if (inflate_done)
+    {
+        return ESP_OK; // Trailer
+    }
+    return inflate_write(data, len);
+}
+
+// Flash erase and write stalls land here, not on the receiving socket
+static void ota_writer_task(void *arg)
+{
+    while (1)
+    {
+        uint8_t index;
+        xQueueReceive(full_blocks, &index, portMAX_DELAY);
+        if (index == BLOCK_END)
+        {
+            xSemaphoreGive(writer_done);
+            continue;
+        }
+
+        if (!writer_failed.load(std::memory_order_relaxed))
+        {
+            esp_err_t ret = write_block(blocks[index], block_fill[index]);
+            if (ret != ESP_OK)
+            {
+                if (ret != ESP_ERR_INVALID_RESPONSE) // Already described
+                {
+                    char message[64];
+                    snprintf(message, sizeof(message), "Flash write failed (%s)", esp_err_to_name(ret));
+                    set_error(message);
+                }
+                writer_failed.store(true, std::memory_order_relaxed);
+            }
+        }
+        xQueueSend(free_blocks, &index, portMAX_DELAY);
+    }
+}
+
+static bool pipeline_init(void)
+{
+    if (writer_task_handle != NULL)
+    {
+        return true;
+    }
+
+    free_blocks = xQueueCreate(OTA_BLOCK_COUNT, sizeof(uint8_t));
+    full_blocks = xQueueCreate(OTA_BLOCK_COUNT + 1, sizeof(uint8_t)); // + BLOCK_END
+    writer_done = xSemaphoreCreateBinary();
+    if (free_blocks == NULL || full_blocks == NULL || writer_done == NULL)
+    {
+        return false;
+    }
+
+    return xTaskCreatePinnedToCore(ota_writer_task, "ota_writer", OTA_WRITER_STACK_SIZE, NULL,
+                                   OTA_WRITER_PRIORITY, &writer_task_handle, OTA_WRITER_CORE) == pdPASS;
+}
+
+static void session_free_buffers(void)
+{
+    for (int i = 0; i < OTA_BLOCK_COUNT; i++)
+    {
+        heap_caps_free(blocks[i]);
+        blocks[i] = NULL;
+    }
+    heap_caps_free(inflator);
+    heap_caps_free(inflate_dict);
+    inflator = NULL;
+    inflate_dict = NULL;
+}
+
+// Session buffers: PSRAM blocks and the inflater, or small internal RAM blocks without PSRAM
+static bool session_alloc_buffers(void)
+{
+    bool psram = heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0;
+    uint32_t caps = psram ? MALLOC_CAP_SPIRAM : (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    block_size = psram ? OTA_BLOCK_SIZE : OTA_BLOCK_INTERNAL_SIZE;
+    block_count = psram ? OTA_BLOCK_COUNT : OTA_BLOCK_INTERNAL_COUNT;
+
+    bool allocated = true;
+    for (int i = 0; i < block_count; i++)
+    {
+        blocks[i] = (uint8_t *)heap_caps_malloc(block_size, caps);
+        allocated = allocated && blocks[i] != NULL;
+    }
+    if (psram)
+    {
+        inflator = (tinfl_decompressor *)heap_caps_malloc(sizeof(tinfl_decompressor), MALLOC_CAP_SPIRAM);
+        inflate_dict = (uint8_t *)heap_caps_malloc(INFLATE_DICT_SIZE, MALLOC_CAP_SPIRAM);
+        allocated = allocated && inflator != NULL && inflate_dict != NULL;
+    }
+    else
+    {
+        ESP_LOGI(TAG, "No PSRAM: %u x %zu byte internal RAM blocks, gzip images disabled",
+                 (unsigned)block_count, block_size);
+    }
+    return allocated;
+}
+
+// Take the single OTA slot (false while another update runs)
+static bool session_claim(void)
+{
+    bool expected = false;
+    return ota_in_progress.compare_exchange_strong(expected, true);
+}
+
+static void session_release(void)
+{
+    ota_in_progress.store(false);
+}
+
+// Start writing an image to the update partition (slot claimed)
+static bool session_begin(const char *source, size_t image_size)
+{
+    session_source = source;
+    total_size.store(image_size, std::memory_order_relaxed);
+    received_size.store(0, std::memory_order_relaxed);
+    written_size.store(0, std::memory_order_relaxed);
+    set_error("");
+
+    if (!pipeline_init())
+    {
+        set_error("Failed to start flash writer");
+        return false;
+    }
+
+    if (!session_alloc_buffers())
+    {
+        session_free_buffers();
+        set_error("Out of memory for OTA buffers");
+        return false;
+    }
+
+    update_partition = esp_ota_get_next_update_partition(NULL);
+    if (!update_partition)
+    {
+        session_free_buffers();
+        set_error("No update partition");
+        return false;
+    }
+
+    ESP_LOGI(TAG, "OTA %s started: writing to partition subtype %d at offset 0x%lx",
+             source, update_partition->subtype, update_partition->address);
+
+    // Sectors are erased as the writer reaches them instead of all up front
+    esp_err_t ret = esp_ota_begin(update_partition, OTA_WITH_SEQUENTIAL_WRITES, &ota_handle);
+    if (ret != ESP_OK)
+    {
+        session_free_buffers();
+        char message[64];
+        snprintf(message, sizeof(message), "esp_ota_begin failed (%s)", esp_err_to_name(ret));
+        set_error(message);
+        return false;
+    }
+
+    xQueueReset(free_blocks);
+    xQueueReset(full_blocks);
+    for (uint8_t i = 0; i < block_count; i++)
+    {
+        xQueueSend(free_blocks, &i, 0);
+    }
+    writer_failed.store(false);
+    current_block = -1;
+    blocks_received = 0;
+    first_block = true;
+    session_compressed = false;
+    inflate_done = false;
+    dict_offset = 0;
+    session_start_us = esp_timer_get_time();
+    return true;
+}
+
+// Space left in the block being filled, taking a free one when needed (NULL: stop receiving)
+static uint8_t *session_reserve(size_t *space)
+{
+    if (writer_failed.load(std::memory_order_relaxed))
+    {
+        return NULL;
+    }
+
+    if (current_block < 0)
+    {
+        uint8_t index;
+        if (xQueueReceive(free_blocks, &index, pdMS_TO_TICKS(OTA_BLOCK_WAIT_MS)) != pdTRUE)
+        {
+            set_error("Flash writer stalled");
+            return NULL;
+        }
+        current_block = index;
+        block_fill[index] = 0;
+    }
+
+    *space = block_size - block_fill[current_block];
+    return blocks[current_block] + block_fill[current_block];
+}
+
+static void session_hand_over(void)
+{
+    if (current_block < 0)
+    {
+        return;
+    }
+
+    uint8_t index = (uint8_t)current_block;
+    current_block = -1;
+    xQueueSend(block_fill[index] > 0 ? full_blocks : free_blocks, &index, portMAX_DELAY);
+
+    if (++blocks_received % (PROGRESS_LOG_BYTES / block_size) == 0)
+    {
+        ESP_LOGI(TAG, "Received %zu of %zu bytes (%d%%), flashed %zu",
+                 received_size.load(), total_size.load(), ota_handler_get_progress(), written_size.load());
+    }
+}
+
+static void session_commit(size_t bytes)
+{
+    block_fill[current_block] += bytes;
+    received_size.fetch_add(bytes, std::memory_order_relaxed);
+    if (block_fill[current_block] == block_size)
+    {
+        session_hand_over();
+    }
+}
+
+// Flush the last block, wait for the writer and activate the image; releases the slot
+static bool session_finish(bool received)
+{
+    if (!received)
+    {
+        writer_failed.store(true, std::memory_order_relaxed); // Skip what is still queued
+    }
+    session_hand_over();
+
+    const uint8_t end = BLOCK_END;
+    xQueueSend(full_blocks, &end, portMAX_DELAY);
+    xSemaphoreTake(writer_done, portMAX_DELAY);
+
+    bool ok = received && !writer_failed.load(std::memory_order_relaxed);
+    if (ok && session_compressed && !inflate_done)
+    {
+        set_error("Compressed image truncated");
+        ok = false;
+    }
+
+    if (!ok)
+    {
+        esp_ota_abort(ota_handle);
+    }
+    else
+    {
+        esp_err_t ret = esp_ota_end(ota_handle); // Validates the image
+        if (ret == ESP_OK)
+        {
+            ret = esp_ota_set_boot_partition(update_partition);
+        }
+        if (ret != ESP_OK)
+        {
+            char message[64];
+            snprintf(message, sizeof(message), "Image rejected (%s)", esp_err_to_name(ret));
+            set_error(message);
+            ok = false;
+        }
+    }
+    ota_handle = 0;
+    session_free_buffers();
+
+    uint32_t elapsed_ms = (uint32_t)((esp_timer_get_time() - session_start_us) / 1000);
+    if (ok)
+    {
+        ESP_LOGI(TAG, "OTA update successful! Received %zu bytes, flashed %zu in %lu ms",
+                 received_size.load(), written_size.load(), elapsed_ms);
+    }
+    session_release();
+    return ok;
+}
 
 bool ota_handler_init(void)
 {
@@ -24,17 +475,27 @@ bool ota_handler_init(void)
 
 bool ota_handler_is_active(void)
 {
-    return ota_in_progress;
+    return ota_in_progress.load();
 }
 
 int ota_handler_get_progress(void)
 {
-    if (total_size == 0)
+    size_t total = total_size.load(std::memory_order_relaxed);
+    if (total == 0)
         return 0;
-    return (written_size * 100) / total_size;
+    return (received_size.load(std::memory_order_relaxed) * 100) / total;
 }
 
-// POST /api/ota/upload - Handle OTA firmware upload
+static esp_err_t send_busy(httpd_req_t *req)
+{
+    web_server_v2_add_cors_headers(req);
+    httpd_resp_set_status(req, "409 Conflict");
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"OTA update already in progress\"}");
+    return ESP_FAIL;
+}
+
+// POST /api/ota/upload - Handle OTA firmware upload (.bin, or .bin.gz inflated while flashing)
 static esp_err_t ota_upload_handler(httpd_req_t *req)
 {
     // Check authentication first
@@ -43,103 +504,209 @@ static esp_err_t ota_upload_handler(httpd_req_t *req)
         return web_server_v2_send_auth_required(req);
     }
 
+    if (!session_claim())
+    {
+        return send_busy(req);
+    }
+
     // Add CORS headers for successful auth
     web_server_v2_add_cors_headers(req);
 
-    esp_err_t ret = ESP_OK;
-    char buf[1024];
-    int received;
-
-    ESP_LOGI(TAG, "OTA upload started");
-    ota_in_progress = true;
-    written_size = 0;
-    total_size = req->content_len;
-
-    // Get update partition
-    update_partition = esp_ota_get_next_update_partition(NULL);
-    if (!update_partition)
+    char error[64];
+    if (!session_begin("upload", req->content_len))
     {
-        ESP_LOGE(TAG, "Failed to find update partition");
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "No update partition");
-        ota_in_progress = false;
+        session_release();
+        get_error(error, sizeof(error));
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, error);
         return ESP_FAIL;
     }
 
-    ESP_LOGI(TAG, "Writing to partition subtype %d at offset 0x%lx",
-             update_partition->subtype, update_partition->address);
+    // Receive straight into the pipeline blocks
+    size_t remaining = req->content_len;
+    int timeouts = 0;
+    bool received = true;
+    while (remaining > 0)
+    {
+        size_t space;
+        uint8_t *dst = session_reserve(&space);
+        if (dst == NULL)
+        {
+            received = false;
+            break;
+        }
 
-    // Begin OTA
-    ret = esp_ota_begin(update_partition, OTA_SIZE_UNKNOWN, &ota_handle);
-    if (ret != ESP_OK)
+        int len = httpd_req_recv(req, (char *)dst, space < remaining ? space : remaining);
+        if (len == HTTPD_SOCK_ERR_TIMEOUT && ++timeouts <= OTA_RECV_TIMEOUT_RETRIES)
+        {
+            continue;
+        }
+        if (len <= 0)
+        {
+            set_error("Error receiving data");
+            received = false;
+            break;
+        }
+        timeouts = 0;
+        session_commit(len);
+        remaining -= len;
+    }
+
+    if (!session_finish(received))
     {
-        ESP_LOGE(TAG, "esp_ota_begin failed (%s)", esp_err_to_name(ret));
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "OTA begin failed");
-        ota_in_progress = false;
+        get_error(error, sizeof(error));
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, error);
         return ESP_FAIL;
     }
 
-    // Write data
-    while ((received = httpd_req_recv(req, buf, sizeof(buf))) > 0)
+    // Send success response
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, "{\"status\":\"success\",\"message\":\"OTA complete. Rebooting...\"}");
+
+    vTaskDelay(pdMS_TO_TICKS(OTA_REBOOT_DELAY_MS));
+    esp_restart();
+
+    return ESP_OK;
+}
+
+// Download the image from pull_url through the pipeline (slot claimed by the request)
+static void ota_pull_task(void *arg)
+{
+    esp_http_client_config_t config = {};
+    config.url = pull_url;
+    config.timeout_ms = OTA_PULL_TIMEOUT_MS;
+    config.crt_bundle_attach = esp_crt_bundle_attach;
+
+    bool started = false;
+    bool ok = false;
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    if (client == NULL)
     {
-        ret = esp_ota_write(ota_handle, buf, received);
-        if (ret != ESP_OK)
+        set_error("HTTP client init failed");
+    }
+    else if (esp_http_client_open(client, 0) != ESP_OK)
+    {
+        set_error("Failed to connect to update server");
+    }
+    else
+    {
+        int64_t length = esp_http_client_fetch_headers(client);
+        int status = esp_http_client_get_status_code(client);
+        if (status != 200)
         {
-            ESP_LOGE(TAG, "esp_ota_write failed (%s)", esp_err_to_name(ret));
-            esp_ota_abort(ota_handle);
-            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "OTA write failed");
-            ota_in_progress = false;
-            return ESP_FAIL;
+            char message[64];
+            snprintf(message, sizeof(message), "Update server returned %d", status);
+            set_error(message);
         }
-        written_size += received;
-
-        // Log progress
-        if (written_size % (100 * 1024) == 0)
+        else if (session_begin("pull", length > 0 ? (size_t)length : 0))
         {
-            ESP_LOGI(TAG, "Written %zu of %zu bytes (%d%%)",
-                     written_size, total_size, ota_handler_get_progress());
+            started = true;
+            bool received = true;
+            while (true)
+            {
+                size_t space;
+                uint8_t *dst = session_reserve(&space);
+                if (dst == NULL)
+                {
+                    received = false;
+                    break;
+                }
+
+                int len = esp_http_client_read(client, (char *)dst, space);
+                if (len < 0)
+                {
+                    set_error("Download failed");
+                    received = false;
+                    break;
+                }
+                if (len == 0)
+                {
+                    if (!esp_http_client_is_complete_data_received(client))
+                    {
+                        set_error("Download truncated");
+                        received = false;
+                    }
+                    break;
+                }
+                session_commit(len);
+            }
+            ok = session_finish(received);
         }
     }
 
-    if (received < 0)
+    if (client != NULL)
     {
-        ESP_LOGE(TAG, "Error receiving data");
-        esp_ota_abort(ota_handle);
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Receive error");
-        ota_in_progress = false;
-        return ESP_FAIL;
+        esp_http_client_close(client);
+        esp_http_client_cleanup(client);
+    }
+    if (!started)
+    {
+        session_release();
     }
 
-    // Finalize OTA
-    ret = esp_ota_end(ota_handle);
-    if (ret != ESP_OK)
+    if (ok)
     {
-        ESP_LOGE(TAG, "esp_ota_end failed (%s)", esp_err_to_name(ret));
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "OTA end failed");
-        ota_in_progress = false;
-        return ESP_FAIL;
+        ESP_LOGI(TAG, "Rebooting into the pulled image");
+        vTaskDelay(pdMS_TO_TICKS(OTA_REBOOT_DELAY_MS));
+        esp_restart();
     }
 
-    // Set boot partition
-    ret = esp_ota_set_boot_partition(update_partition);
-    if (ret != ESP_OK)
+    pull_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+// POST /api/ota/pull - Download and flash an image: {"url": "https://server/firmware.bin[.gz]"}
+static esp_err_t ota_pull_handler(httpd_req_t *req)
+{
+    // Check authentication first
+    if (!web_server_v2_check_auth(req))
+    {
+        return web_server_v2_send_auth_required(req);
+    }
+
+    char body[OTA_PULL_URL_MAX + 32];
+    int len = (req->content_len < sizeof(body)) ? httpd_req_recv(req, body, req->content_len) : -1;
+    if (len <= 0)
     {
-        ESP_LOGE(TAG, "esp_ota_set_boot_partition failed (%s)", esp_err_to_name(ret));
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Set boot partition failed");
-        ota_in_progress = false;
+        web_server_v2_add_cors_headers(req);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid request body");
         return ESP_FAIL;
     }
+    body[len] = '\0';
 
-    ESP_LOGI(TAG, "OTA update successful! Total: %zu bytes", written_size);
-    ota_in_progress = false;
+    cJSON *root = cJSON_Parse(body);
+    cJSON *url = root ? cJSON_GetObjectItem(root, "url") : NULL;
+    bool valid = cJSON_IsString(url) && strlen(url->valuestring) < sizeof(pull_url) &&
+                 (strncmp(url->valuestring, "http://", 7) == 0 || strncmp(url->valuestring, "https://", 8) == 0);
+    if (!valid)
+    {
+        cJSON_Delete(root);
+        web_server_v2_add_cors_headers(req);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Expected {\"url\": \"http(s)://...\"}");
+        return ESP_FAIL;
+    }
 
-    // Send success response
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, "{\"status\":\"success\",\"message\":\"OTA complete. Rebooting...\"}");
+    if (!session_claim())
+    {
+        cJSON_Delete(root);
+        return send_busy(req);
+    }
+    strcpy(pull_url, url->valuestring);
+    cJSON_Delete(root);
 
-    // Reboot after 2 seconds
-    vTaskDelay(pdMS_TO_TICKS(2000));
-    esp_restart();
+    if (xTaskCreatePinnedToCore(ota_pull_task, "ota_pull", OTA_PULL_STACK_SIZE, NULL, OTA_PULL_PRIORITY,
+                                &pull_task_handle, OTA_WRITER_CORE) != pdPASS)
+    {
+        session_release();
+        web_server_v2_add_cors_headers(req);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to start download");
+        return ESP_FAIL;
+    }
 
+    ESP_LOGI(TAG, "OTA pull from %s", pull_url);
+    web_server_v2_add_cors_headers(req);
+    httpd_resp_set_status(req, "202 Accepted");
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, "{\"status\":\"started\",\"message\":\"Downloading. Poll /api/ota/status\"}");
     return ESP_OK;
 }
 
@@ -159,8 +726,17 @@ static esp_err_t ota_status_handler(httpd_req_t *req)
     const esp_partition_t *boot = esp_ota_get_boot_partition();
     const esp_partition_t *update = esp_ota_get_next_update_partition(NULL);
 
-    cJSON_AddBoolToObject(root, "in_progress", ota_in_progress);
+    char error[64];
+    get_error(error, sizeof(error));
+
+    cJSON_AddBoolToObject(root, "in_progress", ota_in_progress.load());
     cJSON_AddNumberToObject(root, "progress", ota_handler_get_progress());
+    cJSON_AddStringToObject(root, "source", session_source);
+    cJSON_AddBoolToObject(root, "compressed", session_compressed);
+    cJSON_AddNumberToObject(root, "total_bytes", total_size.load());
+    cJSON_AddNumberToObject(root, "received_bytes", received_size.load());
+    cJSON_AddNumberToObject(root, "written_bytes", written_size.load());
+    cJSON_AddStringToObject(root, "last_error", error);
     cJSON_AddStringToObject(root, "running_partition", running->label);
     cJSON_AddStringToObject(root, "boot_partition", boot->label);
 
@@ -271,6 +847,18 @@ bool ota_handler_register_endpoints(httpd_handle_t server)
     ret = httpd_register_uri_handler(server, &ota_status_uri);
     ESP_LOGI(TAG, "Registered /api/ota/status: %s", ret == ESP_OK ? "SUCCESS" : "FAILED");
 
+    // POST /api/ota/pull
+    httpd_uri_t ota_pull_uri = {
+        .uri = "/api/ota/pull",
+        .method = HTTP_POST,
+        .handler = ota_pull_handler,
+        .user_ctx = NULL,
+        .is_websocket = false,
+        .handle_ws_control_frames = false,
+        .supported_subprotocol = NULL};
+    ret = httpd_register_uri_handler(server, &ota_pull_uri);
+    ESP_LOGI(TAG, "Registered /api/ota/pull: %s", ret == ESP_OK ? "SUCCESS" : "FAILED");
+
     // POST /api/ota/rollback
     httpd_uri_t ota_rollback_uri = {
         .uri = "/api/ota/rollback",
@@ -289,10 +877,11 @@ bool ota_handler_register_endpoints(httpd_handle_t server)
 
 void ota_handler_deinit(void)
 {
-    if (ota_in_progress && ota_handle)
+    if (ota_in_progress.load())
     {
-        esp_ota_abort(ota_handle);
-        ota_in_progress = false;
+        // The receiving side stops at its next block and aborts the update itself
+        set_error("OTA cancelled");
+        writer_failed.store(true);
     }
     ESP_LOGI(TAG, "OTA handler deinitialized");
 }
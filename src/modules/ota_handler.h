@@ -4,6 +4,20 @@
 #include <stdbool.h>
 #include "esp_http_server.h"
 
+/**
+ * Firmware updates without stalling the stream
+ *
+ * Images arrive either as an upload (POST /api/ota/upload) or are pulled
+ * from an HTTP(S) server (POST /api/ota/pull {"url": ...}). The receiving
+ * side fills PSRAM blocks while a low-priority writer task flashes them,
+ * erasing sector by sector, so flash stalls never block the socket or the
+ * audio tasks. gzip-compressed images (.bin.gz) are inflated while flashing.
+ *
+ * Without a PSRAM heap the blocks come from internal RAM, fewer and
+ * smaller (OTA_BLOCK_INTERNAL_SIZE/COUNT), and gzip images are refused: the
+ * inflate window alone would take 32 KB of internal RAM.
+ */
+
 /**
  * Initialize OTA handler
  * @return true on success
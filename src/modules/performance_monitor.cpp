@@ -3,12 +3,16 @@
 #include "tcp_streamer.h"
 #include "udp_streamer.h"
 #include "buffer_manager.h"
+#include "audio_encoder.h"
+#include "adaptive_quality.h"
 #include "network_manager.h"
 #include "config_manager.h"
+#include "rate_limiter.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "esp_wifi.h"
 #include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
@@ -21,29 +25,206 @@ static bool monitoring_enabled = true;
 static uint32_t monitoring_interval_ms = HISTORY_INTERVAL_MS;
 static uint32_t last_collection_time = 0;
 
-// Historical data storage
-static performance_metrics_t history[MAX_HISTORY_ENTRIES];
-static size_t history_head = 0;
+// Historical data storage: byte ring of delta-encoded entries (see history_encode)
+// Each entry is stored as deltas from the one before it; history_base holds the
+// values the oldest entry's deltas apply to, history_last the newest entry.
+#define HISTORY_ENTRY_MAX_BYTES 128 // Worst case encoded entry
+static uint8_t *history_store = NULL;
+static size_t history_capacity = 0;
+static size_t history_tail = 0; // Oldest entry
+static size_t history_used = 0; // Bytes
 static size_t history_count = 0;
+static performance_metrics_t history_base;
+static performance_metrics_t history_last;
 static SemaphoreHandle_t history_mutex = NULL;
 
-// Alert storage
-static performance_alert_t alerts[MAX_ALERTS];
+// Alert storage (PSRAM when present)
+static performance_alert_t *alerts = NULL;
 static size_t alert_head = 0;
 static size_t alert_count = 0;
 static SemaphoreHandle_t alert_mutex = NULL;
+static uint32_t alert_keys[MAX_ALERTS]; // Dedup key of each stored alert
+static rate_limiter_t alert_limiter;
 
 // Statistics
 static uint32_t total_drops = 0;
 static uint32_t max_buffer_usage = 0;
 static uint64_t total_buffer_usage = 0;
 static uint32_t uptime_samples = 0;
+static overflow_stats_t last_overflow_stats; // Previous collection, for change alerts
 
 // Forward declarations
 static void performance_monitor_task(void *arg);
 static void check_and_generate_alerts(const performance_metrics_t *metrics);
 static TaskHandle_t monitor_task_handle = NULL;
 
+// Prefer PSRAM and leave internal RAM to WiFi
+static void *alloc_prefer_psram(size_t size)
+{
+    void *ptr = heap_caps_calloc(1, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (ptr == NULL)
+    {
+        ptr = heap_caps_calloc(1, size, MALLOC_CAP_8BIT);
+    }
+    return ptr;
+}
+
+// ---- History encoding ----
+// Entry layout (all integers LEB128 varints, deltas zigzag-encoded):
+//   timestamp delta, flags, buffer usage, rssi, channel, then signed deltas of
+//   tcp bytes/reconnects, udp bytes/packets/lost, buffer available/free,
+//   free heap, min free heap, largest block, audio bitrate.
+// Loss rate, fragmentation and uptime are derived on decode, so no floats are stored.
+
+#define HISTORY_FLAG_TCP_CONNECTED 0x01
+#define HISTORY_FLAG_UDP_CONNECTED 0x02
+#define HISTORY_FLAG_OVERFLOW 0x04
+
+static size_t put_varint(uint8_t *out, uint64_t value)
+{
+    size_t n = 0;
+    while (value >= 0x80)
+    {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static size_t put_delta(uint8_t *out, uint64_t value, uint64_t prev)
+{
+    int64_t delta = (int64_t)(value - prev);
+    return put_varint(out, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+}
+
+static size_t history_encode(const performance_metrics_t *m, const performance_metrics_t *prev, uint8_t *out)
+{
+    size_t n = 0;
+    n += put_varint(out + n, (uint32_t)(m->timestamp_ms - prev->timestamp_ms));
+    out[n++] = (m->tcp_connected ? HISTORY_FLAG_TCP_CONNECTED : 0) |
+               (m->udp_connected ? HISTORY_FLAG_UDP_CONNECTED : 0) |
+               (m->buffer_overflow_detected ? HISTORY_FLAG_OVERFLOW : 0);
+    out[n++] = m->buffer_usage_percent;
+    out[n++] = (uint8_t)m->wifi_rssi;
+    out[n++] = m->wifi_channel;
+    n += put_delta(out + n, m->tcp_bytes_sent, prev->tcp_bytes_sent);
+    n += put_delta(out + n, m->tcp_reconnects, prev->tcp_reconnects);
+    n += put_delta(out + n, m->udp_bytes_sent, prev->udp_bytes_sent);
+    n += put_delta(out + n, m->udp_packets_sent, prev->udp_packets_sent);
+    n += put_delta(out + n, m->udp_lost_packets, prev->udp_lost_packets);
+    n += put_delta(out + n, m->buffer_available_samples, prev->buffer_available_samples);
+    n += put_delta(out + n, m->buffer_free_space_samples, prev->buffer_free_space_samples);
+    n += put_delta(out + n, m->free_heap, prev->free_heap);
+    n += put_delta(out + n, m->min_free_heap, prev->min_free_heap);
+    n += put_delta(out + n, m->largest_free_block, prev->largest_free_block);
+    n += put_delta(out + n, m->audio_data_rate_bps, prev->audio_data_rate_bps);
+    return n;
+}
+
+// Reads from the ring at *pos, wrapping at the end of the store
+static uint64_t get_varint(size_t *pos)
+{
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        uint8_t b = history_store[*pos];
+        *pos = (*pos + 1) % history_capacity;
+        value |= (uint64_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0)
+        {
+            break;
+        }
+    }
+    return value;
+}
+
+static uint64_t get_delta(size_t *pos, uint64_t prev)
+{
+    uint64_t zz = get_varint(pos);
+    return prev + ((zz >> 1) ^ (~(zz & 1) + 1));
+}
+
+static uint8_t get_byte(size_t *pos)
+{
+    uint8_t b = history_store[*pos];
+    *pos = (*pos + 1) % history_capacity;
+    return b;
+}
+
+// Decodes the entry at *pos on top of m (the previous entry) and advances *pos
+static void history_decode(size_t *pos, performance_metrics_t *m)
+{
+    m->timestamp_ms += (uint32_t)get_varint(pos);
+    uint8_t flags = get_byte(pos);
+    m->tcp_connected = (flags & HISTORY_FLAG_TCP_CONNECTED) != 0;
+    m->udp_connected = (flags & HISTORY_FLAG_UDP_CONNECTED) != 0;
+    m->buffer_overflow_detected = (flags & HISTORY_FLAG_OVERFLOW) != 0;
+    m->buffer_usage_percent = get_byte(pos);
+    m->wifi_rssi = (int8_t)get_byte(pos);
+    m->wifi_channel = get_byte(pos);
+    m->tcp_bytes_sent = get_delta(pos, m->tcp_bytes_sent);
+    m->tcp_reconnects = (uint32_t)get_delta(pos, m->tcp_reconnects);
+    m->udp_bytes_sent = get_delta(pos, m->udp_bytes_sent);
+    m->udp_packets_sent = (uint32_t)get_delta(pos, m->udp_packets_sent);
+    m->udp_lost_packets = (uint32_t)get_delta(pos, m->udp_lost_packets);
+    m->buffer_available_samples = (size_t)get_delta(pos, m->buffer_available_samples);
+    m->buffer_free_space_samples = (size_t)get_delta(pos, m->buffer_free_space_samples);
+    m->free_heap = (size_t)get_delta(pos, m->free_heap);
+    m->min_free_heap = (size_t)get_delta(pos, m->min_free_heap);
+    m->largest_free_block = (size_t)get_delta(pos, m->largest_free_block);
+    m->audio_data_rate_bps = (uint32_t)get_delta(pos, m->audio_data_rate_bps);
+
+    // Derived fields, as performance_monitor_collect_metrics() computes them
+    m->udp_packet_loss_rate = (m->udp_packets_sent > 0) ? (double)m->udp_lost_packets / m->udp_packets_sent * 100.0 : 0.0;
+    m->fragmentation_percent = (m->largest_free_block > 0 && m->free_heap > 0) ? (1.0 - (double)m->largest_free_block / m->free_heap) * 100.0 : 0.0;
+    m->uptime_sec = m->timestamp_ms / 1000;
+}
+
+static void history_reset(void)
+{
+    history_tail = 0;
+    history_used = 0;
+    history_count = 0;
+    memset(&history_base, 0, sizeof(history_base));
+    memset(&history_last, 0, sizeof(history_last));
+}
+
+// Appends an entry, dropping the oldest ones to make room (history_mutex held)
+static void history_append(const performance_metrics_t *metrics)
+{
+    uint8_t entry[HISTORY_ENTRY_MAX_BYTES];
+    size_t len = history_encode(metrics, &history_last, entry);
+
+    while (history_count > 0 && (history_count >= MAX_HISTORY_ENTRIES || history_used + len > history_capacity))
+    {
+        size_t pos = history_tail;
+        history_decode(&pos, &history_base);
+        history_used -= (pos + history_capacity - history_tail) % history_capacity;
+        history_tail = pos;
+        history_count--;
+    }
+    if (history_count == 0)
+    {
+        history_tail = 0;
+        history_used = 0;
+        memset(&history_base, 0, sizeof(history_base));
+        len = history_encode(metrics, &history_base, entry);
+    }
+
+    size_t head = (history_tail + history_used) % history_capacity;
+    size_t first = history_capacity - head;
+    if (first > len)
+    {
+        first = len;
+    }
+    memcpy(history_store + head, entry, first);
+    memcpy(history_store, entry + first, len - first);
+    history_used += len;
+    history_count++;
+    history_last = *metrics;
+}
+
 bool performance_monitor_init(void)
 {
     ESP_LOGI(TAG, "Initializing performance monitoring system");
@@ -65,15 +246,28 @@ bool performance_monitor_init(void)
     }
 
     // Initialize storage
-    memset(history, 0, sizeof(history));
-    memset(alerts, 0, sizeof(alerts));
-    history_head = 0;
-    history_count = 0;
+    history_store = (uint8_t *)alloc_prefer_psram(HISTORY_STORE_BYTES);
+    alerts = (performance_alert_t *)alloc_prefer_psram(MAX_ALERTS * sizeof(performance_alert_t));
+    if (history_store == NULL || alerts == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to allocate history storage");
+        heap_caps_free(history_store);
+        heap_caps_free(alerts);
+        history_store = NULL;
+        alerts = NULL;
+        vSemaphoreDelete(history_mutex);
+        vSemaphoreDelete(alert_mutex);
+        return false;
+    }
+    history_capacity = HISTORY_STORE_BYTES;
+    history_reset();
     alert_head = 0;
     alert_count = 0;
+    rate_limiter_init(&alert_limiter, ALERT_RATE_LIMIT_BURST, ALERT_RATE_LIMIT_REFILL_MS);
 
     // Reset statistics
     total_drops = 0;
+    memset(&last_overflow_stats, 0, sizeof(last_overflow_stats));
     max_buffer_usage = 0;
     total_buffer_usage = 0;
     uptime_samples = 0;
@@ -96,7 +290,8 @@ bool performance_monitor_init(void)
         return false;
     }
 
-    ESP_LOGI(TAG, "Performance monitoring initialized");
+    ESP_LOGI(TAG, "Performance monitoring initialized (history %d bytes in %s)", HISTORY_STORE_BYTES,
+             esp_ptr_external_ram(history_store) ? "PSRAM" : "internal RAM");
     return true;
 }
 
@@ -116,12 +311,21 @@ void performance_monitor_deinit(void)
         history_mutex = NULL;
     }
 
+    heap_caps_free(history_store);
+    history_store = NULL;
+    history_capacity = 0;
+    history_reset();
+
     if (alert_mutex != NULL)
     {
         vSemaphoreDelete(alert_mutex);
         alert_mutex = NULL;
     }
 
+    heap_caps_free(alerts);
+    alerts = NULL;
+    alert_count = 0;
+
     ESP_LOGI(TAG, "Performance monitoring deinitialized");
 }
 
@@ -198,17 +402,16 @@ performance_metrics_t performance_monitor_collect_metrics(void)
         }
     }
 
-    // Audio metrics (fixed 16kHz 16-bit mono)
-    // Note: audio_data_rate_bps field name implies bits per second, so we multiply by 8 for bits
-    metrics.audio_data_rate_bps = SAMPLE_RATE * CHANNELS * BITS_PER_SAMPLE;
+    // Audio metrics (running format and codec, bits per second on the wire)
+    metrics.audio_data_rate_bps = audio_encoder_get_bitrate();
 
     return metrics;
 }
 
-size_t performance_monitor_get_history(uint32_t start_timestamp_ms, uint32_t end_timestamp_ms,
-                                       performance_metrics_t *metrics, size_t max_entries)
+size_t performance_monitor_foreach_history(uint32_t start_timestamp_ms, uint32_t end_timestamp_ms,
+                                           performance_history_cb_t callback, void *ctx)
 {
-    if (!metrics || max_entries == 0)
+    if (!callback || history_mutex == NULL)
     {
         return 0;
     }
@@ -219,28 +422,30 @@ size_t performance_monitor_get_history(uint32_t start_timestamp_ms, uint32_t end
         return 0;
     }
 
-    size_t count = 0;
-    uint32_t now = esp_timer_get_time() / 1000;
-
     if (end_timestamp_ms == 0)
     {
-        end_timestamp_ms = now;
+        end_timestamp_ms = esp_timer_get_time() / 1000;
     }
 
-    // Search history for entries in the time range
-    for (size_t i = 0; i < history_count && count < max_entries; i++)
-    {
-        size_t index = (history_head - 1 - i + MAX_HISTORY_ENTRIES) % MAX_HISTORY_ENTRIES;
-        const performance_metrics_t *entry = &history[index];
+    size_t count = 0;
+    size_t pos = history_tail;
+    performance_metrics_t entry = history_base;
 
-        if (entry->timestamp_ms >= start_timestamp_ms && entry->timestamp_ms <= end_timestamp_ms)
+    // History is ordered oldest first, so stop at the first entry past the range
+    for (size_t i = 0; i < history_count; i++)
+    {
+        history_decode(&pos, &entry);
+        if (entry.timestamp_ms > end_timestamp_ms)
         {
-            metrics[count] = *entry;
-            count++;
+            break;
         }
-        else if (entry->timestamp_ms < start_timestamp_ms)
+        if (entry.timestamp_ms >= start_timestamp_ms)
         {
-            break; // History is ordered, we can stop
+            count++;
+            if (!callback(&entry, ctx))
+            {
+                break;
+            }
         }
     }
 
@@ -248,6 +453,82 @@ size_t performance_monitor_get_history(uint32_t start_timestamp_ms, uint32_t end
     return count;
 }
 
+typedef struct
+{
+    performance_metrics_t *metrics;
+    size_t max_entries;
+    size_t skip; // Older entries in range that do not fit
+    size_t seen;
+} history_copy_ctx_t;
+
+static bool history_count_cb(const performance_metrics_t *metrics, void *ctx)
+{
+    (void)metrics;
+    (void)ctx;
+    return true;
+}
+
+static bool history_copy_cb(const performance_metrics_t *metrics, void *ctx)
+{
+    history_copy_ctx_t *copy = (history_copy_ctx_t *)ctx;
+    if (copy->seen >= copy->skip)
+    {
+        // Most recent first, as the array-backed history returned them
+        size_t slot = copy->max_entries - 1 - (copy->seen - copy->skip);
+        copy->metrics[slot] = *metrics;
+    }
+    copy->seen++;
+    return copy->seen < copy->skip + copy->max_entries;
+}
+
+size_t performance_monitor_get_history(uint32_t start_timestamp_ms, uint32_t end_timestamp_ms,
+                                       performance_metrics_t *metrics, size_t max_entries)
+{
+    if (!metrics || max_entries == 0)
+    {
+        return 0;
+    }
+
+    if (end_timestamp_ms == 0)
+    {
+        end_timestamp_ms = esp_timer_get_time() / 1000;
+    }
+
+    size_t in_range = performance_monitor_foreach_history(start_timestamp_ms, end_timestamp_ms,
+                                                          history_count_cb, NULL);
+    size_t count = in_range < max_entries ? in_range : max_entries;
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    history_copy_ctx_t copy = {metrics, count, in_range - count, 0};
+    performance_monitor_foreach_history(start_timestamp_ms, end_timestamp_ms, history_copy_cb, &copy);
+    size_t copied = copy.seen > copy.skip ? copy.seen - copy.skip : 0;
+    if (copied < count)
+    {
+        // Entries aged out between the two passes; close the gap at the front
+        memmove(metrics, metrics + (count - copied), copied * sizeof(performance_metrics_t));
+        count = copied;
+    }
+    return count;
+}
+
+void performance_monitor_get_history_usage(size_t *entries, size_t *bytes_used, size_t *bytes_capacity)
+{
+    if (history_mutex == NULL || xSemaphoreTake(history_mutex, pdMS_TO_TICKS(1000)) != pdTRUE)
+    {
+        return;
+    }
+    if (entries)
+        *entries = history_count;
+    if (bytes_used)
+        *bytes_used = history_used;
+    if (bytes_capacity)
+        *bytes_capacity = history_capacity;
+    xSemaphoreGive(history_mutex);
+}
+
 bool performance_monitor_get_latest(performance_metrics_t *metrics)
 {
     if (!metrics)
@@ -264,8 +545,7 @@ bool performance_monitor_get_latest(performance_metrics_t *metrics)
     bool result = false;
     if (history_count > 0)
     {
-        size_t latest_index = (history_head - 1 + MAX_HISTORY_ENTRIES) % MAX_HISTORY_ENTRIES;
-        *metrics = history[latest_index];
+        *metrics = history_last;
         result = true;
     }
 
@@ -280,20 +560,43 @@ void performance_monitor_add_alert(alert_level_t level, const char *category, co
         return;
     }
 
+    uint32_t now_ms = esp_timer_get_time() / 1000;
+    uint32_t key = rate_limiter_hash(message, rate_limiter_hash(category, (uint32_t)level + 1));
+    bool allowed = rate_limiter_allow(&alert_limiter, key, NULL, now_ms, NULL);
+
     if (xSemaphoreTake(alert_mutex, pdMS_TO_TICKS(100)) != pdTRUE)
     {
         ESP_LOGW(TAG, "Failed to acquire alert mutex");
         return;
     }
 
+    if (!allowed)
+    {
+        // Fold into the newest matching alert; if it was evicted, store this one again
+        for (size_t i = 0; i < alert_count; i++)
+        {
+            size_t index = (alert_head - 1 - i + MAX_ALERTS) % MAX_ALERTS;
+            if (alert_keys[index] == key)
+            {
+                alerts[index].repeat_count++;
+                alerts[index].last_timestamp_ms = now_ms;
+                xSemaphoreGive(alert_mutex);
+                return;
+            }
+        }
+    }
+
     // Add new alert
     performance_alert_t *alert = &alerts[alert_head];
-    alert->timestamp_ms = esp_timer_get_time() / 1000;
+    alert->timestamp_ms = now_ms;
+    alert->last_timestamp_ms = now_ms;
+    alert->repeat_count = 0;
     alert->level = level;
     strncpy(alert->category, category, sizeof(alert->category) - 1);
     strncpy(alert->message, message, sizeof(alert->message) - 1);
     alert->category[sizeof(alert->category) - 1] = '\0';
     alert->message[sizeof(alert->message) - 1] = '\0';
+    alert_keys[alert_head] = key;
 
     // Update head and count
     alert_head = (alert_head + 1) % MAX_ALERTS;
@@ -367,7 +670,8 @@ void performance_monitor_clear_alerts(void)
 
     alert_head = 0;
     alert_count = 0;
-    memset(alerts, 0, sizeof(alerts));
+    memset(alerts, 0, MAX_ALERTS * sizeof(performance_alert_t));
+    memset(alert_keys, 0, sizeof(alert_keys));
 
     xSemaphoreGive(alert_mutex);
     ESP_LOGI(TAG, "Alerts cleared");
@@ -394,6 +698,21 @@ void performance_monitor_get_summary(uint32_t duration_min,
     }
 }
 
+void performance_monitor_get_overflow_stats(overflow_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    stats->policy = buffer_manager_get_overflow_policy();
+    buffer_manager_get_drop_stats(&stats->dropped_oldest_samples, &stats->dropped_newest_samples,
+                                  &stats->overflow_events);
+    adaptive_quality_status_t quality;
+    adaptive_quality_get_status(&quality);
+    stats->degrade_events = quality.codec_degrades;
+}
+
 void performance_monitor_set_enabled(bool enabled)
 {
     monitoring_enabled = enabled;
@@ -435,12 +754,7 @@ static void performance_monitor_task(void *arg)
                 // Store in history
                 if (xSemaphoreTake(history_mutex, pdMS_TO_TICKS(100)) == pdTRUE)
                 {
-                    history[history_head] = metrics;
-                    history_head = (history_head + 1) % MAX_HISTORY_ENTRIES;
-                    if (history_count < MAX_HISTORY_ENTRIES)
-                    {
-                        history_count++;
-                    }
+                    history_append(&metrics);
 
                     // Update statistics
                     total_buffer_usage += metrics.buffer_usage_percent;
@@ -471,10 +785,24 @@ static void performance_monitor_task(void *arg)
 
 static void check_and_generate_alerts(const performance_metrics_t *metrics)
 {
-    // Buffer overflow alert
+    // Buffer overflow alert, with what the overflow policy discarded since the last check
     if (metrics->buffer_overflow_detected)
     {
-        performance_monitor_add_alert(ALERT_LEVEL_WARNING, "buffer", "Buffer overflow detected");
+        overflow_stats_t stats;
+        performance_monitor_get_overflow_stats(&stats);
+        char message[128];
+        snprintf(message, sizeof(message), "Buffer overflow: dropped %llu oldest, %llu newest samples",
+                 stats.dropped_oldest_samples - last_overflow_stats.dropped_oldest_samples,
+                 stats.dropped_newest_samples - last_overflow_stats.dropped_newest_samples);
+        performance_monitor_add_alert(ALERT_LEVEL_WARNING, "buffer", message);
+
+        if (stats.degrade_events != last_overflow_stats.degrade_events)
+        {
+            snprintf(message, sizeof(message), "Sustained overflow: codec degraded to %s",
+                     audio_encoder_codec_name(audio_encoder_get_codec()));
+            performance_monitor_add_alert(ALERT_LEVEL_WARNING, "buffer", message);
+        }
+        last_overflow_stats = stats;
     }
 
     // High buffer usage alert
@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include "../config.h"
 
 // Performance metrics structure
 typedef struct {
@@ -38,6 +39,15 @@ typedef struct {
     uint32_t audio_data_rate_bps;
 } performance_metrics_t;
 
+// Ring overflow policy counters (since boot, not kept in history)
+typedef struct {
+    overflow_policy_t policy;
+    uint32_t overflow_events;        // Writes that found the ring full
+    uint64_t dropped_oldest_samples; // Buffered audio shed to let fresh audio in
+    uint64_t dropped_newest_samples; // Incoming audio that did not fit
+    uint32_t degrade_events;         // Codec step-downs under sustained overflow
+} overflow_stats_t;
+
 // Alert levels
 typedef enum {
     ALERT_LEVEL_INFO = 0,
@@ -52,11 +62,16 @@ typedef struct {
     alert_level_t level;
     char message[128];
     char category[32];
+    uint32_t repeat_count;      // Identical alerts folded into this one (rate limited)
+    uint32_t last_timestamp_ms; // Newest of them
 } performance_alert_t;
 
 // Historical data configuration
+// History is a delta-encoded byte log (varint counter deltas, no floats), in
+// PSRAM when present; a typical entry takes ~20 bytes instead of ~100.
 #define MAX_HISTORY_ENTRIES 720  // 2 hours of data at 10-second intervals
 #define HISTORY_INTERVAL_MS 10000 // Collect data every 10 seconds
+#define HISTORY_STORE_BYTES (24 * 1024) // Oldest entries are dropped when full
 // MAX_ALERTS is defined in config.h to avoid redefinition
 
 /**
@@ -74,17 +89,46 @@ void performance_monitor_deinit(void);
  */
 performance_metrics_t performance_monitor_collect_metrics(void);
 
+/**
+ * Called for each decoded history entry, oldest first
+ * @return false to stop the walk
+ */
+typedef bool (*performance_history_cb_t)(const performance_metrics_t *metrics, void *ctx);
+
+/**
+ * Stream historical performance data without copying it out
+ *
+ * Entries are decoded one at a time while the history lock is held, so the
+ * callback should not block for long.
+ *
+ * @param start_timestamp_ms Start time (0 for beginning)
+ * @param end_timestamp_ms End time (0 for now)
+ * @param callback Called for each entry in the range
+ * @param ctx Passed to callback
+ * @return Number of entries passed to callback
+ */
+size_t performance_monitor_foreach_history(uint32_t start_timestamp_ms, uint32_t end_timestamp_ms,
+                                           performance_history_cb_t callback, void *ctx);
+
 /**
  * Get historical performance data
  * @param start_timestamp_ms Start time (0 for beginning)
  * @param end_timestamp_ms End time (0 for now)
- * @param metrics Output array for metrics
+ * @param metrics Output array for metrics (most recent first)
  * @param max_entries Maximum number of entries to return
  * @return Number of entries returned
  */
 size_t performance_monitor_get_history(uint32_t start_timestamp_ms, uint32_t end_timestamp_ms,
                                       performance_metrics_t *metrics, size_t max_entries);
 
+/**
+ * Get history storage usage
+ * @param entries Entries held (may be NULL)
+ * @param bytes_used Encoded bytes held (may be NULL)
+ * @param bytes_capacity Store size (may be NULL)
+ */
+void performance_monitor_get_history_usage(size_t *entries, size_t *bytes_used, size_t *bytes_capacity);
+
 /**
  * Get latest performance metrics
  */
@@ -92,6 +136,10 @@ bool performance_monitor_get_latest(performance_metrics_t *metrics);
 
 /**
  * Add an alert
+ *
+ * Rate limited per level, category and message (digits ignored): a repeat
+ * within ALERT_RATE_LIMIT_REFILL_MS is folded into the previous alert's
+ * repeat_count instead of taking a new slot or a log line.
  */
 void performance_monitor_add_alert(alert_level_t level, const char *category, const char *message);
 
@@ -119,6 +167,11 @@ void performance_monitor_get_summary(uint32_t duration_min,
                                    uint32_t *total_drops,
                                    uint32_t *uptime_percent);
 
+/**
+ * Get ring overflow policy counters
+ */
+void performance_monitor_get_overflow_stats(overflow_stats_t *stats);
+
 /**
  * Enable/disable automatic monitoring
  */
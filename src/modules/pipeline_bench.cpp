@@ -0,0 +1,386 @@
+#include "pipeline_bench.h"
+#include "buffer_manager.h"
+#include "audio_convert.h"
+#include "i2s_handler.h"
+#include "tcp_streamer.h"
+#include "udp_streamer.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+
+static const char *TAG = "PIPELINE_BENCH";
+
+#define SINE_PERIOD 64          // Synthetic tone: 250 Hz at 16 kHz
+#define WAIT_SLICE_MS 20        // Sender wait per attempt (the producer wakes it)
+
+#ifdef PIPELINE_BENCH_HOST
+// memcpy() is counted by the host shim (bench/host/shim/bench_copy.h)
+#define COPY_BYTES() ((int64_t)bench_host_copy_bytes())
+#else
+#define COPY_BYTES() ((int64_t)-1)
+#endif
+
+typedef struct
+{
+    const pipeline_bench_params_t *params;
+    int32_t *slots;         // One capture block of I2S slots
+    size_t sample_bytes;    // Ring format
+    size_t channels;
+    uint64_t produced;      // Samples generated (written or dropped)
+    size_t trace_pos;
+    uint32_t lfsr;
+} bench_source_t;
+
+// Paced run state shared with the capture task
+static std::atomic<bool> capture_running(false);
+static std::atomic<bool> capture_done(false);
+static int64_t capture_start_us = 0;
+
+static void fill_slots(bench_source_t *src, size_t samples)
+{
+    const pipeline_bench_params_t *p = src->params;
+    for (size_t i = 0; i < samples; i++)
+    {
+        if (p->trace != NULL && p->trace_samples > 0)
+        {
+            src->slots[i] = p->trace[src->trace_pos];
+            src->trace_pos = (src->trace_pos + 1) % p->trace_samples;
+            continue;
+        }
+
+        // Tone at -6 dBFS plus low-level noise, 24-bit data in the top of the slot
+        static const int16_t quarter[SINE_PERIOD / 4 + 1] = {
+            0, 3212, 6393, 9512, 12539, 15446, 18204, 20787, 23170,
+            25329, 27245, 28898, 30273, 31356, 32137, 32609, 32767};
+        size_t phase = (size_t)((src->produced + i) / src->channels) % SINE_PERIOD;
+        size_t q = phase % (SINE_PERIOD / 2);
+        int32_t sine = quarter[q <= SINE_PERIOD / 4 ? q : SINE_PERIOD / 2 - q];
+        if (phase >= SINE_PERIOD / 2)
+        {
+            sine = -sine;
+        }
+        src->lfsr = src->lfsr * 1664525u + 1013904223u;
+        int32_t noise = (int32_t)(src->lfsr >> 20) - 2048;
+        src->slots[i] = (int32_t)(((sine * 128) + noise) * 256) & ~0xFF;
+    }
+}
+
+static void convert_into(const int32_t *in, uint8_t *out, size_t samples, size_t sample_bytes)
+{
+    if (sample_bytes == 2)
+    {
+        audio_convert_to_16(in, (int16_t *)out, samples);
+    }
+    else if (sample_bytes == 3)
+    {
+        audio_convert_to_24(in, out, samples);
+    }
+    else
+    {
+        audio_convert_to_32(in, out, samples);
+    }
+}
+
+// One capture block into reserved ring space, as the I2S reader does it
+static void capture_block(bench_source_t *src, size_t samples, int64_t capture_us)
+{
+    fill_slots(src, samples);
+    src->produced += samples;
+
+    buffer_span_t span;
+    size_t written = buffer_manager_reserve_write(samples, &span);
+    if (written == 0)
+    {
+        return;
+    }
+    convert_into(src->slots, span.data[0], span.samples[0], src->sample_bytes);
+    if (span.samples[1] > 0)
+    {
+        convert_into(src->slots + span.samples[0], span.data[1], span.samples[1], src->sample_bytes);
+    }
+    buffer_manager_commit_write_at(written, capture_us);
+}
+
+static bool send_span(uint8_t protocol, const buffer_span_t *span)
+{
+    return protocol == PIPELINE_BENCH_UDP ? udp_streamer_send_span(span) : tcp_streamer_send_span(span);
+}
+
+static bool streamer_connected(uint8_t protocol)
+{
+    return protocol == PIPELINE_BENCH_UDP ? udp_streamer_is_connected() : tcp_streamer_is_connected();
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint64_t ring_dropped(uint32_t *events)
+{
+    uint64_t oldest = 0, newest = 0;
+    buffer_manager_get_drop_stats(&oldest, &newest, events);
+    return oldest + newest;
+}
+
+// Produces blocks at the capture rate, stamped with their ideal capture time
+static void capture_task(void *arg)
+{
+    bench_source_t *src = (bench_source_t *)arg;
+    const uint64_t total = (uint64_t)src->params->sample_rate * src->channels * src->params->duration_ms / 1000;
+    const size_t block = I2S_READ_SAMPLES * src->channels;
+    const uint64_t rate = (uint64_t)src->params->sample_rate * src->channels;
+
+    while (capture_running.load() && src->produced < total)
+    {
+        // Whole blocks due by now: DMA hands them over in bursts too
+        uint64_t due = (uint64_t)(esp_timer_get_time() - capture_start_us) * rate / 1000000;
+        while (src->produced + block <= due && src->produced < total)
+        {
+            int64_t capture_us = capture_start_us + (int64_t)(src->produced * 1000000 / rate);
+            capture_block(src, block, capture_us);
+        }
+        vTaskDelay(1);
+    }
+
+    capture_done.store(true);
+    vTaskDelete(NULL);
+}
+
+static void run_unpaced(bench_source_t *src, pipeline_bench_report_t *report)
+{
+    const pipeline_bench_params_t *p = src->params;
+    const size_t block = I2S_READ_SAMPLES * src->channels;
+    uint64_t sent = 0;
+
+    int64_t start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < p->throughput_blocks; i++)
+    {
+        capture_block(src, block, esp_timer_get_time());
+        while (buffer_manager_available() >= p->send_samples)
+        {
+            buffer_span_t span;
+            size_t samples = buffer_manager_peek_read(p->send_samples, &span);
+            send_span(p->protocol, &span);
+            buffer_manager_consume_read(samples);
+            sent += samples;
+        }
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+    report->throughput_sps = elapsed_us > 0 ? (uint32_t)(sent * 1000000 / (uint64_t)elapsed_us) : 0;
+    uint64_t capture_sps = (uint64_t)p->sample_rate * src->channels;
+    report->realtime_factor_x10 = capture_sps > 0 ? (uint32_t)(report->throughput_sps * 10ULL / capture_sps) : 0;
+    buffer_manager_reset();
+}
+
+static bool run_paced(bench_source_t *src, pipeline_bench_report_t *report)
+{
+    const pipeline_bench_params_t *p = src->params;
+    const size_t max_blocks = PIPELINE_BENCH_MAX_BLOCKS;
+    uint32_t *latencies = (uint32_t *)heap_caps_malloc(max_blocks * sizeof(uint32_t), MALLOC_CAP_SPIRAM);
+    if (latencies == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to allocate latency log");
+        return false;
+    }
+
+    uint32_t events_before = 0;
+    uint64_t dropped_before = ring_dropped(&events_before);
+    int64_t copies_before = COPY_BYTES();
+    uint64_t latency_sum = 0;
+
+    src->produced = 0;
+    capture_done.store(false);
+    capture_running.store(true);
+    capture_start_us = esp_timer_get_time();
+    int64_t next_stall_us = capture_start_us + (int64_t)p->stall_every_ms * 1000;
+    if (xTaskCreatePinnedToCore(capture_task, "bench_capture", PIPELINE_BENCH_STACK_SIZE, src,
+                                I2S_READER_PRIORITY, NULL, I2S_READER_CORE) != pdPASS)
+    {
+        capture_running.store(false);
+        heap_caps_free(latencies);
+        ESP_LOGE(TAG, "Failed to start capture task");
+        return false;
+    }
+
+    while (true)
+    {
+        bool finished = capture_done.load();
+        size_t available = buffer_manager_wait_available(p->send_samples, WAIT_SLICE_MS);
+        uint8_t usage = buffer_manager_usage_percent();
+        if (usage > report->peak_usage_percent)
+        {
+            report->peak_usage_percent = usage;
+        }
+        if (available < p->send_samples && !(finished && available > 0))
+        {
+            if (finished)
+            {
+                break;
+            }
+            continue;
+        }
+
+        // A blocked send() holds the sender just like this
+        if (p->stall_every_ms > 0 && esp_timer_get_time() >= next_stall_us)
+        {
+            vTaskDelay(pdMS_TO_TICKS(p->stall_ms));
+            next_stall_us += (int64_t)p->stall_every_ms * 1000;
+            report->stalls++;
+        }
+
+        buffer_span_t span;
+        size_t samples = buffer_manager_peek_read(p->send_samples, &span);
+        if (samples == 0)
+        {
+            continue;
+        }
+        bool ok = send_span(p->protocol, &span);
+        int64_t done_us = esp_timer_get_time();
+
+        // Refused TCP blocks stay in the ring until it is nearly full, as in the sender
+        if (!ok && p->protocol == PIPELINE_BENCH_TCP && tcp_streamer_is_connected() &&
+            buffer_manager_usage_percent() < TCP_BACKPRESSURE_DROP_PERCENT)
+        {
+            buffer_manager_consume_read(0);
+            continue;
+        }
+        buffer_manager_consume_read(samples);
+
+        if (!ok)
+        {
+            report->send_failures++;
+            report->dropped_samples += samples;
+            if (!streamer_connected(p->protocol))
+            {
+                p->protocol == PIPELINE_BENCH_UDP ? udp_streamer_reconnect() : tcp_streamer_reconnect();
+            }
+            continue;
+        }
+
+        uint32_t latency = (uint32_t)(done_us - span.capture_us);
+        if (report->blocks < max_blocks)
+        {
+            latencies[report->blocks] = latency;
+        }
+        latency_sum += latency;
+        report->blocks++;
+        report->sent_samples += samples;
+        report->payload_bytes += samples * span.sample_bytes;
+    }
+
+    capture_running.store(false);
+    report->captured_samples = src->produced;
+
+    uint32_t events_after = 0;
+    report->dropped_samples += ring_dropped(&events_after) - dropped_before;
+    report->drop_events = events_after - events_before;
+    int64_t copies_after = COPY_BYTES();
+    report->copy_bytes = copies_after >= 0 ? copies_after - copies_before : -1;
+
+    size_t logged = report->blocks < max_blocks ? report->blocks : max_blocks;
+    if (logged > 0)
+    {
+        qsort(latencies, logged, sizeof(uint32_t), compare_u32);
+        report->latency_min_us = latencies[0];
+        report->latency_p50_us = latencies[logged / 2];
+        report->latency_p99_us = latencies[(logged * 99) / 100];
+        report->latency_max_us = latencies[logged - 1];
+        report->latency_avg_us = (uint32_t)(latency_sum / report->blocks);
+    }
+    heap_caps_free(latencies);
+    buffer_manager_reset();
+    return true;
+}
+
+void pipeline_bench_default_params(pipeline_bench_params_t *params)
+{
+    if (params == NULL)
+    {
+        return;
+    }
+
+    i2s_audio_format_t format;
+    i2s_handler_get_format(&format);
+
+    memset(params, 0, sizeof(*params));
+    params->protocol = STREAMING_PROTOCOL == STREAMING_PROTOCOL_UDP ? PIPELINE_BENCH_UDP : PIPELINE_BENCH_TCP;
+    params->sample_rate = format.sample_rate;
+    params->send_samples = TCP_SEND_SAMPLES;
+    params->throughput_blocks = PIPELINE_BENCH_THROUGHPUT_BLOCKS;
+    params->duration_ms = PIPELINE_BENCH_DURATION_MS;
+    params->stall_ms = PIPELINE_BENCH_STALL_MS;
+    params->stall_every_ms = PIPELINE_BENCH_STALL_EVERY_MS;
+}
+
+bool pipeline_bench_run(const pipeline_bench_params_t *params, pipeline_bench_report_t *report)
+{
+    if (params == NULL || report == NULL || params->sample_rate == 0 || params->send_samples == 0)
+    {
+        return false;
+    }
+    memset(report, 0, sizeof(*report));
+
+    if (!streamer_connected(params->protocol))
+    {
+        ESP_LOGE(TAG, "%s streamer not connected", params->protocol == PIPELINE_BENCH_UDP ? "UDP" : "TCP");
+        return false;
+    }
+
+    i2s_audio_format_t format;
+    i2s_handler_get_format(&format);
+    bench_source_t src;
+    memset(&src, 0, sizeof(src));
+    src.params = params;
+    src.sample_bytes = buffer_manager_get_sample_bytes();
+    src.channels = format.channels > 0 ? format.channels : 1;
+    src.lfsr = 0xACE1u;
+    src.slots = (int32_t *)heap_caps_malloc(I2S_READ_SAMPLES * src.channels * sizeof(int32_t), MALLOC_CAP_SPIRAM);
+    if (src.slots == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to allocate capture block");
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Benchmark: %s, %lu Hz x%zu, %zu-byte samples, %zu per send, %s trace",
+             params->protocol == PIPELINE_BENCH_UDP ? "UDP" : "TCP", params->sample_rate, src.channels,
+             src.sample_bytes, params->send_samples, params->trace ? "recorded" : "synthetic");
+
+    buffer_manager_reset();
+    run_unpaced(&src, report);
+    bool ok = run_paced(&src, report);
+
+    heap_caps_free(src.slots);
+    return ok;
+}
+
+void pipeline_bench_log_report(const pipeline_bench_params_t *params, const pipeline_bench_report_t *report)
+{
+    ESP_LOGI(TAG, "Throughput: %lu samples/s unpaced (%lu.%lux real time)",
+             report->throughput_sps, report->realtime_factor_x10 / 10, report->realtime_factor_x10 % 10);
+    ESP_LOGI(TAG, "Paced %lu ms, stall %lu ms every %lu ms (%lu injected)",
+             params->duration_ms, params->stall_ms, params->stall_every_ms, report->stalls);
+    ESP_LOGI(TAG, "  Samples: %llu captured, %llu sent, %llu dropped (%lu ring overflows, %lu refused sends)",
+             report->captured_samples, report->sent_samples, report->dropped_samples, report->drop_events,
+             report->send_failures);
+    ESP_LOGI(TAG, "  Latency per block (%lu): min %lu  avg %lu  p50 %lu  p99 %lu  max %lu us",
+             report->blocks, report->latency_min_us, report->latency_avg_us, report->latency_p50_us,
+             report->latency_p99_us, report->latency_max_us);
+    if (report->copy_bytes >= 0 && report->payload_bytes > 0)
+    {
+        uint32_t centi = (uint32_t)((uint64_t)report->copy_bytes * 100 / report->payload_bytes);
+        ESP_LOGI(TAG, "  Ring peak %u%%, copies %lu.%02lu memcpy bytes per payload byte",
+                 report->peak_usage_percent, centi / 100, centi % 100);
+    }
+    else
+    {
+        ESP_LOGI(TAG, "  Ring peak %u%%, copies not counted on target", report->peak_usage_percent);
+    }
+}
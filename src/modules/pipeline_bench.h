@@ -0,0 +1,88 @@
+#ifndef PIPELINE_BENCH_H
+#define PIPELINE_BENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../config.h"
+
+/**
+ * Audio pipeline benchmark and replay harness
+ *
+ * Drives the production path (conversion kernel into reserved ring space,
+ * buffer_manager, the TCP or UDP span packetizer) with a synthetic or
+ * recorded I2S slot trace, the same way on the S3 (bench env in
+ * platformio.ini) and on a Linux host (bench/host, native_bench env):
+ *   1. Unpaced: capture and send alternate in one task as fast as they
+ *      go, giving end-to-end throughput.
+ *   2. Paced: a capture task produces blocks at the sample rate while the
+ *      calling task sends; injected stalls block the sender the way a
+ *      stuck send() does, so ring fill, drops and latency can be compared.
+ * Latency is taken per block from its capture time to the return of the
+ * send call.
+ */
+
+#define PIPELINE_BENCH_TCP 0
+#define PIPELINE_BENCH_UDP 1
+
+typedef struct
+{
+    uint8_t protocol;           // PIPELINE_BENCH_TCP or PIPELINE_BENCH_UDP (streamer initialized, server set)
+    uint32_t sample_rate;       // Capture rate of the paced run, Hz
+    size_t send_samples;        // Samples per send, as the network sender uses
+    uint32_t throughput_blocks; // Capture blocks pushed through the unpaced run
+    uint32_t duration_ms;       // Length of the paced run
+    uint32_t stall_ms;          // Sender blocked this long...
+    uint32_t stall_every_ms;    // ...this often (0 = no stalls)
+    const int32_t *trace;       // Recorded I2S slots, replayed in a loop (NULL = synthetic)
+    size_t trace_samples;
+} pipeline_bench_params_t;
+
+typedef struct
+{
+    // Unpaced run
+    uint32_t throughput_sps;     // Samples per second through convert + ring + send
+    uint32_t realtime_factor_x10; // Throughput over the capture rate, x10
+
+    // Paced run
+    uint64_t captured_samples;
+    uint64_t sent_samples;
+    uint64_t dropped_samples;    // Shed by the ring (overflow policy) or refused by the streamer
+    uint32_t drop_events;
+    uint32_t send_failures;      // Blocks the streamer did not take
+    uint32_t stalls;             // Injected
+    uint32_t blocks;             // Sent
+    uint32_t latency_min_us;
+    uint32_t latency_avg_us;
+    uint32_t latency_p50_us;
+    uint32_t latency_p99_us;
+    uint32_t latency_max_us;
+    uint8_t peak_usage_percent;  // Ring fill
+    uint64_t payload_bytes;      // Ring bytes handed to the streamer
+    int64_t copy_bytes;          // memcpy() bytes during the run (-1 = not counted, on target)
+} pipeline_bench_report_t;
+
+/**
+ * Get defaults: configured protocol, capture rate and send size, PIPELINE_BENCH_* timing
+ * @param params Output
+ */
+void pipeline_bench_default_params(pipeline_bench_params_t *params);
+
+/**
+ * Run both phases
+ *
+ * The ring must be initialized and idle (no reader or sender task); its
+ * contents are discarded before and after.
+ *
+ * @param params Run parameters
+ * @param report Output
+ * @return false if buffers could not be allocated or the streamer is not connected
+ */
+bool pipeline_bench_run(const pipeline_bench_params_t *params, pipeline_bench_report_t *report);
+
+/**
+ * Log a report
+ */
+void pipeline_bench_log_report(const pipeline_bench_params_t *params, const pipeline_bench_report_t *report);
+
+#endif // PIPELINE_BENCH_H
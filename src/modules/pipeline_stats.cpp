@@ -0,0 +1,230 @@
+#include "pipeline_stats.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+#include <atomic>
+
+static const char *TAG = "PIPE_STATS";
+
+// Log-linear buckets: 0-3 exact, then 4 per power of two up to 2^32 cycles
+#define SUB_BITS 2
+#define SUB_BUCKETS (1 << SUB_BITS)
+#define BUCKET_COUNT (SUB_BUCKETS * 31)
+
+typedef struct
+{
+    uint32_t buckets[BUCKET_COUNT];
+    uint32_t count;
+    uint32_t max_cycles;
+    uint64_t sum_cycles;
+    uint32_t generation;
+} stage_histogram_t;
+
+static const char *stage_names[PIPELINE_STAGE_COUNT] = {
+    "i2s_read", "dsp", "convert", "ring_write", "ring_read", "encode", "send"};
+static stage_histogram_t histograms[PIPELINE_STAGE_COUNT];
+static std::atomic<uint32_t> reset_generation(0);
+
+// Previous run-time snapshot for interval load
+typedef struct
+{
+    TaskHandle_t handle;
+    uint32_t run_time;
+} task_sample_t;
+
+static task_sample_t prev_tasks[PIPELINE_STATS_MAX_TASKS];
+static size_t prev_task_count = 0;
+static uint32_t prev_total_time = 0;
+
+static inline uint32_t bucket_index(uint32_t cycles)
+{
+    if (cycles < SUB_BUCKETS)
+    {
+        return cycles;
+    }
+    uint32_t msb = 31 - __builtin_clz(cycles);
+    return SUB_BUCKETS * (msb - SUB_BITS + 1) + ((cycles >> (msb - SUB_BITS)) & (SUB_BUCKETS - 1));
+}
+
+// Largest value that falls in a bucket
+static uint32_t bucket_upper(uint32_t index)
+{
+    if (index < SUB_BUCKETS)
+    {
+        return index;
+    }
+    uint32_t shift = index / SUB_BUCKETS - 1;
+    uint64_t lower = (uint64_t)(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    uint64_t upper = lower + ((uint64_t)1 << shift) - 1;
+    return upper > UINT32_MAX ? UINT32_MAX : (uint32_t)upper;
+}
+
+void pipeline_stats_record_cycles(pipeline_stage_t stage, uint32_t cycles)
+{
+#if PIPELINE_STATS_ENABLED
+    if (stage >= PIPELINE_STAGE_COUNT)
+    {
+        return;
+    }
+
+    stage_histogram_t *h = &histograms[stage];
+    uint32_t generation = reset_generation.load(std::memory_order_relaxed);
+    if (h->generation != generation)
+    {
+        memset(h, 0, sizeof(*h));
+        h->generation = generation;
+    }
+
+    h->buckets[bucket_index(cycles)]++;
+    h->sum_cycles += cycles;
+    if (cycles > h->max_cycles)
+    {
+        h->max_cycles = cycles;
+    }
+    h->count++;
+#else
+    (void)stage;
+    (void)cycles;
+#endif
+}
+
+void pipeline_stats_record(pipeline_stage_t stage, uint32_t start_cycles)
+{
+    pipeline_stats_record_cycles(stage, esp_cpu_get_cycle_count() - start_cycles);
+}
+
+bool pipeline_stats_get(pipeline_stage_t stage, pipeline_stage_summary_t *summary)
+{
+    if (stage >= PIPELINE_STAGE_COUNT || summary == NULL)
+    {
+        return false;
+    }
+
+    memset(summary, 0, sizeof(*summary));
+    summary->name = stage_names[stage];
+
+    const stage_histogram_t *h = &histograms[stage];
+    if (h->generation != reset_generation.load(std::memory_order_relaxed))
+    {
+        return true; // Cleared, not yet recorded since
+    }
+
+    // Unlocked snapshot: counts may move while we walk them, totals come from the copy
+    static uint32_t snapshot[BUCKET_COUNT];
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < BUCKET_COUNT; i++)
+    {
+        snapshot[i] = h->buckets[i];
+        total += snapshot[i];
+    }
+    if (total == 0)
+    {
+        return true;
+    }
+
+    const float cycles_per_us = (float)esp_rom_get_cpu_ticks_per_us();
+    uint32_t p50_rank = (total + 1) / 2;
+    uint32_t p99_rank = total - total / 100;
+    uint32_t seen = 0;
+    uint32_t p50 = 0;
+    uint32_t p99 = 0;
+    for (uint32_t i = 0; i < BUCKET_COUNT; i++)
+    {
+        if (snapshot[i] == 0)
+        {
+            continue;
+        }
+        seen += snapshot[i];
+        if (p50 == 0 && seen >= p50_rank)
+        {
+            p50 = bucket_upper(i);
+        }
+        if (seen >= p99_rank)
+        {
+            p99 = bucket_upper(i);
+            break;
+        }
+    }
+
+    uint32_t max_cycles = h->max_cycles;
+    summary->count = h->count;
+    summary->p50_us = (p50 < max_cycles ? p50 : max_cycles) / cycles_per_us;
+    summary->p99_us = (p99 < max_cycles ? p99 : max_cycles) / cycles_per_us;
+    summary->max_us = max_cycles / cycles_per_us;
+    summary->mean_us = (float)((double)h->sum_cycles / (summary->count > 0 ? summary->count : 1)) / cycles_per_us;
+    return true;
+}
+
+void pipeline_stats_reset(void)
+{
+    reset_generation.fetch_add(1, std::memory_order_relaxed);
+    ESP_LOGI(TAG, "Pipeline histograms cleared");
+}
+
+size_t pipeline_stats_get_tasks(pipeline_task_load_t *tasks, size_t max_tasks)
+{
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+    if (tasks == NULL || max_tasks == 0)
+    {
+        return 0;
+    }
+
+    static TaskStatus_t status[PIPELINE_STATS_MAX_TASKS];
+    uint32_t total_time = 0;
+    UBaseType_t count = uxTaskGetSystemState(status, PIPELINE_STATS_MAX_TASKS, &total_time);
+    if (count == 0)
+    {
+        ESP_LOGW(TAG, "More than %d tasks, raise PIPELINE_STATS_MAX_TASKS", PIPELINE_STATS_MAX_TASKS);
+        return 0;
+    }
+
+    // First call: load since boot
+    uint32_t interval = total_time - prev_total_time;
+    if (interval == 0)
+    {
+        interval = 1;
+    }
+
+    size_t filled = 0;
+    for (UBaseType_t i = 0; i < count && filled < max_tasks; i++)
+    {
+        uint32_t prev_run = 0;
+        for (size_t j = 0; j < prev_task_count; j++)
+        {
+            if (prev_tasks[j].handle == status[i].xHandle)
+            {
+                prev_run = prev_tasks[j].run_time;
+                break;
+            }
+        }
+
+        pipeline_task_load_t *t = &tasks[filled++];
+        strncpy(t->name, status[i].pcTaskName, sizeof(t->name) - 1);
+        t->name[sizeof(t->name) - 1] = '\0';
+        BaseType_t core = xTaskGetCoreID(status[i].xHandle);
+        t->core = (core == tskNO_AFFINITY) ? -1 : (int8_t)core;
+        t->priority = (uint8_t)status[i].uxCurrentPriority;
+        uint64_t permille = ((uint64_t)(status[i].ulRunTimeCounter - prev_run) * 1000) / interval;
+        t->cpu_permille = permille > 1000 ? 1000 : (uint16_t)permille;
+        t->stack_free = status[i].usStackHighWaterMark;
+    }
+
+    prev_task_count = count;
+    for (UBaseType_t i = 0; i < count; i++)
+    {
+        prev_tasks[i].handle = status[i].xHandle;
+        prev_tasks[i].run_time = status[i].ulRunTimeCounter;
+    }
+    prev_total_time = total_time;
+    return filled;
+#else
+    (void)tasks;
+    (void)max_tasks;
+    (void)prev_tasks;
+    (void)prev_task_count;
+    (void)prev_total_time;
+    return 0;
+#endif
+}
@@ -0,0 +1,107 @@
+#ifndef PIPELINE_STATS_H
+#define PIPELINE_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_cpu.h"
+#include "../config.h"
+
+/**
+ * Pipeline timing and per-task CPU load
+ *
+ * Each stage keeps a log-linear histogram of CPU-cycle durations (4 buckets
+ * per power of two, so percentiles are within 25%) plus the exact maximum.
+ * A stage is recorded by one task only, so recording is a few instructions
+ * and needs no lock; readers take an unlocked snapshot.
+ *
+ * Task load comes from FreeRTOS run-time stats (configGENERATE_RUN_TIME_STATS)
+ * as the share of one core used since the previous query.
+ */
+
+typedef enum
+{
+    PIPELINE_STAGE_I2S_READ = 0,   // i2s_channel_read() wait (I2S reader)
+    PIPELINE_STAGE_DSP = 1,        // DSP chain (I2S reader)
+    PIPELINE_STAGE_CONVERT = 2,    // Slot conversion into the ring (I2S reader)
+    PIPELINE_STAGE_RING_WRITE = 3, // Reserve + commit (I2S reader)
+    PIPELINE_STAGE_RING_READ = 4,  // Wait-free peek + consume (network sender)
+    PIPELINE_STAGE_ENCODE = 5,     // Codec frames of one block (network sender)
+    PIPELINE_STAGE_SEND = 6,       // Streamer send calls of one block (network sender)
+    PIPELINE_STAGE_COUNT
+} pipeline_stage_t;
+
+/**
+ * Stage summary in microseconds
+ */
+typedef struct
+{
+    const char *name;
+    uint32_t count;
+    float p50_us;
+    float p99_us;
+    float max_us;
+    float mean_us;
+} pipeline_stage_summary_t;
+
+/**
+ * CPU load of one task
+ */
+typedef struct
+{
+    char name[16];
+    int8_t core;          // -1 = not pinned
+    uint8_t priority;
+    uint16_t cpu_permille; // Of one core, since the previous query
+    uint32_t stack_free;  // Bytes, high-water mark
+} pipeline_task_load_t;
+
+/**
+ * Read the cycle counter to start timing a stage
+ */
+static inline uint32_t pipeline_stats_start(void)
+{
+    return esp_cpu_get_cycle_count();
+}
+
+/**
+ * Record a stage duration measured from pipeline_stats_start()
+ *
+ * Only the task that owns the stage may call this.
+ *
+ * @param stage Stage to record
+ * @param start_cycles Value returned by pipeline_stats_start()
+ */
+void pipeline_stats_record(pipeline_stage_t stage, uint32_t start_cycles);
+
+/**
+ * Record a stage duration in CPU cycles (for sums of several calls)
+ */
+void pipeline_stats_record_cycles(pipeline_stage_t stage, uint32_t cycles);
+
+/**
+ * Get percentiles for a stage
+ *
+ * @param stage Stage to summarize
+ * @param summary Output
+ * @return false on invalid stage
+ */
+bool pipeline_stats_get(pipeline_stage_t stage, pipeline_stage_summary_t *summary);
+
+/**
+ * Clear all histograms (applied by each owning task on its next record)
+ */
+void pipeline_stats_reset(void);
+
+/**
+ * Get per-task CPU load
+ *
+ * Not reentrant: keeps the previous snapshot to compute the interval.
+ *
+ * @param tasks Output array
+ * @param max_tasks Size of tasks
+ * @return Number of tasks filled, 0 if run-time stats are not compiled in
+ */
+size_t pipeline_stats_get_tasks(pipeline_task_load_t *tasks, size_t max_tasks);
+
+#endif // PIPELINE_STATS_H
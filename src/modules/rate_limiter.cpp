@@ -0,0 +1,133 @@
+#include "rate_limiter.h"
+#include <string.h>
+
+#define PROBE_LIMIT 4
+
+void rate_limiter_init(rate_limiter_t *limiter, uint16_t burst, uint32_t refill_ms)
+{
+    memset(limiter->sites, 0, sizeof(limiter->sites));
+    limiter->burst = burst > 0 ? burst : 1;
+    limiter->refill_ms = refill_ms > 0 ? refill_ms : 1;
+    portMUX_INITIALIZE(&limiter->lock);
+}
+
+// Find the site for a key, or claim a free / least recently seen slot in its probe window
+static rate_limit_site_t *find_site(rate_limiter_t *limiter, uint32_t key, uint32_t now_ms)
+{
+    uint32_t start = (key * 2654435761u) >> 16;
+    rate_limit_site_t *victim = NULL;
+
+    for (uint32_t i = 0; i < PROBE_LIMIT; i++)
+    {
+        rate_limit_site_t *site = &limiter->sites[(start + i) % RATE_LIMIT_SITES];
+        if (site->key == key)
+        {
+            return site;
+        }
+        if (site->key == 0)
+        {
+            if (victim == NULL || victim->key != 0)
+            {
+                victim = site;
+            }
+        }
+        else if (victim == NULL || (victim->key != 0 && (now_ms - site->last_seen_ms) > (now_ms - victim->last_seen_ms)))
+        {
+            victim = site;
+        }
+    }
+
+    // Evicting a site drops its pending repeat count; the table is sized so this is rare
+    victim->key = key;
+    victim->suppressed = 0;
+    victim->tokens = limiter->burst;
+    victim->last_refill_ms = now_ms;
+    victim->last_seen_ms = now_ms;
+    return victim;
+}
+
+bool rate_limiter_allow(rate_limiter_t *limiter, uint32_t key, const void *label,
+                        uint32_t now_ms, uint32_t *repeated)
+{
+    if (key == 0)
+    {
+        key = 1;
+    }
+
+    bool allowed;
+    uint32_t suppressed = 0;
+
+    portENTER_CRITICAL(&limiter->lock);
+    rate_limit_site_t *site = find_site(limiter, key, now_ms);
+    site->label = label;
+    site->last_seen_ms = now_ms;
+
+    // Refill whole tokens only, keeping the remainder
+    uint32_t earned = (now_ms - site->last_refill_ms) / limiter->refill_ms;
+    if (earned > 0)
+    {
+        uint32_t tokens = site->tokens + earned;
+        site->tokens = tokens > limiter->burst ? limiter->burst : (uint16_t)tokens;
+        site->last_refill_ms += earned * limiter->refill_ms;
+    }
+
+    if (site->tokens > 0)
+    {
+        site->tokens--;
+        suppressed = site->suppressed;
+        site->suppressed = 0;
+        allowed = true;
+    }
+    else
+    {
+        site->suppressed++;
+        allowed = false;
+    }
+    portEXIT_CRITICAL(&limiter->lock);
+
+    if (repeated)
+    {
+        *repeated = suppressed;
+    }
+    return allowed;
+}
+
+size_t rate_limiter_collect(rate_limiter_t *limiter, uint32_t now_ms, uint32_t quiet_ms,
+                            rate_limit_summary_t *out, size_t max_out)
+{
+    size_t count = 0;
+
+    portENTER_CRITICAL(&limiter->lock);
+    for (uint32_t i = 0; i < RATE_LIMIT_SITES && count < max_out; i++)
+    {
+        rate_limit_site_t *site = &limiter->sites[i];
+        if (site->key == 0 || site->suppressed == 0 || (now_ms - site->last_seen_ms) < quiet_ms)
+        {
+            continue;
+        }
+        out[count].key = site->key;
+        out[count].label = site->label;
+        out[count].repeated = site->suppressed;
+        site->suppressed = 0;
+        count++;
+    }
+    portEXIT_CRITICAL(&limiter->lock);
+
+    return count;
+}
+
+uint32_t rate_limiter_hash(const char *text, uint32_t seed)
+{
+    // FNV-1a
+    uint32_t hash = seed ? seed : 2166136261u;
+    for (const char *p = text; p && *p; p++)
+    {
+        if (*p >= '0' && *p <= '9')
+        {
+            continue;
+        }
+        hash ^= (uint8_t)*p;
+        hash *= 16777619u;
+    }
+    return hash ? hash : 1;
+}
@@ -0,0 +1,100 @@
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "../config.h"
+
+/**
+ * Per-call-site token bucket with repeat counting
+ *
+ * Each site (a key, e.g. a format string address or a message hash) gets a
+ * slot in a RATE_LIMIT_SITES table holding `burst` tokens that refill one
+ * per `refill_ms`. A call without a token is suppressed and counted; the
+ * count is handed back on the next allowed call, or by
+ * rate_limiter_collect() once the site has gone quiet, so the caller can
+ * say "repeated N times" instead of printing N lines.
+ *
+ * The table is guarded by a spinlock held for a few dozen instructions, so
+ * it can sit in front of logging from any task on either core.
+ */
+
+typedef struct
+{
+    uint32_t key;          // 0 = free
+    const void *label;     // Caller data for summaries (e.g. the format string)
+    uint32_t last_refill_ms;
+    uint32_t last_seen_ms;
+    uint32_t suppressed;   // Since the last allowed call or summary
+    uint16_t tokens;
+} rate_limit_site_t;
+
+typedef struct
+{
+    rate_limit_site_t sites[RATE_LIMIT_SITES];
+    uint16_t burst;
+    uint32_t refill_ms;
+    portMUX_TYPE lock;
+} rate_limiter_t;
+
+/**
+ * Summary of a site that was suppressed and then went quiet
+ */
+typedef struct
+{
+    uint32_t key;
+    const void *label;
+    uint32_t repeated;
+} rate_limit_summary_t;
+
+/**
+ * Initialize a limiter
+ *
+ * @param limiter Limiter to initialize
+ * @param burst Calls allowed back to back per site
+ * @param refill_ms Time to earn back one call
+ */
+void rate_limiter_init(rate_limiter_t *limiter, uint16_t burst, uint32_t refill_ms);
+
+/**
+ * Take a token for a site
+ *
+ * @param limiter Limiter
+ * @param key Site key, non-zero
+ * @param label Stored with the site for rate_limiter_collect()
+ * @param now_ms Current time
+ * @param repeated Output: calls suppressed since the last allowed one (may be NULL)
+ * @return true if the caller should emit, false if suppressed
+ */
+bool rate_limiter_allow(rate_limiter_t *limiter, uint32_t key, const void *label,
+                        uint32_t now_ms, uint32_t *repeated);
+
+/**
+ * Collect sites with suppressed calls and no call for quiet_ms
+ *
+ * Their counts are reset, so each suppression is reported once.
+ *
+ * @param limiter Limiter
+ * @param now_ms Current time
+ * @param quiet_ms How long a site must be idle
+ * @param out Output array
+ * @param max_out Size of out
+ * @return Number of summaries filled
+ */
+size_t rate_limiter_collect(rate_limiter_t *limiter, uint32_t now_ms, uint32_t quiet_ms,
+                            rate_limit_summary_t *out, size_t max_out);
+
+/**
+ * Hash a message into a site key, ignoring digits
+ *
+ * "dropped 12 samples" and "dropped 40 samples" map to the same key.
+ *
+ * @param text String to hash
+ * @param seed Previous hash to chain fields, or 0
+ * @return Non-zero key
+ */
+uint32_t rate_limiter_hash(const char *text, uint32_t seed);
+
+#endif // RATE_LIMITER_H
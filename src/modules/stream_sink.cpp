@@ -0,0 +1,567 @@
+#include "stream_sink.h"
+#include "boot_profile.h"
+#include "network_manager.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+
+static const char *TAG = "STREAM_SINK";
+
+#define RECORD_ALIGN 8
+#define RECORD_HEADER_SIZE ((sizeof(stream_record_t) + RECORD_ALIGN - 1) & ~(size_t)(RECORD_ALIGN - 1))
+#define RECORD_FLAG_PAD 0x80 // Skip to the ring wrap (internal)
+#define SINK_IDLE_WAIT_MS 100 // Longest sleep without a notification (suspend/lap checks)
+
+typedef struct
+{
+    const stream_sink_ops_t *ops;
+    TaskHandle_t task;
+    uint64_t cursor;         // Next byte to read (logical)
+    stream_record_t record;  // Staged record, copied out of the ring
+    uint8_t *staging;        // Its payload
+    bool staged;
+    bool ever_connected;
+    stream_sink_stats_t stats; // Under stats_lock
+} sink_t;
+
+// Logical byte positions only grow; the ring offset is position % ring_size.
+// [tail, write_pos) holds whole records. The writer moves tail before it reuses
+// space, and a reader that finds its cursor behind tail has been lapped.
+static uint8_t *ring = NULL;
+static size_t ring_size = 0;
+static uint64_t head = 0; // Writer-owned: end of appended records
+static std::atomic<uint64_t> write_pos(0);
+static std::atomic<uint64_t> tail_pos(0);
+
+static sink_t sinks[STREAM_SINK_MAX];
+static std::atomic<uint32_t> sink_count(0);
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static std::atomic<bool> suspend_requested(false);
+static std::atomic<uint32_t> parked_mask(0);
+
+static void wake_sinks(void)
+{
+    uint32_t count = sink_count.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (sinks[i].task != NULL)
+        {
+            xTaskNotifyGive(sinks[i].task);
+        }
+    }
+}
+
+static inline size_t record_span(size_t payload_bytes)
+{
+    return (RECORD_HEADER_SIZE + payload_bytes + RECORD_ALIGN - 1) & ~(size_t)(RECORD_ALIGN - 1);
+}
+
+// Position of the record after the one at pos (writer only: its own headers are intact)
+static uint64_t record_next(uint64_t pos)
+{
+    size_t offset = pos % ring_size;
+    size_t room = ring_size - offset;
+    if (room < RECORD_HEADER_SIZE)
+    {
+        return pos + room;
+    }
+
+    stream_record_t record;
+    memcpy(&record, ring + offset, sizeof(record));
+    return (record.flags & RECORD_FLAG_PAD) ? pos + room : pos + record_span(record.bytes);
+}
+
+static bool ring_append(const stream_record_t *record, const uint8_t *data0, size_t bytes0,
+                        const uint8_t *data1, size_t bytes1)
+{
+    if (ring == NULL || bytes0 + bytes1 > STREAM_SINK_RECORD_MAX_BYTES)
+    {
+        return false;
+    }
+
+    size_t span = record_span(bytes0 + bytes1);
+    size_t offset = head % ring_size;
+    size_t room = ring_size - offset;
+    size_t pad = room < span ? room : 0; // Records never wrap
+
+    // Free the space first so a reader still copying from it sees the lap
+    uint64_t end = head + pad + span;
+    uint64_t tail = tail_pos.load(std::memory_order_relaxed);
+    while (end - tail > ring_size)
+    {
+        tail = record_next(tail);
+    }
+    tail_pos.store(tail, std::memory_order_seq_cst);
+
+    if (pad > 0)
+    {
+        if (pad >= RECORD_HEADER_SIZE)
+        {
+            stream_record_t marker;
+            memset(&marker, 0, sizeof(marker));
+            marker.bytes = pad - RECORD_HEADER_SIZE;
+            marker.flags = RECORD_FLAG_PAD;
+            memcpy(ring + offset, &marker, sizeof(marker));
+        }
+        head += pad;
+        offset = 0;
+    }
+
+    stream_record_t header = *record;
+    header.bytes = bytes0 + bytes1;
+    memcpy(ring + offset, &header, sizeof(header));
+    memcpy(ring + offset + RECORD_HEADER_SIZE, data0, bytes0);
+    if (bytes1 > 0)
+    {
+        memcpy(ring + offset + RECORD_HEADER_SIZE + bytes0, data1, bytes1);
+    }
+    head += span;
+    return true;
+}
+
+// true if the writer has reused the space at pos since the caller started reading it
+static inline bool lapped(uint64_t pos)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return tail_pos.load(std::memory_order_relaxed) > pos;
+}
+
+static void sink_note_lap(sink_t *sink)
+{
+    uint64_t tail = tail_pos.load(std::memory_order_acquire);
+    if (sink->cursor >= tail)
+    {
+        return;
+    }
+
+    portENTER_CRITICAL(&stats_lock);
+    sink->stats.overruns++;
+    sink->stats.bytes_dropped += tail - sink->cursor;
+    portEXIT_CRITICAL(&stats_lock);
+    sink->cursor = tail;
+}
+
+/**
+ * Copy the record at the sink's cursor into its staging buffer
+ * @return false if the sink has caught up with the writer
+ */
+static bool sink_fetch(sink_t *sink)
+{
+    while (true)
+    {
+        sink_note_lap(sink);
+        uint64_t pos = sink->cursor;
+        if (pos >= write_pos.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        size_t offset = pos % ring_size;
+        size_t room = ring_size - offset;
+        if (room < RECORD_HEADER_SIZE)
+        {
+            sink->cursor = pos + room;
+            continue;
+        }
+
+        stream_record_t record;
+        memcpy(&record, ring + offset, sizeof(record));
+        bool fits = (record.flags & RECORD_FLAG_PAD) ? record.bytes == room - RECORD_HEADER_SIZE
+                                                     : record.bytes <= STREAM_SINK_RECORD_MAX_BYTES &&
+                                                           record_span(record.bytes) <= room;
+        if (fits && !(record.flags & RECORD_FLAG_PAD))
+        {
+            memcpy(sink->staging, ring + offset + RECORD_HEADER_SIZE, record.bytes);
+        }
+        if (lapped(pos))
+        {
+            continue; // Overwritten while copying; resume at the oldest record
+        }
+        if (!fits)
+        {
+            ESP_LOGE(TAG, "%s: corrupt record at %llu, skipping to the newest audio",
+                     sink->ops->name, (unsigned long long)pos);
+            sink->cursor = write_pos.load(std::memory_order_acquire);
+            return false;
+        }
+        if (record.flags & RECORD_FLAG_PAD)
+        {
+            sink->cursor = pos + room;
+            continue;
+        }
+
+        sink->record = record;
+        sink->staged = true;
+        return true;
+    }
+}
+
+static void sink_consume(sink_t *sink, bool delivered)
+{
+    uint64_t next = sink->cursor + record_span(sink->record.bytes);
+    sink->staged = false;
+
+    portENTER_CRITICAL(&stats_lock);
+    if (delivered)
+    {
+        sink->stats.records_sent++;
+        sink->stats.bytes_sent += sink->record.bytes;
+    }
+    else
+    {
+        sink->stats.bytes_dropped += sink->record.bytes;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+
+    // A record sent from its copy after being lapped: the newer ones were lost too
+    sink->cursor = next;
+    sink_note_lap(sink);
+}
+
+static void sink_park(sink_t *sink)
+{
+    const uint32_t bit = 1u << (sink - sinks);
+    if (!suspend_requested.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    parked_mask.fetch_or(bit, std::memory_order_release);
+    while (suspend_requested.load(std::memory_order_acquire))
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SINK_IDLE_WAIT_MS));
+    }
+    parked_mask.fetch_and(~bit, std::memory_order_release);
+}
+
+// Sleep up to ms, cut short by a suspend
+static void sink_wait(uint32_t ms)
+{
+    for (uint32_t waited = 0; waited < ms && !suspend_requested.load(std::memory_order_relaxed);
+         waited += SINK_IDLE_WAIT_MS)
+    {
+        vTaskDelay(pdMS_TO_TICKS(SINK_IDLE_WAIT_MS));
+    }
+}
+
+#if ENABLE_AUTO_REBOOT
+// Every sink has kept failing since it last delivered audio
+static bool all_sinks_failing(void)
+{
+    uint32_t count = sink_count.load(std::memory_order_acquire);
+    bool failing = count > 0;
+    portENTER_CRITICAL(&stats_lock);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        failing = failing && sinks[i].stats.reconnect_attempts >= MAX_RECONNECT_ATTEMPTS;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+    return failing;
+}
+#endif
+
+static void sink_connect(sink_t *sink)
+{
+    // WiFi down: wait for it instead of spending reconnect attempts
+    if (!network_manager_wait_connected(STREAM_NETWORK_WAIT_MS))
+    {
+        return;
+    }
+
+    if (sink->ops->connect())
+    {
+        portENTER_CRITICAL(&stats_lock);
+        sink->stats.connects++;
+        sink->stats.reconnect_attempts = 0;
+        sink->stats.backoff_ms = RECONNECT_BACKOFF_MS;
+        portEXIT_CRITICAL(&stats_lock);
+        sink->ever_connected = true;
+        ESP_LOGI(TAG, "%s connected", sink->ops->name);
+        boot_profile_mark(BOOT_PHASE_STREAM);
+        return;
+    }
+
+    portENTER_CRITICAL(&stats_lock);
+    uint32_t backoff_ms = sink->stats.backoff_ms;
+    // Server not up yet at boot: back off without counting toward the reboot limit
+    if (sink->ever_connected)
+    {
+        sink->stats.reconnect_attempts++;
+    }
+    uint32_t attempts = sink->stats.reconnect_attempts;
+    sink->stats.backoff_ms = (backoff_ms * 2 > MAX_RECONNECT_BACKOFF_MS) ? MAX_RECONNECT_BACKOFF_MS : backoff_ms * 2;
+    portEXIT_CRITICAL(&stats_lock);
+
+    ESP_LOGW(TAG, "%s connect failed (attempt %lu/%d), retrying in %lu ms",
+             sink->ops->name, attempts, MAX_RECONNECT_ATTEMPTS, backoff_ms);
+
+#if ENABLE_AUTO_REBOOT
+    if (attempts >= MAX_RECONNECT_ATTEMPTS && all_sinks_failing())
+    {
+        ESP_LOGE(TAG, "Max reconnect attempts reached on every sink, rebooting...");
+        vTaskDelay(pdMS_TO_TICKS(1000));
+        esp_restart();
+    }
+#endif
+
+    sink_wait(backoff_ms);
+}
+
+static void sink_task(void *arg)
+{
+    sink_t *sink = (sink_t *)arg;
+    ESP_LOGI(TAG, "%s sink started", sink->ops->name);
+
+    while (1)
+    {
+        sink_park(sink);
+
+        if (!sink->ops->is_connected())
+        {
+            sink_connect(sink);
+            continue;
+        }
+
+        if (!sink->staged && !sink_fetch(sink))
+        {
+            if (sink->ops->flush != NULL)
+            {
+                sink->ops->flush();
+            }
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SINK_IDLE_WAIT_MS));
+            continue;
+        }
+
+        if (sink->ops->send(&sink->record, sink->staging))
+        {
+            sink_consume(sink, true);
+            boot_profile_mark(BOOT_PHASE_FIRST_AUDIO);
+            continue;
+        }
+
+        bool connected = sink->ops->is_connected();
+        portENTER_CRITICAL(&stats_lock);
+        if (connected)
+        {
+            sink->stats.refused++;
+        }
+        else
+        {
+            sink->stats.failures++;
+        }
+        portEXIT_CRITICAL(&stats_lock);
+
+        // A reliable sink keeps the record for the retry or the next connection
+        if (!sink->ops->reliable)
+        {
+            sink_consume(sink, false);
+        }
+        if (!connected)
+        {
+            ESP_LOGW(TAG, "%s send failed, reconnecting", sink->ops->name);
+        }
+        else if (sink->ops->reliable)
+        {
+            vTaskDelay(1); // Backed up: let the destination drain
+        }
+    }
+}
+
+// Prefer PSRAM and leave internal RAM to WiFi; boards without PSRAM use internal RAM
+static void *alloc_prefer_psram(size_t size)
+{
+    void *ptr = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (ptr == NULL)
+    {
+        ptr = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    }
+    return ptr;
+}
+
+bool stream_sink_init(size_t size)
+{
+    if (ring != NULL)
+    {
+        ESP_LOGW(TAG, "Already initialized");
+        return true;
+    }
+
+    bool psram = heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0;
+    if (!psram && size > STREAM_SINK_INTERNAL_BUFFER_SIZE)
+    {
+        ESP_LOGW(TAG, "No PSRAM, fan-out ring reduced to %d KB of internal RAM",
+                 STREAM_SINK_INTERNAL_BUFFER_SIZE / 1024);
+        size = STREAM_SINK_INTERNAL_BUFFER_SIZE;
+    }
+
+    size &= ~(size_t)(RECORD_ALIGN - 1);
+    if (size < 2 * record_span(STREAM_SINK_RECORD_MAX_BYTES))
+    {
+        ESP_LOGE(TAG, "Fan-out ring of %zu bytes cannot hold two records", size);
+        return false;
+    }
+
+    ring = (uint8_t *)alloc_prefer_psram(size);
+    if (ring == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to allocate %zu byte fan-out ring", size);
+        return false;
+    }
+
+    ring_size = size;
+    ESP_LOGI(TAG, "Fan-out ring: %zu KB", size / 1024);
+    return true;
+}
+
+int stream_sink_register(const stream_sink_ops_t *ops, uint32_t priority)
+{
+    uint32_t index = sink_count.load(std::memory_order_relaxed);
+    if (ring == NULL || ops == NULL || ops->send == NULL || ops->connect == NULL || ops->is_connected == NULL)
+    {
+        return -1;
+    }
+    if (index >= STREAM_SINK_MAX)
+    {
+        ESP_LOGE(TAG, "Sink limit (%d) reached, %s not added", STREAM_SINK_MAX, ops->name);
+        return -1;
+    }
+
+    sink_t *sink = &sinks[index];
+    memset(sink, 0, sizeof(*sink));
+    sink->ops = ops;
+    sink->cursor = write_pos.load(std::memory_order_acquire);
+    sink->stats.name = ops->name;
+    sink->stats.backoff_ms = RECONNECT_BACKOFF_MS;
+    sink->staging = (uint8_t *)alloc_prefer_psram(STREAM_SINK_RECORD_MAX_BYTES);
+    if (sink->staging == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to allocate %s staging buffer", ops->name);
+        return -1;
+    }
+
+    // Counted before the task runs so the writer wakes it from the first record on
+    sink_count.store(index + 1, std::memory_order_release);
+    char name[16];
+    snprintf(name, sizeof(name), "Sink_%s", ops->name);
+    if (xTaskCreatePinnedToCore(sink_task, name, STREAM_SINK_TASK_STACK_SIZE, sink, priority,
+                                &sink->task, TCP_SENDER_CORE) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create %s sink task", ops->name);
+        sink_count.store(index, std::memory_order_release);
+        heap_caps_free(sink->staging);
+        sink->staging = NULL;
+        return -1;
+    }
+
+    return (int)index;
+}
+
+size_t stream_sink_count(void)
+{
+    return sink_count.load(std::memory_order_acquire);
+}
+
+bool stream_sink_append(const stream_record_t *record, const uint8_t *payload)
+{
+    if (record == NULL || (payload == NULL && record->bytes > 0))
+    {
+        return false;
+    }
+    return ring_append(record, payload, record->bytes, NULL, 0);
+}
+
+bool stream_sink_append_span(const buffer_span_t *span, uint8_t channels)
+{
+    if (span == NULL || span->samples[0] == 0)
+    {
+        return false;
+    }
+
+    stream_record_t record;
+    memset(&record, 0, sizeof(record));
+    record.samples = span->samples[0] + span->samples[1];
+    record.sample_index = span->sample_index;
+    record.capture_us = span->capture_us;
+    record.codec = AUDIO_CODEC_PCM;
+    record.sample_bytes = span->sample_bytes;
+    record.channels = channels;
+    return ring_append(&record, span->data[0], span->samples[0] * span->sample_bytes,
+                       span->data[1], span->samples[1] * span->sample_bytes);
+}
+
+void stream_sink_publish(void)
+{
+    if (head == write_pos.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    write_pos.store(head, std::memory_order_release);
+    wake_sinks();
+}
+
+bool stream_sink_suspend(uint32_t timeout_ms)
+{
+    uint32_t count = sink_count.load(std::memory_order_acquire);
+    const uint32_t all = (1u << count) - 1;
+
+    suspend_requested.store(true, std::memory_order_release);
+    wake_sinks();
+
+    TickType_t start = xTaskGetTickCount();
+    while ((parked_mask.load(std::memory_order_acquire) & all) != all)
+    {
+        if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(timeout_ms))
+        {
+            ESP_LOGW(TAG, "Sinks did not park within %lu ms", timeout_ms);
+            return false;
+        }
+        vTaskDelay(1);
+    }
+    return true;
+}
+
+void stream_sink_resume(void)
+{
+    suspend_requested.store(false, std::memory_order_release);
+    wake_sinks();
+}
+
+void stream_sink_reset(void)
+{
+    uint64_t now = write_pos.load(std::memory_order_relaxed);
+    head = now;
+    tail_pos.store(now, std::memory_order_release);
+
+    uint32_t count = sink_count.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        sinks[i].cursor = now;
+        sinks[i].staged = false;
+    }
+}
+
+bool stream_sink_get_stats(size_t index, stream_sink_stats_t *stats)
+{
+    if (stats == NULL || index >= sink_count.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    sink_t *sink = &sinks[index];
+    portENTER_CRITICAL(&stats_lock);
+    *stats = sink->stats;
+    portEXIT_CRITICAL(&stats_lock);
+
+    uint64_t written = write_pos.load(std::memory_order_acquire);
+    uint64_t cursor = sink->cursor; // Owned by the sink task; a slightly stale read is fine here
+    stats->backlog_bytes = written > cursor ? (size_t)(written - cursor) : 0;
+    stats->connected = sink->ops->is_connected();
+    return true;
+}
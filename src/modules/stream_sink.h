@@ -0,0 +1,160 @@
+#ifndef STREAM_SINK_H
+#define STREAM_SINK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../config.h"
+#include "buffer_manager.h"
+
+/**
+ * Multi-destination fan-out
+ *
+ * The network sender gates and encodes each block once and appends the
+ * result as records to a shared fan-out ring (one writer). Every sink runs
+ * in its own task with its own read cursor into that ring, its own
+ * connection, reconnect backoff and stats, so a slow or dead destination
+ * only ever delays itself.
+ *
+ * The writer never waits for a sink: a sink that falls a whole ring behind
+ * is lapped, skips to the oldest record still held and counts the bytes it
+ * missed. Sinks copy a record out before sending it, so the writer may
+ * reuse the space while a send is in progress.
+ */
+
+#define STREAM_RECORD_FLAG_VARIABLE 0x01 // Variable-size codec frame (length-prefixed on unframed TCP)
+
+/**
+ * One unit of audio in the fan-out ring
+ *
+ * PCM records hold a block in the ring sample format, encoded records one
+ * codec frame, silence records the comfort-noise level of a gated run.
+ */
+typedef struct
+{
+    uint32_t bytes;        // Payload bytes following the record
+    uint32_t samples;      // Interleaved samples represented
+    uint64_t sample_index; // Capture stream index of the first sample
+    int64_t capture_us;    // Capture time of the first sample
+    uint8_t codec;         // audio_codec_t (AUDIO_CODEC_SILENCE for a gated run)
+    uint8_t sample_bytes;  // Bytes per sample (PCM records)
+    uint8_t channels;      // Interleaved channels
+    uint8_t flags;         // STREAM_RECORD_FLAG_*
+} stream_record_t;
+
+/**
+ * Destination callbacks (run in the sink's task)
+ */
+typedef struct
+{
+    const char *name;
+    bool reliable;                   // Retry records the destination refuses instead of dropping them
+    bool (*connect)(void);           // Open or reopen the destination
+    bool (*is_connected)(void);
+    bool (*send)(const stream_record_t *record, const uint8_t *payload);
+    void (*flush)(void);             // Caught up with the writer (may be NULL)
+} stream_sink_ops_t;
+
+/**
+ * Per-sink statistics
+ */
+typedef struct
+{
+    const char *name;
+    bool connected;
+    uint64_t bytes_sent;         // Record payload bytes delivered
+    uint64_t bytes_dropped;      // Skipped after being lapped, or dropped by an unreliable sink
+    uint32_t records_sent;
+    uint32_t overruns;           // Times the writer lapped the sink
+    uint32_t refused;            // Sends refused while connected (retried by reliable sinks)
+    uint32_t failures;           // Sends that found the destination gone
+    uint32_t connects;           // Successful (re)connects
+    uint32_t reconnect_attempts; // Failed connects in a row
+    uint32_t backoff_ms;         // Wait before the next connect
+    size_t backlog_bytes;        // Written but not yet sent to this sink
+} stream_sink_stats_t;
+
+/**
+ * Allocate the fan-out ring (PSRAM)
+ *
+ * Without a PSRAM heap the ring falls back to internal RAM, capped at
+ * STREAM_SINK_INTERNAL_BUFFER_SIZE: a lagging sink then drops sooner.
+ *
+ * @param size Ring size in bytes
+ * @return true on success
+ */
+bool stream_sink_init(size_t size);
+
+/**
+ * Add a destination and start its task
+ *
+ * The sink starts at the writer's current position and connects once
+ * WiFi is up.
+ *
+ * @param ops Callbacks (must stay valid)
+ * @param priority Task priority; a real-time sink may sit above an archival one
+ * @return Sink index, or -1 on failure
+ */
+int stream_sink_register(const stream_sink_ops_t *ops, uint32_t priority);
+
+/**
+ * Get number of registered sinks
+ */
+size_t stream_sink_count(void);
+
+/**
+ * Append a record (writer only)
+ *
+ * Not visible to the sinks until stream_sink_publish().
+ *
+ * @param record Record metadata (bytes = payload size)
+ * @param payload Record payload
+ * @return false if the record exceeds STREAM_SINK_RECORD_MAX_BYTES
+ */
+bool stream_sink_append(const stream_record_t *record, const uint8_t *payload);
+
+/**
+ * Append ring spans as one PCM record (writer only)
+ * @param span Spans from buffer_manager_peek_read()
+ * @param channels Interleaved channels
+ * @return false if the block exceeds STREAM_SINK_RECORD_MAX_BYTES
+ */
+bool stream_sink_append_span(const buffer_span_t *span, uint8_t channels);
+
+/**
+ * Make appended records visible and wake the sinks (writer only)
+ */
+void stream_sink_publish(void);
+
+/**
+ * Park every sink task between records
+ *
+ * For reconfiguring the streamers behind the sinks. A sink in the middle of
+ * a connect finishes it first. stream_sink_resume() must follow either way.
+ *
+ * @param timeout_ms Longest wait for all sinks to park
+ * @return true if all sinks are parked
+ */
+bool stream_sink_suspend(uint32_t timeout_ms);
+
+/**
+ * Let parked sinks continue
+ */
+void stream_sink_resume(void);
+
+/**
+ * Discard every record not yet sent (sinks suspended, writer idle)
+ *
+ * Used when the capture format changes: buffered audio belongs to the old clock.
+ */
+void stream_sink_reset(void);
+
+/**
+ * Get statistics for one sink
+ * @param index Sink index
+ * @param stats Output
+ * @return false if there is no such sink
+ */
+bool stream_sink_get_stats(size_t index, stream_sink_stats_t *stats);
+
+#endif // STREAM_SINK_H
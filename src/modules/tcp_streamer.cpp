@@ -1,8 +1,14 @@
 #include "tcp_streamer.h"
+#include "audio_convert.h"
+#include "i2s_handler.h"
+#include "media_clock.h"
 #include "../config.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "lwip/sockets.h"
 #include "lwip/netdb.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include <string.h>
 
 static const char *TAG = "TCP_STREAMER";
@@ -11,20 +17,39 @@ static int sock = -1;
 static uint64_t total_bytes_sent = 0;
 static uint32_t reconnect_count = 0;
 
+// Server address (set from the saved config, used by the next connect)
+static char server_ip[16] = TCP_SERVER_IP;
+static uint16_t server_port = TCP_SERVER_PORT;
+
+// Framed mode state
+static bool framing_enabled = TCP_FRAMING_ENABLED;
+static uint8_t quality_tier = 0;
+static uint32_t frame_sequence = 0;
+static uint64_t next_sample_index = 0; // Used by the legacy send paths
+
 // ✅ ADD: Global packing buffer (allocated once at init)
 static uint8_t *packing_buffer = NULL;
 static size_t packing_buffer_size = 0;
 
+// ✅ NON-BLOCKING: bytes the caller handed over that the TCP stack has not taken yet.
+// A block is either refused whole or accepted whole; an accepted block's unsent tail
+// is copied here and flushed before anything else, so the stream never tears.
+static uint8_t *inflight_buffer = NULL;
+static size_t inflight_len = 0;
+static size_t inflight_offset = 0;
+static uint32_t stall_start_ms = 0; // 0 = socket draining normally
+static uint32_t stall_count = 0;
+
 static bool tcp_connect(void)
 {
     struct sockaddr_in server_addr;
     memset(&server_addr, 0, sizeof(server_addr));
 
     server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(TCP_SERVER_PORT);
-    inet_pton(AF_INET, TCP_SERVER_IP, &server_addr.sin_addr);
+    server_addr.sin_port = htons(server_port);
+    inet_pton(AF_INET, server_ip, &server_addr.sin_addr);
 
-    ESP_LOGI(TAG, "Connecting to %s:%d...", TCP_SERVER_IP, TCP_SERVER_PORT);
+    ESP_LOGI(TAG, "Connecting to %s:%d...", server_ip, server_port);
 
     sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
     if (sock < 0)
@@ -85,14 +110,36 @@ static bool tcp_connect(void)
     }
 #endif
 
-    // Set send timeout
-    struct timeval timeout;
-    timeout.tv_sec = 5;
-    timeout.tv_usec = 0;
-    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    // ✅ NON-BLOCKING: the socket never blocks; waits go through select() with a bound
+    int flags = fcntl(sock, F_GETFL, 0);
+    fcntl(sock, F_SETFL, flags | O_NONBLOCK);
 
     // Connect to server
     int ret = connect(sock, (struct sockaddr *)&server_addr, sizeof(server_addr));
+    if (ret != 0 && errno == EINPROGRESS)
+    {
+        fd_set write_set;
+        FD_ZERO(&write_set);
+        FD_SET(sock, &write_set);
+        struct timeval timeout;
+        timeout.tv_sec = TCP_CONNECT_TIMEOUT_MS / 1000;
+        timeout.tv_usec = (TCP_CONNECT_TIMEOUT_MS % 1000) * 1000;
+
+        ret = -1;
+        if (select(sock + 1, NULL, &write_set, NULL, &timeout) > 0)
+        {
+            int error = 0;
+            socklen_t len = sizeof(error);
+            getsockopt(sock, SOL_SOCKET, SO_ERROR, &error, &len);
+            ret = (error == 0) ? 0 : -1;
+            errno = error;
+        }
+        else
+        {
+            errno = ETIMEDOUT;
+        }
+    }
+
     if (ret != 0)
     {
         ESP_LOGE(TAG, "Failed to connect: errno %d", errno);
@@ -101,6 +148,11 @@ static bool tcp_connect(void)
         return false;
     }
 
+    // A new connection starts with an empty stream
+    inflight_len = 0;
+    inflight_offset = 0;
+    stall_start_ms = 0;
+
     ESP_LOGI(TAG, "Connected successfully");
     return true;
 }
@@ -122,32 +174,19 @@ bool tcp_streamer_init(void)
 
     ESP_LOGI(TAG, "Packing buffer allocated: %zu bytes", packing_buffer_size);
 
-    // Attempt connection with retries
-    int max_retries = TCP_CONNECT_MAX_RETRIES;
-    int retry_delay_ms = 2000;
-
-    for (int i = 0; i < max_retries; i++)
-    {
-        if (tcp_connect())
-        {
-            return true;
-        }
-
-        ESP_LOGW(TAG, "Connection attempt %d/%d failed, retrying...", i + 1, max_retries);
-        vTaskDelay(pdMS_TO_TICKS(retry_delay_ms));
-        retry_delay_ms *= 2; // Exponential backoff
-    }
-
-    ESP_LOGE(TAG, "Failed to connect after %d attempts", max_retries);
-
-    // ✅ ADD: Free buffer if connection failed
-    if (packing_buffer != NULL)
+    inflight_buffer = (uint8_t *)malloc(TCP_INFLIGHT_WINDOW_BYTES);
+    if (inflight_buffer == NULL)
     {
+        ESP_LOGE(TAG, "Failed to allocate in-flight buffer");
         free(packing_buffer);
         packing_buffer = NULL;
+        return false;
     }
 
-    return false;
+    // ✅ FAST BOOT: no connection here, so boot never waits on the server;
+    // the sender connects with tcp_streamer_reconnect() once the network is up
+    ESP_LOGI(TAG, "TCP streamer ready for %s:%d", server_ip, server_port);
+    return true;
 }
 
 bool tcp_streamer_is_connected(void)
@@ -170,47 +209,373 @@ bool tcp_streamer_is_connected(void)
     return true;
 }
 
-// ✅ NEW: Native 16-bit send function (no conversion needed)
-bool tcp_streamer_send_audio_16(const int16_t *samples, size_t sample_count)
+static uint32_t now_ms(void)
 {
-    if (sock < 0 || samples == NULL || sample_count == 0)
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+// Hard socket error: drop the connection so the sender's reconnect logic takes over
+static void tcp_fail(const char *what)
+{
+    ESP_LOGE(TAG, "%s failed: errno %d", what, errno);
+    close(sock);
+    sock = -1;
+    inflight_len = 0;
+    inflight_offset = 0;
+    stall_start_ms = 0;
+}
+
+// Wait until the socket can take more data, at most wait_ms
+static bool tcp_wait_writable(uint32_t wait_ms)
+{
+    fd_set write_set;
+    FD_ZERO(&write_set);
+    FD_SET(sock, &write_set);
+    struct timeval timeout;
+    timeout.tv_sec = wait_ms / 1000;
+    timeout.tv_usec = (wait_ms % 1000) * 1000;
+    return select(sock + 1, NULL, &write_set, NULL, &timeout) > 0;
+}
+
+// Track how long the peer has not been draining; a long stall is a dead connection
+static bool tcp_note_progress(bool progressed)
+{
+    if (progressed)
     {
+        stall_start_ms = 0;
+        return true;
+    }
+
+    uint32_t now = now_ms();
+    if (stall_start_ms == 0)
+    {
+        stall_start_ms = now ? now : 1;
+        stall_count++;
+        return true;
+    }
+    if (now - stall_start_ms > TCP_STALL_TIMEOUT_MS)
+    {
+        errno = ETIMEDOUT;
+        tcp_fail("Send stalled");
         return false;
     }
+    return true;
+}
 
-    size_t data_size = sample_count * sizeof(int16_t);
+// Push the in-flight tail into the stack without blocking
+static bool tcp_flush_inflight(void)
+{
+    while (inflight_len > 0)
+    {
+        ssize_t sent = send(sock, inflight_buffer + inflight_offset, inflight_len, MSG_DONTWAIT);
+        if (sent < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return tcp_note_progress(false);
+            }
+            tcp_fail("Send");
+            return false;
+        }
+        inflight_offset += sent;
+        inflight_len -= sent;
+        total_bytes_sent += sent;
+        tcp_note_progress(true);
+    }
+    inflight_offset = 0;
+    return true;
+}
 
-    // Send data directly (no packing buffer needed for 16-bit)
-    size_t total_sent = 0;
-    const uint8_t *data_ptr = (const uint8_t *)samples;
+/**
+ * Send a block made of several byte ranges with one sendmsg() per attempt
+ *
+ * The block is refused (false, nothing written) if the previous tail cannot
+ * be flushed within TCP_SEND_WAIT_MS. Once any byte is written the block is
+ * accepted: whatever the stack does not take within TCP_SEND_WAIT_MS stays in
+ * the in-flight buffer. Blocks larger than TCP_INFLIGHT_WINDOW_BYTES may wait
+ * up to TCP_STALL_TIMEOUT_MS to keep the stream intact.
+ */
+static bool tcp_sendv(struct iovec *iov, int iov_count)
+{
+    if (!tcp_flush_inflight())
+    {
+        return false;
+    }
+    if (inflight_len > 0)
+    {
+        if (tcp_wait_writable(TCP_SEND_WAIT_MS) && !tcp_flush_inflight())
+        {
+            return false;
+        }
+        if (inflight_len > 0)
+        {
+            return false; // Still backed up: refuse the block, stream stays consistent
+        }
+    }
 
-    while (total_sent < data_size)
+    size_t remaining = 0;
+    for (int i = 0; i < iov_count; i++)
     {
-        ssize_t sent = send(sock, data_ptr + total_sent, data_size - total_sent, 0);
+        remaining += iov[i].iov_len;
+    }
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iov_count;
 
+    bool started = false;
+    while (remaining > 0)
+    {
+        ssize_t sent = sendmsg(sock, &msg, MSG_DONTWAIT);
         if (sent < 0)
         {
-            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                tcp_fail("Send");
+                return false;
+            }
+            if (!started)
             {
-                vTaskDelay(pdMS_TO_TICKS(10));
+                // Nothing of this block written yet: refuse it rather than wait long
+                if (!tcp_wait_writable(TCP_SEND_WAIT_MS))
+                {
+                    tcp_note_progress(false);
+                    return false;
+                }
                 continue;
             }
-            ESP_LOGE(TAG, "Send failed: errno %d", errno);
-            return false;
+            if (remaining <= TCP_INFLIGHT_WINDOW_BYTES)
+            {
+                break; // Keep the tail, the next call flushes it
+            }
+            // Tail larger than the window: wait it out, bounded by the stall timeout
+            if (!tcp_note_progress(false))
+            {
+                return false;
+            }
+            tcp_wait_writable(TCP_SEND_WAIT_MS);
+            continue;
+        }
+
+        started = true;
+        tcp_note_progress(sent > 0);
+        total_bytes_sent += sent;
+        remaining -= sent;
+
+        // Skip the ranges that went out completely
+        size_t skip = sent;
+        while (msg.msg_iovlen > 0 && skip >= msg.msg_iov->iov_len)
+        {
+            skip -= msg.msg_iov->iov_len;
+            msg.msg_iov++;
+            msg.msg_iovlen--;
         }
-        else if (sent == 0)
+        if (msg.msg_iovlen > 0)
         {
-            ESP_LOGW(TAG, "Connection closed");
-            return false;
+            msg.msg_iov->iov_base = (uint8_t *)msg.msg_iov->iov_base + skip;
+            msg.msg_iov->iov_len -= skip;
         }
+    }
 
-        total_sent += sent;
+    // Park the unsent tail (fits the window by construction)
+    inflight_offset = 0;
+    for (size_t i = 0; i < msg.msg_iovlen && remaining > 0; i++)
+    {
+        memcpy(inflight_buffer + inflight_len, msg.msg_iov[i].iov_base, msg.msg_iov[i].iov_len);
+        inflight_len += msg.msg_iov[i].iov_len;
     }
 
-    total_bytes_sent += data_size;
     return true;
 }
 
+void tcp_streamer_set_framing(bool enabled)
+{
+    framing_enabled = enabled;
+    ESP_LOGI(TAG, "Framed TCP mode %s", enabled ? "enabled" : "disabled");
+}
+
+void tcp_streamer_set_quality_tier(uint8_t tier)
+{
+    quality_tier = tier;
+}
+
+bool tcp_streamer_framing_enabled(void)
+{
+    return framing_enabled;
+}
+
+bool tcp_streamer_set_server(const char *ip, uint16_t port)
+{
+    struct in_addr addr;
+    if (ip == NULL || inet_pton(AF_INET, ip, &addr) != 1 || port == 0)
+    {
+        ESP_LOGE(TAG, "Invalid server address: %s:%d", ip ? ip : "(null)", port);
+        return false;
+    }
+
+    strncpy(server_ip, ip, sizeof(server_ip) - 1);
+    server_ip[sizeof(server_ip) - 1] = '\0';
+    server_port = port;
+    return true;
+}
+
+// Build the frame header for the payload that follows (sent in the same block)
+static void tcp_fill_frame_header(tcp_frame_header_t *header, uint8_t codec, uint8_t bits_per_sample,
+                                  uint32_t sample_count, uint32_t payload_bytes,
+                                  uint64_t sample_index, int64_t capture_us)
+{
+    i2s_audio_format_t format;
+    i2s_handler_get_format(&format);
+
+    memset(header, 0, sizeof(*header));
+    header->magic = TCP_FRAME_MAGIC;
+    header->version = TCP_FRAME_VERSION;
+    header->header_size = sizeof(*header);
+    header->codec = codec;
+    header->channels = format.channels;
+    header->sample_rate = format.sample_rate;
+    header->bits_per_sample = bits_per_sample;
+    header->quality_tier = quality_tier;
+    header->sequence = frame_sequence++; // Counted even if the send fails, so gaps show up
+    header->sample_count = sample_count;
+    header->payload_bytes = payload_bytes;
+    header->sample_index = sample_index;
+    header->capture_time_us = capture_us;
+    int64_t utc_us = 0;
+    if (media_clock_to_utc(capture_us, &utc_us))
+    {
+        header->utc_time_us = utc_us;
+        header->clock_flags |= TCP_FRAME_CLOCK_UTC;
+    }
+    header->clock_drift_ppb = media_clock_sample_drift_ppb();
+
+    next_sample_index = sample_index + sample_count;
+}
+
+// ✅ NEW: Native 16-bit send function (no conversion needed)
+bool tcp_streamer_send_audio_16(const int16_t *samples, size_t sample_count)
+{
+    if (sock < 0 || samples == NULL || sample_count == 0)
+    {
+        return false;
+    }
+
+    size_t bytes = sample_count * sizeof(int16_t);
+    tcp_frame_header_t header;
+    struct iovec iov[2];
+    int iov_count = 0;
+
+    // Legacy callers have no capture metadata: continue the stream, stamp with send time
+    if (framing_enabled)
+    {
+        tcp_fill_frame_header(&header, AUDIO_CODEC_PCM, 16, sample_count, bytes,
+                              next_sample_index, esp_timer_get_time());
+        iov[iov_count++] = {&header, sizeof(header)};
+    }
+
+    // Send data directly (no packing buffer needed for 16-bit)
+    iov[iov_count++] = {(void *)samples, bytes};
+    return tcp_sendv(iov, iov_count);
+}
+
+// ✅ ZERO-COPY: Send straight out of the ring buffer (any ring sample format)
+// Header and both spans leave in one sendmsg() (scatter-gather, no staging copy)
+bool tcp_streamer_send_span(const buffer_span_t *span)
+{
+    if (sock < 0 || span == NULL || span->samples[0] == 0)
+    {
+        return false;
+    }
+
+    tcp_frame_header_t header;
+    struct iovec iov[3];
+    int iov_count = 0;
+
+    if (framing_enabled)
+    {
+        size_t samples = span->samples[0] + span->samples[1];
+        tcp_fill_frame_header(&header, AUDIO_CODEC_PCM, span->sample_bytes * 8, samples,
+                              samples * span->sample_bytes, span->sample_index, span->capture_us);
+        iov[iov_count++] = {&header, sizeof(header)};
+    }
+
+    iov[iov_count++] = {span->data[0], span->samples[0] * span->sample_bytes};
+    if (span->samples[1] > 0)
+    {
+        iov[iov_count++] = {span->data[1], span->samples[1] * span->sample_bytes};
+    }
+
+    return tcp_sendv(iov, iov_count);
+}
+
+bool tcp_streamer_send_encoded(const uint8_t *data, size_t bytes, const tcp_frame_info_t *info,
+                               bool length_prefix)
+{
+    if (sock < 0 || data == NULL || bytes == 0 || bytes > UINT16_MAX)
+    {
+        return false;
+    }
+
+    tcp_frame_header_t header;
+    uint8_t prefix[2] = {(uint8_t)(bytes & 0xFF), (uint8_t)(bytes >> 8)};
+    struct iovec iov[2];
+    int iov_count = 0;
+
+    if (framing_enabled && info != NULL)
+    {
+        // Encoders take 16-bit input
+        tcp_fill_frame_header(&header, info->codec, 16, info->samples, bytes,
+                              info->sample_index, info->capture_us);
+        iov[iov_count++] = {&header, sizeof(header)};
+    }
+    else if (length_prefix)
+    {
+        iov[iov_count++] = {prefix, sizeof(prefix)};
+    }
+
+    iov[iov_count++] = {(void *)data, bytes};
+    return tcp_sendv(iov, iov_count);
+}
+
+// Outage audio from the flash spool: stamped as captured, off the live timeline
+// One frame header per IMA-ADPCM frame, like live encoded frames; the record leaves in one sendmsg()
+bool tcp_streamer_send_backfill(const flash_spool_block_t *block)
+{
+    if (sock < 0 || !framing_enabled || block == NULL || block->frames == 0 ||
+        block->frames > FLASH_SPOOL_RECORD_FRAMES_MAX)
+    {
+        return false;
+    }
+
+    tcp_frame_header_t headers[FLASH_SPOOL_RECORD_FRAMES_MAX];
+    struct iovec iov[FLASH_SPOOL_RECORD_FRAMES_MAX * 2];
+    const uint64_t samples_per_sec = (uint64_t)block->sample_rate * block->channels;
+    const uint64_t live_index = next_sample_index;
+
+    for (size_t f = 0; f < block->frames; f++)
+    {
+        size_t start = f * block->frame_samples;
+        size_t count = block->samples - start < block->frame_samples ? block->samples - start : block->frame_samples;
+        int64_t offset_us = samples_per_sec > 0 ? (int64_t)(start * 1000000ULL / samples_per_sec) : 0;
+
+        tcp_frame_header_t *header = &headers[f];
+        tcp_fill_frame_header(header, AUDIO_CODEC_IMA_ADPCM, 16, count, block->frame_bytes,
+                              block->sample_index + start, block->capture_us != 0 ? block->capture_us + offset_us : 0);
+        header->channels = block->channels;
+        header->sample_rate = block->sample_rate;
+        header->utc_time_us = block->utc_us != 0 ? block->utc_us + offset_us : 0;
+        header->clock_flags = block->utc_us != 0 ? TCP_FRAME_CLOCK_UTC : 0;
+        header->flags = TCP_FRAME_FLAG_BACKFILL | (block->previous_boot ? TCP_FRAME_FLAG_PREVIOUS_BOOT : 0);
+
+        iov[f * 2] = {header, sizeof(*header)};
+        iov[f * 2 + 1] = {(void *)(block->data + f * block->frame_bytes), block->frame_bytes};
+    }
+    next_sample_index = live_index;
+
+    return tcp_sendv(iov, (int)(block->frames * 2));
+}
+
 // ✅ LEGACY: 32-bit send function (converts to 16-bit)
 bool tcp_streamer_send_audio(const int32_t *samples, size_t sample_count)
 {
@@ -230,38 +595,49 @@ bool tcp_streamer_send_audio(const int32_t *samples, size_t sample_count)
 
     // Pack 32-bit samples to 16-bit
     int16_t *packed_samples = (int16_t *)packing_buffer;
-    for (size_t i = 0; i < sample_count; i++)
+    audio_convert_to_16(samples, packed_samples, sample_count);
+
+    tcp_frame_header_t header;
+    struct iovec iov[2];
+    int iov_count = 0;
+
+    if (framing_enabled)
     {
-        packed_samples[i] = (int16_t)(samples[i] >> 16);
+        tcp_fill_frame_header(&header, AUDIO_CODEC_PCM, 16, sample_count, packed_size,
+                              next_sample_index, esp_timer_get_time());
+        iov[iov_count++] = {&header, sizeof(header)};
     }
 
-    // Send packed data
-    size_t total_sent = 0;
-    while (total_sent < packed_size)
+    iov[iov_count++] = {packing_buffer, packed_size};
+    return tcp_sendv(iov, iov_count);
+}
+
+bool tcp_streamer_wait_writable(uint32_t wait_ms)
+{
+    if (sock < 0)
     {
-        ssize_t sent = send(sock, packing_buffer + total_sent, packed_size - total_sent, 0);
+        return false;
+    }
 
-        if (sent < 0)
-        {
-            if (errno == EAGAIN || errno == EWOULDBLOCK)
-            {
-                vTaskDelay(pdMS_TO_TICKS(10));
-                continue;
-            }
-            ESP_LOGE(TAG, "Send failed: errno %d", errno);
-            return false;
-        }
-        else if (sent == 0)
-        {
-            ESP_LOGW(TAG, "Connection closed");
-            return false;
-        }
+    if (!tcp_flush_inflight())
+    {
+        return false;
+    }
+    if (inflight_len == 0)
+    {
+        return true;
+    }
 
-        total_sent += sent;
+    if (tcp_wait_writable(wait_ms) && tcp_flush_inflight())
+    {
+        return inflight_len == 0;
     }
+    return false;
+}
 
-    total_bytes_sent += packed_size;
-    return true;
+size_t tcp_streamer_in_flight(void)
+{
+    return inflight_len;
 }
 
 bool tcp_streamer_reconnect(void)
@@ -303,6 +679,9 @@ void tcp_streamer_deinit(void)
         packing_buffer_size = 0;
         ESP_LOGI(TAG, "Packing buffer freed");
     }
+
+    free(inflight_buffer);
+    inflight_buffer = NULL;
 }
 
 void tcp_streamer_get_stats(uint64_t *bytes_sent, uint32_t *reconnect_cnt)
@@ -311,4 +690,9 @@ void tcp_streamer_get_stats(uint64_t *bytes_sent, uint32_t *reconnect_cnt)
         *bytes_sent = total_bytes_sent;
     if (reconnect_cnt)
         *reconnect_cnt = reconnect_count;
+}
+
+uint32_t tcp_streamer_get_stall_count(void)
+{
+    return stall_count;
 }
\ No newline at end of file
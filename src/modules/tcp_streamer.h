@@ -4,9 +4,97 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include "buffer_manager.h"
+#include "flash_spool.h"
 
 /**
- * Initialize TCP streamer and connect to server
+ * Framed TCP mode (TCP_FRAMING_ENABLED / tcp_framing_enabled)
+ *
+ * Every block or encoded frame is preceded by this little-endian header.
+ * sequence increases by one per frame for the whole session, including
+ * frames lost while disconnected; sample_index counts every captured
+ * sample, so after a reconnect the server can tell exactly what is missing.
+ * capture_time_us is the esp_timer time of the first sample on the
+ * sample clock, not the send time; utc_time_us is the same instant in UTC
+ * microseconds once the media clock is synced (TCP_FRAME_CLOCK_UTC, see
+ * media_clock.h). Servers should skip header_size bytes so later versions
+ * can append fields.
+ *
+ * Frames flagged TCP_FRAME_FLAG_BACKFILL are outage audio replayed from the
+ * flash spool (flash_spool.h) between live frames: IMA-ADPCM frames with
+ * the format and stamps of their capture, not part of the live
+ * sample_index run. The last frame of a record may have a sample_count
+ * below the frame size; the rest of the frame is padding. With TCP_FRAME_FLAG_PREVIOUS_BOOT their sample_index and
+ * capture_time_us belong to the boot before the last restart; only
+ * utc_time_us places them then.
+ */
+#define TCP_FRAME_MAGIC 0x52545341 // "ASTR" on the wire
+#define TCP_FRAME_VERSION 4 // 2: quality_tier (was reserved), 3: clock_flags, utc_time_us, clock_drift_ppb, 4: flags
+#define TCP_FRAME_CLOCK_UTC (1 << 0) // utc_time_us is valid
+#define TCP_FRAME_FLAG_BACKFILL (1 << 0)      // Replayed from the flash spool, not live
+#define TCP_FRAME_FLAG_PREVIOUS_BOOT (1 << 1) // Backfill captured before the last restart
+
+typedef struct
+{
+    uint32_t magic;
+    uint8_t version;
+    uint8_t header_size;     // sizeof(tcp_frame_header_t)
+    uint8_t codec;           // audio_codec_t of the payload
+    uint8_t channels;        // 1 = mono, 2 = interleaved stereo
+    uint32_t sample_rate;    // Hz
+    uint8_t bits_per_sample; // 16, 24 (packed) or 32 before encoding
+    uint8_t quality_tier;    // Adaptive quality tier, 0 = configured quality
+    uint8_t clock_flags;     // TCP_FRAME_CLOCK_*
+    uint8_t flags;           // TCP_FRAME_FLAG_* (was reserved)
+    uint32_t sequence;       // Frame counter
+    uint32_t sample_count;   // Interleaved samples in the payload
+    uint32_t payload_bytes;  // Bytes following this header
+    uint64_t sample_index;   // Capture stream index of the first sample
+    int64_t capture_time_us; // Capture time of the first sample
+    int64_t utc_time_us;     // ... in UTC (0 while not synced)
+    int32_t clock_drift_ppb; // Measured sample clock drift (+ = fast)
+} __attribute__((packed)) tcp_frame_header_t;
+
+/**
+ * Capture metadata for one encoded frame
+ */
+typedef struct
+{
+    uint64_t sample_index; // Capture stream index of the first sample
+    int64_t capture_us;    // Capture time of the first sample
+    uint32_t samples;      // Interleaved samples encoded in the frame
+    uint8_t codec;         // audio_codec_t
+} tcp_frame_info_t;
+
+/**
+ * Enable or disable framed TCP mode
+ * Call before tcp_streamer_init(); the server needs to know the mode.
+ * @param enabled true to prefix every block with tcp_frame_header_t
+ */
+void tcp_streamer_set_framing(bool enabled);
+
+/**
+ * Check whether framed TCP mode is active
+ */
+bool tcp_streamer_framing_enabled(void);
+
+/**
+ * Set the quality tier carried in the frame header
+ * @param tier Adaptive quality tier (0 = configured quality)
+ */
+void tcp_streamer_set_quality_tier(uint8_t tier);
+
+/**
+ * Set the server address (takes effect on the next init/reconnect)
+ * @param ip IPv4 address in dotted notation
+ * @param port Server port
+ * @return true if the address was accepted (TCP_SERVER_IP:TCP_SERVER_PORT is kept otherwise)
+ */
+bool tcp_streamer_set_server(const char *ip, uint16_t port);
+
+/**
+ * Allocate the TCP streamer buffers (does not connect or block)
+ * The first connection is made with tcp_streamer_reconnect().
  */
 bool tcp_streamer_init(void);
 
@@ -15,6 +103,35 @@ bool tcp_streamer_init(void);
  */
 bool tcp_streamer_is_connected(void);
 
+/**
+ * Non-blocking send model
+ *
+ * The socket is non-blocking and every wait is a select() of at most
+ * TCP_SEND_WAIT_MS. Each send call hands one whole block to the stack with
+ * a single sendmsg(). A block is either refused (false, nothing written, the
+ * stream stays consistent) or accepted; an accepted block's unsent tail is
+ * kept in flight (at most TCP_INFLIGHT_WINDOW_BYTES) and flushed first by the
+ * next call. A peer that drains nothing for TCP_STALL_TIMEOUT_MS is treated
+ * as disconnected.
+ */
+
+/**
+ * Flush in-flight bytes and check whether the next block can go out
+ * @param wait_ms Longest time to wait for the socket to drain
+ * @return true if nothing is in flight (a send is likely to be accepted)
+ */
+bool tcp_streamer_wait_writable(uint32_t wait_ms);
+
+/**
+ * Get bytes accepted but not yet taken by the TCP stack
+ */
+size_t tcp_streamer_in_flight(void);
+
+/**
+ * Get number of send stalls (socket full) since boot
+ */
+uint32_t tcp_streamer_get_stall_count(void);
+
 /**
  * Send audio samples over TCP (16-bit samples)
  * @param samples Array of 16-bit audio samples
@@ -23,6 +140,33 @@ bool tcp_streamer_is_connected(void);
  */
 bool tcp_streamer_send_audio_16(const int16_t *samples, size_t sample_count);
 
+/**
+ * Send ring buffer spans over TCP without copying (ring sample format)
+ * The both spans are sent back to back on the stream.
+ * @param span Spans obtained from buffer_manager_peek_read()
+ * @return true if sent successfully
+ */
+bool tcp_streamer_send_span(const buffer_span_t *span);
+
+/**
+ * Send one encoded audio frame over TCP
+ * In framed mode the frame header replaces the length prefix.
+ * @param data Encoded frame
+ * @param bytes Frame size (at most 65535)
+ * @param info Capture metadata for the frame header
+ * @param length_prefix Prepend a 16-bit little-endian length (variable-size codecs)
+ * @return true if sent successfully
+ */
+bool tcp_streamer_send_encoded(const uint8_t *data, size_t bytes, const tcp_frame_info_t *info,
+                               bool length_prefix);
+
+/**
+ * Send one spooled record as backfill frames, one per IMA-ADPCM frame (framed mode only)
+ * @param block Record from flash_spool_peek()
+ * @return true if the record was accepted (false if refused, unframed or disconnected)
+ */
+bool tcp_streamer_send_backfill(const flash_spool_block_t *block);
+
 /**
  * Send audio samples over TCP (legacy 32-bit interface)
  * @param samples Array of 32-bit audio samples
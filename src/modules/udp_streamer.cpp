@@ -1,6 +1,11 @@
 #include "udp_streamer.h"
+#include "i2s_handler.h"
+#include "audio_convert.h"
+#include "media_clock.h"
 #include "../config.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_netif.h"
 #include "lwip/sockets.h"
 #include "lwip/netdb.h"
 #include "freertos/FreeRTOS.h"
@@ -16,27 +21,170 @@ static uint32_t total_packets_sent = 0;
 static uint32_t lost_packets = 0;
 static uint32_t packet_sequence = 0;
 
-// UDP configuration buffer for packet headers
+// Unicast destination (set from the saved config, used by the next connect)
+static char server_ip[16] = UDP_SERVER_IP;
+static uint16_t server_port = UDP_SERVER_PORT;
+
+// Multicast destination (replaces server_ip when enabled)
+static bool multicast_enabled = UDP_MULTICAST_ENABLED;
+static char multicast_group[16] = UDP_MULTICAST_GROUP;
+static uint16_t multicast_port = UDP_MULTICAST_PORT;
+static uint8_t multicast_ttl = UDP_MULTICAST_TTL;
+
+// Conversion buffer for udp_streamer_send_audio()
 static uint8_t *udp_buffer = NULL;
 static size_t udp_buffer_size = 0;
 
 // UDP packet header structure
+// Every datagram carries one MTU-sized slice of a ring block, so a lost packet
+// costs only its own samples; sample_offset places each slice on the capture
+// timeline (the low 32 bits of the stream index TCP frames carry as sample_index)
+// capture_time_us is the capture time of the first sample on the media clock:
+// UTC microseconds with bit 14 set, esp_timer microseconds until it is synced
 typedef struct {
-    uint32_t sequence;     // Packet sequence number
-    uint32_t timestamp;    // Timestamp in milliseconds
-    uint16_t sample_count; // Number of samples in this packet
-    uint16_t flags;        // Flags (bit 0: start of stream, bit 1: end of stream)
+    uint32_t sequence;        // Packet sequence number (per datagram)
+    int64_t capture_time_us;  // Capture time of the first sample
+    uint32_t sample_offset;   // Capture stream index of the first sample (wraps at 2^32)
+    uint16_t sample_count;    // Number of samples in this packet
+    uint16_t flags;           // Flags (bit 0: start of stream, bit 1: end of stream,
+                              //        bits 2-3: sample width, bit 4: stereo interleaved,
+                              //        bit 5: FEC parity packet, bit 6: FEC-protected data,
+                              //        bits 7-8: codec, see audio_codec_t,
+                              //        bits 9-10: quality tier, bits 11-13: sample rate code,
+                              //        bit 14: capture_time_us is UTC, bit 15: backfill)
+    int32_t clock_drift_ppb;  // Measured sample clock drift (+ = fast)
 } __attribute__((packed)) udp_packet_header_t;
 
+#define UDP_FLAG_START (1 << 0)
+#define UDP_FLAG_END (1 << 1)
+
+// Sample width codes for header flags bits 2-3
+#define UDP_FLAG_WIDTH_SHIFT 2
+#define UDP_FLAG_WIDTH_16 0 // 16-bit little-endian
+#define UDP_FLAG_WIDTH_24 1 // 24-bit packed little-endian
+#define UDP_FLAG_WIDTH_32 2 // 32-bit raw I2S slot
+#define UDP_FLAG_STEREO (1 << 4)
+#define UDP_FLAG_FEC_PARITY (1 << 5)
+#define UDP_FLAG_FEC (1 << 6)
+#define UDP_FLAG_CODEC_SHIFT 7 // 0 = PCM, 1 = IMA-ADPCM, 2 = Opus, 3 = silence
+#define UDP_FLAG_CODEC_MASK 0x3
+#define UDP_FLAG_TIER_SHIFT 9 // Adaptive quality tier, 0 = configured quality
+#define UDP_FLAG_TIER_MASK 0x3
+#define UDP_FLAG_RATE_SHIFT 11 // 1 = 8k, 2 = 16k, 3 = 22.05k, 4 = 32k, 5 = 44.1k, 6 = 48k (0 = not signalled)
+#define UDP_FLAG_RATE_MASK 0x7
+#define UDP_FLAG_CLOCK_UTC (1 << 14)
+#define UDP_FLAG_BACKFILL (1 << 15) // Replayed from the flash spool, behind the live stream on the same timeline
+
+// Audio bytes that fit in one unfragmented datagram
+#define UDP_PAYLOAD_MAX_SIZE (UDP_PACKET_MAX_SIZE - sizeof(udp_packet_header_t))
+// With FEC the parity packet wraps a whole data datagram, so data leaves room for one more header
+#define UDP_FEC_PAYLOAD_MAX_SIZE (UDP_PAYLOAD_MAX_SIZE - sizeof(udp_packet_header_t))
+
+static uint64_t next_sample_index = 0; // Used by the legacy send paths
+static bool stream_start_pending = true;
+static uint8_t quality_tier = 0;
+
+// XOR parity FEC
+// The parity payload is the XOR of every data datagram (header + audio) in
+// the group, zero-padded to the longest one. A receiver missing exactly one
+// packet of the group XORs the others into the parity payload to rebuild it.
+// Parity header: sequence/sample_offset of the first covered packet,
+// sample_count = number of covered packets. Parity packets do not consume
+// data sequence numbers.
+static bool fec_enabled = UDP_FEC_ENABLED;
+static uint8_t fec_group_size = UDP_FEC_GROUP_SIZE;
+static uint8_t fec_parity[UDP_PACKET_MAX_SIZE];
+static size_t fec_parity_len = 0;
+static uint8_t fec_group_count = 0;
+static uint32_t fec_first_sequence = 0;
+static uint32_t fec_first_offset = 0;
+static int64_t fec_first_capture_us = 0;
+static uint16_t fec_first_clock_flags = 0;
+
+static void fec_reset_group(void)
+{
+    memset(fec_parity, 0, fec_parity_len);
+    fec_parity_len = 0;
+    fec_group_count = 0;
+}
+
+static uint16_t udp_format_flags_for(size_t sample_bytes, uint8_t channels, uint32_t sample_rate)
+{
+    uint16_t width = UDP_FLAG_WIDTH_16;
+    if (sample_bytes == 3)
+        width = UDP_FLAG_WIDTH_24;
+    else if (sample_bytes == 4)
+        width = UDP_FLAG_WIDTH_32;
+
+    uint16_t flags = width << UDP_FLAG_WIDTH_SHIFT;
+    if (channels == AUDIO_CHANNELS_STEREO)
+    {
+        flags |= UDP_FLAG_STEREO;
+    }
+
+    // The adaptive quality controller may change the rate mid-stream
+    static const uint32_t rate_codes[] = {AUDIO_SAMPLE_RATE_8K, AUDIO_SAMPLE_RATE_16K, AUDIO_SAMPLE_RATE_22K,
+                                          AUDIO_SAMPLE_RATE_32K, AUDIO_SAMPLE_RATE_44K, AUDIO_SAMPLE_RATE_48K};
+    for (size_t i = 0; i < sizeof(rate_codes) / sizeof(rate_codes[0]); i++)
+    {
+        if (sample_rate == rate_codes[i])
+        {
+            flags |= (uint16_t)((i + 1) << UDP_FLAG_RATE_SHIFT);
+            break;
+        }
+    }
+    flags |= (uint16_t)((quality_tier & UDP_FLAG_TIER_MASK) << UDP_FLAG_TIER_SHIFT);
+    return flags;
+}
+
+static uint16_t udp_format_flags(size_t sample_bytes)
+{
+    i2s_audio_format_t format;
+    i2s_handler_get_format(&format);
+    return udp_format_flags_for(sample_bytes, format.channels, format.sample_rate);
+}
+
+// Multicast TX options: hop limit, STA interface, no loopback
+static void udp_setup_multicast(void)
+{
+    uint8_t ttl = multicast_ttl;
+    if (setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) != 0)
+    {
+        ESP_LOGW(TAG, "Failed to set multicast TTL: errno %d", errno);
+    }
+
+    uint8_t loop = 0;
+    setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+
+    // Pin egress to the WiFi STA interface rather than lwIP's default netif
+    esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    esp_netif_ip_info_t ip_info;
+    if (netif != NULL && esp_netif_get_ip_info(netif, &ip_info) == ESP_OK && ip_info.ip.addr != 0)
+    {
+        struct in_addr iface;
+        iface.s_addr = ip_info.ip.addr;
+        if (setsockopt(sock, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface)) != 0)
+        {
+            ESP_LOGW(TAG, "Failed to set multicast interface: errno %d", errno);
+        }
+    }
+
+    ESP_LOGI(TAG, "Multicast TTL %d", multicast_ttl);
+}
+
 static bool udp_connect(void)
 {
     memset(&server_addr, 0, sizeof(server_addr));
 
+    const char *dest_ip = multicast_enabled ? multicast_group : server_ip;
+    uint16_t dest_port = multicast_enabled ? multicast_port : server_port;
+
     server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(UDP_SERVER_PORT);
-    inet_pton(AF_INET, UDP_SERVER_IP, &server_addr.sin_addr);
+    server_addr.sin_port = htons(dest_port);
+    inet_pton(AF_INET, dest_ip, &server_addr.sin_addr);
 
-    ESP_LOGI(TAG, "Setting up UDP for %s:%d...", UDP_SERVER_IP, UDP_SERVER_PORT);
+    ESP_LOGI(TAG, "Setting up UDP %s for %s:%d...",
+             multicast_enabled ? "multicast" : "unicast", dest_ip, dest_port);
 
     sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
     if (sock < 0)
@@ -45,6 +193,11 @@ static bool udp_connect(void)
         return false;
     }
 
+    if (multicast_enabled)
+    {
+        udp_setup_multicast();
+    }
+
     // Set socket options for UDP with optimized values
     int reuse = 1;
     setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
@@ -85,12 +238,12 @@ static bool udp_connect(void)
 
 bool udp_streamer_init(void)
 {
-    // Allocate UDP buffer (header + audio data)
+    // Allocate conversion buffer for the legacy 32-bit interface
     // Calculate max audio payload based on configuration constants instead of magic number
     size_t max_audio_payload = TCP_SEND_SAMPLES * BYTES_PER_SAMPLE; // Max samples × bytes per sample
-    // Add safety margin for packet headers and potential overhead
+    // Add safety margin for potential overhead
     max_audio_payload += 1024;
-    udp_buffer_size = sizeof(udp_packet_header_t) + max_audio_payload;
+    udp_buffer_size = max_audio_payload;
     udp_buffer = (uint8_t *)malloc(udp_buffer_size);
 
     if (udp_buffer == NULL)
@@ -101,21 +254,19 @@ bool udp_streamer_init(void)
 
     ESP_LOGI(TAG, "UDP buffer allocated: %zu bytes", udp_buffer_size);
 
-    // Initialize UDP socket
-    if (!udp_connect())
-    {
-        free(udp_buffer);
-        udp_buffer = NULL;
-        return false;
-    }
+    // ✅ FAST BOOT: the socket is opened by udp_streamer_reconnect() once the network is up
 
     // Reset statistics
     total_bytes_sent = 0;
     total_packets_sent = 0;
     lost_packets = 0;
     packet_sequence = 0;
+    next_sample_index = 0;
+    stream_start_pending = true;
+    fec_reset_group();
 
-    ESP_LOGI(TAG, "UDP streamer initialized");
+    ESP_LOGI(TAG, "UDP streamer initialized (max %u payload bytes per datagram)",
+             (unsigned)(fec_enabled ? UDP_FEC_PAYLOAD_MAX_SIZE : UDP_PAYLOAD_MAX_SIZE));
     return true;
 }
 
@@ -124,122 +275,426 @@ bool udp_streamer_is_connected(void)
     return sock >= 0;
 }
 
-bool udp_streamer_send_audio_16(const int16_t *samples, size_t sample_count)
+// Send one datagram, retrying briefly while lwIP/WiFi TX queues drain
+static bool udp_send_packet(struct iovec *iov, int iov_count, size_t packet_size)
 {
-    if (sock < 0 || samples == NULL || sample_count == 0)
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = &server_addr;
+    msg.msg_namelen = sizeof(server_addr);
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iov_count;
+
+    ssize_t sent = -1;
+    for (int attempt = 0; attempt <= UDP_SEND_RETRY_COUNT; attempt++)
     {
-        return false;
+        sent = sendmsg(sock, &msg, 0);
+        if (sent >= 0 || (errno != ENOMEM && errno != EAGAIN && errno != EWOULDBLOCK))
+        {
+            break;
+        }
+        // A burst of packets can outrun the WiFi TX queue; let it drain
+        vTaskDelay(1);
     }
 
-    size_t data_size = sample_count * sizeof(int16_t);
-    size_t packet_size = sizeof(udp_packet_header_t) + data_size;
-
-    if (packet_size > udp_buffer_size)
+    if (sent < 0)
     {
-        ESP_LOGE(TAG, "Data too large for UDP buffer");
+        if (errno == ENOMEM || errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            ESP_LOGW(TAG, "UDP send timeout, packet lost");
+        }
+        else
+        {
+            ESP_LOGE(TAG, "UDP send failed: errno %d", errno);
+        }
+        lost_packets++;
+        return false;
+    }
+    else if ((size_t)sent != packet_size)
+    {
+        ESP_LOGW(TAG, "Partial UDP send: %zd/%zu bytes", sent, packet_size);
+        lost_packets++;
         return false;
     }
 
-    // Prepare packet header
-    udp_packet_header_t *header = (udp_packet_header_t *)udp_buffer;
-    header->sequence = packet_sequence++;
-    header->timestamp = xTaskGetTickCount() * portTICK_PERIOD_MS;
-    header->sample_count = sample_count;
-    header->flags = 0; // Normal packet
+    total_packets_sent++;
+    return true;
+}
 
-    // Copy audio data after header
-    memcpy(udp_buffer + sizeof(udp_packet_header_t), samples, data_size);
+bool udp_streamer_set_server(const char *ip, uint16_t port)
+{
+    struct in_addr addr;
+    if (ip == NULL || inet_pton(AF_INET, ip, &addr) != 1 || port == 0)
+    {
+        ESP_LOGE(TAG, "Invalid server address: %s:%d", ip ? ip : "(null)", port);
+        return false;
+    }
 
-    // Send UDP packet
-    ssize_t sent = sendto(sock, udp_buffer, packet_size, 0,
-                         (struct sockaddr *)&server_addr, sizeof(server_addr));
+    strncpy(server_ip, ip, sizeof(server_ip) - 1);
+    server_ip[sizeof(server_ip) - 1] = '\0';
+    server_port = port;
+    return true;
+}
 
-    if (sent < 0)
+bool udp_streamer_set_multicast(bool enabled, const char *group, uint16_t port, uint8_t ttl)
+{
+    if (enabled)
     {
-        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        struct in_addr addr;
+        if (group == NULL || inet_pton(AF_INET, group, &addr) != 1 || !IN_MULTICAST(ntohl(addr.s_addr)))
         {
-            ESP_LOGW(TAG, "UDP send timeout, packet lost");
-            lost_packets++;
+            ESP_LOGE(TAG, "Invalid multicast group: %s", group ? group : "(null)");
             return false;
         }
-        else
+        if (port == 0 || ttl == 0)
         {
-            ESP_LOGE(TAG, "UDP send failed: errno %d", errno);
-            lost_packets++;
+            ESP_LOGE(TAG, "Invalid multicast port/TTL: %d/%d", port, ttl);
             return false;
         }
+
+        strncpy(multicast_group, group, sizeof(multicast_group) - 1);
+        multicast_group[sizeof(multicast_group) - 1] = '\0';
+        multicast_port = port;
+        multicast_ttl = ttl;
     }
-    else if (sent != packet_size)
+
+    multicast_enabled = enabled;
+    return true;
+}
+
+void udp_streamer_set_quality_tier(uint8_t tier)
+{
+    quality_tier = tier;
+}
+
+bool udp_streamer_set_fec(bool enabled, uint8_t group_size)
+{
+    if (group_size < UDP_FEC_GROUP_SIZE_MIN || group_size > UDP_FEC_GROUP_SIZE_MAX)
     {
-        ESP_LOGW(TAG, "Partial UDP send: %zd/%zu bytes", sent, packet_size);
-        lost_packets++;
+        ESP_LOGE(TAG, "Invalid FEC group size: %d", group_size);
         return false;
     }
 
-    total_bytes_sent += data_size;
-    total_packets_sent++;
+    fec_enabled = enabled;
+    fec_group_size = group_size;
+    fec_reset_group();
+
+    if (enabled)
+    {
+        ESP_LOGI(TAG, "FEC enabled: 1 parity per %d packets (%d%% overhead)",
+                 group_size, 100 / group_size);
+    }
     return true;
 }
 
-bool udp_streamer_send_audio(const int32_t *samples, size_t sample_count)
+// Fold one data datagram into the group parity
+static void fec_accumulate(const struct iovec *iov, int iov_count)
+{
+    size_t pos = 0;
+    for (int i = 0; i < iov_count; i++)
+    {
+        const uint8_t *src = (const uint8_t *)iov[i].iov_base;
+        for (size_t j = 0; j < iov[i].iov_len; j++)
+        {
+            fec_parity[pos++] ^= src[j];
+        }
+    }
+    if (pos > fec_parity_len)
+    {
+        fec_parity_len = pos;
+    }
+}
+
+static void fec_send_parity(uint16_t format_flags)
+{
+    udp_packet_header_t header;
+    header.sequence = fec_first_sequence;
+    header.capture_time_us = fec_first_capture_us;
+    header.sample_offset = fec_first_offset;
+    header.sample_count = fec_group_count;
+    header.flags = format_flags | UDP_FLAG_FEC_PARITY | fec_first_clock_flags;
+    header.clock_drift_ppb = media_clock_sample_drift_ppb();
+
+    struct iovec iov[2];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = fec_parity;
+    iov[1].iov_len = fec_parity_len;
+
+    udp_send_packet(iov, 2, sizeof(header) + fec_parity_len);
+    fec_reset_group();
+}
+
+bool udp_streamer_send_audio_16(const int16_t *samples, size_t sample_count)
 {
     if (sock < 0 || samples == NULL || sample_count == 0)
     {
         return false;
     }
 
-    size_t data_size = sample_count * sizeof(int16_t); // After conversion to 16-bit
-    size_t packet_size = sizeof(udp_packet_header_t) + data_size;
+    buffer_span_t span;
+    span.data[0] = (uint8_t *)samples; // sendmsg() only reads
+    span.samples[0] = sample_count;
+    span.data[1] = NULL;
+    span.samples[1] = 0;
+    span.sample_bytes = sizeof(int16_t);
+    span.sample_index = next_sample_index; // No capture metadata: continue the stream, stamp at send time
+    span.capture_us = 0;
+    return udp_streamer_send_span(&span);
+}
 
-    if (packet_size > udp_buffer_size)
+/**
+ * Send one data datagram: sequence, stream start, FEC accounting
+ *
+ * @param header Stamped header (sample_offset, sample_count, flags, capture time)
+ * @param iov iov[1..] hold the payload; iov[0] is filled with the header
+ * @param iov_count Number of iov entries including the header slot
+ * @param payload_bytes Total payload bytes in iov[1..]
+ * @param format_flags Width/stereo/codec flags (for the parity packet)
+ */
+static bool udp_emit_datagram(udp_packet_header_t *header, struct iovec *iov, int iov_count,
+                              size_t payload_bytes, uint16_t format_flags)
+{
+    header->sequence = packet_sequence++;
+    if (stream_start_pending)
+    {
+        header->flags |= UDP_FLAG_START;
+    }
+    if (fec_enabled)
+    {
+        header->flags |= UDP_FLAG_FEC;
+    }
+
+    iov[0].iov_base = header;
+    iov[0].iov_len = sizeof(*header);
+
+    if (fec_enabled)
+    {
+        if (fec_group_count == 0)
+        {
+            fec_first_sequence = header->sequence;
+            fec_first_offset = header->sample_offset;
+            fec_first_capture_us = header->capture_time_us;
+            fec_first_clock_flags = header->flags & UDP_FLAG_CLOCK_UTC;
+        }
+        // Locally dropped packets stay in the parity: the receiver can still rebuild them
+        fec_accumulate(iov, iov_count);
+        fec_group_count++;
+    }
+
+    bool sent = udp_send_packet(iov, iov_count, sizeof(*header) + payload_bytes);
+    if (sent)
+    {
+        stream_start_pending = false;
+        total_bytes_sent += payload_bytes;
+    }
+
+    if (fec_enabled && fec_group_count >= fec_group_size)
+    {
+        fec_send_parity(format_flags);
+    }
+    return sent;
+}
+
+/**
+ * Emit one live data datagram
+ *
+ * @param iov iov[1..] hold the payload; iov[0] is filled with the header
+ * @param iov_count Number of iov entries including the header slot
+ * @param payload_bytes Total payload bytes in iov[1..]
+ * @param samples Samples represented by the payload
+ * @param sample_index Capture stream index of the first sample
+ * @param capture_us esp_timer capture time of the first sample (0 = now)
+ * @param format_flags Width/stereo/codec flags
+ */
+static bool udp_emit_packet(struct iovec *iov, int iov_count, size_t payload_bytes, size_t samples,
+                            uint64_t sample_index, int64_t capture_us, uint16_t format_flags)
+{
+    udp_packet_header_t header;
+    header.sample_offset = (uint32_t)sample_index;
+    header.sample_count = samples;
+    header.flags = format_flags;
+    int64_t stamp_us = 0;
+    if (media_clock_to_utc(capture_us != 0 ? capture_us : esp_timer_get_time(), &stamp_us))
+    {
+        header.flags |= UDP_FLAG_CLOCK_UTC;
+    }
+    header.capture_time_us = stamp_us;
+    header.clock_drift_ppb = media_clock_sample_drift_ppb();
+
+    bool sent = udp_emit_datagram(&header, iov, iov_count, payload_bytes, format_flags);
+    next_sample_index = sample_index + samples;
+    return sent;
+}
+
+size_t udp_streamer_max_payload(void)
+{
+    return fec_enabled ? UDP_FEC_PAYLOAD_MAX_SIZE : UDP_PAYLOAD_MAX_SIZE;
+}
+
+// ✅ ZERO-COPY: Packetize ring spans into MTU-sized datagrams with sendmsg()
+bool udp_streamer_send_span(const buffer_span_t *span)
+{
+    if (sock < 0 || span == NULL || span->samples[0] == 0 || span->sample_bytes == 0)
     {
-        ESP_LOGE(TAG, "Data too large for UDP buffer");
         return false;
     }
 
-    // Prepare packet header
-    udp_packet_header_t *header = (udp_packet_header_t *)udp_buffer;
-    header->sequence = packet_sequence++;
-    header->timestamp = xTaskGetTickCount() * portTICK_PERIOD_MS;
-    header->sample_count = sample_count;
-    header->flags = 0; // Normal packet
+    i2s_audio_format_t format;
+    i2s_handler_get_format(&format);
+
+    // Whole frames per packet so stereo pairs never straddle datagrams
+    size_t frame_samples = format.channels > 0 ? format.channels : 1;
+    size_t packet_samples = udp_streamer_max_payload() / span->sample_bytes;
+    packet_samples -= packet_samples % frame_samples;
+
+    // Later slices are stamped from the block's first sample at the nominal rate
+    const uint64_t samples_per_sec = (uint64_t)format.sample_rate * frame_samples;
+    uint16_t format_flags = udp_format_flags(span->sample_bytes);
+    size_t remaining = span->samples[0] + span->samples[1];
+    size_t part = 0;
+    size_t part_offset = 0;
+    size_t slice_start = 0;
+    bool all_sent = true;
+
+    // Batch: the whole block goes out in one wakeup, one datagram per slice
+    while (remaining > 0)
+    {
+        size_t count = remaining < packet_samples ? remaining : packet_samples;
+
+        // Gather the slice after the header slot; it may straddle the ring wrap (two spans)
+        struct iovec iov[3];
+        int iov_count = 1;
+
+        size_t gathered = 0;
+        while (gathered < count)
+        {
+            size_t part_left = span->samples[part] - part_offset;
+            size_t take = (count - gathered) < part_left ? (count - gathered) : part_left;
+
+            iov[iov_count].iov_base = span->data[part] + part_offset * span->sample_bytes;
+            iov[iov_count].iov_len = take * span->sample_bytes;
+            iov_count++;
+
+            gathered += take;
+            part_offset += take;
+            if (part_offset == span->samples[part])
+            {
+                part++;
+                part_offset = 0;
+            }
+        }
+
+        int64_t capture_us = 0;
+        if (span->capture_us != 0 && samples_per_sec > 0)
+        {
+            capture_us = span->capture_us + (int64_t)(slice_start * 1000000ULL / samples_per_sec);
+        }
+        if (!udp_emit_packet(iov, iov_count, count * span->sample_bytes, count, span->sample_index + slice_start,
+                             capture_us, format_flags))
+        {
+            all_sent = false;
+        }
+        remaining -= count;
+        slice_start += count;
+    }
+
+    return all_sent;
+}
 
-    // Convert 32-bit samples to 16-bit and copy after header
-    int16_t *audio_data = (int16_t *)(udp_buffer + sizeof(udp_packet_header_t));
-    for (size_t i = 0; i < sample_count; i++)
+bool udp_streamer_send_encoded(const uint8_t *data, size_t bytes, size_t samples, uint8_t codec,
+                               uint64_t sample_index, int64_t capture_us)
+{
+    if (sock < 0 || data == NULL || bytes == 0)
     {
-        audio_data[i] = (int16_t)(samples[i] >> 16);
+        return false;
     }
 
-    // Send UDP packet
-    ssize_t sent = sendto(sock, udp_buffer, packet_size, 0,
-                         (struct sockaddr *)&server_addr, sizeof(server_addr));
+    if (bytes > udp_streamer_max_payload())
+    {
+        ESP_LOGE(TAG, "Encoded payload too large: %zu bytes", bytes);
+        return false;
+    }
 
-    if (sent < 0)
+    uint16_t format_flags = udp_format_flags(sizeof(int16_t));
+    format_flags |= (uint16_t)((codec & UDP_FLAG_CODEC_MASK) << UDP_FLAG_CODEC_SHIFT);
+
+    struct iovec iov[2];
+    iov[1].iov_base = (void *)data; // sendmsg() only reads
+    iov[1].iov_len = bytes;
+
+    return udp_emit_packet(iov, 2, bytes, samples, sample_index, capture_us, format_flags);
+}
+
+// Outage audio from the flash spool: whole IMA-ADPCM frames per datagram, stamped as captured
+bool udp_streamer_send_backfill(const flash_spool_block_t *block)
+{
+    if (sock < 0 || block == NULL || block->frames == 0 || block->frame_bytes == 0)
+    {
+        return false;
+    }
+
+    const size_t packet_frames = udp_streamer_max_payload() / block->frame_bytes;
+    if (packet_frames == 0)
+    {
+        return false;
+    }
+    const uint64_t samples_per_sec = (uint64_t)block->sample_rate * (block->channels > 0 ? block->channels : 1);
+    uint16_t format_flags = udp_format_flags_for(sizeof(int16_t), block->channels, block->sample_rate);
+    format_flags |= (uint16_t)((AUDIO_CODEC_IMA_ADPCM & UDP_FLAG_CODEC_MASK) << UDP_FLAG_CODEC_SHIFT);
+
+    // A record from before a restart can only be placed by its UTC stamp
+    int64_t stamp_us = block->utc_us != 0 ? block->utc_us : (block->previous_boot ? 0 : block->capture_us);
+    bool all_sent = true;
+
+    for (size_t f = 0; f < block->frames; f += packet_frames)
     {
-        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        size_t frames = block->frames - f < packet_frames ? block->frames - f : packet_frames;
+        size_t start = f * block->frame_samples;
+        size_t end = (f + frames) * block->frame_samples;
+        if (end > block->samples)
         {
-            ESP_LOGW(TAG, "UDP send timeout, packet lost");
-            lost_packets++;
-            return false;
+            end = block->samples; // Padded last frame
         }
-        else
+
+        udp_packet_header_t header;
+        header.sample_offset = (uint32_t)(block->sample_index + start);
+        header.sample_count = end - start;
+        header.flags = format_flags | UDP_FLAG_BACKFILL | (block->utc_us != 0 ? UDP_FLAG_CLOCK_UTC : 0);
+        header.capture_time_us = stamp_us != 0 && samples_per_sec > 0
+                                     ? stamp_us + (int64_t)(start * 1000000ULL / samples_per_sec)
+                                     : 0;
+        header.clock_drift_ppb = media_clock_sample_drift_ppb();
+
+        struct iovec iov[2];
+        iov[1].iov_base = (void *)(block->data + f * block->frame_bytes); // sendmsg() only reads
+        iov[1].iov_len = frames * block->frame_bytes;
+        if (!udp_emit_datagram(&header, iov, 2, iov[1].iov_len, format_flags))
         {
-            ESP_LOGE(TAG, "UDP send failed: errno %d", errno);
-            lost_packets++;
-            return false;
+            all_sent = false;
         }
     }
-    else if (sent != packet_size)
+    return all_sent;
+}
+
+bool udp_streamer_send_audio(const int32_t *samples, size_t sample_count)
+{
+    if (sock < 0 || samples == NULL || sample_count == 0)
+    {
+        return false;
+    }
+
+    size_t data_size = sample_count * sizeof(int16_t); // After conversion to 16-bit
+
+    if (data_size > udp_buffer_size)
     {
-        ESP_LOGW(TAG, "Partial UDP send: %zd/%zu bytes", sent, packet_size);
-        lost_packets++;
+        ESP_LOGE(TAG, "Data too large for UDP buffer");
         return false;
     }
 
-    total_bytes_sent += data_size;
-    total_packets_sent++;
-    return true;
+    // Convert 32-bit samples to 16-bit, then packetize like any other block
+    audio_convert_to_16(samples, (int16_t *)udp_buffer, sample_count);
+    return udp_streamer_send_audio_16((const int16_t *)udp_buffer, sample_count);
 }
 
 bool udp_streamer_reconnect(void)
@@ -252,6 +707,8 @@ bool udp_streamer_reconnect(void)
         sock = -1;
     }
 
+    stream_start_pending = true;
+    fec_reset_group();
     return udp_connect();
 }
 
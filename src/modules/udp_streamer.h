@@ -4,9 +4,12 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include "buffer_manager.h"
+#include "flash_spool.h"
 
 /**
- * Initialize UDP streamer
+ * Allocate the UDP streamer buffers (does not open the socket)
+ * The socket is opened with udp_streamer_reconnect().
  */
 bool udp_streamer_init(void);
 
@@ -17,12 +20,58 @@ bool udp_streamer_is_connected(void);
 
 /**
  * Send audio samples over UDP (16-bit samples)
+ * Split into datagrams of at most UDP_PACKET_MAX_SIZE bytes.
  * @param samples Array of 16-bit audio samples
  * @param sample_count Number of samples
  * @return true if sent successfully
  */
 bool udp_streamer_send_audio_16(const int16_t *samples, size_t sample_count);
 
+/**
+ * Send ring buffer spans over UDP without copying (ring sample format)
+ * The block is split into datagrams of at most UDP_PACKET_MAX_SIZE bytes
+ * (whole frames, no IP fragmentation), each gathered from the spans with
+ * sendmsg() and carrying its own sequence number, the low 32 bits of its
+ * capture stream index as sample offset, and the capture time of its first
+ * sample on the media clock (media_clock.h).
+ * @param span Spans obtained from buffer_manager_peek_read()
+ * @return true if every datagram was sent
+ */
+bool udp_streamer_send_span(const buffer_span_t *span);
+
+/**
+ * Send one datagram of encoded audio frames
+ * The codec ID goes in header flags bits 7-8; sample_count is the samples
+ * the frames represent and sample_offset the low 32 bits of sample_index.
+ * @param data Encoded frames (whole frames only)
+ * @param bytes Encoded size, at most udp_streamer_max_payload()
+ * @param samples Interleaved samples represented by the frames
+ * @param codec audio_codec_t of the payload
+ * @param sample_index Capture stream index of the first sample
+ * @param capture_us esp_timer capture time of the first sample (0 = stamp at send time)
+ * @return true if sent successfully
+ */
+bool udp_streamer_send_encoded(const uint8_t *data, size_t bytes, size_t samples, uint8_t codec,
+                               uint64_t sample_index, int64_t capture_us);
+
+/**
+ * Send one spooled record as backfill datagrams
+ * IMA-ADPCM frames, flagged with header bit 15. sample_offset is the
+ * record's capture stream index (low 32 bits), on the same timeline as
+ * live datagrams, and capture_time_us its capture stamp, so receivers place
+ * it beside the live stream. The last datagram's sample_count may stop
+ * short of its frames; the rest is padding.
+ * @param block Record from flash_spool_peek()
+ * @return true if every datagram was sent
+ */
+bool udp_streamer_send_backfill(const flash_spool_block_t *block);
+
+/**
+ * Get the largest payload that fits one unfragmented datagram
+ * (accounts for FEC headroom when FEC is enabled)
+ */
+size_t udp_streamer_max_payload(void);
+
 /**
  * Send audio samples over UDP (legacy 32-bit interface)
  * @param samples Array of 32-bit audio samples
@@ -31,6 +80,42 @@ bool udp_streamer_send_audio_16(const int16_t *samples, size_t sample_count);
  */
 bool udp_streamer_send_audio(const int32_t *samples, size_t sample_count);
 
+/**
+ * Set the unicast destination (takes effect on the next init/reconnect)
+ * @param ip IPv4 address in dotted notation
+ * @param port Destination port
+ * @return true if the address was accepted (UDP_SERVER_IP:UDP_SERVER_PORT is kept otherwise)
+ */
+bool udp_streamer_set_server(const char *ip, uint16_t port);
+
+/**
+ * Configure multicast streaming (takes effect on the next init/reconnect)
+ * When enabled, datagrams go to group:port instead of the unicast server, so any
+ * number of servers can subscribe to a single transmission.
+ * @param enabled Use multicast instead of unicast
+ * @param group IPv4 multicast group (224.0.0.0/4)
+ * @param port Destination port
+ * @param ttl IP_MULTICAST_TTL hop limit (1 = local subnet)
+ * @return true if the settings were accepted
+ */
+bool udp_streamer_set_multicast(bool enabled, const char *group, uint16_t port, uint8_t ttl);
+
+/**
+ * Configure XOR parity forward error correction
+ * One parity packet follows every group_size data packets, letting the
+ * receiver rebuild any single lost packet of the group.
+ * @param enabled Send parity packets
+ * @param group_size Data packets per parity packet (UDP_FEC_GROUP_SIZE_MIN-MAX)
+ * @return true if the settings were accepted
+ */
+bool udp_streamer_set_fec(bool enabled, uint8_t group_size);
+
+/**
+ * Set the quality tier carried in header flags bits 9-10
+ * @param tier Adaptive quality tier (0 = configured quality)
+ */
+void udp_streamer_set_quality_tier(uint8_t tier);
+
 /**
  * Reconnect UDP socket (mainly for configuration changes)
  */
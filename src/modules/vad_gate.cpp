@@ -0,0 +1,228 @@
+#include "vad_gate.h"
+#include "esp_log.h"
+#include <string.h>
+#include <math.h>
+#include <atomic>
+
+static const char *TAG = "VAD_GATE";
+
+// Gate transitions by capture-stream index (SPSC: I2S reader writes, sender reads)
+typedef struct
+{
+    uint64_t stream_index;
+    bool active;
+} vad_transition_t;
+
+static vad_transition_t transitions[VAD_TRANSITIONS_MAX];
+static std::atomic<uint32_t> transition_count(0);
+
+// Configuration
+static bool gate_enabled = false;
+static uint64_t open_energy = 0;  // Mean-square AC energy that opens the gate (16-bit units)
+static uint64_t close_energy = 0; // 3 dB below open_energy
+static size_t hangover_samples = 0;
+static size_t preroll_samples = 0;
+static size_t frame_samples = 1;
+
+// Producer state
+static bool gate_open = true;
+static size_t hangover_left = 0;
+static uint64_t noise_energy = 0;
+
+// Statistics
+static std::atomic<uint16_t> noise_rms(0);
+static std::atomic<bool> open_flag(true);
+static std::atomic<uint32_t> openings(0);
+static std::atomic<uint64_t> suppressed(0);
+
+static size_t ms_to_samples(const i2s_audio_format_t *format, uint32_t ms)
+{
+    size_t frames = (size_t)(((uint64_t)format->sample_rate * ms) / 1000);
+    return frames * format->channels;
+}
+
+// Record a transition (producer only)
+static void push_transition(uint64_t stream_index, bool active)
+{
+    uint32_t count = transition_count.load(std::memory_order_relaxed);
+    if (count > 0)
+    {
+        // Never go back before the previous transition; equal indices supersede it
+        const vad_transition_t *last = &transitions[(count - 1) % VAD_TRANSITIONS_MAX];
+        if (stream_index < last->stream_index)
+        {
+            stream_index = last->stream_index;
+        }
+    }
+
+    vad_transition_t *t = &transitions[count % VAD_TRANSITIONS_MAX];
+    t->stream_index = stream_index;
+    t->active = active;
+    transition_count.store(count + 1, std::memory_order_release);
+    open_flag.store(active, std::memory_order_relaxed);
+}
+
+bool vad_gate_init(bool enabled, int threshold_dbfs, uint32_t hangover_ms, uint32_t preroll_ms,
+                   const i2s_audio_format_t *format)
+{
+    gate_enabled = false;
+    if (!enabled || format == NULL || format->channels == 0)
+    {
+        return false;
+    }
+
+    if (preroll_ms > VAD_PREROLL_MAX_MS)
+    {
+        ESP_LOGW(TAG, "Pre-roll %lu ms clamped to %d ms", preroll_ms, VAD_PREROLL_MAX_MS);
+        preroll_ms = VAD_PREROLL_MAX_MS;
+    }
+
+    // Full scale 16-bit sine has mean square 2^30 / 2; thresholds are relative to 2^30
+    double energy = 1073741824.0 * pow(10.0, threshold_dbfs / 10.0);
+    open_energy = (uint64_t)energy;
+    close_energy = open_energy / 2;
+    hangover_samples = ms_to_samples(format, hangover_ms);
+    preroll_samples = ms_to_samples(format, preroll_ms);
+    frame_samples = format->channels;
+
+    // Start open so nothing is lost before the first hangover expires
+    gate_open = true;
+    hangover_left = hangover_samples;
+    noise_energy = 0;
+    transition_count.store(0);
+    push_transition(0, true);
+
+    gate_enabled = true;
+    ESP_LOGI(TAG, "VAD gate: open at %d dBFS, hangover %lu ms, pre-roll %lu ms",
+             threshold_dbfs, hangover_ms, preroll_ms);
+    return true;
+}
+
+bool vad_gate_enabled(void)
+{
+    return gate_enabled;
+}
+
+void vad_gate_process(const int32_t *raw, size_t samples, uint64_t stream_index)
+{
+    if (!gate_enabled || raw == NULL || samples == 0)
+    {
+        return;
+    }
+
+    // AC energy of the chunk (DC bias of the mic removed) on the 16-bit scale
+    int64_t sum = 0;
+    uint64_t sum_sq = 0;
+    for (size_t i = 0; i < samples; i++)
+    {
+        int32_t v = raw[i] >> 16;
+        sum += v;
+        sum_sq += (uint64_t)((int64_t)v * v);
+    }
+    int64_t mean = sum / (int64_t)samples;
+    uint64_t mean_sq = sum_sq / samples;
+    uint64_t dc_sq = (uint64_t)(mean * mean);
+    uint64_t energy = (mean_sq > dc_sq) ? mean_sq - dc_sq : 0;
+
+    bool loud = energy > (gate_open ? close_energy : open_energy);
+    if (loud)
+    {
+        hangover_left = hangover_samples;
+        if (!gate_open)
+        {
+            gate_open = true;
+            openings.fetch_add(1, std::memory_order_relaxed);
+            uint64_t onset = (stream_index > preroll_samples) ? stream_index - preroll_samples : 0;
+            push_transition(onset, true);
+        }
+        return;
+    }
+
+    // Comfort-noise level tracks the quiet chunks (EMA, alpha = 1/8)
+    noise_energy = (noise_energy == 0) ? energy : noise_energy - noise_energy / 8 + energy / 8;
+    noise_rms.store((uint16_t)sqrt((double)noise_energy), std::memory_order_relaxed);
+
+    if (gate_open)
+    {
+        if (hangover_left >= samples)
+        {
+            hangover_left -= samples;
+            return;
+        }
+
+        // Hangover ends inside this chunk
+        size_t keep = hangover_left - (hangover_left % frame_samples);
+        hangover_left = 0;
+        gate_open = false;
+        push_transition(stream_index + keep, false);
+    }
+}
+
+size_t vad_gate_run(uint64_t stream_index, size_t max_samples, bool *active)
+{
+    if (active)
+    {
+        *active = true;
+    }
+
+    uint32_t count = transition_count.load(std::memory_order_acquire);
+    if (!gate_enabled || count == 0)
+    {
+        return max_samples;
+    }
+
+    // Keep clear of the slots the producer may be overwriting
+    uint32_t usable = (count < VAD_TRANSITIONS_MAX - 4) ? count : VAD_TRANSITIONS_MAX - 4;
+    uint32_t oldest = count - usable;
+    uint32_t found = oldest;
+    for (uint32_t i = count; i > oldest; i--)
+    {
+        if (transitions[(i - 1) % VAD_TRANSITIONS_MAX].stream_index <= stream_index)
+        {
+            found = i - 1;
+            break;
+        }
+    }
+
+    if (active)
+    {
+        *active = transitions[found % VAD_TRANSITIONS_MAX].active;
+    }
+
+    // Run until the next transition that changes the state
+    for (uint32_t i = found + 1; i < count; i++)
+    {
+        const vad_transition_t *next = &transitions[i % VAD_TRANSITIONS_MAX];
+        if (next->active != transitions[found % VAD_TRANSITIONS_MAX].active)
+        {
+            uint64_t run = (next->stream_index > stream_index) ? next->stream_index - stream_index : 0;
+            return (run < max_samples) ? (size_t)run : max_samples;
+        }
+    }
+    return max_samples;
+}
+
+size_t vad_gate_preroll_samples(void)
+{
+    return gate_enabled ? preroll_samples : 0;
+}
+
+uint16_t vad_gate_noise_level(void)
+{
+    return noise_rms.load(std::memory_order_relaxed);
+}
+
+void vad_gate_add_suppressed(size_t samples)
+{
+    suppressed.fetch_add(samples, std::memory_order_relaxed);
+}
+
+void vad_gate_get_stats(bool *open, uint32_t *openings_out, uint64_t *suppressed_samples)
+{
+    if (open)
+        *open = gate_enabled ? open_flag.load(std::memory_order_relaxed) : true;
+    if (openings_out)
+        *openings_out = openings.load(std::memory_order_relaxed);
+    if (suppressed_samples)
+        *suppressed_samples = suppressed.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,93 @@
+#ifndef VAD_GATE_H
+#define VAD_GATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../config.h"
+#include "i2s_handler.h"
+
+/**
+ * Energy gate (VAD) for suppressing quiet audio
+ *
+ * The I2S reader measures the AC energy of every chunk before it enters the
+ * ring and records open/close transitions by capture-stream sample index.
+ * The network sender looks the state up for each block: speech goes out as
+ * usual, silence as one small AUDIO_CODEC_SILENCE frame per block.
+ *
+ * Silence frame: sample_count (UDP header / TCP frame header) is the
+ * duration; the 2-byte payload is the comfort-noise RMS as uint16 LE in
+ * 16-bit full-scale units.
+ *
+ * - Hysteresis: the gate closes 3 dB below the open threshold
+ * - Hangover: the gate stays open hangover_ms after the last loud chunk
+ * - Pre-roll: an opening is back-dated by preroll_ms; the sender keeps that
+ *   much silence in the ring so the start of speech is never clipped
+ *
+ * Needs framed transport: UDP always, TCP only with tcp_framing_enabled.
+ */
+
+/**
+ * Configure the gate for a capture format
+ *
+ * Call before the I2S reader and network sender start.
+ *
+ * @param enabled false passes everything through
+ * @param threshold_dbfs Open threshold in dBFS (e.g. -50)
+ * @param hangover_ms Time the gate stays open after the level drops
+ * @param preroll_ms Audio kept before an opening (clamped to VAD_PREROLL_MAX_MS)
+ * @param format Capture format
+ * @return true if the gate is active
+ */
+bool vad_gate_init(bool enabled, int threshold_dbfs, uint32_t hangover_ms, uint32_t preroll_ms,
+                   const i2s_audio_format_t *format);
+
+/**
+ * Check whether the gate is active
+ */
+bool vad_gate_enabled(void);
+
+/**
+ * Measure one I2S chunk and update the gate (I2S reader only)
+ *
+ * @param raw Raw 32-bit I2S slots as read
+ * @param samples Interleaved samples in raw
+ * @param stream_index Capture-stream index of raw[0] (includes dropped samples)
+ */
+void vad_gate_process(const int32_t *raw, size_t samples, uint64_t stream_index);
+
+/**
+ * Get the gate state at a capture-stream index (network sender only)
+ *
+ * @param stream_index Capture-stream index, e.g. buffer_span_t.sample_index
+ * @param max_samples Longest run to report
+ * @param active Output: true if the gate is open there
+ * @return Samples from stream_index until the state changes, at most max_samples
+ */
+size_t vad_gate_run(uint64_t stream_index, size_t max_samples, bool *active);
+
+/**
+ * Get the pre-roll the sender must keep buffered while the gate is closed
+ */
+size_t vad_gate_preroll_samples(void);
+
+/**
+ * Get the comfort-noise RMS measured while the gate is closed
+ */
+uint16_t vad_gate_noise_level(void);
+
+/**
+ * Count samples replaced by silence frames (network sender only)
+ */
+void vad_gate_add_suppressed(size_t samples);
+
+/**
+ * Get gate statistics since boot
+ *
+ * @param open Output: true if the gate is currently open (may be NULL)
+ * @param openings Gate openings (may be NULL)
+ * @param suppressed_samples Samples sent as silence frames (may be NULL)
+ */
+void vad_gate_get_stats(bool *open, uint32_t *openings, uint64_t *suppressed_samples);
+
+#endif // VAD_GATE_H
@@ -0,0 +1,31 @@
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Embedded web UI assets
+ *
+ * The table is generated from data/ at build time by scripts/web_assets.py.
+ * Every asset is stored gzip-compressed. CSS and JS carry a content hash in
+ * their path and never change under it, so browsers may cache them for
+ * good; the HTML pages keep their paths and are revalidated by ETag.
+ */
+
+typedef struct
+{
+    const char *uri;       // Served path (/js/app.<hash>.js for fingerprinted assets)
+    const char *mime_type;
+    const char *etag;      // Quoted content hash of the uncompressed file
+    const uint8_t *gzip;   // gzip stream (no file name, mtime 0)
+    size_t gzip_size;
+    size_t size;           // Uncompressed size
+    bool immutable;        // Path changes with the content
+} web_asset_t;
+
+extern const web_asset_t web_assets[];
+extern const size_t web_asset_count;
+
+#endif // WEB_ASSETS_H
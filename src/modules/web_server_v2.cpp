@@ -6,19 +6,36 @@
 #include "udp_streamer.h"
 #include "buffer_manager.h"
 #include "i2s_handler.h"
+#include "audio_encoder.h"
+#include "latency_profile.h"
+#include "vad_gate.h"
+#include "dsp_chain.h"
 #include "ota_handler.h"
 #include "performance_monitor.h"
+#include "pipeline_stats.h"
+#include "live_reconfig.h"
+#include "boot_profile.h"
+#include "adaptive_quality.h"
+#include "stream_sink.h"
+#include "media_clock.h"
+#include "flash_spool.h"
+#include "json_stream.h"
+#include "ws_push.h"
 #include "captive_portal.h"
+#include "web_assets.h"
 #include "esp_log.h"
 #include "esp_system.h"
 #include "esp_chip_info.h"
 #include "esp_timer.h"
+#include "esp_rom_sys.h"
 #include "esp_mac.h"
 #include "esp_ota_ops.h"
 #include "esp_app_format.h"
 #include "esp_wifi.h"
 #include "cJSON.h"
 #include "mbedtls/base64.h"
+#include "miniz.h"
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 
@@ -65,12 +82,10 @@ esp_err_t web_server_v2_send_auth_required(httpd_req_t *req)
     return ESP_FAIL;
 }
 
-bool web_server_v2_check_auth(httpd_req_t *req)
+bool web_server_v2_check_credentials(const char *encoded)
 {
-    // Validate request pointer
-    if (!req)
+    if (!encoded)
     {
-        ESP_LOGE(TAG, "NULL request pointer in auth check");
         return false;
     }
 
@@ -92,28 +107,11 @@ bool web_server_v2_check_auth(httpd_req_t *req)
     strncpy(password, config.auth_password, sizeof(password));
     password[sizeof(password) - 1] = '\0';
 
-    // Get Authorization header
-    char auth_header[256];
-    esp_err_t err = httpd_req_get_hdr_value_str(req, "Authorization", auth_header, sizeof(auth_header));
-    if (err != ESP_OK)
-    {
-        ESP_LOGD(TAG, "No Authorization header");
-        return false;
-    }
-
-    // Check for "Basic " prefix
-    if (strncmp(auth_header, "Basic ", 6) != 0)
-    {
-        ESP_LOGW(TAG, "Invalid Authorization header format");
-        return false;
-    }
-
     // Decode base64
     unsigned char decoded[128];
     size_t decoded_len;
-    int ret = mbedtls_base64_decode(decoded, sizeof(decoded), &decoded_len,
-                                    (const unsigned char *)(auth_header + 6),
-                                    strlen(auth_header + 6));
+    int ret = mbedtls_base64_decode(decoded, sizeof(decoded) - 1, &decoded_len,
+                                    (const unsigned char *)encoded, strlen(encoded));
     if (ret != 0)
     {
         ESP_LOGW(TAG, "Failed to decode base64 auth: %d", ret);
@@ -145,6 +143,34 @@ bool web_server_v2_check_auth(httpd_req_t *req)
     return valid;
 }
 
+bool web_server_v2_check_auth(httpd_req_t *req)
+{
+    // Validate request pointer
+    if (!req)
+    {
+        ESP_LOGE(TAG, "NULL request pointer in auth check");
+        return false;
+    }
+
+    // Get Authorization header
+    char auth_header[256];
+    esp_err_t err = httpd_req_get_hdr_value_str(req, "Authorization", auth_header, sizeof(auth_header));
+    if (err != ESP_OK)
+    {
+        ESP_LOGD(TAG, "No Authorization header");
+        return false;
+    }
+
+    // Check for "Basic " prefix
+    if (strncmp(auth_header, "Basic ", 6) != 0)
+    {
+        ESP_LOGW(TAG, "Invalid Authorization header format");
+        return false;
+    }
+
+    return web_server_v2_check_credentials(auth_header + 6);
+}
+
 // Helper function to send JSON response
 esp_err_t web_server_v2_send_json_response(httpd_req_t *req, cJSON *json, int status_code)
 {
@@ -405,34 +431,18 @@ static esp_err_t api_get_network_handler(httpd_req_t *req)
 
     // TCP/UDP server configuration
     cJSON *server = cJSON_CreateObject();
-    char tcp_ip[16], udp_ip[16];
-    char tcp_port_str[8], udp_port_str[8];
+    const unified_config_t *config = config_manager_v2_acquire();
 
-    if (config_manager_v2_get_field(CONFIG_FIELD_TCP_SERVER_IP, tcp_ip, sizeof(tcp_ip)))
-    {
-        cJSON_AddStringToObject(server, "tcp_ip", tcp_ip);
-    }
-    if (config_manager_v2_get_field(CONFIG_FIELD_UDP_SERVER_IP, udp_ip, sizeof(udp_ip)))
-    {
-        cJSON_AddStringToObject(server, "udp_ip", udp_ip);
-    }
-    if (config_manager_v2_get_field(CONFIG_FIELD_TCP_SERVER_PORT, tcp_port_str, sizeof(tcp_port_str)))
-    {
-        cJSON_AddNumberToObject(server, "tcp_port", atoi(tcp_port_str));
-    }
-    if (config_manager_v2_get_field(CONFIG_FIELD_UDP_SERVER_PORT, udp_port_str, sizeof(udp_port_str)))
-    {
-        cJSON_AddNumberToObject(server, "udp_port", atoi(udp_port_str));
-    }
+    cJSON_AddStringToObject(server, "tcp_ip", config->tcp_server_ip);
+    cJSON_AddStringToObject(server, "udp_ip", config->udp_server_ip);
+    cJSON_AddNumberToObject(server, "tcp_port", config->tcp_server_port);
+    cJSON_AddNumberToObject(server, "udp_port", config->udp_server_port);
 
-    char protocol_str[8];
-    if (config_manager_v2_get_field(CONFIG_FIELD_STREAMING_PROTOCOL, protocol_str, sizeof(protocol_str)))
-    {
-        int protocol = atoi(protocol_str);
-        const char *protocol_name = (protocol == 0) ? "TCP" : (protocol == 1) ? "UDP"
-                                                                              : "BOTH";
-        cJSON_AddStringToObject(server, "protocol", protocol_name);
-    }
+    uint8_t protocol = config->streaming_protocol;
+    const char *protocol_name = (protocol == 0) ? "TCP" : (protocol == 1) ? "UDP"
+                                                                          : "BOTH";
+    cJSON_AddStringToObject(server, "protocol", protocol_name);
+    config_manager_v2_release(config);
 
     cJSON_AddItemToObject(root, "server", server);
 
@@ -646,34 +656,38 @@ static esp_err_t api_get_audio_handler(httpd_req_t *req)
 
     cJSON *root = cJSON_CreateObject();
 
-    // Audio configuration (fixed format, only GPIO pins configurable)
+    // Audio configuration (format and GPIO pins, applied on restart)
     cJSON *audio = cJSON_CreateObject();
-    char bck_pin_str[8], ws_pin_str[8], data_in_pin_str[8];
-
-    if (config_manager_v2_get_field(CONFIG_FIELD_AUDIO_BCK_PIN, bck_pin_str, sizeof(bck_pin_str)))
-    {
-        cJSON_AddNumberToObject(audio, "bck_pin", atoi(bck_pin_str));
-    }
-    if (config_manager_v2_get_field(CONFIG_FIELD_AUDIO_WS_PIN, ws_pin_str, sizeof(ws_pin_str)))
-    {
-        cJSON_AddNumberToObject(audio, "ws_pin", atoi(ws_pin_str));
-    }
-    if (config_manager_v2_get_field(CONFIG_FIELD_AUDIO_DATA_IN_PIN, data_in_pin_str, sizeof(data_in_pin_str)))
-    {
-        cJSON_AddNumberToObject(audio, "data_in_pin", atoi(data_in_pin_str));
-    }
-
-    // Fixed values (read-only)
-    cJSON_AddNumberToObject(audio, "sample_rate", SAMPLE_RATE);
-    cJSON_AddNumberToObject(audio, "bits_per_sample", BITS_PER_SAMPLE);
-    cJSON_AddNumberToObject(audio, "channels", CHANNELS);
-    cJSON_AddStringToObject(audio, "format", "PCM 16-bit mono");
-
-    // Calculate data rate (bps = bits per second)
-    uint32_t data_rate_bps = SAMPLE_RATE * CHANNELS * BITS_PER_SAMPLE;
+    const unified_config_t *config = config_manager_v2_acquire();
+
+    cJSON_AddNumberToObject(audio, "bck_pin", config->audio_bck_pin);
+    cJSON_AddNumberToObject(audio, "ws_pin", config->audio_ws_pin);
+    cJSON_AddNumberToObject(audio, "data_in_pin", config->audio_data_in_pin);
+
+    uint32_t sample_rate = config->audio_sample_rate;
+    uint32_t bits_per_sample = config->audio_bits_per_sample;
+    uint32_t channels = config->audio_channels;
+    audio_codec_t codec = (audio_codec_t)config->audio_codec;
+    config_manager_v2_release(config);
+
+    cJSON_AddNumberToObject(audio, "sample_rate", sample_rate);
+    cJSON_AddNumberToObject(audio, "bits_per_sample", bits_per_sample);
+    cJSON_AddNumberToObject(audio, "channels", channels);
+    char format_str[32];
+    snprintf(format_str, sizeof(format_str), "PCM %lu-bit %s", (unsigned long)bits_per_sample,
+             channels == 2 ? "stereo" : "mono");
+    cJSON_AddStringToObject(audio, "format", format_str);
+
+    // Calculate data rate (bps = bits per second, as sent on the wire)
+    uint32_t data_rate_bps = sample_rate * channels * bits_per_sample;
     cJSON_AddNumberToObject(audio, "data_rate_bps", data_rate_bps);
     cJSON_AddNumberToObject(audio, "data_rate_kbps", data_rate_bps / 1024.0);
 
+    // Transport codec (configured) and the running encoder's bitrate
+    cJSON_AddNumberToObject(audio, "codec", codec);
+    cJSON_AddStringToObject(audio, "codec_name", audio_encoder_codec_name(codec));
+    cJSON_AddNumberToObject(audio, "encoded_rate_bps", audio_encoder_get_bitrate());
+
     cJSON_AddItemToObject(root, "audio", audio);
 
     esp_err_t ret = web_server_v2_send_json_response(req, root, 200);
@@ -681,7 +695,7 @@ static esp_err_t api_get_audio_handler(httpd_req_t *req)
     return ret;
 }
 
-// POST /api/config/audio - Update audio configuration (GPIO pins only)
+// POST /api/config/audio - Update audio configuration (format and GPIO pins)
 static esp_err_t api_post_audio_handler(httpd_req_t *req)
 {
     if (!web_server_v2_check_auth(req))
@@ -705,6 +719,41 @@ static esp_err_t api_post_audio_handler(httpd_req_t *req)
     bool changed = false;
     config_validation_result_t result;
 
+    // Update capture format if provided
+    const struct
+    {
+        const char *key;
+        config_field_id_t field;
+    } format_fields[] = {
+        {"sample_rate", CONFIG_FIELD_AUDIO_SAMPLE_RATE},
+        {"bits_per_sample", CONFIG_FIELD_AUDIO_BITS_PER_SAMPLE},
+        {"channels", CONFIG_FIELD_AUDIO_CHANNELS},
+        {"codec", CONFIG_FIELD_AUDIO_CODEC},
+    };
+    for (size_t i = 0; i < sizeof(format_fields) / sizeof(format_fields[0]); i++)
+    {
+        cJSON *item = cJSON_GetObjectItem(root, format_fields[i].key);
+        if (item && cJSON_IsNumber(item))
+        {
+            char value_str[16];
+            snprintf(value_str, sizeof(value_str), "%d", item->valueint);
+            if (config_manager_v2_set_field(format_fields[i].field, value_str, &result))
+            {
+                changed = true;
+            }
+            else
+            {
+                cJSON *response = cJSON_CreateObject();
+                cJSON_AddStringToObject(response, "status", "error");
+                cJSON_AddStringToObject(response, "message", result.error_message);
+                esp_err_t ret = web_server_v2_send_json_response(req, response, 400);
+                cJSON_Delete(response);
+                cJSON_Delete(root);
+                return ret;
+            }
+        }
+    }
+
     // Update GPIO pins if provided
     cJSON *bck_pin = cJSON_GetObjectItem(root, "bck_pin");
     if (bck_pin && cJSON_IsNumber(bck_pin))
@@ -762,8 +811,12 @@ static esp_err_t api_post_audio_handler(httpd_req_t *req)
     cJSON_AddStringToObject(response, "status", "success");
     if (changed)
     {
-        cJSON_AddStringToObject(response, "message", "Audio GPIO configuration saved. Restart required to apply changes.");
-        cJSON_AddBoolToObject(response, "restart_required", true);
+        reconfig_status_t reconfig;
+        live_reconfig_get_status(&reconfig);
+        bool live = reconfig.active && LIVE_RECONFIG_AUTO_APPLY;
+        cJSON_AddStringToObject(response, "message", live ? "Audio configuration saved and being applied."
+                                                          : "Audio configuration saved. Restart required to apply changes.");
+        cJSON_AddBoolToObject(response, "restart_required", !live);
     }
     else
     {
@@ -878,6 +931,8 @@ static esp_err_t api_post_all_config_handler(httpd_req_t *req)
 }
 
 // GET /api/system/status - Get system status
+// Streamed in chunks from a fixed scratch buffer: polled at 1 Hz by dashboards,
+// so it must not allocate
 static esp_err_t api_get_status_handler(httpd_req_t *req)
 {
     if (!web_server_v2_check_auth(req))
@@ -885,22 +940,24 @@ static esp_err_t api_get_status_handler(httpd_req_t *req)
         return web_server_v2_send_auth_required(req);
     }
 
-    cJSON *root = cJSON_CreateObject();
+    json_stream_t js;
+    json_stream_begin(&js, req);
+    json_stream_object_start(&js, NULL);
 
     // Uptime
-    cJSON_AddNumberToObject(root, "uptime_sec", esp_timer_get_time() / 1000000);
+    json_stream_add_uint(&js, "uptime_sec", esp_timer_get_time() / 1000000);
 
     // WiFi status
-    cJSON *wifi = cJSON_CreateObject();
-    cJSON_AddBoolToObject(wifi, "connected", network_manager_is_connected());
+    json_stream_object_start(&js, "wifi");
+    json_stream_add_bool(&js, "connected", network_manager_is_connected());
     if (network_manager_is_connected())
     {
         // Get the ACTUAL connected SSID from WiFi stack, not from NVS config
         wifi_ap_record_t ap_info;
         if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK)
         {
-            cJSON_AddStringToObject(wifi, "ssid", (char *)ap_info.ssid);
-            cJSON_AddNumberToObject(wifi, "rssi", ap_info.rssi);
+            json_stream_add_string(&js, "ssid", (char *)ap_info.ssid);
+            json_stream_add_int(&js, "rssi", ap_info.rssi);
         }
         else
         {
@@ -908,65 +965,216 @@ static esp_err_t api_get_status_handler(httpd_req_t *req)
             char ssid[32];
             if (config_manager_v2_get_field(CONFIG_FIELD_WIFI_SSID, ssid, sizeof(ssid)))
             {
-                cJSON_AddStringToObject(wifi, "ssid", ssid);
+                json_stream_add_string(&js, "ssid", ssid);
             }
         }
     }
     else
     {
-        cJSON_AddStringToObject(wifi, "ssid", "N/A");
+        json_stream_add_string(&js, "ssid", "N/A");
     }
-    cJSON_AddItemToObject(root, "wifi", wifi);
+    json_stream_object_end(&js);
 
     // TCP status
-    cJSON *tcp = cJSON_CreateObject();
-    cJSON_AddBoolToObject(tcp, "connected", tcp_streamer_is_connected());
+    json_stream_object_start(&js, "tcp");
+    json_stream_add_bool(&js, "connected", tcp_streamer_is_connected());
     char tcp_ip[16], tcp_port_str[8];
     if (config_manager_v2_get_field(CONFIG_FIELD_TCP_SERVER_IP, tcp_ip, sizeof(tcp_ip)) &&
         config_manager_v2_get_field(CONFIG_FIELD_TCP_SERVER_PORT, tcp_port_str, sizeof(tcp_port_str)))
     {
         char server_str[32];
         snprintf(server_str, sizeof(server_str), "%s:%s", tcp_ip, tcp_port_str);
-        cJSON_AddStringToObject(tcp, "server", server_str);
+        json_stream_add_string(&js, "server", server_str);
     }
 
     uint64_t bytes_sent;
     uint32_t reconnects;
     tcp_streamer_get_stats(&bytes_sent, &reconnects);
-    cJSON_AddNumberToObject(tcp, "bytes_sent", bytes_sent);
-    cJSON_AddNumberToObject(tcp, "reconnects", reconnects);
-    cJSON_AddItemToObject(root, "tcp", tcp);
-
-    // Audio status
-    cJSON *audio = cJSON_CreateObject();
-    cJSON_AddNumberToObject(audio, "sample_rate", SAMPLE_RATE);
-    cJSON_AddNumberToObject(audio, "bits_per_sample", BITS_PER_SAMPLE);
-    cJSON_AddNumberToObject(audio, "channels", CHANNELS);
-    cJSON_AddItemToObject(root, "audio", audio);
+    json_stream_add_uint(&js, "bytes_sent", bytes_sent);
+    json_stream_add_uint(&js, "reconnects", reconnects);
+    json_stream_object_end(&js);
+
+    // Audio status (running capture format)
+    i2s_audio_format_t format;
+    i2s_handler_get_format(&format);
+    json_stream_object_start(&js, "audio");
+    json_stream_add_uint(&js, "sample_rate", format.sample_rate);
+    json_stream_add_uint(&js, "bits_per_sample", format.bits_per_sample);
+    json_stream_add_uint(&js, "channels", format.channels);
+    json_stream_object_end(&js);
 
     // Buffer status
-    cJSON *buffer = cJSON_CreateObject();
-    cJSON_AddNumberToObject(buffer, "usage_percent", buffer_manager_usage_percent());
+    json_stream_object_start(&js, "buffer");
+    json_stream_add_uint(&js, "usage_percent", buffer_manager_usage_percent());
     char buffer_size_str[16];
     if (config_manager_v2_get_field(CONFIG_FIELD_BUFFER_RING_SIZE, buffer_size_str, sizeof(buffer_size_str)))
     {
-        cJSON_AddNumberToObject(buffer, "size_kb", atoi(buffer_size_str) / 1024);
-    }
-    cJSON_AddItemToObject(root, "buffer", buffer);
+        json_stream_add_int(&js, "size_kb", atoi(buffer_size_str) / 1024);
+    }
+#if ADAPTIVE_BUFFERING_ENABLED
+    size_t active_size = 0;
+    uint32_t resizes = 0, resize_last_us = 0, resize_max_us = 0, stall_max_us = 0;
+    buffer_manager_adaptive_get_stats(&active_size, &resizes, NULL);
+    buffer_manager_adaptive_get_resize_timing(&resize_last_us, &resize_max_us, NULL, &stall_max_us);
+    json_stream_add_uint(&js, "active_kb", active_size / 1024);
+    json_stream_add_uint(&js, "resize_count", resizes);
+    json_stream_add_uint(&js, "resize_last_us", resize_last_us);
+    json_stream_add_uint(&js, "resize_max_us", resize_max_us);
+    json_stream_add_uint(&js, "resize_stall_max_us", stall_max_us);
+#endif
+    overflow_stats_t overflow;
+    performance_monitor_get_overflow_stats(&overflow);
+    json_stream_add_int(&js, "overflow_policy", overflow.policy);
+    json_stream_add_uint(&js, "overflow_events", overflow.overflow_events);
+    json_stream_add_uint(&js, "dropped_oldest_samples", overflow.dropped_oldest_samples);
+    json_stream_add_uint(&js, "dropped_newest_samples", overflow.dropped_newest_samples);
+    json_stream_add_uint(&js, "degrade_events", overflow.degrade_events);
+    json_stream_object_end(&js);
+
+    // Capture-to-send latency (oldest sample of each block as it leaves)
+    const latency_params_t *params = latency_profile_get();
+    latency_stats_t stats;
+    latency_profile_get_stats(&stats);
+    json_stream_object_start(&js, "latency");
+    json_stream_add_string(&js, "profile", latency_profile_name(params->profile));
+    json_stream_add_uint(&js, "budget_ms", params->budget_ms);
+    json_stream_add_uint(&js, "block_samples", params->send_samples);
+    json_stream_add_uint(&js, "last_us", stats.last_us);
+    json_stream_add_uint(&js, "avg_us", stats.avg_us);
+    json_stream_add_uint(&js, "max_us", stats.max_us);
+    json_stream_add_uint(&js, "over_budget", stats.over_budget);
+    json_stream_object_end(&js);
+
+    // Silence gate
+    bool vad_open = true;
+    uint32_t vad_openings = 0;
+    uint64_t vad_suppressed = 0;
+    vad_gate_get_stats(&vad_open, &vad_openings, &vad_suppressed);
+    json_stream_object_start(&js, "vad");
+    json_stream_add_bool(&js, "enabled", vad_gate_enabled());
+    json_stream_add_bool(&js, "open", vad_open);
+    json_stream_add_uint(&js, "openings", vad_openings);
+    json_stream_add_uint(&js, "suppressed_samples", vad_suppressed);
+    json_stream_add_number(&js, "noise_rms", vad_gate_noise_level());
+    json_stream_object_end(&js);
+
+    // DSP chain: cycles per output sample against each stage's budget
+    dsp_stage_stats_t stages[DSP_STAGE_COUNT];
+    size_t stage_count = dsp_chain_get_stats(stages, DSP_STAGE_COUNT);
+    json_stream_object_start(&js, "dsp");
+    json_stream_add_uint(&js, "capture_rate", i2s_handler_get_capture_rate());
+    json_stream_add_uint(&js, "decimation", dsp_chain_decimation());
+    json_stream_add_number(&js, "agc_gain_db", dsp_chain_agc_gain_db10() / 10.0);
+    json_stream_array_start(&js, "stages");
+    for (size_t i = 0; i < stage_count; i++)
+    {
+        json_stream_object_start(&js, NULL);
+        json_stream_add_string(&js, "name", stages[i].name);
+        json_stream_add_bool(&js, "enabled", stages[i].enabled);
+        json_stream_add_uint(&js, "budget_cycles", stages[i].budget_cycles);
+        json_stream_add_number(&js, "avg_cycles", stages[i].avg_centicycles / 100.0);
+        json_stream_add_number(&js, "max_cycles", stages[i].max_centicycles / 100.0);
+        json_stream_add_uint(&js, "over_budget", stages[i].over_budget);
+        json_stream_object_end(&js);
+    }
+    json_stream_array_end(&js);
+    json_stream_object_end(&js);
 
     // Memory status
-    cJSON *memory = cJSON_CreateObject();
-    cJSON_AddNumberToObject(memory, "free_heap", esp_get_free_heap_size());
-    cJSON_AddNumberToObject(memory, "min_free_heap", esp_get_minimum_free_heap_size());
-    cJSON_AddItemToObject(root, "memory", memory);
+    json_stream_object_start(&js, "memory");
+    json_stream_add_uint(&js, "free_heap", esp_get_free_heap_size());
+    json_stream_add_uint(&js, "min_free_heap", esp_get_minimum_free_heap_size());
+    json_stream_object_end(&js);
 
     // Configuration version
-    cJSON_AddNumberToObject(root, "config_version", config_manager_v2_get_version());
-    cJSON_AddBoolToObject(root, "has_unsaved_changes", config_manager_v2_has_unsaved_changes());
+    json_stream_add_uint(&js, "config_version", config_manager_v2_get_version());
+    json_stream_add_bool(&js, "has_unsaved_changes", config_manager_v2_has_unsaved_changes());
 
-    esp_err_t ret = web_server_v2_send_json_response(req, root, 200);
-    cJSON_Delete(root);
-    return ret;
+    json_stream_object_end(&js);
+    return json_stream_finish(&js);
+}
+
+typedef struct
+{
+    performance_metrics_t entries[HISTORY_STREAM_BATCH];
+    size_t count;
+} history_batch_t;
+
+static bool history_batch_cb(const performance_metrics_t *metrics, void *ctx)
+{
+    history_batch_t *batch = (history_batch_t *)ctx;
+    batch->entries[batch->count++] = *metrics;
+    return batch->count < HISTORY_STREAM_BATCH;
+}
+
+// GET /api/perf/history?start=<ms>&end=<ms> - Metrics history, oldest first
+// Decoded from the history log a batch at a time, so the history lock is never
+// held while the socket is written
+static esp_err_t api_get_perf_history_handler(httpd_req_t *req)
+{
+    if (!web_server_v2_check_auth(req))
+    {
+        return web_server_v2_send_auth_required(req);
+    }
+
+    uint32_t start_ms = 0;
+    uint32_t end_ms = esp_timer_get_time() / 1000;
+    char query[64];
+    char value[16];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK)
+    {
+        if (httpd_query_key_value(query, "start", value, sizeof(value)) == ESP_OK)
+        {
+            start_ms = strtoul(value, NULL, 10);
+        }
+        if (httpd_query_key_value(query, "end", value, sizeof(value)) == ESP_OK && strtoul(value, NULL, 10) > 0)
+        {
+            end_ms = strtoul(value, NULL, 10);
+        }
+    }
+
+    json_stream_t js;
+    json_stream_begin(&js, req);
+    json_stream_object_start(&js, NULL);
+    json_stream_add_uint(&js, "interval_ms", performance_monitor_get_interval());
+    json_stream_array_start(&js, "entries");
+
+    history_batch_t batch;
+    uint32_t next_ms = start_ms;
+    do
+    {
+        batch.count = 0;
+        performance_monitor_foreach_history(next_ms, end_ms, history_batch_cb, &batch);
+        for (size_t i = 0; i < batch.count; i++)
+        {
+            const performance_metrics_t *m = &batch.entries[i];
+            json_stream_object_start(&js, NULL);
+            json_stream_add_uint(&js, "timestamp_ms", m->timestamp_ms);
+            json_stream_add_uint(&js, "buffer_usage_percent", m->buffer_usage_percent);
+            json_stream_add_bool(&js, "buffer_overflow", m->buffer_overflow_detected);
+            json_stream_add_uint(&js, "free_heap", m->free_heap);
+            json_stream_add_uint(&js, "min_free_heap", m->min_free_heap);
+            json_stream_add_uint(&js, "largest_free_block", m->largest_free_block);
+            json_stream_add_number(&js, "fragmentation_percent", m->fragmentation_percent);
+            json_stream_add_bool(&js, "tcp_connected", m->tcp_connected);
+            json_stream_add_uint(&js, "tcp_bytes_sent", m->tcp_bytes_sent);
+            json_stream_add_uint(&js, "tcp_reconnects", m->tcp_reconnects);
+            json_stream_add_bool(&js, "udp_connected", m->udp_connected);
+            json_stream_add_uint(&js, "udp_packets_sent", m->udp_packets_sent);
+            json_stream_add_number(&js, "udp_packet_loss_rate", m->udp_packet_loss_rate);
+            json_stream_add_int(&js, "wifi_rssi", m->wifi_rssi);
+            json_stream_add_uint(&js, "audio_data_rate_bps", m->audio_data_rate_bps);
+            json_stream_object_end(&js);
+        }
+        if (batch.count > 0)
+        {
+            next_ms = batch.entries[batch.count - 1].timestamp_ms + 1;
+        }
+    } while (batch.count == HISTORY_STREAM_BATCH && next_ms <= end_ms && !js.failed);
+
+    json_stream_array_end(&js);
+    json_stream_object_end(&js);
+    return json_stream_finish(&js);
 }
 
 // GET /api/system/info - Get device info
@@ -997,11 +1205,337 @@ static esp_err_t api_get_info_handler(httpd_req_t *req)
     cJSON_AddStringToObject(root, "firmware_version", "2.0.0");
     cJSON_AddStringToObject(root, "config_system", "unified_v2");
 
+    // Milliseconds since boot at which each phase was reached (phases not reached yet are left out)
+    cJSON *boot = cJSON_CreateObject();
+    for (int i = 0; i < BOOT_PHASE_COUNT; i++)
+    {
+        int32_t ms = boot_profile_get_ms((boot_phase_t)i);
+        if (ms >= 0)
+        {
+            cJSON_AddNumberToObject(boot, boot_profile_phase_name((boot_phase_t)i), ms);
+        }
+    }
+    cJSON_AddItemToObject(root, "boot_ms", boot);
+
     esp_err_t ret = web_server_v2_send_json_response(req, root, 200);
     cJSON_Delete(root);
     return ret;
 }
 
+// GET /api/perf/pipeline - Stage latency percentiles and per-task CPU load
+// ?reset=1 clears the histograms after they are reported
+static esp_err_t api_get_perf_pipeline_handler(httpd_req_t *req)
+{
+    if (!web_server_v2_check_auth(req))
+    {
+        return web_server_v2_send_auth_required(req);
+    }
+
+    bool reset = false;
+    char query[32];
+    char value[8];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "reset", value, sizeof(value)) == ESP_OK)
+    {
+        reset = (strcmp(value, "1") == 0 || strcmp(value, "true") == 0);
+    }
+
+    json_stream_t js;
+    json_stream_begin(&js, req);
+    json_stream_object_start(&js, NULL);
+    json_stream_add_uint(&js, "cpu_mhz", esp_rom_get_cpu_ticks_per_us());
+
+    json_stream_array_start(&js, "stages");
+    for (int i = 0; i < PIPELINE_STAGE_COUNT; i++)
+    {
+        pipeline_stage_summary_t summary;
+        if (!pipeline_stats_get((pipeline_stage_t)i, &summary))
+        {
+            continue;
+        }
+        json_stream_object_start(&js, NULL);
+        json_stream_add_string(&js, "name", summary.name);
+        json_stream_add_uint(&js, "count", summary.count);
+        json_stream_add_number(&js, "p50_us", summary.p50_us);
+        json_stream_add_number(&js, "p99_us", summary.p99_us);
+        json_stream_add_number(&js, "max_us", summary.max_us);
+        json_stream_add_number(&js, "mean_us", summary.mean_us);
+        json_stream_object_end(&js);
+    }
+    json_stream_array_end(&js);
+
+    // Load is the share of one core since the previous request
+    static pipeline_task_load_t loads[PIPELINE_STATS_MAX_TASKS];
+    size_t task_count = pipeline_stats_get_tasks(loads, PIPELINE_STATS_MAX_TASKS);
+    json_stream_add_bool(&js, "runtime_stats_available", task_count > 0);
+    json_stream_array_start(&js, "tasks");
+    for (size_t i = 0; i < task_count; i++)
+    {
+        json_stream_object_start(&js, NULL);
+        json_stream_add_string(&js, "name", loads[i].name);
+        json_stream_add_int(&js, "core", loads[i].core);
+        json_stream_add_uint(&js, "priority", loads[i].priority);
+        json_stream_add_number(&js, "cpu_percent", loads[i].cpu_permille / 10.0);
+        json_stream_add_uint(&js, "stack_free", loads[i].stack_free);
+        json_stream_object_end(&js);
+    }
+    json_stream_array_end(&js);
+    json_stream_object_end(&js);
+
+    if (reset)
+    {
+        pipeline_stats_reset();
+    }
+
+    return json_stream_finish(&js);
+}
+
+// Add reconfig_part_t names to a JSON array
+static void add_reconfig_parts(cJSON *object, const char *name, uint32_t parts)
+{
+    cJSON *array = cJSON_AddArrayToObject(object, name);
+    if (parts & RECONFIG_PART_AUDIO)
+    {
+        cJSON_AddItemToArray(array, cJSON_CreateString("audio"));
+    }
+    if (parts & RECONFIG_PART_STREAM)
+    {
+        cJSON_AddItemToArray(array, cJSON_CreateString("stream"));
+    }
+    if (parts & RECONFIG_PART_CODEC)
+    {
+        cJSON_AddItemToArray(array, cJSON_CreateString("codec"));
+    }
+}
+
+// GET /api/perf/quality - Link-quality tier and the signals behind it
+static esp_err_t api_get_perf_quality_handler(httpd_req_t *req)
+{
+    if (!web_server_v2_check_auth(req))
+    {
+        return web_server_v2_send_auth_required(req);
+    }
+
+    adaptive_quality_status_t status;
+    adaptive_quality_get_status(&status);
+
+    i2s_audio_format_t format;
+    i2s_handler_get_format(&format);
+
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddBoolToObject(response, "enabled", status.enabled);
+    cJSON_AddNumberToObject(response, "tier", status.tier);
+    cJSON_AddNumberToObject(response, "tier_count", ADAPTIVE_QUALITY_TIER_COUNT);
+    cJSON_AddNumberToObject(response, "sample_rate", format.sample_rate);
+    cJSON_AddNumberToObject(response, "bits_per_sample", format.bits_per_sample);
+    cJSON_AddStringToObject(response, "codec", audio_encoder_codec_name(audio_encoder_get_codec()));
+    cJSON_AddNumberToObject(response, "bitrate_bps", status.bitrate_bps);
+    cJSON_AddNumberToObject(response, "rssi", status.rssi);
+    cJSON_AddNumberToObject(response, "loss_percent", status.loss_percent);
+    cJSON_AddNumberToObject(response, "buffer_percent", status.buffer_percent);
+    cJSON_AddNumberToObject(response, "switches", status.switches);
+    cJSON_AddNumberToObject(response, "since_switch_ms", status.since_switch_ms);
+    cJSON_AddNumberToObject(response, "codec_steps", status.codec_steps);
+    cJSON_AddNumberToObject(response, "codec_degrades", status.codec_degrades);
+
+    esp_err_t ret = web_server_v2_send_json_response(req, response, 200);
+    cJSON_Delete(response);
+    return ret;
+}
+
+// GET /api/perf/sinks - Per-destination fan-out state (empty unless TCP and UDP both stream)
+static esp_err_t api_get_perf_sinks_handler(httpd_req_t *req)
+{
+    if (!web_server_v2_check_auth(req))
+    {
+        return web_server_v2_send_auth_required(req);
+    }
+
+    cJSON *response = cJSON_CreateObject();
+    cJSON *array = cJSON_AddArrayToObject(response, "sinks");
+    for (size_t i = 0; i < stream_sink_count(); i++)
+    {
+        stream_sink_stats_t stats;
+        if (!stream_sink_get_stats(i, &stats))
+        {
+            continue;
+        }
+        cJSON *sink = cJSON_CreateObject();
+        cJSON_AddStringToObject(sink, "name", stats.name);
+        cJSON_AddBoolToObject(sink, "connected", stats.connected);
+        cJSON_AddNumberToObject(sink, "backlog_bytes", stats.backlog_bytes);
+        cJSON_AddNumberToObject(sink, "bytes_sent", (double)stats.bytes_sent);
+        cJSON_AddNumberToObject(sink, "records_sent", stats.records_sent);
+        cJSON_AddNumberToObject(sink, "bytes_dropped", (double)stats.bytes_dropped);
+        cJSON_AddNumberToObject(sink, "overruns", stats.overruns);
+        cJSON_AddNumberToObject(sink, "refused", stats.refused);
+        cJSON_AddNumberToObject(sink, "failures", stats.failures);
+        cJSON_AddNumberToObject(sink, "connects", stats.connects);
+        cJSON_AddNumberToObject(sink, "reconnect_attempts", stats.reconnect_attempts);
+        cJSON_AddNumberToObject(sink, "backoff_ms", stats.backoff_ms);
+        cJSON_AddItemToArray(array, sink);
+    }
+    cJSON_AddNumberToObject(response, "ring_bytes", stream_sink_count() > 0 ? STREAM_SINK_BUFFER_SIZE : 0);
+
+    esp_err_t ret = web_server_v2_send_json_response(req, response, 200);
+    cJSON_Delete(response);
+    return ret;
+}
+
+// GET /api/perf/clock - Capture clock discipline and measured drift
+static esp_err_t api_get_perf_clock_handler(httpd_req_t *req)
+{
+    if (!web_server_v2_check_auth(req))
+    {
+        return web_server_v2_send_auth_required(req);
+    }
+
+    media_clock_status_t status;
+    media_clock_get_status(&status);
+    int64_t utc_us = 0;
+    media_clock_to_utc(esp_timer_get_time(), &utc_us);
+
+    static const char *sources[] = {"none", "ntp", "server"};
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddBoolToObject(response, "synced", status.synced);
+    cJSON_AddStringToObject(response, "source", sources[status.source <= MEDIA_CLOCK_SOURCE_SERVER ? status.source : 0]);
+    cJSON_AddNumberToObject(response, "utc_us", status.synced ? (double)utc_us : 0);
+    cJSON_AddNumberToObject(response, "syncs", status.syncs);
+    cJSON_AddNumberToObject(response, "steps", status.steps);
+    cJSON_AddNumberToObject(response, "since_sync_ms", status.since_sync_ms);
+    cJSON_AddNumberToObject(response, "uncertainty_us", status.uncertainty_us);
+    cJSON_AddNumberToObject(response, "last_offset_us", status.last_offset_us);
+    cJSON_AddNumberToObject(response, "timer_drift_ppm", status.timer_drift_ppb / 1000.0);
+    cJSON_AddNumberToObject(response, "sample_drift_ppm", status.sample_drift_ppb / 1000.0);
+    cJSON_AddBoolToObject(response, "sample_drift_valid", status.sample_drift_valid);
+    cJSON_AddNumberToObject(response, "capture_jitter_us", status.capture_jitter_us);
+    cJSON_AddNumberToObject(response, "capture_resyncs", status.capture_resyncs);
+
+    esp_err_t ret = web_server_v2_send_json_response(req, response, 200);
+    cJSON_Delete(response);
+    return ret;
+}
+
+// GET /api/perf/spool - Outage spool fill and backfill progress
+static esp_err_t api_get_perf_spool_handler(httpd_req_t *req)
+{
+    if (!web_server_v2_check_auth(req))
+    {
+        return web_server_v2_send_auth_required(req);
+    }
+
+    flash_spool_status_t status;
+    flash_spool_get_status(&status);
+
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddBoolToObject(response, "ready", status.ready);
+    cJSON_AddBoolToObject(response, "enabled", status.enabled);
+    cJSON_AddBoolToObject(response, "spilling", status.spilling);
+    cJSON_AddNumberToObject(response, "slots", status.slots);
+    cJSON_AddNumberToObject(response, "pending", status.pending);
+    cJSON_AddNumberToObject(response, "pending_ms", status.pending_ms);
+    cJSON_AddNumberToObject(response, "capacity_ms", status.capacity_ms);
+    cJSON_AddNumberToObject(response, "spilled", status.spilled);
+    cJSON_AddNumberToObject(response, "replayed", status.replayed);
+    cJSON_AddNumberToObject(response, "overwritten", status.overwritten);
+    cJSON_AddNumberToObject(response, "errors", status.errors);
+
+    esp_err_t ret = web_server_v2_send_json_response(req, response, 200);
+    cJSON_Delete(response);
+    return ret;
+}
+
+// GET /api/system/reconfigure - Live reconfiguration status
+static esp_err_t api_get_reconfigure_handler(httpd_req_t *req)
+{
+    if (!web_server_v2_check_auth(req))
+    {
+        return web_server_v2_send_auth_required(req);
+    }
+
+    reconfig_status_t status;
+    live_reconfig_get_status(&status);
+
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddBoolToObject(response, "active", status.active);
+    cJSON_AddBoolToObject(response, "auto_apply", LIVE_RECONFIG_AUTO_APPLY);
+    cJSON_AddBoolToObject(response, "in_progress", status.in_progress);
+    add_reconfig_parts(response, "pending", status.pending_parts);
+    add_reconfig_parts(response, "last_parts", status.last_parts);
+    cJSON_AddBoolToObject(response, "last_success", status.last_success);
+    cJSON_AddNumberToObject(response, "last_gap_ms", status.last_gap_ms);
+    cJSON_AddNumberToObject(response, "last_total_ms", status.last_total_ms);
+    cJSON_AddNumberToObject(response, "count", status.count);
+    cJSON_AddNumberToObject(response, "failures", status.failures);
+
+    esp_err_t ret = web_server_v2_send_json_response(req, response, 200);
+    cJSON_Delete(response);
+    return ret;
+}
+
+// POST /api/system/reconfigure - Apply audio/stream changes without a restart
+// Body (optional): {"audio": true, "stream": true}; default is whatever changed
+static esp_err_t api_post_reconfigure_handler(httpd_req_t *req)
+{
+    if (!web_server_v2_check_auth(req))
+    {
+        return web_server_v2_send_auth_required(req);
+    }
+
+    uint32_t parts = 0;
+    if (req->content_len > 0)
+    {
+        char buf[128];
+        if (safe_httpd_req_recv(req, buf, sizeof(buf), NULL) != ESP_OK)
+        {
+            return ESP_FAIL;
+        }
+
+        cJSON *root = cJSON_Parse(buf);
+        if (!root)
+        {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+            return ESP_FAIL;
+        }
+        if (cJSON_IsTrue(cJSON_GetObjectItem(root, "audio")))
+        {
+            parts |= RECONFIG_PART_AUDIO;
+        }
+        if (cJSON_IsTrue(cJSON_GetObjectItem(root, "stream")))
+        {
+            parts |= RECONFIG_PART_STREAM;
+        }
+        cJSON_Delete(root);
+    }
+
+    reconfig_status_t status;
+    live_reconfig_get_status(&status);
+
+    cJSON *response = cJSON_CreateObject();
+    int code = 200;
+    if (!status.active)
+    {
+        cJSON_AddStringToObject(response, "status", "error");
+        cJSON_AddStringToObject(response, "message", "Live reconfiguration not running. Restart to apply changes.");
+        code = 500;
+    }
+    else if (!live_reconfig_request(parts))
+    {
+        cJSON_AddStringToObject(response, "status", "success");
+        cJSON_AddStringToObject(response, "message", "No changes to apply.");
+    }
+    else
+    {
+        cJSON_AddStringToObject(response, "status", "accepted");
+        cJSON_AddStringToObject(response, "message", "Reconfiguration queued. GET this endpoint for the measured gap.");
+        add_reconfig_parts(response, "parts", parts != 0 ? parts : status.pending_parts);
+    }
+
+    esp_err_t ret = web_server_v2_send_json_response(req, response, code);
+    cJSON_Delete(response);
+    return ret;
+}
+
 // POST /api/system/restart - Restart device
 static esp_err_t api_post_restart_handler(httpd_req_t *req)
 {
@@ -1198,130 +1732,93 @@ static esp_err_t api_get_validate_handler(httpd_req_t *req)
 // Static File Serving (Embedded Web UI)
 // ========================================
 
-// External symbols for embedded web files
-extern const uint8_t index_html_start[] asm("_binary_index_html_start");
-extern const uint8_t index_html_end[] asm("_binary_index_html_end");
-extern const uint8_t config_html_start[] asm("_binary_config_html_start");
-extern const uint8_t config_html_end[] asm("_binary_config_html_end");
-extern const uint8_t monitor_html_start[] asm("_binary_monitor_html_start");
-extern const uint8_t monitor_html_end[] asm("_binary_monitor_html_end");
-extern const uint8_t ota_html_start[] asm("_binary_ota_html_start");
-extern const uint8_t ota_html_end[] asm("_binary_ota_html_end");
-extern const uint8_t logs_html_start[] asm("_binary_logs_html_start");
-extern const uint8_t logs_html_end[] asm("_binary_logs_html_end");
-extern const uint8_t network_html_start[] asm("_binary_network_html_start");
-extern const uint8_t network_html_end[] asm("_binary_network_html_end");
-extern const uint8_t style_css_start[] asm("_binary_style_css_start");
-extern const uint8_t style_css_end[] asm("_binary_style_css_end");
-extern const uint8_t api_js_start[] asm("_binary_api_js_start");
-extern const uint8_t api_js_end[] asm("_binary_api_js_end");
-extern const uint8_t utils_js_start[] asm("_binary_utils_js_start");
-extern const uint8_t utils_js_end[] asm("_binary_utils_js_end");
-extern const uint8_t app_js_start[] asm("_binary_app_js_start");
-extern const uint8_t app_js_end[] asm("_binary_app_js_end");
-extern const uint8_t config_js_start[] asm("_binary_config_js_start");
-extern const uint8_t config_js_end[] asm("_binary_config_js_end");
-extern const uint8_t monitor_js_start[] asm("_binary_monitor_js_start");
-extern const uint8_t monitor_js_end[] asm("_binary_monitor_js_end");
-extern const uint8_t ota_js_start[] asm("_binary_ota_js_start");
-extern const uint8_t ota_js_end[] asm("_binary_ota_js_end");
-extern const uint8_t logs_js_start[] asm("_binary_logs_js_start");
-extern const uint8_t logs_js_end[] asm("_binary_logs_js_end");
-extern const uint8_t network_js_start[] asm("_binary_network_js_start");
-extern const uint8_t network_js_end[] asm("_binary_network_js_end");
-
-static const char *get_mime_type(const char *path)
-{
-    const char *ext = strrchr(path, '.');
-    if (!ext)
-        return "application/octet-stream";
-    if (strcmp(ext, ".html") == 0)
-        return "text/html";
-    if (strcmp(ext, ".css") == 0)
-        return "text/css";
-    if (strcmp(ext, ".js") == 0)
-        return "application/javascript";
-    if (strcmp(ext, ".json") == 0)
-        return "application/json";
-    return "application/octet-stream";
-}
+#define ASSET_STR(x) #x
+#define ASSET_XSTR(x) ASSET_STR(x)
+#define IMMUTABLE_CACHE_CONTROL "public, max-age=" ASSET_XSTR(WEB_ASSET_MAX_AGE_S) ", immutable"
 
-static esp_err_t serve_embedded_file(httpd_req_t *req, const uint8_t *start, const uint8_t *end, const char *path)
+// Inflate an embedded asset for a client that does not take gzip (rare: every browser does)
+static esp_err_t send_inflated_asset(httpd_req_t *req, const web_asset_t *asset)
 {
-    size_t file_size = end - start;
-    if (file_size > 0 && start[file_size - 1] == '\0')
-        file_size--; // Remove null terminator
-    const char *mime_type = get_mime_type(path);
-    web_server_v2_add_cors_headers(req);
-    httpd_resp_set_type(req, mime_type);
-    httpd_resp_send(req, (const char *)start, file_size);
-    return ESP_OK;
-}
+    const size_t gzip_header = 10, gzip_trailer = 8; // Written without file name or extra fields
+    tinfl_decompressor *inflator = (tinfl_decompressor *)malloc(sizeof(tinfl_decompressor));
+    uint8_t *out = (uint8_t *)malloc(asset->size);
+    if (inflator == NULL || out == NULL)
+    {
+        free(inflator);
+        free(out);
+        return httpd_resp_send_500(req);
+    }
 
-// HTML file handlers (NO authentication required for captive portal)
-static esp_err_t root_handler(httpd_req_t *req)
-{
-    return serve_embedded_file(req, index_html_start, index_html_end, "index.html");
-}
-static esp_err_t config_html_handler(httpd_req_t *req)
-{
-    return serve_embedded_file(req, config_html_start, config_html_end, "config.html");
-}
-static esp_err_t monitor_html_handler(httpd_req_t *req)
-{
-    return serve_embedded_file(req, monitor_html_start, monitor_html_end, "monitor.html");
-}
-static esp_err_t ota_html_handler(httpd_req_t *req)
-{
-    return serve_embedded_file(req, ota_html_start, ota_html_end, "ota.html");
-}
-static esp_err_t logs_html_handler(httpd_req_t *req)
-{
-    return serve_embedded_file(req, logs_html_start, logs_html_end, "logs.html");
-}
-static esp_err_t network_html_handler(httpd_req_t *req)
-{
-    return serve_embedded_file(req, network_html_start, network_html_end, "network.html");
-}
+    tinfl_init(inflator);
+    size_t in_size = asset->gzip_size - gzip_header - gzip_trailer;
+    size_t out_size = asset->size;
+    tinfl_status status = tinfl_decompress(inflator, asset->gzip + gzip_header, &in_size, out, out, &out_size,
+                                           TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
+    free(inflator);
 
-// CSS handlers
-static esp_err_t css_style_handler(httpd_req_t *req)
-{
-    return serve_embedded_file(req, style_css_start, style_css_end, "style.css");
+    esp_err_t ret;
+    if (status == TINFL_STATUS_DONE && out_size == asset->size)
+    {
+        ret = httpd_resp_send(req, (const char *)out, out_size);
+    }
+    else
+    {
+        ESP_LOGE(TAG, "Failed to inflate %s (%d)", asset->uri, status);
+        ret = httpd_resp_send_500(req);
+    }
+    free(out);
+    return ret;
 }
 
-// JS handlers
-static esp_err_t js_api_handler(httpd_req_t *req)
-{
-    return serve_embedded_file(req, api_js_start, api_js_end, "api.js");
-}
-static esp_err_t js_utils_handler(httpd_req_t *req)
-{
-    return serve_embedded_file(req, utils_js_start, utils_js_end, "utils.js");
-}
-static esp_err_t js_app_handler(httpd_req_t *req)
-{
-    return serve_embedded_file(req, app_js_start, app_js_end, "app.js");
-}
-static esp_err_t js_config_handler(httpd_req_t *req)
+// Does the request header contain token (truncated values are still searched)
+static bool request_header_has(httpd_req_t *req, const char *field, const char *token)
 {
-    return serve_embedded_file(req, config_js_start, config_js_end, "config.js");
+    char value[128];
+    esp_err_t ret = httpd_req_get_hdr_value_str(req, field, value, sizeof(value));
+    return (ret == ESP_OK || ret == ESP_ERR_HTTPD_RESULT_TRUNC) && strstr(value, token) != NULL;
 }
-static esp_err_t js_monitor_handler(httpd_req_t *req)
-{
-    return serve_embedded_file(req, monitor_js_start, monitor_js_end, "monitor.js");
-}
-static esp_err_t js_ota_handler(httpd_req_t *req)
-{
-    return serve_embedded_file(req, ota_js_start, ota_js_end, "ota.js");
-}
-static esp_err_t js_logs_handler(httpd_req_t *req)
+
+// Static file handler (NO authentication required for captive portal), asset in user_ctx
+static esp_err_t static_asset_handler(httpd_req_t *req)
 {
-    return serve_embedded_file(req, logs_js_start, logs_js_end, "logs.js");
+    const web_asset_t *asset = (const web_asset_t *)req->user_ctx;
+
+    web_server_v2_add_cors_headers(req);
+    httpd_resp_set_hdr(req, "ETag", asset->etag);
+    httpd_resp_set_hdr(req, "Cache-Control", asset->immutable ? IMMUTABLE_CACHE_CONTROL : "no-cache");
+    httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+
+    if (request_header_has(req, "If-None-Match", asset->etag))
+    {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    httpd_resp_set_type(req, asset->mime_type);
+    if (!request_header_has(req, "Accept-Encoding", "gzip"))
+    {
+        return send_inflated_asset(req, asset);
+    }
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    return httpd_resp_send(req, (const char *)asset->gzip, asset->gzip_size);
 }
-static esp_err_t js_network_handler(httpd_req_t *req)
+
+static bool register_static_asset(const char *uri, const web_asset_t *asset)
 {
-    return serve_embedded_file(req, network_js_start, network_js_end, "network.js");
+    httpd_uri_t handler = {
+        .uri = uri,
+        .method = HTTP_GET,
+        .handler = static_asset_handler,
+        .user_ctx = (void *)asset,
+        .is_websocket = false,
+        .handle_ws_control_frames = false,
+        .supported_subprotocol = NULL};
+    if (httpd_register_uri_handler(server, &handler) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to register static file %s", uri);
+        return false;
+    }
+    return true;
 }
 
 // Initialize web server v2
@@ -1336,7 +1833,7 @@ bool web_server_v2_init(void)
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = 80;
     config.max_uri_handlers = 50; // API endpoints + static files + OTA + OPTIONS (added /api/config/wifi)
-    config.max_open_sockets = 4;
+    config.max_open_sockets = 4 + WS_PUSH_MAX_CLIENTS; // WebSocket viewers keep theirs open
     config.lru_purge_enable = true;
     config.stack_size = 12288; // Increased from 8192 to prevent stack overflow
 
@@ -1379,6 +1876,16 @@ bool web_server_v2_init(void)
         {.uri = "/api/system/save", .method = HTTP_POST, .handler = api_post_save_config_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
         {.uri = "/api/system/load", .method = HTTP_POST, .handler = api_post_load_config_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
         {.uri = "/api/system/validate", .method = HTTP_GET, .handler = api_get_validate_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
+        {.uri = "/api/system/reconfigure", .method = HTTP_GET, .handler = api_get_reconfigure_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
+        {.uri = "/api/system/reconfigure", .method = HTTP_POST, .handler = api_post_reconfigure_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
+
+        // Performance endpoints
+        {.uri = "/api/perf/history", .method = HTTP_GET, .handler = api_get_perf_history_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
+        {.uri = "/api/perf/pipeline", .method = HTTP_GET, .handler = api_get_perf_pipeline_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
+        {.uri = "/api/perf/quality", .method = HTTP_GET, .handler = api_get_perf_quality_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
+        {.uri = "/api/perf/sinks", .method = HTTP_GET, .handler = api_get_perf_sinks_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
+        {.uri = "/api/perf/clock", .method = HTTP_GET, .handler = api_get_perf_clock_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
+        {.uri = "/api/perf/spool", .method = HTTP_GET, .handler = api_get_perf_spool_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
     };
 
     // Register all API endpoints
@@ -1392,38 +1899,24 @@ bool web_server_v2_init(void)
     }
 
     // ✅ Register static file handlers (HTML, CSS, JS) for web UI
-    const httpd_uri_t static_files[] = {
-        {.uri = "/", .method = HTTP_GET, .handler = root_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
-        {.uri = "/index.html", .method = HTTP_GET, .handler = root_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
-        {.uri = "/config.html", .method = HTTP_GET, .handler = config_html_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
-        {.uri = "/monitor.html", .method = HTTP_GET, .handler = monitor_html_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
-        {.uri = "/ota.html", .method = HTTP_GET, .handler = ota_html_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
-        {.uri = "/logs.html", .method = HTTP_GET, .handler = logs_html_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
-        {.uri = "/network.html", .method = HTTP_GET, .handler = network_html_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
-        {.uri = "/css/style.css", .method = HTTP_GET, .handler = css_style_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
-        {.uri = "/js/api.js", .method = HTTP_GET, .handler = js_api_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
-        {.uri = "/js/utils.js", .method = HTTP_GET, .handler = js_utils_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
-        {.uri = "/js/app.js", .method = HTTP_GET, .handler = js_app_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
-        {.uri = "/js/config.js", .method = HTTP_GET, .handler = js_config_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
-        {.uri = "/js/monitor.js", .method = HTTP_GET, .handler = js_monitor_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
-        {.uri = "/js/ota.js", .method = HTTP_GET, .handler = js_ota_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
-        {.uri = "/js/logs.js", .method = HTTP_GET, .handler = js_logs_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
-        {.uri = "/js/network.js", .method = HTTP_GET, .handler = js_network_handler, .user_ctx = NULL, .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL},
-    };
-
-    for (size_t i = 0; i < sizeof(static_files) / sizeof(static_files[0]); i++)
+    size_t static_count = 0;
+    for (size_t i = 0; i < web_asset_count; i++)
     {
-        esp_err_t ret = httpd_register_uri_handler(server, &static_files[i]);
-        if (ret != ESP_OK)
+        const web_asset_t *asset = &web_assets[i];
+        static_count += register_static_asset(asset->uri, asset) ? 1 : 0;
+        if (strcmp(asset->uri, "/index.html") == 0)
         {
-            ESP_LOGE(TAG, "Failed to register static file %s", static_files[i].uri);
+            static_count += register_static_asset("/", asset) ? 1 : 0;
         }
     }
 
     // Register OTA endpoints (from existing OTA handler)
     ota_handler_register_endpoints(server);
 
-    size_t total_endpoints = sizeof(endpoints) / sizeof(endpoints[0]) + sizeof(static_files) / sizeof(static_files[0]);
+    // Live metrics/logs push for the dashboards (non-critical)
+    ws_push_start(server);
+
+    size_t total_endpoints = sizeof(endpoints) / sizeof(endpoints[0]) + static_count;
     ESP_LOGI(TAG, "Web server v2 started successfully with %zu endpoints", total_endpoints);
     return true;
 }
@@ -1437,6 +1930,7 @@ void web_server_v2_deinit(void)
 {
     if (server != NULL)
     {
+        ws_push_stop();
         httpd_stop(server);
         server = NULL;
         ESP_LOGI(TAG, "Web server v2 stopped");
@@ -40,6 +40,13 @@ httpd_handle_t web_server_v2_get_handle(void);
  */
 bool web_server_v2_check_auth(httpd_req_t *req);
 
+/**
+ * Check Basic-auth credentials against the configured ones
+ * @param encoded base64 of "username:password" (the Authorization value after "Basic ")
+ * @return true if they match
+ */
+bool web_server_v2_check_credentials(const char *encoded);
+
 /**
  * Send authentication required response
  * @param req HTTP request
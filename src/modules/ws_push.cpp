@@ -0,0 +1,505 @@
+#include "ws_push.h"
+#include "web_server_v2.h"
+#include "log_manager.h"
+#include "network_manager.h"
+#include "tcp_streamer.h"
+#include "buffer_manager.h"
+#include "latency_profile.h"
+#include "i2s_handler.h"
+#include "vad_gate.h"
+#include "dsp_chain.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <atomic>
+
+static const char *TAG = "WS_PUSH";
+
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+
+#define WS_SECTION_METRICS 0x01
+#define WS_SECTION_LOGS 0x02
+#define WS_LOG_BATCH 8 // Log entries fetched per client per push
+
+// Wire width of each field (ws_metric_field_t order)
+static const uint8_t field_bytes[WS_FIELD_COUNT] = {4, 1, 1, 1, 8, 4, 1, 4, 4, 4, 4, 4, 4, 1, 2};
+
+typedef struct
+{
+    int fd; // -1 = free slot
+    std::atomic<bool> busy; // Frame queued on the httpd task
+    std::atomic<bool> failed;
+    uint32_t interval_ms;
+    int64_t last_push_us;
+    uint32_t log_seq;     // Last log entry sent
+    int32_t log_tokens;   // Bytes the client may still receive
+    int64_t log_refill_us;
+    bool has_sent;        // sent[] is valid
+    uint64_t sent[WS_FIELD_COUNT];
+    size_t frame_len;
+    uint8_t frame[WS_PUSH_FRAME_MAX];
+} ws_client_t;
+
+static httpd_handle_t ws_server = NULL;
+static ws_client_t clients[WS_PUSH_MAX_CLIENTS];
+static uint8_t client_count = 0;
+static SemaphoreHandle_t clients_mutex = NULL;
+static TaskHandle_t push_task_handle = NULL;
+
+static void remove_client(ws_client_t *c)
+{
+    ESP_LOGI(TAG, "WebSocket client %d disconnected", c->fd);
+    c->fd = -1;
+    client_count--;
+}
+
+// Percent-decode a query value in place
+static void url_decode(char *s)
+{
+    char *out = s;
+    for (; *s != '\0'; s++)
+    {
+        if (*s == '%' && isxdigit((unsigned char)s[1]) && isxdigit((unsigned char)s[2]))
+        {
+            char hex[3] = {s[1], s[2], '\0'};
+            *out++ = (char)strtol(hex, NULL, 16);
+            s += 2;
+        }
+        else
+        {
+            *out++ = *s;
+        }
+    }
+    *out = '\0';
+}
+
+static bool ws_authorized(httpd_req_t *req)
+{
+    if (web_server_v2_check_auth(req))
+    {
+        return true;
+    }
+
+    char query[160];
+    char token[128];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "auth", token, sizeof(token)) == ESP_OK)
+    {
+        url_decode(token);
+        return web_server_v2_check_credentials(token);
+    }
+    return false;
+}
+
+static bool add_client(int fd)
+{
+    bool added = false;
+    xSemaphoreTake(clients_mutex, portMAX_DELAY);
+
+    for (int i = 0; i < WS_PUSH_MAX_CLIENTS; i++)
+    {
+        ws_client_t *c = &clients[i];
+        // Reclaim slots of sockets httpd has already closed
+        if (c->fd >= 0 && !c->busy.load() && httpd_ws_get_fd_info(ws_server, c->fd) != HTTPD_WS_CLIENT_WEBSOCKET)
+        {
+            remove_client(c);
+        }
+    }
+
+    for (int i = 0; i < WS_PUSH_MAX_CLIENTS && !added; i++)
+    {
+        ws_client_t *c = &clients[i];
+        if (c->fd >= 0 || c->busy.load())
+        {
+            continue;
+        }
+        c->fd = fd;
+        c->failed.store(false);
+        c->interval_ms = WS_PUSH_DEFAULT_INTERVAL_MS;
+        c->last_push_us = 0; // First frame on the next tick
+        c->log_seq = 0;      // Start with the buffered backlog
+        c->log_tokens = WS_PUSH_FRAME_MAX;
+        c->log_refill_us = esp_timer_get_time();
+        c->has_sent = false;
+        client_count++;
+        added = true;
+    }
+
+    xSemaphoreGive(clients_mutex);
+    return added;
+}
+
+static void set_client_interval(int fd, uint32_t interval_ms)
+{
+    if (interval_ms < WS_PUSH_MIN_INTERVAL_MS)
+    {
+        interval_ms = WS_PUSH_MIN_INTERVAL_MS;
+    }
+
+    xSemaphoreTake(clients_mutex, portMAX_DELAY);
+    for (int i = 0; i < WS_PUSH_MAX_CLIENTS; i++)
+    {
+        if (clients[i].fd == fd)
+        {
+            clients[i].interval_ms = interval_ms;
+        }
+    }
+    xSemaphoreGive(clients_mutex);
+}
+
+static esp_err_t ws_handler(httpd_req_t *req)
+{
+    if (req->method == HTTP_GET)
+    {
+        // httpd has already answered the upgrade; refuse by closing the session
+        if (!ws_authorized(req))
+        {
+            ESP_LOGW(TAG, "Unauthorized WebSocket client");
+            return ESP_FAIL;
+        }
+        int fd = httpd_req_to_sockfd(req);
+        if (!add_client(fd))
+        {
+            ESP_LOGW(TAG, "WebSocket client limit (%d) reached", WS_PUSH_MAX_CLIENTS);
+            return ESP_FAIL;
+        }
+        ESP_LOGI(TAG, "WebSocket client %d connected", fd);
+        return ESP_OK;
+    }
+
+    // Data frame from the client (httpd answers ping/close itself)
+    httpd_ws_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    if (httpd_ws_recv_frame(req, &frame, 0) != ESP_OK)
+    {
+        return ESP_FAIL;
+    }
+
+    char payload[32];
+    if (frame.len >= sizeof(payload))
+    {
+        ESP_LOGW(TAG, "Oversized WebSocket message (%d bytes)", (int)frame.len);
+        return ESP_FAIL;
+    }
+    frame.payload = (uint8_t *)payload;
+    if (frame.len > 0 && httpd_ws_recv_frame(req, &frame, sizeof(payload) - 1) != ESP_OK)
+    {
+        return ESP_FAIL;
+    }
+    payload[frame.len] = '\0';
+
+    if (frame.type == HTTPD_WS_TYPE_TEXT && strncmp(payload, "interval=", 9) == 0)
+    {
+        set_client_interval(httpd_req_to_sockfd(req), strtoul(payload + 9, NULL, 10));
+    }
+    return ESP_OK;
+}
+
+// Runs on the httpd task, which owns the sockets
+static void ws_send_work(void *arg)
+{
+    ws_client_t *c = (ws_client_t *)arg;
+
+    httpd_ws_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.final = true;
+    frame.type = HTTPD_WS_TYPE_BINARY;
+    frame.payload = c->frame;
+    frame.len = c->frame_len;
+    if (ws_server == NULL || httpd_ws_send_frame_async(ws_server, c->fd, &frame) != ESP_OK)
+    {
+        c->failed.store(true);
+    }
+    c->busy.store(false);
+}
+
+static void collect_metrics(uint64_t *values)
+{
+    values[WS_FIELD_UPTIME_SEC] = esp_timer_get_time() / 1000000;
+
+    bool wifi = network_manager_is_connected();
+    values[WS_FIELD_WIFI_CONNECTED] = wifi;
+    values[WS_FIELD_WIFI_RSSI] = 0;
+    wifi_ap_record_t ap_info;
+    if (wifi && esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK)
+    {
+        values[WS_FIELD_WIFI_RSSI] = (uint8_t)ap_info.rssi;
+    }
+
+    uint64_t bytes_sent = 0;
+    uint32_t reconnects = 0;
+    tcp_streamer_get_stats(&bytes_sent, &reconnects);
+    values[WS_FIELD_TCP_CONNECTED] = tcp_streamer_is_connected();
+    values[WS_FIELD_TCP_BYTES_SENT] = bytes_sent;
+    values[WS_FIELD_TCP_RECONNECTS] = reconnects;
+
+    values[WS_FIELD_BUFFER_USAGE] = buffer_manager_usage_percent();
+    values[WS_FIELD_FREE_HEAP] = esp_get_free_heap_size();
+    values[WS_FIELD_MIN_FREE_HEAP] = esp_get_minimum_free_heap_size();
+
+    latency_stats_t latency;
+    latency_profile_get_stats(&latency);
+    values[WS_FIELD_LATENCY_AVG_US] = latency.avg_us;
+    values[WS_FIELD_LATENCY_MAX_US] = latency.max_us;
+
+    i2s_audio_format_t format;
+    i2s_handler_get_format(&format);
+    values[WS_FIELD_SAMPLE_RATE] = format.sample_rate;
+
+    uint32_t overflow_events = 0;
+    buffer_manager_get_drop_stats(NULL, NULL, &overflow_events);
+    values[WS_FIELD_OVERFLOW_EVENTS] = overflow_events;
+
+    bool vad_open = true;
+    vad_gate_get_stats(&vad_open, NULL, NULL);
+    values[WS_FIELD_VAD_OPEN] = vad_open;
+    values[WS_FIELD_AGC_GAIN_DB10] = (uint16_t)(int16_t)dsp_chain_agc_gain_db10();
+}
+
+static size_t put_le(uint8_t *out, uint64_t value, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; i++)
+    {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+    return bytes;
+}
+
+// Fields that changed since the client's previous frame
+static size_t build_metrics_section(ws_client_t *c, const uint64_t *values, uint8_t *out)
+{
+    uint32_t mask = 0;
+    for (int f = 0; f < WS_FIELD_COUNT; f++)
+    {
+        if (!c->has_sent || c->sent[f] != values[f])
+        {
+            mask |= 1u << f;
+        }
+    }
+    if (mask == 0)
+    {
+        return 0;
+    }
+
+    size_t n = 0;
+    out[n++] = WS_SECTION_METRICS;
+    n += put_le(out + n, mask, 4);
+    for (int f = 0; f < WS_FIELD_COUNT; f++)
+    {
+        if (mask & (1u << f))
+        {
+            n += put_le(out + n, values[f], field_bytes[f]);
+            c->sent[f] = values[f];
+        }
+    }
+    c->has_sent = true;
+    return n;
+}
+
+// New log entries, as many as the client's byte budget and the frame allow
+static size_t build_logs_section(ws_client_t *c, uint8_t *out, size_t room, int64_t now_us)
+{
+    static log_entry_t logs[WS_LOG_BATCH]; // Push task only
+
+    int64_t refill = (now_us - c->log_refill_us) * WS_PUSH_LOG_BYTES_PER_SEC / 1000000;
+    if (refill > 0)
+    {
+        c->log_tokens = (int32_t)((c->log_tokens + refill > WS_PUSH_FRAME_MAX) ? WS_PUSH_FRAME_MAX : c->log_tokens + refill);
+        c->log_refill_us = now_us;
+    }
+    if (room < 2 || c->log_tokens <= 0)
+    {
+        return 0;
+    }
+
+    size_t fetched = log_manager_get_since(c->log_seq, logs, WS_LOG_BATCH);
+    size_t n = 2;
+    uint8_t count = 0;
+    for (size_t i = 0; i < fetched; i++)
+    {
+        size_t tag_len = strnlen(logs[i].tag, MAX_LOG_TAG_LEN);
+        size_t msg_len = strnlen(logs[i].message, MAX_LOG_MESSAGE_LEN);
+        size_t entry_len = 4 + 4 + 1 + 1 + tag_len + 1 + msg_len;
+        if (n + entry_len > room || (int32_t)entry_len > c->log_tokens)
+        {
+            break;
+        }
+
+        n += put_le(out + n, logs[i].seq, 4);
+        n += put_le(out + n, logs[i].timestamp, 4);
+        out[n++] = (uint8_t)logs[i].level;
+        out[n++] = (uint8_t)tag_len;
+        memcpy(out + n, logs[i].tag, tag_len);
+        n += tag_len;
+        out[n++] = (uint8_t)msg_len;
+        memcpy(out + n, logs[i].message, msg_len);
+        n += msg_len;
+
+        c->log_tokens -= entry_len;
+        c->log_seq = logs[i].seq;
+        count++;
+    }
+
+    if (count == 0)
+    {
+        return 0;
+    }
+    out[0] = WS_SECTION_LOGS;
+    out[1] = count;
+    return n;
+}
+
+static void ws_push_task(void *arg)
+{
+    uint64_t values[WS_FIELD_COUNT];
+
+    while (1)
+    {
+        vTaskDelay(pdMS_TO_TICKS(WS_PUSH_TICK_MS));
+        if (client_count == 0)
+        {
+            continue;
+        }
+
+        int64_t now_us = esp_timer_get_time();
+        bool collected = false;
+
+        xSemaphoreTake(clients_mutex, portMAX_DELAY);
+        for (int i = 0; i < WS_PUSH_MAX_CLIENTS && ws_server != NULL; i++)
+        {
+            ws_client_t *c = &clients[i];
+            if (c->fd < 0 || c->busy.load())
+            {
+                continue; // Previous frame still in flight: skip, never queue up
+            }
+            if (c->failed.load() || httpd_ws_get_fd_info(ws_server, c->fd) != HTTPD_WS_CLIENT_WEBSOCKET)
+            {
+                remove_client(c);
+                continue;
+            }
+            if (now_us - c->last_push_us < (int64_t)c->interval_ms * 1000)
+            {
+                continue;
+            }
+            c->last_push_us = now_us;
+
+            // One sample per tick, shared by every client that is due
+            if (!collected)
+            {
+                collect_metrics(values);
+                collected = true;
+            }
+
+            size_t len = build_metrics_section(c, values, c->frame);
+            len += build_logs_section(c, c->frame + len, sizeof(c->frame) - len, now_us);
+            if (len == 0)
+            {
+                continue;
+            }
+
+            c->frame_len = len;
+            c->busy.store(true);
+            if (httpd_queue_work(ws_server, ws_send_work, c) != ESP_OK)
+            {
+                c->busy.store(false);
+                c->has_sent = false; // Resend everything next time
+            }
+        }
+        xSemaphoreGive(clients_mutex);
+    }
+}
+
+bool ws_push_start(httpd_handle_t server)
+{
+    if (clients_mutex == NULL)
+    {
+        clients_mutex = xSemaphoreCreateMutex();
+        if (clients_mutex == NULL)
+        {
+            ESP_LOGE(TAG, "Failed to create client mutex");
+            return false;
+        }
+        for (int i = 0; i < WS_PUSH_MAX_CLIENTS; i++)
+        {
+            clients[i].fd = -1;
+            clients[i].busy.store(false);
+        }
+    }
+
+    ws_server = server;
+
+    const httpd_uri_t ws_uri = {
+        .uri = "/ws",
+        .method = HTTP_GET,
+        .handler = ws_handler,
+        .user_ctx = NULL,
+        .is_websocket = true,
+        .handle_ws_control_frames = false,
+        .supported_subprotocol = NULL};
+    if (httpd_register_uri_handler(server, &ws_uri) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to register /ws");
+        return false;
+    }
+
+    if (push_task_handle == NULL &&
+        xTaskCreatePinnedToCore(ws_push_task, "ws_push", WS_PUSH_STACK_SIZE, NULL,
+                                WS_PUSH_PRIORITY, &push_task_handle, WS_PUSH_CORE) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create push task");
+        push_task_handle = NULL;
+        return false;
+    }
+
+    ESP_LOGI(TAG, "WebSocket push on /ws (max %d clients)", WS_PUSH_MAX_CLIENTS);
+    return true;
+}
+
+void ws_push_stop(void)
+{
+    if (clients_mutex == NULL)
+    {
+        return;
+    }
+
+    xSemaphoreTake(clients_mutex, portMAX_DELAY);
+    for (int i = 0; i < WS_PUSH_MAX_CLIENTS; i++)
+    {
+        clients[i].fd = -1;
+    }
+    client_count = 0;
+    ws_server = NULL;
+    xSemaphoreGive(clients_mutex);
+}
+
+uint8_t ws_push_client_count(void)
+{
+    return client_count;
+}
+
+#else // !CONFIG_HTTPD_WS_SUPPORT
+
+bool ws_push_start(httpd_handle_t server)
+{
+    (void)server;
+    ESP_LOGW(TAG, "CONFIG_HTTPD_WS_SUPPORT is off, /ws not available");
+    return false;
+}
+
+void ws_push_stop(void)
+{
+}
+
+uint8_t ws_push_client_count(void)
+{
+    return 0;
+}
+
+#endif // CONFIG_HTTPD_WS_SUPPORT
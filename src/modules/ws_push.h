@@ -0,0 +1,71 @@
+#ifndef WS_PUSH_H
+#define WS_PUSH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_http_server.h"
+#include "../config.h"
+
+/**
+ * WebSocket push channel (/ws) for live metrics and logs
+ *
+ * Replaces dashboard polling: one long-lived socket per viewer, and a single
+ * low-priority task that samples the metrics once per tick and pushes each
+ * client only the fields that changed since its previous frame, plus new
+ * log_manager entries. Every client has its own metrics interval (at least
+ * WS_PUSH_MIN_INTERVAL_MS) and a token bucket on log bytes, and at most one
+ * frame in flight; a slow client is skipped rather than queued for.
+ *
+ * Authentication: the Authorization header, or ?auth=<base64 user:pass>
+ * since browsers cannot set headers on a WebSocket.
+ *
+ * Binary frame: a sequence of sections, integers little-endian.
+ *   0x01 metrics: u32 field mask, then each set field in ascending bit order
+ *        in its width (ws_metric_field_t)
+ *   0x02 logs:    u8 count, then count x {u32 seq, u32 timestamp_ms,
+ *        u8 level, u8 tag_len, tag, u8 msg_len, msg}
+ * Text from the client: "interval=<ms>" sets its metrics interval.
+ */
+
+/**
+ * Metric fields, in wire bit order
+ */
+typedef enum
+{
+    WS_FIELD_UPTIME_SEC = 0,      // u32
+    WS_FIELD_WIFI_CONNECTED = 1,  // u8
+    WS_FIELD_WIFI_RSSI = 2,       // i8
+    WS_FIELD_TCP_CONNECTED = 3,   // u8
+    WS_FIELD_TCP_BYTES_SENT = 4,  // u64
+    WS_FIELD_TCP_RECONNECTS = 5,  // u32
+    WS_FIELD_BUFFER_USAGE = 6,    // u8, percent
+    WS_FIELD_FREE_HEAP = 7,       // u32
+    WS_FIELD_MIN_FREE_HEAP = 8,   // u32
+    WS_FIELD_LATENCY_AVG_US = 9,  // u32
+    WS_FIELD_LATENCY_MAX_US = 10, // u32
+    WS_FIELD_SAMPLE_RATE = 11,    // u32
+    WS_FIELD_OVERFLOW_EVENTS = 12, // u32
+    WS_FIELD_VAD_OPEN = 13,       // u8
+    WS_FIELD_AGC_GAIN_DB10 = 14,  // i16
+    WS_FIELD_COUNT
+} ws_metric_field_t;
+
+/**
+ * Register /ws on the web server and start the push task
+ *
+ * @param server Running HTTP server
+ * @return true on success (false if WebSocket support is not compiled in)
+ */
+bool ws_push_start(httpd_handle_t server);
+
+/**
+ * Drop all clients before the web server stops
+ */
+void ws_push_stop(void);
+
+/**
+ * Get the number of connected WebSocket clients
+ */
+uint8_t ws_push_client_count(void);
+
+#endif // WS_PUSH_H